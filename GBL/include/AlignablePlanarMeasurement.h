@@ -0,0 +1,83 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @addtogroup genfit
+ * @{
+ */
+
+#ifndef genfit_AlignablePlanarMeasurement_h
+#define genfit_AlignablePlanarMeasurement_h
+
+#include "ICalibrationParametersDerivatives.h"
+#include "PlanarMeasurement.h"
+
+
+namespace genfit {
+
+/** @brief Planar measurement with rigid body alignment derivatives of its sensor
+ *
+ * The global parameters are the shifts (du, dv, dw) of the sensor along its
+ * u, v and normal w axes and the rotations (alpha, beta, gamma) around them.
+ * Their labels are label(planeId, 0..5), and are cached per sensor, so
+ * fillGlobalDerivatives(...) does not allocate.
+ *
+ * With the predicted state (q/p, u', v', u, v) on the plane, the derivatives
+ * of the residuals (first order) are
+ *
+ * du: ( 1, 0, -u', -u'v,  u'u, -v )
+ * dv: ( 0, 1, -v', -v'v,  v'u,  u )
+ *
+ * Both rows are filled for 1D strips as well; the unmeasured coordinate
+ * is disabled by GblFitterInfo via its precision.
+ */
+class AlignablePlanarMeasurement : public PlanarMeasurement, public ICalibrationParametersDerivatives {
+
+ public:
+  AlignablePlanarMeasurement(int nDim = 1);
+  AlignablePlanarMeasurement(const TVectorD& rawHitCoords, const TMatrixDSym& rawHitCov, int detId, int hitId, TrackPoint* trackPoint);
+
+  virtual ~AlignablePlanarMeasurement() {;}
+
+  virtual AbsMeasurement* clone() const override {return new AlignablePlanarMeasurement(*this);}
+
+  static const unsigned int nAlignmentParameters = 6;
+  //! Millepede label of alignment parameter iParameter (0..5) of sensor sensorId (plane id)
+  static int label(int sensorId, unsigned int iParameter) {return 10 * (sensorId + 1) + iParameter + 1;}
+
+  virtual std::vector<int> labels() override;
+  virtual TMatrixD derivatives(const genfit::StateOnPlane* sop) override;
+
+  virtual const std::vector<int>& fillGlobalDerivatives(const genfit::StateOnPlane* sop, CalibrationDerivatives& derivatives, std::vector<int>& labelBuffer) override;
+  virtual unsigned int fillLocalDerivatives(const genfit::StateOnPlane* sop, CalibrationDerivatives& derivatives) override;
+  virtual void prepareCalibrationLabels() override {cachedLabels();}
+
+ private:
+  const std::vector<int>& cachedLabels() const;
+
+  static CalibrationLabelCache labelCache_; //! labels per sensor
+
+ public:
+
+  ClassDefOverride(AlignablePlanarMeasurement,1)
+
+};
+
+} /* End of namespace genfit */
+/** @} */
+
+#endif // genfit_AlignablePlanarMeasurement_h
@@ -35,17 +35,17 @@
 #include<vector>
 #include<math.h>
 #include<cstdlib>
-#include "TVectorD.h"
-#include "TMatrixD.h"
-#include "TMatrixDSym.h"
-#include "VMatrix.h"
+#include "EigenMatrixTypedefs.h"
 
 //! Namespace for the general broken lines package
 namespace gbl {
 
 /// (Symmetric) Bordered Band Matrix.
 /**
- *  Separate storage of border, mixed and band parts (as vector<double>).
+ *  Separate storage of border, mixed and band parts (as Eigen matrices).
+ *  Storage and work space for the solution are kept with the matrix and
+ *  only grow (the band size defines the used columns), so that a matrix
+ *  can be reused for many trajectories without reallocation.
  *
  *\verbatim
  *  Example for matrix size=8 with border size and band width of two
@@ -82,12 +82,12 @@ public:
 	virtual ~BorderedBandMatrix();
 	void resize(unsigned int nSize, unsigned int nBorder = 1,
 			unsigned int nBand = 5);
-	void solveAndInvertBorderedBand(const VVector &aRightHandSide,
-			VVector &aSolution);
-	void addBlockMatrix(double aWeight,
-			const std::vector<unsigned int>* anIndex,
-			const std::vector<double>* aVector);
-	TMatrixDSym getBlockMatrix(const std::vector<unsigned int> anIndex) const;
+	void solveAndInvertBorderedBand(const genfit::VectorDynamic &aRightHandSide,
+			genfit::VectorDynamic &aSolution);
+	void addBlockMatrix(double aWeight, unsigned int nSimple,
+			const unsigned int* anIndex, const double* aVector);
+	void getBlockMatrix(unsigned int nSimple, const unsigned int* anIndex,
+			genfit::MatrixDynamic &aMatrix) const;
 	void printMatrix() const;
 
 private:
@@ -95,16 +95,29 @@ private:
 	unsigned int numBorder; ///< Border size
 	unsigned int numBand; ///< Band width
 	unsigned int numCol; ///< Band matrix size
-	VSymMatrix theBorder; ///< Border part
-	VMatrix theMixed; ///< Mixed part
-	VMatrix theBand; ///< Band part
+	bool isSolved; ///< Matrix has been decomposed (border and mixed part contain inverse)
+	mutable int numInverted; ///< First column of band part of inverse already calculated
+	genfit::MatrixDynamic theBorder; ///< Border part
+	genfit::MatrixDynamic theMixed; ///< Mixed part
+	genfit::MatrixDynamic theBand; ///< Band part (column i: diagonal and sub-diagonals of column i)
+	// work space
+	mutable genfit::MatrixDynamic inverseBand; ///< Band part of inverse of band part (calculated on demand)
+	genfit::MatrixDynamic auxMat; ///< Solution X^T of D*X=C for mixed part
+	genfit::MatrixDynamic inverseBorder; ///< Inverse E of border part
+	genfit::VectorDynamic auxVec; ///< Right hand side for border part
+	genfit::VectorDynamic borderSolution; ///< Solution for border part
+	genfit::VectorDynamic bandSolution; ///< Solution for band part
+	genfit::VectorDynamic auxDiag; ///< Diagonal elements (for decomposition or inversion)
+	genfit::VectorDynamic auxPivot; ///< Pivot column (for inversion)
+	std::vector<bool> auxUsed; ///< Used pivots (for inversion)
 
-	void decomposeBand();
-	VVector solveBand(const VVector &aRightHandSide) const;
-	VMatrix solveBand(const VMatrix &aRightHandSide) const;
-	VMatrix invertBand();
-	VMatrix bandOfAVAT(const VMatrix &anArray,
-			const VSymMatrix &aSymArray) const;
+	void reserveColumns(genfit::MatrixDynamic &aMatrix, unsigned int nRow) const;
+	static void reserveSize(genfit::VectorDynamic &aVector, unsigned int nSize);
+	template<int nRowFixed> void decomposeBand();
+	template<typename Matrix> void solveBand(Matrix &&aSolution) const;
+	template<int nRowFixed, typename Matrix> void solveBand(Matrix &aSolution) const;
+	void invertBand(int aColumn) const;
+	void invertBorder();
 };
 }
 #endif /* BORDEREDBANDMATRIX_H_ */
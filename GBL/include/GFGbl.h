@@ -25,8 +25,10 @@
 
 #include "GblTrajectory.h"
 #include "AbsFitter.h"
+#include "GFGblDiagnostics.h"
 
 #include <map>
+#include <memory>
 #include <iostream>
 
 #include <TMatrixD.h>
@@ -59,6 +61,10 @@ namespace genfit {
     bool m_enableScatterers;
     bool m_enableIntermediateScatterer;
     
+    // Output per instance (no shared state between instances/threads)
+    std::unique_ptr<gbl::MilleBinary> m_milleFile; //! Millepede-II binary file
+    GFGblDiagnostics* m_diagnostics; //! Optional diagnostics (not owned)
+    
     
   public:
     
@@ -70,7 +76,7 @@ namespace genfit {
     /**
      * Destructor
      */
-    virtual ~GFGbl() {;}
+    virtual ~GFGbl();
     
     /**
      * Creates the mille binary file for output of
@@ -113,6 +119,15 @@ namespace genfit {
       m_chi2Cut = chi2Cut;
     }
     
+    /**
+     * @brief Sets optional diagnostics (e.g. GFGblHistograms)
+     * 
+     * The diagnostics object is not owned and can be shared between
+     * instances running in parallel (it has to be thread safe).
+     * @param diagnostics Diagnostics to fill, nullptr to disable
+     */
+    void setDiagnostics(GFGblDiagnostics* diagnostics) {m_diagnostics = diagnostics;}
+    
     /**
      * Performs fit on a Track.
      * Hit resorting currently NOT supported.
@@ -122,7 +137,7 @@ namespace genfit {
     
   public:
     
-    ClassDef(GFGbl, 1)
+    ClassDef(GFGbl, 2)
     
   };
   
@@ -0,0 +1,182 @@
+/* Copyright 2013
+ *   Authors: Sergey Yashchenko and Tadeas Bilka
+ *
+ *   This file is part of GENFIT.
+ *
+ *   GENFIT is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   GENFIT is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/** @addtogroup genfit
+ * @{
+ */
+
+#ifndef GFGBLDIAGNOSTICS_H
+#define GFGBLDIAGNOSTICS_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <TVectorD.h>
+
+class TH1;
+
+namespace genfit {
+
+  /** @brief Optional diagnostics of GFGbl fits
+   *
+   * Filled by GFGbl::processTrackWithRep(...). One object can be shared by
+   * several GFGbl instances running in parallel, so implementations have to be
+   * thread safe (preferably lock free, see GFGblHistograms).
+   */
+  class GFGblDiagnostics {
+
+  public:
+
+    virtual ~GFGblDiagnostics() {;}
+
+    /**
+     * @brief Result of GBL fit of a track
+     * @param fitRes Result of GblTrajectory::fit(...), 0 for success
+     * @param ndf Degrees of freedom (-1 for failure)
+     */
+    virtual void fillFitResult(int fitRes, int ndf) = 0;
+
+    /**
+     * @brief GBL fit results at a measurement of an accepted track
+     * @param sensorId Sensor id from the measurement
+     * @param residuals Residuals (u, v)
+     * @param measErrors Measurement errors
+     * @param resErrors Residual errors
+     * @param downWeights Down-weighting factors
+     * @param localPar Local track parameters (corrections)
+     */
+    virtual void fillMeasurement(unsigned int sensorId, const TVectorD& residuals, const TVectorD& measErrors,
+                                 const TVectorD& resErrors, const TVectorD& downWeights, const TVectorD& localPar) = 0;
+
+    /**
+     * @brief Accepted track
+     * @param chi2 Chi2 of GBL fit
+     * @param ndf Degrees of freedom of GBL fit (chi2/ndf and p-value are only filled for ndf > 0)
+     * @param sensorIds Sensor ids of all measurements of the track
+     */
+    virtual void fillTrack(double chi2, int ndf, const std::vector<unsigned int>& sensorIds) = 0;
+
+  };
+
+
+  /** @brief 1D histogram with fixed binning and atomic bin counters
+   *
+   * Filling is lock free and thread safe. Conversion to ROOT histogram
+   * (and writing) should be done after filling has finished.
+   */
+  class AtomicHistogram {
+
+  public:
+
+    AtomicHistogram(const std::string& name, const std::string& title, unsigned int nBins, double low, double high);
+
+    /**
+     * @brief Increment the bin of x (with under- and overflow bin)
+     */
+    void fill(double x);
+
+    /**
+     * @brief Number of entries in bin (0: underflow, nBins + 1: overflow)
+     */
+    unsigned int getBinContent(unsigned int bin) const {return bins_[bin].load(std::memory_order_relaxed);}
+
+    /**
+     * @brief Number of entries, including under- and overflow
+     */
+    unsigned int getEntries() const;
+
+    unsigned int getNBins() const {return nBins_;}
+
+    /**
+     * @brief Create ROOT histogram (owned by caller) with the current content
+     */
+    TH1* createRootHistogram() const;
+
+  private:
+
+    AtomicHistogram(const AtomicHistogram&);
+    AtomicHistogram& operator=(const AtomicHistogram&);
+
+    std::string name_;
+    std::string title_;
+    unsigned int nBins_;
+    double low_;
+    double high_;
+    std::unique_ptr<std::atomic<unsigned int>[]> bins_;
+
+  };
+
+
+  /** @brief Diagnostic histograms of GFGbl (formerly compiled in with OUTPUT)
+   *
+   * Residuals, pulls, down-weights and local parameters per layer
+   * of the VXD test beam setup, fit results and hit statistics of tracks.
+   * Lock free, can be filled by several GFGbl instances in parallel.
+   */
+  class GFGblHistograms : public GFGblDiagnostics {
+
+  public:
+
+    GFGblHistograms();
+
+    void fillFitResult(int fitRes, int ndf) override;
+    void fillMeasurement(unsigned int sensorId, const TVectorD& residuals, const TVectorD& measErrors,
+                         const TVectorD& resErrors, const TVectorD& downWeights, const TVectorD& localPar) override;
+    void fillTrack(double chi2, int ndf, const std::vector<unsigned int>& sensorIds) override;
+
+    /**
+     * @brief Write all histograms to (new) ROOT file
+     */
+    void write(const std::string& rootFileName = "gbl.root") const;
+
+    /**
+     * @brief Layer (1-12) of test beam setup for sensor id, 0 if not part of setup
+     */
+    static unsigned int layerOfSensor(unsigned int sensorId);
+
+    /// Histograms per layer
+    enum LayerHistogram {resU, resV, measPullU, measPullV, pullU, pullV, downWeightU, downWeightV,
+                         localPar1, localPar2, localPar3, localPar4, localPar5, nLayerHistograms};
+    static const unsigned int nLayers = 12;
+
+    const AtomicHistogram& getLayerHistogram(unsigned int layer, LayerHistogram histogram) const {return *layerHistograms_[(layer - 1) * nLayerHistograms + histogram];}
+    const AtomicHistogram& getFitResultHistogram() const {return fitResHisto_;}
+    const AtomicHistogram& getNdfHistogram() const {return ndfHisto_;}
+    const AtomicHistogram& getChi2OverNdfHistogram() const {return chi2OndfHisto_;}
+    const AtomicHistogram& getPValueHistogram() const {return pValueHisto_;}
+    const AtomicHistogram& getStatsHistogram() const {return stats_;}
+
+  private:
+
+    AtomicHistogram& layerHistogram(unsigned int layer, LayerHistogram histogram) {return *layerHistograms_[(layer - 1) * nLayerHistograms + histogram];}
+
+    std::vector<std::unique_ptr<AtomicHistogram> > layerHistograms_;
+    AtomicHistogram fitResHisto_;
+    AtomicHistogram ndfHisto_;
+    AtomicHistogram chi2OndfHisto_;
+    AtomicHistogram pValueHisto_;
+    AtomicHistogram stats_;
+
+  };
+
+}  /* End of namespace genfit */
+/** @} */
+
+#endif // GFGBLDIAGNOSTICS_H
@@ -33,68 +33,117 @@
 #include<iostream>
 #include<vector>
 #include<math.h>
-#include "VMatrix.h"
-#include "TVectorD.h"
-#include "TMatrixD.h"
-#include "TMatrixDSym.h"
-
-#include "Math/SMatrix.h"
-#include "Math/SVector.h"
-typedef ROOT::Math::SMatrix<double, 2, 5> SMatrix25;
-typedef ROOT::Math::SMatrix<double, 2, 7> SMatrix27;
-typedef ROOT::Math::SMatrix<double, 5, 5> SMatrix55;
+#include<array>
+#include "GblPoint.h"
 
 //! Namespace for the general broken lines package
 namespace gbl {
 
+/// Data block type
+enum dataBlockType {
+	None, InternalMeasurement, InternalKink, ExternalSeed, ExternalMeasurement
+};
+
 /// Data (block) for independent scalar measurement
 /**
  * Data (block) containing value, precision and derivatives for measurements and kinks.
  * Created from attributes of GblPoints, used to construct linear equation system for track fit.
+ *
+ * The (up to 7) derivatives vs track parameters are kept in fixed size arrays, only data blocks
+ * with additional local or external parameters need (heap allocated) lists.
+ * Global derivatives are not copied, they are retrieved from the corresponding point.
  */
 class GblData {
 public:
-        GblData() : theLabel(0), theValue(0.), thePrecision(-1.), theDownWeight(0.), thePrediction(0.) {};
-	GblData(unsigned int aLabel, double aMeas, double aPrec);
+	GblData() :
+			theType(None), theLabel(0), theRow(0), theTraj(0), thePoint(0), theValue(
+					0.), thePrecision(-1.), theDownWeight(0.), thePrediction(0.), theNumParameters(
+					0), moreParameters(), moreDerivatives() {
+	}
+	GblData(unsigned int aLabel, dataBlockType aType, double aMeas,
+			double aPrec, unsigned int aTraj = 0, unsigned int aPoint = 0);
 	virtual ~GblData();
 	void addDerivatives(unsigned int iRow,
-			const std::vector<unsigned int> &labDer, const SMatrix55 &matDer,
-			unsigned int iOff, const TMatrixD &derLocal,
-			const std::vector<int> &labGlobal, const TMatrixD &derGlobal,
-			unsigned int nLocal, const TMatrixD &derTrans);
+			const std::array<unsigned int, 5> &labDer, const Matrix5x5 &matDer,
+			unsigned int iOff, const MatrixDynamic &derLocal,
+			unsigned int nLocal, const MatrixDynamic &derTrans);
 	void addDerivatives(unsigned int iRow,
-			const std::vector<unsigned int> &labDer, const SMatrix27 &matDer,
-			unsigned int nLocal, const TMatrixD &derTrans);
-	void addDerivatives(const std::vector<unsigned int> &index,
-			const std::vector<double> &derivatives);
+			const std::array<unsigned int, 7> &labDer, const Matrix2x7 &matDer,
+			unsigned int nLocal, const MatrixDynamic &derTrans);
+	void addDerivatives(unsigned int nDer, const unsigned int* index,
+			const double* derivatives);
 
-	void setPrediction(const VVector &aVector);
-	double setDownWeighting(unsigned int aMethod);
-	double getChi2() const;
 	void printData() const;
-	void getLocalData(double &aValue, double &aWeight,
-			std::vector<unsigned int>* &indLocal,
-			std::vector<double>* &derLocal);
-	void getAllData(double &aValue, double &aErr,
-			std::vector<unsigned int>* &indLocal,
-			std::vector<double>* &derLocal, std::vector<int>* &labGlobal,
-			std::vector<double>* &derGlobal);
-	void getResidual(double &aResidual, double &aVariance, double &aDownWeight,
-			std::vector<unsigned int>* &indLocal,
-			std::vector<double>* &derLocal);
+	dataBlockType getType() const;
+	void getLocalData(double &aValue, double &aWeight, unsigned int &numLocal,
+			const unsigned int* &indLocal, const double* &derLocal) const;
+	void getAllData(double &aValue, double &aErr, unsigned int &numLocal,
+			const unsigned int* &indLocal, const double* &derLocal,
+			unsigned int &aTraj, unsigned int &aPoint,
+			unsigned int &aRow) const;
+	void getResidual(double &aResidual, double &aVariance,
+			double &aDownWeight, unsigned int &numLocal,
+			const unsigned int* &indLocal, const double* &derLocal) const;
 
 private:
-	unsigned int theLabel; ///< Label (of measurements point)
+	friend class GblDataBlocks;
+	void addParameter(unsigned int aParameter, double aDerivative);
+
+	dataBlockType theType; ///< Type (None, InternalMeasurement, InternalKink, ExternalSeed, ExternalMeasurement)
+	unsigned int theLabel; ///< Label (of corresponding point)
+	unsigned int theRow; ///< Row number (of measurement)
+	unsigned int theTraj; ///< Trajectory number (of corresponding point)
+	unsigned int thePoint; ///< Point number (on trajectory)
 	double theValue; ///< Value (residual)
 	double thePrecision; ///< Precision (1/sigma**2)
 	double theDownWeight; ///< Down-weighting factor (0-1)
 	double thePrediction; ///< Prediction from fit
+	unsigned int theNumParameters; ///< Number of fit parameters in fixed size lists
+	unsigned int theParameters[7]; ///< List of fit parameters (with non zero derivatives)
+	double theDerivatives[7]; ///< List of derivatives for fit
+	std::vector<unsigned int> moreParameters; ///< List of fit parameters (if additional local or external parameters)
+	std::vector<double> moreDerivatives; ///< List of derivatives for fit (if additional local or external parameters)
+
+        ClassDef(GblData, 2)
+};
+
+/// Data blocks of trajectory as structure of arrays
+/**
+ * Values, precisions, down-weighting factors and predictions of all data blocks
+ * are kept in contiguous arrays, the derivatives in a compressed row list.
+ * Prediction, (down-weighted) Chi2 and the M-estimator down-weighting are evaluated
+ * for all data blocks at once (with vectorized array expressions),
+ * which speeds up (multiple) internal iterations on long trajectories.
+ *
+ * Filled from the list of \link GblData \endlink after the preparation of the trajectory,
+ * predictions and down-weighting factors are copied back to it after the fit.
+ */
+class GblDataBlocks {
+public:
+	GblDataBlocks();
+	virtual ~GblDataBlocks();
+	void assign(const std::vector<GblData> &aDataList);
+	unsigned int getNumData() const;
+	void predict(const VectorDynamic &aVector);
+	double downWeight(unsigned int aMethod);
+	double getChi2() const;
+	void copyResults(std::vector<GblData> &aDataList) const;
+	void getLocalData(unsigned int aData, double &aValue, double &aWeight,
+			unsigned int &numLocal, const unsigned int* &indLocal,
+			const double* &derLocal) const;
+	void getResidual(unsigned int aData, double &aResidual,
+			double &aVariance, double &aDownWeight, unsigned int &numLocal,
+			const unsigned int* &indLocal, const double* &derLocal) const;
+
+private:
+	Eigen::ArrayXd theValues; ///< Values (residuals)
+	Eigen::ArrayXd thePrecisions; ///< Precisions (1/sigma**2)
+	Eigen::ArrayXd theDownWeights; ///< Down-weighting factors (0-1)
+	Eigen::ArrayXd thePredictions; ///< Predictions from fit
+	Eigen::ArrayXd workScaledResiduals; ///< Scaled residuals (for down-weighting)
+	std::vector<unsigned int> theOffsets; ///< Offset of data block in lists of fit parameters and derivatives
 	std::vector<unsigned int> theParameters; ///< List of fit parameters (with non zero derivatives)
 	std::vector<double> theDerivatives; ///< List of derivatives for fit
-	std::vector<int> globalLabels; ///< Labels for global derivatives
-	std::vector<double> globalDerivatives; ///< Global derivatives
-
-        ClassDef(GblData, 1)
 };
 }
 #endif /* GBLDATA_H_ */
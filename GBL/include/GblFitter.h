@@ -29,6 +29,8 @@
 #include "GblFitterInfo.h"
 #include "GblFitStatus.h"
 #include "GblTrackSegmentController.h"
+#include "MilleBinary.h"
+#include "MilleAccumulator.h"
 
 #include <map>
 #include <iostream>
@@ -66,12 +68,18 @@ namespace genfit {
     double scatEpsilon;
     GblTrackSegmentController* m_segmentController;
     
+    // Work space reused for all external iterations and tracks
+    // (a fitter instance must not be shared between threads)
+    std::vector<gbl::GblPoint> m_points; //! GBL points of current track
+    gbl::GblTrajectory m_trajectory; //! GBL trajectory of current track
+    std::vector<int> m_labelBuffer; //! Global labels of current point
+    
   public:
     
     /**
      * Default (and only) constructor
      */
-    GblFitter() : AbsFitter(), m_gblInternalIterations(""), m_enableScatterers(true), m_enableIntermediateScatterer(true), m_externalIterations(1), m_recalcJacobians(0), scatEpsilon(1.e-8), m_segmentController(nullptr) {;}
+    GblFitter() : AbsFitter(), m_gblInternalIterations(""), m_enableScatterers(true), m_enableIntermediateScatterer(true), m_externalIterations(1), m_recalcJacobians(0), scatEpsilon(1.e-8), m_segmentController(nullptr), m_points(), m_trajectory(), m_labelBuffer() {;}
     
     /**
      * Destructor
@@ -147,6 +155,22 @@ namespace genfit {
                                  const double p, const double mass, const double charge,
                                  const std::vector<genfit::MatStep>& steps) const;
     
+    /**
+     * @brief Jacobian of the second part of a segment from the Jacobians of the whole segment and of its first part
+     * 
+     * jacSecondPart = jacSegment * jacFirstPart^-1, used to reach the next measurement from an
+     * intermediate scatterer without extrapolating again. Only computed if jacFirstPart is well
+     * conditioned, else the second part has to be extrapolated.
+     * 
+     * @param jacSegment Jacobian of the whole segment
+     * @param jacFirstPart Jacobian of the first part of the segment
+     * @param jacSecondPart returned: Jacobian of the rest of the segment
+     * @param maxCondition Maximum (estimated 1-norm) condition number of jacFirstPart
+     * @return True if jacSecondPart was computed
+     */
+    static bool splitSegmentJacobian(const TMatrixD& jacSegment, const TMatrixD& jacFirstPart, TMatrixD& jacSecondPart,
+                                     double maxCondition = 1.e8);
+    
     /**
      * Performs fit on a Track.
      * Hit resorting currently supported (use only if necessary /wire chamber/ ... will 
@@ -154,6 +178,29 @@ namespace genfit {
      */
     void processTrackWithRep(Track* trk, const AbsTrackRep* rep, bool resortHits = false) override;
     
+    /**
+     * @brief Performs fit on many tracks (with their cardinal representations)
+     * 
+     * Propagation of the seeds and recalculation of Jacobians (extrapolations)
+     * are done track by track. Construction and fit of the GBL trajectories and
+     * the update of the fitter infos are distributed over a pool of threads, each
+     * with its own (reused) work space (points, trajectory, Millepede record).
+     * Results are identical to calling processTrackWithRep(...) for each track
+     * with its cardinal representation.
+     * 
+     * @param tracks Tracks to fit (each track is processed by one thread only)
+     * @param nThreads Number of threads, 0 = number of hardware threads
+     * @param milleFile If given, the records of all tracks (from last external iteration)
+     *                  are written to it in the order of the tracks
+     * @param resortHits Sort hits by arc length before the fit
+     * @param accumulator If given, the records of all tracks (from last external iteration)
+     *                    are added to the global (alignment) normal equations
+     *                    (with partial sums over contiguous ranges of tracks per thread;
+     *                    reproducible for a given number of threads)
+     */
+    void processTracks(const std::vector<Track*>& tracks, unsigned int nThreads = 0, gbl::MilleBinary* milleFile = nullptr, bool resortHits = false,
+                       gbl::MilleAccumulator* accumulator = nullptr);
+    
     /**
      * @brief Propagate seed, populate track with scatterers
      * and GblFitterInfos with reference state set
@@ -195,6 +242,18 @@ namespace genfit {
      */
     std::vector<gbl::GblPoint> collectGblPoints(genfit::Track* trk, const genfit::AbsTrackRep* rep);
     
+    /**
+     * @brief Constructs all GBL points into given (reused) vector
+     * for trajectory construction
+     * 
+     * @param trk The track
+     * @param rep The track representation
+     * @param thePoints List of points to fill (previous content is removed, capacity is kept)
+     * @param labelBuffer Reused buffer for global labels (see GblFitterInfo::constructGblPoint)
+     */
+    void collectGblPoints(genfit::Track* trk, const genfit::AbsTrackRep* rep, std::vector<gbl::GblPoint>& thePoints,
+                          std::vector<int>& labelBuffer);
+    
     /**
      * @brief Remove all previous gbl fitter data from track
      * Also removes trackpoints without measurement
@@ -216,6 +275,37 @@ namespace genfit {
     
     void setTrackSegmentController(GblTrackSegmentController* controler);
     
+  private:
+    
+    /**
+     * @brief Clean, (sort) and propagate track and attach new GblFitStatus
+     * 
+     * @return The fit status of the track for rep
+     */
+    GblFitStatus* prepareTrack(Track* trk, const AbsTrackRep* rep, bool resortHits, bool fitQoverP);
+    
+    /**
+     * @brief One external iteration: collect points into thePoints,
+     * fit (reset) traj and update fitter infos
+     * 
+     * Only touches the track and the given work space (no extrapolation).
+     * 
+     * @return Result of GblTrajectory::fit(...), 0 for success
+     */
+    int fitIteration(Track* trk, const AbsTrackRep* rep, bool fitQoverP, unsigned int iIter,
+                     std::vector<gbl::GblPoint>& thePoints, gbl::GblTrajectory& traj, std::vector<int>& labelBuffer,
+                     double& Chi2, int& Ndf, unsigned int& nMeas);
+    
+    /**
+     * @brief Re-propagate reference states to update Jacobians, planes and measurements
+     */
+    void recalculateJacobians(Track* trk, const AbsTrackRep* rep) const;
+    
+    /**
+     * @brief Set fit status after external iteration iIter
+     */
+    void setFitStatus(GblFitStatus* gblfs, Track* trk, unsigned int iIter, int fitRes, double Chi2, int Ndf, unsigned int nMeas) const;
+    
     
   public:
     
@@ -127,6 +127,18 @@ namespace genfit {
      * @return gbl::GblPoint
      */
     gbl::GblPoint constructGblPoint();
+    
+    /**
+     * @brief Same as constructGblPoint(), with a label buffer reused by the caller
+     * (only filled by measurements that do not cache their labels)
+     */
+    gbl::GblPoint constructGblPoint(std::vector<int>& labelBuffer);
+    
+    /**
+     * @brief Same as constructGblPoint(labelBuffer), but the point is constructed
+     * in place at the end of thePoints (no copy of the point)
+     */
+    void addGblPoint(std::vector<gbl::GblPoint>& thePoints, std::vector<int>& labelBuffer);
   
     /**
      * @brief Update fitter info from GBL fit results
@@ -245,6 +257,8 @@ namespace genfit {
     virtual bool checkConsistency(const genfit::PruneFlags* = nullptr) const override;
        
   private:
+    void fillGblPoint(gbl::GblPoint& thePoint, std::vector<int>& labelBuffer);
+    
     TMatrixD jacobian_;
     TVectorD measResiduals_;
     TVectorD measResidualErrors_;
@@ -37,22 +37,28 @@
 #include "TVectorD.h"
 #include "TMatrixD.h"
 #include "TMatrixDSym.h"
-#include "TMatrixDSymEigen.h"
 
-#include "Math/SMatrix.h"
-#include "Math/SVector.h"
-typedef ROOT::Math::SMatrix<double, 2> SMatrix22;
-typedef ROOT::Math::SMatrix<double, 2, 3> SMatrix23;
-typedef ROOT::Math::SMatrix<double, 2, 5> SMatrix25;
-typedef ROOT::Math::SMatrix<double, 2, 7> SMatrix27;
-typedef ROOT::Math::SMatrix<double, 3, 2> SMatrix32;
-typedef ROOT::Math::SMatrix<double, 3> SMatrix33;
-typedef ROOT::Math::SMatrix<double, 5> SMatrix55;
-typedef ROOT::Math::SVector<double, 2> SVector2;
-typedef ROOT::Math::SVector<double, 5> SVector5;
+#include "EigenMatrixTypedefs.h"
 
 namespace gbl {
 
+/// Fixed size (track parameter) and dynamic size (local/global parameter) matrix types
+using genfit::Vector2;
+using genfit::Vector5;
+using genfit::Matrix2x2;
+using genfit::Matrix2x3;
+using genfit::Matrix2x5;
+using genfit::Matrix2x7;
+using genfit::Matrix3x2;
+using genfit::Matrix3x3;
+using genfit::Matrix5x5;
+using genfit::VectorDynamic;
+using genfit::MatrixDynamic;
+
+/// Unaligned 2D types for members of objects kept in std::vector (no aligned allocator needed)
+typedef Eigen::Matrix<double, 2, 1, Eigen::DontAlign> Vector2Unaligned;
+typedef Eigen::Matrix<double, 2, 2, Eigen::DontAlign> Matrix2x2Unaligned;
+
 /// Point on trajectory
 /**
  * User supplied point on (initial) trajectory.
@@ -68,7 +74,7 @@ namespace gbl {
 class GblPoint {
 public:
 	GblPoint(const TMatrixD &aJacobian);
-	GblPoint(const SMatrix55 &aJacobian);
+	GblPoint(const Matrix5x5 &aJacobian);
 	virtual ~GblPoint();
 	void addMeasurement(const TMatrixD &aProjection, const TVectorD &aResiduals,
 			const TVectorD &aPrecision, double minPrecision = 0.);
@@ -78,55 +84,87 @@ public:
 			double minPrecision = 0.);
 	void addMeasurement(const TVectorD &aResiduals,
 			const TMatrixDSym &aPrecision, double minPrecision = 0.);
+	void addMeasurement(const MatrixDynamic &aProjection,
+			const VectorDynamic &aResiduals, const VectorDynamic &aPrecision,
+			double minPrecision = 0.);
+	void addMeasurement(const MatrixDynamic &aProjection,
+			const VectorDynamic &aResiduals, const MatrixDynamic &aPrecision,
+			double minPrecision = 0.);
+	void addMeasurement(const VectorDynamic &aResiduals,
+			const VectorDynamic &aPrecision, double minPrecision = 0.);
+	void addMeasurement(const VectorDynamic &aResiduals,
+			const MatrixDynamic &aPrecision, double minPrecision = 0.);
 	unsigned int hasMeasurement() const;
-	void getMeasurement(SMatrix55 &aProjection, SVector5 &aResiduals,
-			SVector5 &aPrecision) const;
+	void getMeasurement(Matrix5x5 &aProjection, Vector5 &aResiduals,
+			Vector5 &aPrecision) const;
 	void getMeasTransformation(TMatrixD &aTransformation) const;
 	void addScatterer(const TVectorD &aResiduals, const TVectorD &aPrecision);
 	void addScatterer(const TVectorD &aResiduals,
 			const TMatrixDSym &aPrecision);
+	void addScatterer(const Vector2 &aResiduals, const Vector2 &aPrecision);
+	void addScatterer(const Vector2 &aResiduals, const Matrix2x2 &aPrecision);
 	bool hasScatterer() const;
-	void getScatterer(SMatrix22 &aTransformation, SVector2 &aResiduals,
-			SVector2 &aPrecision) const;
+	void getScatterer(Matrix2x2 &aTransformation, Vector2 &aResiduals,
+			Vector2 &aPrecision) const;
 	void getScatTransformation(TMatrixD &aTransformation) const;
 	void addLocals(const TMatrixD &aDerivatives);
+	void addLocals(const Eigen::Ref<const MatrixDynamic> &aDerivatives);
 	unsigned int getNumLocals() const;
-	const TMatrixD& getLocalDerivatives() const;
+	const MatrixDynamic& getLocalDerivatives() const;
 	void addGlobals(const std::vector<int> &aLabels,
 			const TMatrixD &aDerivatives);
+	void addGlobals(const std::vector<int> &aLabels,
+			const Eigen::Ref<const MatrixDynamic> &aDerivatives);
 	unsigned int getNumGlobals() const;
-	std::vector<int> getGlobalLabels() const;
-	const TMatrixD& getGlobalDerivatives() const;
+	const genfit::CalibrationLabels& getGlobalLabels() const;
+	const genfit::CalibrationDerivatives& getGlobalDerivatives() const;
+	void getGlobalLabelsAndDerivatives(unsigned int aRow,
+			std::vector<int> &aLabels, std::vector<double> &aDerivatives) const;
 	void setLabel(unsigned int aLabel);
 	unsigned int getLabel() const;
 	void setOffset(int anOffset);
 	int getOffset() const;
-	const SMatrix55& getP2pJacobian() const;
-	void addPrevJacobian(const SMatrix55 &aJac);
-	void addNextJacobian(const SMatrix55 &aJac);
-	void getDerivatives(int aDirection, SMatrix22 &matW, SMatrix22 &matWJ,
-			SVector2 &vecWd) const;
+	const Matrix5x5& getP2pJacobian() const;
+	void addPrevJacobian(const Matrix5x5 &aJac);
+	void addNextJacobian(const Matrix5x5 &aJac);
+	void getDerivatives(int aDirection, Matrix2x2 &matW, Matrix2x2 &matWJ,
+			Vector2 &vecWd) const;
 	void printPoint(unsigned int level = 0) const;
 
 private:
+	template<typename Projection, typename Residuals, typename Precision>
+	void setMeasurement(const Projection &aProjection,
+			const Residuals &aResiduals, const Precision &aPrecision,
+			double minPrecision);
+	template<typename Projection, typename Residuals, typename Precision>
+	void setDiagonalizedMeasurement(const Projection &aProjection,
+			const Residuals &aResiduals, const Precision &aPrecision,
+			double minPrecision);
+	template<typename Derivatives, typename Target>
+	void setTransformedDerivatives(const Derivatives &aDerivatives,
+			Target &aTarget) const;
+	template<typename Derivatives>
+	void setGlobals(const std::vector<int> &aLabels,
+			const Derivatives &aDerivatives);
+
 	unsigned int theLabel; ///< Label identifying point
 	int theOffset; ///< Offset number at point if not negative (else interpolation needed)
-	SMatrix55 p2pJacobian; ///< Point-to-point jacobian from previous point
-	SMatrix55 prevJacobian; ///< Jacobian to previous scatterer (or first measurement)
-	SMatrix55 nextJacobian; ///< Jacobian to next scatterer (or last measurement)
+	Matrix5x5 p2pJacobian; ///< Point-to-point jacobian from previous point
+	Matrix5x5 prevJacobian; ///< Jacobian to previous scatterer (or first measurement)
+	Matrix5x5 nextJacobian; ///< Jacobian to next scatterer (or last measurement)
 	unsigned int measDim; ///< Dimension of measurement (1-5), 0 indicates absence of measurement
-	SMatrix55 measProjection; ///< Projection from measurement to local system
-	SVector5 measResiduals; ///< Measurement residuals
-	SVector5 measPrecision; ///< Measurement precision (diagonal of inverse covariance matrix)
+	Matrix5x5 measProjection; ///< Projection from measurement to local system
+	Vector5 measResiduals; ///< Measurement residuals
+	Vector5 measPrecision; ///< Measurement precision (diagonal of inverse covariance matrix)
 	bool transFlag; ///< Transformation exists?
-	TMatrixD measTransformation; ///< Transformation of diagonalization (of meas. precision matrix)
+	Matrix5x5 measTransformation; ///< Transformation of diagonalization (of meas. precision matrix), leading measDim x measDim block
 	bool scatFlag; ///< Scatterer present?
-	SMatrix22 scatTransformation; ///< Transformation of diagonalization (of scat. precision matrix)
-	SVector2 scatResiduals; ///< Scattering residuals (initial kinks if iterating)
-	SVector2 scatPrecision; ///< Scattering precision (diagonal of inverse covariance matrix)
-	TMatrixD localDerivatives; ///< Derivatives of measurement vs additional local (fit) parameters
-	std::vector<int> globalLabels; ///< Labels of global (MP-II) derivatives
-	TMatrixD globalDerivatives; ///< Derivatives of measurement vs additional global (MP-II) parameters
+	Matrix2x2Unaligned scatTransformation; ///< Transformation of diagonalization (of scat. precision matrix)
+	Vector2Unaligned scatResiduals; ///< Scattering residuals (initial kinks if iterating)
+	Vector2Unaligned scatPrecision; ///< Scattering precision (diagonal of inverse covariance matrix)
+	MatrixDynamic localDerivatives; ///< Derivatives of measurement vs additional local (fit) parameters
+	genfit::CalibrationLabels globalLabels; ///< Labels of global (MP-II) derivatives (fixed capacity)
+	genfit::CalibrationDerivatives globalDerivatives; ///< Derivatives of measurement vs additional global (MP-II) parameters (fixed capacity)
 };
 }
 #endif /* GBLPOINT_H_ */
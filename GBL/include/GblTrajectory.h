@@ -30,12 +30,11 @@
 #ifndef GBLTRAJECTORY_H_
 #define GBLTRAJECTORY_H_
 
+#include<array>
 #include "GblPoint.h"
 #include "GblData.h"
-#include "GblPoint.h"
 #include "BorderedBandMatrix.h"
 #include "MilleBinary.h"
-#include "TMatrixDSymEigen.h"
 
 //! Namespace for the general broken lines package
 namespace gbl {
@@ -47,11 +46,15 @@ namespace gbl {
  */
 class GblTrajectory {
 public:
+	GblTrajectory();
 	GblTrajectory(const std::vector<GblPoint> &aPointList, bool flagCurv = true,
 			bool flagU1dir = true, bool flagU2dir = true);
 	GblTrajectory(const std::vector<GblPoint> &aPointList, unsigned int aLabel,
 			const TMatrixDSym &aSeed, bool flagCurv = true, bool flagU1dir =
 					true, bool flagU2dir = true);
+	GblTrajectory(const std::vector<GblPoint> &aPointList, unsigned int aLabel,
+			const MatrixDynamic &aSeed, bool flagCurv = true, bool flagU1dir =
+					true, bool flagU2dir = true);
 	GblTrajectory(
 			const std::vector<std::pair<std::vector<GblPoint>, TMatrixD> > &aPointaAndTransList);
 	GblTrajectory(
@@ -63,25 +66,44 @@ public:
 			const TMatrixD &extDerivatives, const TVectorD &extMeasurements,
 			const TMatrixDSym &extPrecisions);
 	virtual ~GblTrajectory();
+	void reset(const std::vector<GblPoint> &aPointList, bool flagCurv = true,
+			bool flagU1dir = true, bool flagU2dir = true);
+	void reset(std::vector<GblPoint> &&aPointList, bool flagCurv = true,
+			bool flagU1dir = true, bool flagU2dir = true);
+	void reset(const std::vector<GblPoint> &aPointList, unsigned int aLabel,
+			const TMatrixDSym &aSeed, bool flagCurv = true, bool flagU1dir =
+					true, bool flagU2dir = true);
+	void reset(const std::vector<GblPoint> &aPointList, unsigned int aLabel,
+			const MatrixDynamic &aSeed, bool flagCurv = true, bool flagU1dir =
+					true, bool flagU2dir = true);
 	bool isValid() const;
 	unsigned int getNumPoints() const;
 	unsigned int getResults(int aSignedLabel, TVectorD &localPar,
 			TMatrixDSym &localCov) const;
+	unsigned int getResults(int aSignedLabel, VectorDynamic &localPar,
+			MatrixDynamic &localCov) const;
 	unsigned int getMeasResults(unsigned int aLabel, unsigned int &numRes,
 			TVectorD &aResiduals, TVectorD &aMeasErrors, TVectorD &aResErrors,
 			TVectorD &aDownWeights);
+	unsigned int getMeasResults(unsigned int aLabel, unsigned int &numRes,
+			VectorDynamic &aResiduals, VectorDynamic &aMeasErrors,
+			VectorDynamic &aResErrors, VectorDynamic &aDownWeights);
 	unsigned int getScatResults(unsigned int aLabel, unsigned int &numRes,
 			TVectorD &aResiduals, TVectorD &aMeasErrors, TVectorD &aResErrors,
 			TVectorD &aDownWeights);
+	unsigned int getScatResults(unsigned int aLabel, unsigned int &numRes,
+			VectorDynamic &aResiduals, VectorDynamic &aMeasErrors,
+			VectorDynamic &aResErrors, VectorDynamic &aDownWeights);
 	unsigned int getLabels(std::vector<unsigned int> &aLabelList);
 	unsigned int getLabels(std::vector<std::vector<unsigned int> > &aLabelList);
 	unsigned int fit(double &Chi2, int &Ndf, double &lostWeight,
 			std::string optionList = "");
 	void milleOut(MilleBinary &aMille);
+	void milleOut(MilleRecord &aRecord);
 	void printTrajectory(unsigned int level = 0);
 	void printPoints(unsigned int level = 0);
 	void printData();
-        std::vector<GblData> getData() {return theData;}
+        const std::vector<GblData>& getData() const {return theData;}
 
 private:
 	unsigned int numAllPoints; ///< Number of all points on trajectory
@@ -99,30 +121,42 @@ private:
 	std::vector<unsigned int> theDimension; ///< List of active dimensions (0=u1, 1=u2) in fit
 	std::vector<std::vector<GblPoint> > thePoints; ///< (list of) List of points on trajectory
 	std::vector<GblData> theData; ///< List of data blocks
+	GblDataBlocks theDataBlocks; ///< Data blocks as arrays (for fit)
 	std::vector<unsigned int> measDataIndex; ///< mapping points to data blocks from measurements
 	std::vector<unsigned int> scatDataIndex; ///< mapping points to data blocks from scatterers
-	TMatrixDSym externalSeed; ///< Precision (inverse covariance matrix) of external seed
-	std::vector<TMatrixD> innerTransformations; ///< Transformations at innermost points of
+	MatrixDynamic externalSeed; ///< Precision (inverse covariance matrix) of external seed
+	std::vector<MatrixDynamic> innerTransformations; ///< Transformations at innermost points of
 	// composed trajectory (from common external parameters)
-	TMatrixD externalDerivatives; // Derivatives for external measurements of composed trajectory
-	TVectorD externalMeasurements; // Residuals for external measurements of composed trajectory
-	TVectorD externalPrecisions; // Precisions for external measurements of composed trajectory
-	VVector theVector; ///< Vector of linear equation system
+	MatrixDynamic externalDerivatives; // Derivatives for external measurements of composed trajectory
+	VectorDynamic externalMeasurements; // Residuals for external measurements of composed trajectory
+	VectorDynamic externalPrecisions; // Precisions for external measurements of composed trajectory
+	VectorDynamic theVector; ///< Vector of linear equation system
 	BorderedBandMatrix theMatrix; ///< (Bordered band) matrix of linear equation system
+	// work space (reused for all points, queries are not thread safe)
+	mutable std::vector<unsigned int> workIndex; ///< List of fit parameters with non zero derivatives
+	mutable MatrixDynamic workJacobian; ///< Jacobian from fit to local parameters
+	mutable VectorDynamic workVector; ///< Compressed vector (of fit parameters or derivatives)
+	mutable MatrixDynamic workMatrix; ///< Compressed (covariance) matrix
+	mutable MatrixDynamic workProduct; ///< Jacobian times compressed covariance matrix
+	mutable VectorDynamic workParameters; ///< Local parameters (for ROOT interface)
+	mutable MatrixDynamic workCovariance; ///< Local covariance (for ROOT interface)
+	std::vector<int> workGlobalLabels; ///< Global labels (for MP-II output)
+	std::vector<double> workGlobalDerivatives; ///< Global derivatives (for MP-II output)
 
-	std::pair<std::vector<unsigned int>, TMatrixD> getJacobian(
-			int aSignedLabel) const;
-	void getFitToLocalJacobian(std::vector<unsigned int> &anIndex,
-			SMatrix55 &aJacobian, const GblPoint &aPoint, unsigned int measDim,
+	void getJacobian(int aSignedLabel) const;
+	void getFitToLocalJacobian(std::array<unsigned int, 5> &anIndex,
+			Matrix5x5 &aJacobian, const GblPoint &aPoint, unsigned int measDim,
 			unsigned int nJacobian = 1) const;
-	void getFitToKinkJacobian(std::vector<unsigned int> &anIndex,
-			SMatrix27 &aJacobian, const GblPoint &aPoint) const;
+	void getFitToKinkJacobian(std::array<unsigned int, 7> &anIndex,
+			Matrix2x7 &aJacobian, const GblPoint &aPoint) const;
+	void resetSimple(bool flagCurv, bool flagU1dir, bool flagU2dir);
 	void construct();
 	void defineOffsets();
 	void calcJacobians();
 	void prepare();
 	void buildLinearEquationSystem();
 	void predict();
+	template<typename MilleOutput> void addMilleData(MilleOutput &aMille);
 	double downWeight(unsigned int aMethod);
 	void getResAndErr(unsigned int aData, double &aResidual,
 			double &aMeadsError, double &aResError, double &aDownWeight);
@@ -24,13 +24,50 @@
 #define genfit_ICalibrationParametersDerivatives_h
 
 #include "AbsMeasurement.h"
+#include "EigenMatrixTypedefs.h"
+#include "Exception.h"
 #include "StateOnPlane.h"
 #include "TMatrixD.h"
 #include <TMatrixT.h>
 
+#include <map>
+#include <vector>
+
 
 namespace genfit {
 
+/** @brief Per-sensor cache of the (constant) global labels of calibration parameters
+ *
+ * The label list of a sensor is built once and then returned by reference,
+ * so measurements can hand out their labels without allocation in
+ * fillGlobalDerivatives(...). References stay valid for the lifetime of the cache.
+ *
+ * Lookups of cached sensors only read the table and take no lock. Adding a
+ * sensor is not thread safe: the lists have to be built before tracks are fitted
+ * in parallel, which GblFitter::processTracks does serially via
+ * ICalibrationParametersDerivatives::prepareCalibrationLabels().
+ */
+class CalibrationLabelCache {
+
+ public:
+  /**
+   * @brief Labels of sensor sensorId, created with makeLabels(sensorId) if not cached yet
+   */
+  template<typename MakeLabels>
+  const std::vector<int>& get(int sensorId, MakeLabels makeLabels) {
+    std::map<int, std::vector<int> >::const_iterator it = labels_.find(sensorId);
+    if (it == labels_.end())
+      it = labels_.insert(std::make_pair(sensorId, makeLabels(sensorId))).first;
+    return it->second;
+  }
+
+  unsigned int size() const {return labels_.size();}
+
+ private:
+  std::map<int, std::vector<int> > labels_;
+
+};
+
 /** @brief Abstract base class to establish an interface between physical representation
  * of the detector for alignment/calibration and (fitted) state on genfit::Track
  * 
@@ -150,6 +187,68 @@ class ICalibrationParametersDerivatives {
     */
    virtual std::vector<int> localLabels() {return std::vector<int>();}
    
+   /**
+    * @brief Allocation-free variant of globalDerivatives(...)
+    * 
+    * Fills the derivatives (same layout as from derivatives(...)) into a
+    * matrix of fixed capacity and returns the labels. Implementations
+    * should override it and return their (constant) label list from a
+    * CalibrationLabelCache instead of filling labelBuffer
+    * (see AlignablePlanarMeasurement). The default implementation
+    * falls back to globalDerivatives(...) and copies its result,
+    * which allocates.
+    * 
+    * @param sop Predicted state of the track (linearization point)
+    * @param derivatives Filled with derivatives, #columns = number of labels
+    * @param labelBuffer Buffer for labels (reused by caller), may be ignored
+    * @return Labels of global parameters (labelBuffer or cached list)
+    */
+   virtual const std::vector<int>& fillGlobalDerivatives(const genfit::StateOnPlane* sop, CalibrationDerivatives& derivatives, std::vector<int>& labelBuffer) {
+     std::pair<std::vector<int>, TMatrixD> labelsAndMatrix = globalDerivatives(sop);
+     labelBuffer.assign(labelsAndMatrix.first.begin(), labelsAndMatrix.first.end());
+     copyDerivatives(labelsAndMatrix.second, derivatives);
+     return labelBuffer;
+   }
+   
+   /**
+    * @brief Allocation-free variant of localDerivatives(...)
+    * 
+    * The default implementation falls back to localDerivatives(...),
+    * which allocates if there are local parameters.
+    * 
+    * @param sop Predicted state of the track (linearization point)
+    * @param derivatives Filled with derivatives d_residual_i/d_parameter_j
+    * @return Number of local parameters (#columns)
+    */
+   virtual unsigned int fillLocalDerivatives(const genfit::StateOnPlane* sop, CalibrationDerivatives& derivatives) {
+     copyDerivatives(localDerivatives(sop), derivatives);
+     return derivatives.cols();
+   }
+   
+   /**
+    * @brief Build cached labels (see CalibrationLabelCache) before tracks are fitted in parallel
+    * 
+    * Called serially for every measurement by GblFitter::processTracks.
+    * Measurements without a label cache need not implement it.
+    */
+   virtual void prepareCalibrationLabels() {}
+   
+ protected:
+   
+   /**
+    * @brief Copy derivatives from TMatrixD (checks capacity)
+    */
+   static void copyDerivatives(const TMatrixD& source, CalibrationDerivatives& target) {
+     if (source.GetNrows() > target.MaxRowsAtCompileTime || source.GetNcols() > target.MaxColsAtCompileTime) {
+       Exception exc("ICalibrationParametersDerivatives::copyDerivatives ==> too many derivatives for CalibrationDerivatives",__LINE__,__FILE__);
+       throw exc;
+     }
+     target.resize(source.GetNrows(), source.GetNcols());
+     for (int i = 0; i < source.GetNrows(); ++i)
+       for (int j = 0; j < source.GetNcols(); ++j)
+         target(i, j) = source(i, j);
+   }
+   
 };
 
 } /* End of namespace genfit */
@@ -0,0 +1,102 @@
+/*
+ * MilleAccumulator.h
+ *
+ *  This file is part of GENFIT.
+ *
+ *  GENFIT is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  GENFIT is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file
+ *  MilleAccumulator definition.
+ */
+
+#ifndef MILLEACCUMULATOR_H_
+#define MILLEACCUMULATOR_H_
+
+#include<map>
+#include<unordered_map>
+#include<vector>
+
+#include "MilleBinary.h"
+#include "EigenMatrixTypedefs.h"
+
+//! Namespace for the general broken lines package
+namespace gbl {
+
+using genfit::VectorDynamic;
+using genfit::MatrixDynamic;
+
+class GblTrajectory;
+
+///  In-memory accumulation of global (alignment) normal equations.
+/**
+ *  Replaces the round trip over Millepede-II binary files for (iterative) alignment.
+ *  Each \link MilleRecord \endlink (local fit, e.g. a GBL trajectory) is fitted
+ *  for its local parameters and these are eliminated (as in Millepede-II):
+ *
+ *     C += G^T W G - (G^T W L) (L^T W L)^-1 (L^T W G),
+ *     b += G^T W r - (G^T W L) (L^T W L)^-1 (L^T W r)
+ *
+ *  with the local (L) and global (G) derivatives, the weights (W) and residuals (r)
+ *  of the data blocks. The symmetric matrix C is stored sparse (upper triangle)
+ *  indexed by the global labels (from \link genfit::ICalibrationParametersDerivatives \endlink).
+ *
+ *  An accumulator is not thread safe. For parallel processing use one accumulator
+ *  per thread and combine them with \link merge \endlink. The correction to the
+ *  global parameters is obtained with the sparse solver in \link solve \endlink.
+ */
+class MilleAccumulator {
+public:
+	MilleAccumulator();
+	virtual ~MilleAccumulator();
+	unsigned int addRecord(const MilleRecord &aRecord);
+	unsigned int addTrajectory(GblTrajectory &aTrajectory);
+	void merge(const MilleAccumulator &anAccumulator);
+	void clear();
+	unsigned int solve(std::map<int, double> &aCorrection,
+			double aRegularization = 0.) const;
+	unsigned int getNumRecords() const;
+	unsigned int getNumRejected() const;
+	unsigned int getNumParameters() const;
+	double getChi2() const;
+	int getNdf() const;
+
+private:
+	unsigned int numRecords; ///< Number of accumulated records
+	unsigned int numRejected; ///< Number of rejected records (singular local fit)
+	double sumChi2; ///< Sum of Chi2 of local fits
+	int sumNdf; ///< Sum of degrees of freedom of local fits
+	std::map<int, unsigned int> labelToIndex; ///< Index of global parameter for label
+	std::vector<int> indexToLabel; ///< Label of global parameter for index
+	std::vector<double> theVector; ///< Right hand side of normal equations
+	std::unordered_map<unsigned long long, double> theMatrix; ///< Upper triangle of matrix, key (row, column)
+	// work space for records (reused)
+	MilleRecord workRecord; ///< Record from trajectory
+	std::vector<int> workGlobalLabel; ///< Labels of (used) global parameters in record
+	std::vector<unsigned int> workGlobalIndex; ///< Index of (used) global parameters in record (accepted records only)
+	std::vector<unsigned int> workPosition; ///< Position in workGlobalLabel for global derivatives in record
+	MatrixDynamic workLocalMatrix; ///< Local normal matrix (L^T W L)
+	MatrixDynamic workMixedMatrix; ///< Mixed matrix (L^T W G)
+	MatrixDynamic workGlobalMatrix; ///< Global matrix (G^T W G) of record
+	VectorDynamic workLocalVector; ///< Local right hand side (L^T W r)
+	VectorDynamic workGlobalVector; ///< Global right hand side (G^T W r) of record
+
+	unsigned int getIndex(int aLabel);
+	void addToMatrix(unsigned int aRow, unsigned int aCol, double aValue);
+	template<typename Real> unsigned int addRecordData(
+			const std::vector<Real> &realData,
+			const std::vector<int> &intData);
+};
+}
+#endif /* MILLEACCUMULATOR_H_ */
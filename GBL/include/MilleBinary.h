@@ -30,9 +30,15 @@
 #ifndef MILLEBINARY_H_
 #define MILLEBINARY_H_
 
+#include<condition_variable>
 #include<fstream>
+#include<mutex>
+#include<string>
+#include<thread>
 #include<vector>
 
+struct gzFile_s;
+
 //! Namespace for the general broken lines package
 namespace gbl {
 
@@ -65,24 +71,81 @@ namespace gbl {
  *         global derivative       label of global derivative
  *\endverbatim
  */
+class MilleRecord {
+public:
+	MilleRecord(bool doublePrec = false, unsigned int aSize = 2000);
+	virtual ~MilleRecord();
+	void addData(double aMeas, double aPrec, unsigned int numLocal,
+			const unsigned int* indLocal, const double* derLocal,
+			const std::vector<int> &labGlobal,
+			const std::vector<double> &derGlobal);
+	void clear();
+	bool isEmpty() const;
+	bool isDoublePrecision() const;
+
+private:
+	friend class MilleBinary;
+	friend class MilleAccumulator;
+	std::vector<int> intBuffer; ///< Integer buffer
+	std::vector<float> floatBuffer; ///< Float buffer
+	std::vector<double> doubleBuffer; ///< Double buffer
+	bool doublePrecision; ///< Flag for storage in as *double* values
+};
+
+///  Millepede-II binary file.
+/**
+ *  Records are either collected in the internal record (with \link addData \endlink)
+ *  or prepared elsewhere (e.g. in parallel for many tracks) as \link MilleRecord \endlink
+ *  and written in the wanted order.
+ *
+ *  Written records are collected in an output buffer. Full buffers are
+ *  handed over to a background thread writing them to the file
+ *  (with large writes of multiples of the block size), so that the
+ *  fitting is not stalled by the I/O. With a buffer size of zero each
+ *  record is written directly (synchronously).
+ *
+ *  File names ending with ".gz" are written compressed (gzip, readable
+ *  by Millepede-II) if built with zlib (GBL_USE_ZLIB).
+ *
+ *  Writing of records is thread safe, the order of records from
+ *  different threads is then given by the order of the calls. For
+ *  reproducible files either write the records of all threads from one
+ *  thread in a fixed order or use one file (shard) per thread.
+ */
 class MilleBinary {
 public:
 	MilleBinary(const std::string fileName = "milleBinaryISN.dat",
-			bool doublePrec = false, unsigned int aSize = 2000);
+			bool doublePrec = false, unsigned int aSize = 2000,
+			unsigned int aBufferSize = 4 << 20);
 	virtual ~MilleBinary();
-	void addData(double aMeas, double aPrec,
-			const std::vector<unsigned int> &indLocal,
-			const std::vector<double> &derLocal,
+	void addData(double aMeas, double aPrec, unsigned int numLocal,
+			const unsigned int* indLocal, const double* derLocal,
 			const std::vector<int> &labGlobal,
 			const std::vector<double> &derGlobal);
 	void writeRecord();
+	void writeRecord(const MilleRecord &aRecord);
+	void flush();
+	bool isDoublePrecision() const;
 
 private:
+	MilleBinary(const MilleBinary&);
+	MilleBinary& operator=(const MilleBinary&);
+	void appendRecord(const MilleRecord &aRecord);
+	void handOver(std::unique_lock<std::mutex> &aLock, bool complete);
+	void writeBlock(const std::vector<char> &aBlock);
+	void writerLoop();
+
 	std::ofstream binaryFile; ///< Binary File
-	std::vector<int> intBuffer; ///< Integer buffer
-	std::vector<float> floatBuffer; ///< Float buffer
-	std::vector<double> doubleBuffer; ///< Double buffer
-	bool doublePrecision; ///< Flag for storage in as *double* values
+	gzFile_s* compressedFile; ///< Compressed (gzip) file (or null)
+	MilleRecord theRecord; ///< Current record
+	unsigned int bufferSize; ///< Size of output buffer (0: synchronous output)
+	std::vector<char> fillBuffer; ///< Output buffer filled with records
+	std::vector<char> writeBuffer; ///< Output buffer written by background thread
+	bool writePending; ///< Write buffer waits for (or is in) output
+	bool stopWriter; ///< Background thread has to finish
+	std::mutex bufferMutex; ///< Protects buffers and flags
+	std::condition_variable bufferCondition; ///< Signals change of buffers or flags
+	std::thread writerThread; ///< Background thread writing to file
 };
 }
 #endif /* MILLEBINARY_H_ */
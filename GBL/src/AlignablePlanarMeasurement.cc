@@ -0,0 +1,95 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "AlignablePlanarMeasurement.h"
+
+#include <Exception.h>
+
+
+namespace genfit {
+
+CalibrationLabelCache AlignablePlanarMeasurement::labelCache_;
+
+
+AlignablePlanarMeasurement::AlignablePlanarMeasurement(int nDim)
+  : PlanarMeasurement(nDim), ICalibrationParametersDerivatives()
+{
+  ;
+}
+
+AlignablePlanarMeasurement::AlignablePlanarMeasurement(const TVectorD& rawHitCoords, const TMatrixDSym& rawHitCov, int detId, int hitId, TrackPoint* trackPoint)
+  : PlanarMeasurement(rawHitCoords, rawHitCov, detId, hitId, trackPoint), ICalibrationParametersDerivatives()
+{
+  ;
+}
+
+
+const std::vector<int>& AlignablePlanarMeasurement::cachedLabels() const {
+  return labelCache_.get(planeId_, [](int sensorId) {
+    std::vector<int> sensorLabels(nAlignmentParameters);
+    for (unsigned int i = 0; i < nAlignmentParameters; ++i)
+      sensorLabels[i] = label(sensorId, i);
+    return sensorLabels;
+  });
+}
+
+
+std::vector<int> AlignablePlanarMeasurement::labels() {
+  return cachedLabels();
+}
+
+
+TMatrixD AlignablePlanarMeasurement::derivatives(const genfit::StateOnPlane* sop) {
+  CalibrationDerivatives derivs;
+  std::vector<int> labelBuffer;
+  fillGlobalDerivatives(sop, derivs, labelBuffer);
+
+  TMatrixD result(derivs.rows(), derivs.cols());
+  for (int i = 0; i < derivs.rows(); ++i)
+    for (int j = 0; j < derivs.cols(); ++j)
+      result(i, j) = derivs(i, j);
+  return result;
+}
+
+
+const std::vector<int>& AlignablePlanarMeasurement::fillGlobalDerivatives(const genfit::StateOnPlane* sop, CalibrationDerivatives& derivs, std::vector<int>&) {
+  const TVectorD& state = sop->getState();
+  if (state.GetNrows() != 5) {
+    Exception exc("AlignablePlanarMeasurement::fillGlobalDerivatives ==> state must be (q/p, u', v', u, v)",__LINE__,__FILE__);
+    throw exc;
+  }
+  const double uSlope = state(1);
+  const double vSlope = state(2);
+  const double u = state(3);
+  const double v = state(4);
+
+  derivs.resize(2, nAlignmentParameters);
+  derivs << 1., 0., -uSlope, -uSlope * v, uSlope * u, -v,
+            0., 1., -vSlope, -vSlope * v, vSlope * u,  u;
+
+  return cachedLabels();
+}
+
+
+unsigned int AlignablePlanarMeasurement::fillLocalDerivatives(const genfit::StateOnPlane*, CalibrationDerivatives& derivs) {
+  derivs.resize(2, 0);
+  return 0;
+}
+
+} /* End of namespace genfit */
@@ -33,7 +33,7 @@
 namespace gbl {
 
 /// Create bordered band matrix.
-BorderedBandMatrix::BorderedBandMatrix() : numSize(0), numBorder(0), numBand(0), numCol(0) {
+BorderedBandMatrix::BorderedBandMatrix() : numSize(0), numBorder(0), numBand(0), numCol(0), isSolved(false), numInverted(0) {
 }
 
 BorderedBandMatrix::~BorderedBandMatrix() {
@@ -41,6 +41,10 @@ BorderedBandMatrix::~BorderedBandMatrix() {
 
 /// Resize bordered band matrix.
 /**
+ * All elements are reset to zero. The storage of the band and mixed parts
+ * (and the corresponding work space) only grows, the columns beyond the actual
+ * band size are left unused. A matrix reused for many trajectories therefore
+ * allocates only for the longest one.
  * \param nSize [in] Size of matrix
  * \param nBorder [in] Size of border (=1 for q/p + additional local parameters)
  * \param nBand [in] Band width (usually = 5, for simplified jacobians = 4)
@@ -51,9 +55,37 @@ void BorderedBandMatrix::resize(unsigned int nSize, unsigned int nBorder,
 	numBorder = nBorder;
 	numCol = nSize - nBorder;
 	numBand = 0;
-	theBorder.resize(numBorder);
-	theMixed.resize(numBorder, numCol);
-	theBand.resize((nBand + 1), numCol);
+	isSolved = false;
+	numInverted = 0;
+	theBorder.setZero(numBorder, numBorder);
+	reserveColumns(theMixed, numBorder);
+	theMixed.leftCols(numCol).setZero();
+	reserveColumns(theBand, nBand + 1);
+	theBand.leftCols(numCol).setZero();
+}
+
+/// Make sure matrix has given number of rows and at least numCol columns.
+/**
+ * \param aMatrix [in,out] Matrix (contents are undefined after reallocation)
+ * \param nRow [in] Number of rows
+ */
+void BorderedBandMatrix::reserveColumns(genfit::MatrixDynamic &aMatrix,
+		unsigned int nRow) const {
+	if (aMatrix.rows() != nRow or aMatrix.cols() < numCol) {
+		aMatrix.resize(nRow, std::max<unsigned int>(numCol, aMatrix.cols()));
+	}
+}
+
+/// Make sure vector has at least given size.
+/**
+ * \param aVector [in,out] Vector (contents are undefined after reallocation)
+ * \param nSize [in] Minimal size
+ */
+void BorderedBandMatrix::reserveSize(genfit::VectorDynamic &aVector,
+		unsigned int nSize) {
+	if (aVector.size() < nSize) {
+		aVector.resize(nSize);
+	}
 }
 
 /// Add symmetric block matrix.
@@ -62,27 +94,25 @@ void BorderedBandMatrix::resize(unsigned int nSize, unsigned int nBorder,
  * to bordered band matrix:
  * BBmatrix(anIndex(i),anIndex(j)) += aVector(i) * aWeight * aVector(j).
  * \param aWeight [in] Weight
+ * \param nSimple [in] Size of block matrix
  * \param anIndex [in] List of rows/colums to be used
  * \param aVector [in] Vector
  */
-void BorderedBandMatrix::addBlockMatrix(double aWeight,
-		const std::vector<unsigned int>* anIndex,
-		const std::vector<double>* aVector) {
+void BorderedBandMatrix::addBlockMatrix(double aWeight, unsigned int nSimple,
+		const unsigned int* anIndex, const double* aVector) {
 	int nBorder = numBorder;
-	for (unsigned int i = 0; i < anIndex->size(); ++i) {
-		int iIndex = (*anIndex)[i] - 1; // anIndex has to be sorted
+	for (unsigned int i = 0; i < nSimple; ++i) {
+		int iIndex = anIndex[i] - 1; // anIndex has to be sorted
+		const double wVi = aVector[i] * aWeight;
 		for (unsigned int j = 0; j <= i; ++j) {
-			int jIndex = (*anIndex)[j] - 1;
+			int jIndex = anIndex[j] - 1;
 			if (iIndex < nBorder) {
-				theBorder(iIndex, jIndex) += (*aVector)[i] * aWeight
-						* (*aVector)[j];
+				theBorder(iIndex, jIndex) += wVi * aVector[j]; // lower triangle only
 			} else if (jIndex < nBorder) {
-				theMixed(jIndex, iIndex - nBorder) += (*aVector)[i] * aWeight
-						* (*aVector)[j];
+				theMixed(jIndex, iIndex - nBorder) += wVi * aVector[j];
 			} else {
 				unsigned int nBand = iIndex - jIndex;
-				theBand(nBand, jIndex - nBorder) += (*aVector)[i] * aWeight
-						* (*aVector)[j];
+				theBand(nBand, jIndex - nBorder) += wVi * aVector[j];
 				numBand = std::max(numBand, nBand); // update band width
 			}
 		}
@@ -92,14 +122,28 @@ void BorderedBandMatrix::addBlockMatrix(double aWeight,
 /// Retrieve symmetric block matrix.
 /**
  * Get (compressed) block from bordered band matrix: aMatrix(i,j) = BBmatrix(anIndex(i),anIndex(j)).
+ * After \link solveAndInvertBorderedBand \endlink the elements are taken from the inverse,
+ * the needed columns of the band part of the inverse are calculated on demand.
+ * \param nSimple [in] Size of block matrix
  * \param anIndex [in] List of rows/colums to be used
+ * \param aMatrix [out] Block matrix (resized to nSimple x nSimple)
  */
-TMatrixDSym BorderedBandMatrix::getBlockMatrix(
-		const std::vector<unsigned int> anIndex) const {
+void BorderedBandMatrix::getBlockMatrix(unsigned int nSimple,
+		const unsigned int* anIndex, genfit::MatrixDynamic &aMatrix) const {
 
-	TMatrixDSym aMatrix(anIndex.size());
+	aMatrix.resize(nSimple, nSimple);
 	int nBorder = numBorder;
-	for (unsigned int i = 0; i < anIndex.size(); ++i) {
+	if (isSolved) {
+		// anIndex is sorted, first band index needs most columns of inverse
+		for (unsigned int i = 0; i < nSimple; ++i) {
+			int iIndex = anIndex[i] - 1;
+			if (iIndex >= nBorder) {
+				invertBand(iIndex - nBorder);
+				break;
+			}
+		}
+	}
+	for (unsigned int i = 0; i < nSimple; ++i) {
 		int iIndex = anIndex[i] - 1; // anIndex has to be sorted
 		for (unsigned int j = 0; j <= i; ++j) {
 			int jIndex = anIndex[j] - 1;
@@ -107,14 +151,21 @@ TMatrixDSym BorderedBandMatrix::getBlockMatrix(
 				aMatrix(i, j) = theBorder(iIndex, jIndex); // border part of inverse
 			} else if (jIndex < nBorder) {
 				aMatrix(i, j) = -theMixed(jIndex, iIndex - nBorder); // mixed part of inverse
+			} else if (isSolved) {
+				// band part of inverse: band(D^-1 + X*E*Xt)
+				unsigned int nBand = iIndex - jIndex;
+				aMatrix(i, j) = inverseBand(nBand, jIndex - nBorder);
+				if (nBorder > 0) {
+					aMatrix(i, j) += theMixed.col(iIndex - nBorder).dot(
+							auxMat.col(jIndex - nBorder));
+				}
 			} else {
 				unsigned int nBand = iIndex - jIndex;
-				aMatrix(i, j) = theBand(nBand, jIndex - nBorder); // band part of inverse
+				aMatrix(i, j) = theBand(nBand, jIndex - nBorder); // band part
 			}
 			aMatrix(j, i) = aMatrix(i, j);
 		}
 	}
-	return aMatrix;
 }
 
 /// Solve linear equation system, partially calculate inverse.
@@ -140,50 +191,142 @@ TMatrixDSym BorderedBandMatrix::getBlockMatrix(
  *     |                     |            , only band part of (D^-1 + X*E*Xt)
  *     | -X*E  D^-1 + X*E*Xt |              is calculated
  *
+ * The border and mixed parts of the inverse are stored immediately. The band
+ * part of D^-1 is only calculated (backwards from the last column) when
+ * requested by \link getBlockMatrix \endlink and the band of X*E*Xt is added per element,
+ * so that solutions not followed by queries of the covariance (like intermediate
+ * down-weighting iterations) skip the inversion.
+ *
+ * The (dominating) band parts are handled by kernels with the band width
+ * fixed at compile time for the common case of five (two offsets in two
+ * dimensions plus curvature), all right hand sides for the mixed part are
+ * solved together (one column of Xt per band column, contiguous in memory).
+ *
+ * Right hand side and solution may be the same vector.
  *
  * \param [in] aRightHandSide Right hand side (vector) 'b' of A*x=b
  * \param [out] aSolution Solution (vector) x of A*x=b
  */
 void BorderedBandMatrix::solveAndInvertBorderedBand(
-		const VVector &aRightHandSide, VVector &aSolution) {
+		const genfit::VectorDynamic &aRightHandSide,
+		genfit::VectorDynamic &aSolution) {
 
 	// decompose band
-	decomposeBand();
-	// invert band
-	VMatrix inverseBand = invertBand();
+	if (numBand == 5) {
+		decomposeBand<6>();
+	} else {
+		decomposeBand<0>();
+	}
+	numInverted = numCol; // no columns of band part of inverse yet
+	isSolved = true;
+	// solve for band part
+	reserveSize(bandSolution, numCol);
+	bandSolution.head(numCol) = aRightHandSide.tail(numCol);
+	solveBand(bandSolution.head(numCol).transpose()); // = x
 	if (numBorder > 0) { // need to use block matrix decomposition to solve
 		// solve for mixed part
-		const VMatrix auxMat = solveBand(theMixed); // = Xt
-		const VMatrix auxMatT = auxMat.transpose(); // = X
+		reserveColumns(auxMat, numBorder);
+		auxMat.leftCols(numCol) = theMixed.leftCols(numCol);
+		solveBand(auxMat.leftCols(numCol)); // = Xt
 		// solve for border part
-		const VVector auxVec = aRightHandSide.getVec(numBorder)
-				- auxMat * aRightHandSide.getVec(numCol, numBorder); // = b1 - Xt*b2
-		VSymMatrix inverseBorder = theBorder - theMixed * auxMatT;
-		inverseBorder.invert(); // = E
-		const VVector borderSolution = inverseBorder * auxVec; // = x1
-		// solve for band part
-		const VVector bandSolution = solveBand(
-				aRightHandSide.getVec(numCol, numBorder)); // = x
-		aSolution.putVec(borderSolution);
-		aSolution.putVec(bandSolution - auxMatT * borderSolution, numBorder); // = x2
+		auxVec = aRightHandSide.head(numBorder);
+		auxVec.noalias() -= auxMat.leftCols(numCol) * aRightHandSide.tail(numCol); // = b1 - Xt*b2
+		inverseBorder = theBorder.selfadjointView<Eigen::Lower>();
+		inverseBorder.noalias() -= theMixed.leftCols(numCol)
+				* auxMat.leftCols(numCol).transpose();
+		invertBorder(); // = E
+		borderSolution.noalias() = inverseBorder * auxVec; // = x1
+		aSolution.resize(numSize);
+		aSolution.head(numBorder) = borderSolution;
+		aSolution.tail(numCol) = bandSolution.head(numCol);
+		aSolution.tail(numCol).noalias() -= auxMat.leftCols(numCol).transpose()
+				* borderSolution; // = x2
 		// parts of inverse
 		theBorder = inverseBorder; // E
-		theMixed = inverseBorder * auxMat; // E*Xt (-mixed part of inverse) !!!
-		theBand = inverseBand + bandOfAVAT(auxMatT, inverseBorder); // band(D^-1 + X*E*Xt)
+		theMixed.leftCols(numCol).noalias() = inverseBorder
+				* auxMat.leftCols(numCol); // E*Xt (-mixed part of inverse) !!!
 	} else {
-		aSolution.putVec(solveBand(aRightHandSide));
-		theBand = inverseBand;
+		aSolution = bandSolution.head(numCol);
 	}
 }
 
 /// Print bordered band matrix.
 void BorderedBandMatrix::printMatrix() const {
+	if (isSolved) {
+		invertBand(0);
+	}
 	std::cout << "Border part " << std::endl;
-	theBorder.print();
+	std::cout << theBorder << std::endl;
 	std::cout << "Mixed  part " << std::endl;
-	theMixed.print();
+	std::cout << theMixed.leftCols(numCol) << std::endl;
 	std::cout << "Band   part " << std::endl;
-	theBand.print();
+	if (isSolved) {
+		genfit::MatrixDynamic aBand = inverseBand.topLeftCorner(numBand + 1,
+				numCol);
+		if (numBorder > 0) {
+			for (unsigned int i = 0; i < numCol; ++i) {
+				for (unsigned int j = (i > numBand ? i - numBand : 0); j <= i;
+						++j) {
+					aBand(i - j, j) += theMixed.col(i).dot(auxMat.col(j));
+				}
+			}
+		}
+		std::cout << aBand << std::endl;
+	} else {
+		std::cout << theBand.leftCols(numCol) << std::endl;
+	}
+}
+
+namespace {
+
+/// Eliminate column of band matrix for LDL^T decomposition.
+/**
+ * \param [in,out] aColumn Column i of band (diagonal (already inverted) and sub-diagonals)
+ * \param [in] aStride Distance between band columns
+ * \param [in] nRow Number of rows of band to be used (band width + 1, or less at the end)
+ */
+inline void eliminateColumn(double* aColumn, int aStride, int nRow) {
+	for (int j = 1; j < nRow; ++j) {
+		const double rxw = aColumn[j] * aColumn[0];
+		double* nextColumn = aColumn + j * aStride;
+		for (int k = 0; k < nRow - j; ++k) {
+			nextColumn[k] -= aColumn[k + j] * rxw;
+		}
+		aColumn[j] = rxw;
+	}
+}
+
+/// Forward substitution step for band column.
+/**
+ * \param [in] aColumn Column i of decomposed band
+ * \param [in,out] aSolution Right hand sides (one column per band column)
+ * \param [in] iCol Column i
+ * \param [in] nRow Number of rows of band to be used
+ */
+template<typename Matrix>
+inline void forwardColumn(const double* aColumn, Matrix &aSolution, int iCol,
+		int nRow) {
+	for (int j = 1; j < nRow; ++j) {
+		aSolution.col(iCol + j) -= aColumn[j] * aSolution.col(iCol);
+	}
+}
+
+/// Backward substitution step for band column.
+/**
+ * \param [in] aColumn Column i of decomposed band
+ * \param [in,out] aSolution Right hand sides (one column per band column)
+ * \param [in] iCol Column i
+ * \param [in] nRow Number of rows of band to be used
+ */
+template<typename Matrix>
+inline void backwardColumn(const double* aColumn, Matrix &aSolution, int iCol,
+		int nRow) {
+	aSolution.col(iCol) *= aColumn[0];
+	for (int j = 1; j < nRow; ++j) {
+		aSolution.col(iCol) -= aColumn[j] * aSolution.col(iCol + j);
+	}
+}
+
 }
 
 /*============================================================================
@@ -193,19 +336,24 @@ void BorderedBandMatrix::printMatrix() const {
 /**
  * Decompose band matrix into diagonal matrix D and lower triangular band matrix
  * L (diagonal=1). Overwrite band matrix with D and off-diagonal part of L.
+ * Columns are stored contiguously (diagonal first), an elimination step
+ * updates the following columns with the current one. For a band width fixed at
+ * compile time (nRowFixed > 0) the inner loops have constant length
+ * (except for the last columns) and are unrolled and vectorized.
  *  \exception 2 : matrix is singular.
  *  \exception 3 : matrix is not positive definite.
  */
+template<int nRowFixed>
 void BorderedBandMatrix::decomposeBand() {
 
-	int nRow = numBand + 1;
-	int nCol = numCol;
-	VVector auxVec(nCol);
+	const int nRow = (nRowFixed > 0) ? nRowFixed : numBand + 1;
+	const int nCol = numCol;
+	const int nStride = theBand.rows();
+	const int nFull = std::max(nCol - nRow + 1, 0); // columns with full band below
+	reserveSize(auxDiag, nCol);
+	auxDiag.head(nCol) = theBand.row(0).head(nCol).transpose() * 16.0; // save diagonal elements
 	for (int i = 0; i < nCol; ++i) {
-		auxVec(i) = theBand(0, i) * 16.0; // save diagonal elements
-	}
-	for (int i = 0; i < nCol; ++i) {
-		if ((theBand(0, i) + auxVec(i)) != theBand(0, i)) {
+		if ((theBand(0, i) + auxDiag(i)) != theBand(0, i)) {
 			theBand(0, i) = 1.0 / theBand(0, i);
 			if (theBand(0, i) < 0.) {
 				throw 3; // not positive definite
@@ -214,12 +362,10 @@ void BorderedBandMatrix::decomposeBand() {
 			theBand(0, i) = 0.0;
 			throw 2; // singular
 		}
-		for (int j = 1; j < std::min(nRow, nCol - i); ++j) {
-			double rxw = theBand(j, i) * theBand(0, i);
-			for (int k = 0; k < std::min(nRow, nCol - i) - j; ++k) {
-				theBand(k, i + j) -= theBand(k + j, i) * rxw;
-			}
-			theBand(j, i) = rxw;
+		if (i < nFull) {
+			eliminateColumn(&theBand(0, i), nStride, nRow);
+		} else {
+			eliminateColumn(&theBand(0, i), nStride, nCol - i);
 		}
 	}
 }
@@ -228,74 +374,62 @@ void BorderedBandMatrix::decomposeBand() {
 /**
  * Solve C*x=b for band part using decomposition C=LDL^T
  * and forward (L*z=b) and backward substitution (L^T*x=D^-1*z).
- * \param [in] aRightHandSide Right hand side (vector) 'b' of C*x=b
- * \return Solution (vector) 'x' of C*x=b
+ * Several right hand sides are solved together, each column of the argument
+ * corresponds to a column of the band (a row vector for a single right hand side).
+ * \param [in,out] aSolution Right hand sides 'b' of C*x=b (transposed), replaced by solutions 'x'
  */
-VVector BorderedBandMatrix::solveBand(const VVector &aRightHandSide) const {
-
-	int nRow = theBand.getNumRows();
-	int nCol = theBand.getNumCols();
-	VVector aSolution(aRightHandSide);
-	for (int i = 0; i < nCol; ++i) // forward substitution
-			{
-		for (int j = 1; j < std::min(nRow, nCol - i); ++j) {
-			aSolution(j + i) -= theBand(j, i) * aSolution(i);
-		}
-	}
-	for (int i = nCol - 1; i >= 0; i--) // backward substitution
-			{
-		double rxw = theBand(0, i) * aSolution(i);
-		for (int j = 1; j < std::min(nRow, nCol - i); ++j) {
-			rxw -= theBand(j, i) * aSolution(j + i);
-		}
-		aSolution(i) = rxw;
+template<typename Matrix>
+void BorderedBandMatrix::solveBand(Matrix &&aSolution) const {
+	if (numBand == 5) {
+		solveBand<6>(aSolution);
+	} else {
+		solveBand<0>(aSolution);
 	}
-	return aSolution;
 }
 
-/// solve band part for mixed part (border rows).
+/// Solve for band part (with fixed band width).
 /**
- * Solve C*X=B for mixed part using decomposition C=LDL^T
- * and forward and backward substitution.
- * \param [in] aRightHandSide Right hand side (matrix) 'B' of C*X=B
- * \return Solution (matrix) 'X' of C*X=B
+ * \param [in,out] aSolution Right hand sides 'b' of C*x=b (transposed), replaced by solutions 'x'
  */
-VMatrix BorderedBandMatrix::solveBand(const VMatrix &aRightHandSide) const {
+template<int nRowFixed, typename Matrix>
+void BorderedBandMatrix::solveBand(Matrix &aSolution) const {
 
-	int nRow = theBand.getNumRows();
-	int nCol = theBand.getNumCols();
-	VMatrix aSolution(aRightHandSide);
-	for (unsigned int iBorder = 0; iBorder < numBorder; iBorder++) {
-		for (int i = 0; i < nCol; ++i) // forward substitution
-				{
-			for (int j = 1; j < std::min(nRow, nCol - i); ++j) {
-				aSolution(iBorder, j + i) -= theBand(j, i)
-						* aSolution(iBorder, i);
-			}
-		}
-		for (int i = nCol - 1; i >= 0; i--) // backward substitution
-				{
-			double rxw = theBand(0, i) * aSolution(iBorder, i);
-			for (int j = 1; j < std::min(nRow, nCol - i); ++j) {
-				rxw -= theBand(j, i) * aSolution(iBorder, j + i);
-			}
-			aSolution(iBorder, i) = rxw;
-		}
+	const int nRow = (nRowFixed > 0) ? nRowFixed : numBand + 1;
+	const int nCol = numCol;
+	const int nFull = std::max(nCol - nRow + 1, 0); // columns with full band below
+	for (int i = 0; i < nFull; ++i) { // forward substitution
+		forwardColumn(&theBand(0, i), aSolution, i, nRow);
+	}
+	for (int i = nFull; i < nCol; ++i) {
+		forwardColumn(&theBand(0, i), aSolution, i, nCol - i);
+	}
+	for (int i = nCol - 1; i >= nFull; i--) { // backward substitution
+		backwardColumn(&theBand(0, i), aSolution, i, nCol - i);
+	}
+	for (int i = nFull - 1; i >= 0; i--) {
+		backwardColumn(&theBand(0, i), aSolution, i, nRow);
 	}
-	return aSolution;
 }
 
 /// Invert band part.
 /**
- * \return Inverted band
+ * Band part of inverse (from decomposition) is stored in inverseBand.
+ * The inverse is calculated backwards from the last column, a call
+ * continues the calculation from the last calculated column down to the requested one.
+ * \param [in] aColumn First column of band part needed
  */
-VMatrix BorderedBandMatrix::invertBand() {
+void BorderedBandMatrix::invertBand(int aColumn) const {
 
 	int nRow = numBand + 1;
 	int nCol = numCol;
-	VMatrix inverseBand(nRow, nCol);
+	if (numInverted <= aColumn) {
+		return; // already available
+	}
+	if (numInverted == nCol) {
+		reserveColumns(inverseBand, theBand.rows());
+	}
 
-	for (int i = nCol - 1; i >= 0; i--) {
+	for (int i = numInverted - 1; i >= aColumn; i--) {
 		double rxw = theBand(0, i);
 		for (int j = i; j >= std::max(0, i - nRow + 1); j--) {
 			for (int k = j + 1; k < std::min(nCol, j + nRow); ++k) {
@@ -306,34 +440,59 @@ VMatrix BorderedBandMatrix::invertBand() {
 			rxw = 0.;
 		}
 	}
-	return inverseBand;
+	numInverted = aColumn;
 }
 
-/// Calculate band part of: 'anArray * aSymArray * anArray.T'.
+/// Invert (symmetric) border part.
 /**
- * \return Band part of product
+ *     Invert symmetric N-by-N matrix inverseBorder in place.
+ *
+ *     Method of solution is by elimination selecting the  pivot  on  the
+ *     diagonal each stage. For rank < N all remaining rows and cols of the
+ *     resulting matrix are set to zero.
+ *  \exception 1 : matrix is singular.
  */
-VMatrix BorderedBandMatrix::bandOfAVAT(const VMatrix &anArray,
-		const VSymMatrix &aSymArray) const {
-	int nBand = numBand;
-	int nCol = numCol;
-	int nBorder = numBorder;
-	double sum;
-	VMatrix aBand((nBand + 1), nCol);
-	for (int i = 0; i < nCol; ++i) {
-		for (int j = std::max(0, i - nBand); j <= i; ++j) {
-			sum = 0.;
-			for (int l = 0; l < nBorder; ++l) { // diagonal
-				sum += anArray(i, l) * aSymArray(l, l) * anArray(j, l);
-				for (int k = 0; k < l; ++k) { // off diagonal
-					sum += anArray(i, l) * aSymArray(l, k) * anArray(j, k)
-							+ anArray(i, k) * aSymArray(l, k) * anArray(j, l);
+void BorderedBandMatrix::invertBorder() {
+
+	const double eps = 1.0E-10;
+	int nSize = numBorder;
+	reserveSize(auxDiag, nSize);
+	auxDiag.head(nSize) = inverseBorder.diagonal().cwiseAbs(); // save abs of diagonal elements
+	auxUsed.assign(nSize, false);
+
+	for (int i = 0; i < nSize; ++i) { // start of loop
+		int k = -1;
+		double vkk = 0.0;
+		// look for pivot
+		for (int j = 0; j < nSize; ++j) {
+			if (not auxUsed[j]
+					and fabs(inverseBorder(j, j))
+							> std::max(fabs(vkk), eps * auxDiag(j))) {
+				vkk = inverseBorder(j, j);
+				k = j;
+			}
+		}
+		// pivot found
+		if (k >= 0) {
+			auxUsed[k] = true; // index is used
+			vkk = 1.0 / vkk;
+			// elimination (with copy of pivot column)
+			auxPivot = inverseBorder.col(k);
+			inverseBorder.noalias() -= vkk * auxPivot * auxPivot.transpose();
+			inverseBorder.col(k) = vkk * auxPivot;
+			inverseBorder.row(k) = vkk * auxPivot.transpose();
+			inverseBorder(k, k) = -vkk;
+		} else {
+			for (int j = 0; j < nSize; ++j) {
+				if (not auxUsed[j]) {
+					inverseBorder.row(j).setZero(); // clear matrix row/col
+					inverseBorder.col(j).setZero();
 				}
 			}
-			aBand(i - j, j) = sum;
+			throw 1; // singular
 		}
 	}
-	return aBand;
+	inverseBorder = -inverseBorder; // finally reverse sign of all matrix elements
 }
 
 }
@@ -68,102 +68,12 @@
 #include <TVector3.h>
 
 //#define DEBUG
-//#define OUTPUT
 
 
 #ifdef DEBUG
 //ofstream debug("gbl.debug");
 #endif
 
-#ifdef OUTPUT
-
-std::string rootFileName = "gbl.root";
-
-
-TFile* diag;
-TH1F* resHistosU[12];
-TH1F* resHistosV[12];
-TH1F* mhistosU[12];
-TH1F* mhistosV[12];
-TH1F* ghistosU[12];
-TH1F* ghistosV[12];
-TH1F* downWeightsHistosU[12];
-TH1F* downWeightsHistosV[12];
-TH1F* localPar1[12];
-TH1F* localPar2[12];
-TH1F* localPar3[12];
-TH1F* localPar4[12];
-TH1F* localPar5[12];
-TH1F* localCov1[12];
-TH1F* localCov2[12];
-TH1F* localCov3[12];
-TH1F* localCov4[12];
-TH1F* localCov5[12];
-TH1F* localCov12[12];
-TH1F* localCov13[12];
-TH1F* localCov14[12];
-TH1F* localCov15[12];
-TH1F* localCov23[12];
-TH1F* localCov24[12];
-TH1F* localCov25[12];
-TH1F* localCov34[12];
-TH1F* localCov35[12];
-TH1F* localCov45[12];
-TH1I* fitResHisto;
-TH1I* ndfHisto;
-TH1F* chi2OndfHisto;
-TH1F* pValueHisto;
-TH1I* stats;
-
-
-
-bool writeHistoDataForLabel(double label, TVectorD res, TVectorD measErr, TVectorD resErr, TVectorD downWeights, TVectorD localPar, TMatrixDSym localCov)
-{
-  if (label < 1.) return false;
-  
-  unsigned int id = floor(label);
-  // skip segment (5 bits)
-  id = id >> 5;
-  unsigned int sensor = id & 7;
-  id = id >> 3;
-  unsigned int ladder = id & 31;
-  id = id >> 5;
-  unsigned int layer = id & 7;
-  if (layer == 7 && ladder == 2) {
-    label = sensor;
-  } else if (layer == 7 && ladder == 3) {
-    label = sensor + 9 - 3;
-  } else {
-    label = layer + 3;
-  }
-  
-  if (label > 12.) return false;
-  
-  int i = int(label);
-  
-  #ifdef OUTPUT
-  resHistosU[i - 1]->Fill(res[0]);
-  resHistosV[i - 1]->Fill(res[1]);
-  mhistosU[i - 1]->Fill(res[0] / measErr[0]);
-  mhistosV[i - 1]->Fill(res[1] / measErr[1]);
-  ghistosU[i - 1]->Fill(res[0] / resErr[0]);
-  ghistosV[i - 1]->Fill(res[1] / resErr[1]);
-  downWeightsHistosU[i - 1]->Fill(downWeights[0]);
-  downWeightsHistosV[i - 1]->Fill(downWeights[1]);
-  localPar1[i - 1]->Fill(localPar(0));
-  localPar2[i - 1]->Fill(localPar(1));
-  localPar3[i - 1]->Fill(localPar(2));
-  localPar4[i - 1]->Fill(localPar(3));
-  localPar5[i - 1]->Fill(localPar(4));
-  #endif
-  
-  
-  return true;
-}
-#endif
-
-// Millepede Binary File for output of GBL trajectories for alignment
-gbl::MilleBinary* milleFile;
 // Minimum scattering sigma (will be squared and inverted...)
 const double scatEpsilon = 1.e-8;
 
@@ -176,68 +86,29 @@ GFGbl::GFGbl() :
 AbsFitter(), m_milleFileName("millefile.dat"), m_gblInternalIterations("THC"), m_pValueCut(0.), m_minNdf(1),
 m_chi2Cut(0.),
 m_enableScatterers(true),
-m_enableIntermediateScatterer(true)
+m_enableIntermediateScatterer(true),
+m_milleFile(nullptr),
+m_diagnostics(nullptr)
 {
   
 }
 
+GFGbl::~GFGbl()
+{
+  ;
+}
+
 void GFGbl::beginRun()
 {
-  milleFile = new MilleBinary(m_milleFileName);
-  
-  #ifdef OUTPUT
-  diag = new TFile(rootFileName.c_str(), "RECREATE");
-  char name[20];
-  
-  for (int i = 0; i < 12; i++) {
-    sprintf(name, "res_u_%i", i + 1);
-    resHistosU[i] = new TH1F(name, "Residual (U)", 1000, -0.1, 0.1);
-    sprintf(name, "res_v_%i", i + 1);
-    resHistosV[i] = new TH1F(name, "Residual (V)", 1000, -0.1, 0.1);
-    sprintf(name, "meas_pull_u_%i", i + 1);
-    mhistosU[i] = new TH1F(name, "Res/Meas.Err. (U)", 1000, -20., 20.);
-    sprintf(name, "meas_pull_v_%i", i + 1);
-    mhistosV[i] = new TH1F(name, "Res/Meas.Err. (V)", 1000, -20., 20.);
-    sprintf(name, "pull_u_%i", i + 1);
-    ghistosU[i] = new TH1F(name, "Res/Res.Err. (U)", 1000, -20., 20.);
-    sprintf(name, "pull_v_%i", i + 1);
-    ghistosV[i] = new TH1F(name, "Res/Res.Err. (V)", 1000, -20., 20.);
-    sprintf(name, "downWeights_u_%i", i + 1);
-    downWeightsHistosU[i] = new TH1F(name, "Down-weights (U)", 1000, 0., 1.);
-    sprintf(name, "downWeights_v_%i", i + 1);
-    downWeightsHistosV[i] = new TH1F(name, "Down-weights (V)", 1000, 0., 1.);
-    sprintf(name, "localPar1_%i", i + 1);
-    
-    localPar1[i] = new TH1F(name, "Residual (U)", 1000, -0.1, 0.1);
-    sprintf(name, "localPar2_%i", i + 1);
-    localPar2[i] = new TH1F(name, "Residual (U)", 1000, -0.1, 0.1);
-    sprintf(name, "localPar3_%i", i + 1);
-    localPar3[i] = new TH1F(name, "Residual (U)", 1000, -0.1, 0.1);
-    sprintf(name, "localPar4_%i", i + 1);
-    localPar4[i] = new TH1F(name, "Residual (U)", 1000, -0.1, 0.1);
-    sprintf(name, "localPar5_%i", i + 1);
-    localPar5[i] = new TH1F(name, "Residual (U)", 1000, -0.1, 0.1);
-  }
-  fitResHisto = new TH1I("fit_result", "GBL Fit Result", 21, -1, 20);
-  ndfHisto = new TH1I("ndf", "GBL Track NDF", 41, -1, 40);
-  chi2OndfHisto = new TH1F("chi2_ndf", "Track Chi2/NDF", 100, 0., 10.);
-  pValueHisto = new TH1F("p_value", "Track P-value", 100, 0., 1.);
-  
-  stats = new TH1I("stats", "0: NDF>0 | 1: fTel&VXD | 2: all | 3: VXD | 4: SVD | 5: all - PXD | 6: fTel&SVD | 7: bTel", 10, 0, 10);
-  
-  #endif
+  m_milleFile.reset();
+  if (m_milleFileName != "")
+    m_milleFile.reset(new MilleBinary(m_milleFileName));
 }
 
 void GFGbl::endRun()
 {
-  #ifdef OUTPUT
-  diag->cd();
-  diag->Write();
-  diag->Close();
-  #endif
   // This is needed to close the file before alignment starts
-  if (milleFile)
-    delete milleFile;
+  m_milleFile.reset();
 }
 
 /**
@@ -862,11 +733,9 @@ void GFGbl::processTrackWithRep(Track* trk, const AbsTrackRep* rep, bool resortH
     //traj->printData();
     //traj->printPoints(100);
     
-    #ifdef OUTPUT
-    // Fill histogram with fit result
-    fitResHisto->Fill(fitRes);
-    ndfHisto->Fill(Ndf);
-    #endif
+    // Fill diagnostics with fit result
+    if (m_diagnostics)
+      m_diagnostics->fillFitResult(fitRes, Ndf);
     
     #ifdef DEBUG
     cout << " Ref. Track Chi2      :  " << trkChi2 << endl;
@@ -893,21 +762,17 @@ void GFGbl::processTrackWithRep(Track* trk, const AbsTrackRep* rep, bool resortH
     cout << "-------------------------------------------------------" << endl;
     #endif
     
-    #ifdef OUTPUT
-    bool hittedLayers[12];
-    for (int hl = 0; hl < 12; hl++) {
-      hittedLayers[hl] = false;
-    }
-    #endif
-    
     // GBL fit succeded if Ndf >= 0, but Ndf = 0 is useless
     //TODO: Here should be some track quality check
     //    if (Ndf > 0 && fitRes == 0) {
     if (traj->isValid() && pvalue >= m_pValueCut && Ndf >= m_minNdf) {
       
       // In case someone forgot to use beginRun and dind't reset mille file name to ""
-      if (!milleFile && m_milleFileName != "")
-        milleFile = new MilleBinary(m_milleFileName);
+      if (!m_milleFile && m_milleFileName != "")
+        m_milleFile.reset(new MilleBinary(m_milleFileName));
+      
+      // Sensors of measurements (for diagnostics)
+      std::vector<unsigned int> measuredSensors;
       
       // Loop over all GBL points
       for (unsigned int p = 0; p < listOfPoints.size(); p++) {
@@ -921,28 +786,6 @@ void GFGbl::processTrackWithRep(Track* trk, const AbsTrackRep* rep, bool resortH
         if (!listOfPoints.at(p).hasMeasurement())
           continue;
         
-        #ifdef OUTPUT
-        // Decode VxdId and get layer in TB setup
-        unsigned int l = 0;
-        unsigned int id = listOfLayers.at(p);
-        // skip segment (5 bits)
-        id = id >> 5;
-        unsigned int sensor = id & 7;
-        id = id >> 3;
-        unsigned int ladder = id & 31;
-        id = id >> 5;
-        unsigned int layer = id & 7;
-        
-        if (layer == 7 && ladder == 2) {
-          l = sensor;
-        } else if (layer == 7 && ladder == 3) {
-          l = sensor + 9 - 3;
-        } else {
-          l = layer + 3;
-        }
-        
-        hittedLayers[l - 1] = true;
-        #endif
         TVectorD localPar(5);
         TMatrixDSym localCov(5);
         traj->getResults(label, localPar, localCov);
@@ -951,119 +794,25 @@ void GFGbl::processTrackWithRep(Track* trk, const AbsTrackRep* rep, bool resortH
         if (m_chi2Cut && (fabs(residuals[0] / resErrors[0]) > m_chi2Cut || fabs(residuals[1] / resErrors[1]) > m_chi2Cut))
           return;
         // Write layer-wise data
-        #ifdef OUTPUT
-        if (!writeHistoDataForLabel(listOfLayers.at(p), residuals, measErrors, resErrors, downWeights, localPar, localCov))
-          return;
-        #endif
+        if (m_diagnostics) {
+          m_diagnostics->fillMeasurement(listOfLayers.at(p), residuals, measErrors, resErrors, downWeights, localPar);
+          measuredSensors.push_back(listOfLayers.at(p));
+        }
         
       } // end for points
       
       // Write binary data to mille binary
-      if (milleFile && m_milleFileName != "" && pvalue >= m_pValueCut && Ndf >= m_minNdf) {
-        traj->milleOut(*milleFile);
+      if (m_milleFile && m_milleFileName != "" && pvalue >= m_pValueCut && Ndf >= m_minNdf) {
+        traj->milleOut(*m_milleFile);
         #ifdef DEBUG
         cout << " GBL Track written to Millepede II binary file." << endl;
         cout << "-------------------------------------------------------" << endl;
         #endif
       }
       
-      #ifdef OUTPUT
-      // Fill histograms
-      chi2OndfHisto->Fill(Chi2 / Ndf);
-      pValueHisto->Fill(TMath::Prob(Chi2, Ndf));
-      // track counting
-      stats->Fill(0);
-      // hitted sensors statistics
-      if (
-        hittedLayers[0] &&
-        hittedLayers[1] &&
-        hittedLayers[2] &&
-        hittedLayers[3] &&
-        hittedLayers[4] &&
-        hittedLayers[5] &&
-        hittedLayers[6] &&
-        hittedLayers[7] &&
-        hittedLayers[8]
-      ) {
-        // front tel + pxd + svd
-        stats->Fill(1);
-      }
-      
-      if (
-        hittedLayers[0] &&
-        hittedLayers[1] &&
-        hittedLayers[2] &&
-        hittedLayers[3] &&
-        hittedLayers[4] &&
-        hittedLayers[5] &&
-        hittedLayers[6] &&
-        hittedLayers[7] &&
-        hittedLayers[8] &&
-        hittedLayers[9] &&
-        hittedLayers[10] &&
-        hittedLayers[11]
-      ) {
-        // all layers
-        stats->Fill(2);
-      }
-      if (
-        hittedLayers[3] &&
-        hittedLayers[4] &&
-        hittedLayers[5] &&
-        hittedLayers[6] &&
-        hittedLayers[7] &&
-        hittedLayers[8]
-      ) {
-        // vxd
-        stats->Fill(3);
-      }
-      if (
-        hittedLayers[5] &&
-        hittedLayers[6] &&
-        hittedLayers[7] &&
-        hittedLayers[8]
-      ) {
-        // svd
-        stats->Fill(4);
-      }
-      if (
-        hittedLayers[0] &&
-        hittedLayers[1] &&
-        hittedLayers[2] &&
-        
-        hittedLayers[5] &&
-        hittedLayers[6] &&
-        hittedLayers[7] &&
-        hittedLayers[8] &&
-        hittedLayers[9] &&
-        hittedLayers[10] &&
-        hittedLayers[11]
-      ) {
-        // all except pxd
-        stats->Fill(5);
-      }
-      if (
-        hittedLayers[0] &&
-        hittedLayers[1] &&
-        hittedLayers[2] &&
-        
-        hittedLayers[5] &&
-        hittedLayers[6] &&
-        hittedLayers[7] &&
-        hittedLayers[8]
-      ) {
-        // front tel + svd
-        stats->Fill(6);
-      }
-      if (
-        hittedLayers[9] &&
-        hittedLayers[10] &&
-        hittedLayers[11]
-      ) {
-        // backward tel
-        stats->Fill(7);
-      }
-      #endif
+      // Fill track diagnostics
+      if (m_diagnostics)
+        m_diagnostics->fillTrack(Chi2, Ndf, measuredSensors);
     }
     
     // Free memory
@@ -0,0 +1,214 @@
+/* Copyright 2013
+ *   Authors: Sergey Yashchenko and Tadeas Bilka
+ *
+ *   This file is part of GENFIT.
+ *
+ *   GENFIT is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   GENFIT is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GFGblDiagnostics.h"
+
+#include <TFile.h>
+#include <TH1F.h>
+#include <TMath.h>
+
+#include <initializer_list>
+#include <sstream>
+
+namespace genfit {
+
+AtomicHistogram::AtomicHistogram(const std::string& name, const std::string& title, unsigned int nBins, double low, double high) :
+  name_(name), title_(title), nBins_(nBins), low_(low), high_(high), bins_(new std::atomic<unsigned int>[nBins + 2])
+{
+  for (unsigned int i = 0; i < nBins_ + 2; ++i)
+    bins_[i].store(0, std::memory_order_relaxed);
+}
+
+void AtomicHistogram::fill(double x)
+{
+  unsigned int bin;
+  if (x < low_)
+    bin = 0;
+  else if (!(x < high_))
+    bin = nBins_ + 1;
+  else
+    bin = 1 + static_cast<unsigned int>((x - low_) / (high_ - low_) * nBins_);
+  if (bin > nBins_ + 1)
+    bin = nBins_ + 1;
+  bins_[bin].fetch_add(1, std::memory_order_relaxed);
+}
+
+unsigned int AtomicHistogram::getEntries() const
+{
+  unsigned int entries = 0;
+  for (unsigned int i = 0; i < nBins_ + 2; ++i)
+    entries += getBinContent(i);
+  return entries;
+}
+
+TH1* AtomicHistogram::createRootHistogram() const
+{
+  TH1F* histogram = new TH1F(name_.c_str(), title_.c_str(), nBins_, low_, high_);
+  for (unsigned int i = 0; i < nBins_ + 2; ++i)
+    histogram->SetBinContent(i, getBinContent(i));
+  histogram->SetEntries(getEntries());
+  return histogram;
+}
+
+
+GFGblHistograms::GFGblHistograms() :
+  layerHistograms_(),
+  fitResHisto_("fit_result", "GBL Fit Result", 21, -1, 20),
+  ndfHisto_("ndf", "GBL Track NDF", 41, -1, 40),
+  chi2OndfHisto_("chi2_ndf", "Track Chi2/NDF", 100, 0., 10.),
+  pValueHisto_("p_value", "Track P-value", 100, 0., 1.),
+  stats_("stats", "0: NDF>0 | 1: fTel&VXD | 2: all | 3: VXD | 4: SVD | 5: all - PXD | 6: fTel&SVD | 7: bTel", 10, 0, 10)
+{
+  const char* names[nLayerHistograms] = {"res_u_", "res_v_", "meas_pull_u_", "meas_pull_v_", "pull_u_", "pull_v_",
+                                         "downWeights_u_", "downWeights_v_",
+                                         "localPar1_", "localPar2_", "localPar3_", "localPar4_", "localPar5_"};
+  const char* titles[nLayerHistograms] = {"Residual (U)", "Residual (V)", "Res/Meas.Err. (U)", "Res/Meas.Err. (V)",
+                                          "Res/Res.Err. (U)", "Res/Res.Err. (V)", "Down-weights (U)", "Down-weights (V)",
+                                          "Residual (U)", "Residual (U)", "Residual (U)", "Residual (U)", "Residual (U)"};
+  const double ranges[nLayerHistograms][2] = {{-0.1, 0.1}, {-0.1, 0.1}, {-20., 20.}, {-20., 20.}, {-20., 20.}, {-20., 20.},
+                                              {0., 1.}, {0., 1.},
+                                              {-0.1, 0.1}, {-0.1, 0.1}, {-0.1, 0.1}, {-0.1, 0.1}, {-0.1, 0.1}};
+  layerHistograms_.reserve(nLayers * nLayerHistograms);
+  for (unsigned int layer = 1; layer <= nLayers; ++layer) {
+    for (unsigned int i = 0; i < nLayerHistograms; ++i) {
+      std::ostringstream name;
+      name << names[i] << layer;
+      layerHistograms_.emplace_back(new AtomicHistogram(name.str(), titles[i], 1000, ranges[i][0], ranges[i][1]));
+    }
+  }
+}
+
+void GFGblHistograms::fillFitResult(int fitRes, int ndf)
+{
+  fitResHisto_.fill(fitRes);
+  ndfHisto_.fill(ndf);
+}
+
+void GFGblHistograms::fillMeasurement(unsigned int sensorId, const TVectorD& residuals, const TVectorD& measErrors,
+                                      const TVectorD& resErrors, const TVectorD& downWeights, const TVectorD& localPar)
+{
+  unsigned int layer = layerOfSensor(sensorId);
+  if (!layer)
+    return;
+
+  layerHistogram(layer, resU).fill(residuals[0]);
+  layerHistogram(layer, resV).fill(residuals[1]);
+  layerHistogram(layer, measPullU).fill(residuals[0] / measErrors[0]);
+  layerHistogram(layer, measPullV).fill(residuals[1] / measErrors[1]);
+  layerHistogram(layer, pullU).fill(residuals[0] / resErrors[0]);
+  layerHistogram(layer, pullV).fill(residuals[1] / resErrors[1]);
+  layerHistogram(layer, downWeightU).fill(downWeights[0]);
+  layerHistogram(layer, downWeightV).fill(downWeights[1]);
+  layerHistogram(layer, localPar1).fill(localPar(0));
+  layerHistogram(layer, localPar2).fill(localPar(1));
+  layerHistogram(layer, localPar3).fill(localPar(2));
+  layerHistogram(layer, localPar4).fill(localPar(3));
+  layerHistogram(layer, localPar5).fill(localPar(4));
+}
+
+void GFGblHistograms::fillTrack(double chi2, int ndf, const std::vector<unsigned int>& sensorIds)
+{
+  if (ndf > 0) {
+    chi2OndfHisto_.fill(chi2 / ndf);
+    pValueHisto_.fill(TMath::Prob(chi2, ndf));
+  }
+  // track counting
+  stats_.fill(0);
+
+  bool hittedLayers[nLayers + 1] = {false};
+  for (unsigned int i = 0; i < sensorIds.size(); ++i)
+    hittedLayers[layerOfSensor(sensorIds[i])] = true;
+  // hitted sensors statistics: first and last layer of groups
+  // (front telescope 1-3, PXD 4-5, SVD 6-9, backward telescope 10-12)
+  struct LayerRange {unsigned int first, last;};
+  auto allHitted = [&hittedLayers](std::initializer_list<LayerRange> ranges) {
+    for (const LayerRange& range : ranges)
+      for (unsigned int layer = range.first; layer <= range.last; ++layer)
+        if (!hittedLayers[layer])
+          return false;
+    return true;
+  };
+  // front tel + pxd + svd
+  if (allHitted({{1, 9}}))
+    stats_.fill(1);
+  // all layers
+  if (allHitted({{1, 12}}))
+    stats_.fill(2);
+  // vxd
+  if (allHitted({{4, 9}}))
+    stats_.fill(3);
+  // svd
+  if (allHitted({{6, 9}}))
+    stats_.fill(4);
+  // all except pxd
+  if (allHitted({{1, 3}, {6, 12}}))
+    stats_.fill(5);
+  // front tel + svd
+  if (allHitted({{1, 3}, {6, 9}}))
+    stats_.fill(6);
+  // backward tel
+  if (allHitted({{10, 12}}))
+    stats_.fill(7);
+}
+
+void GFGblHistograms::write(const std::string& rootFileName) const
+{
+  TFile diag(rootFileName.c_str(), "RECREATE");
+  for (unsigned int i = 0; i < layerHistograms_.size(); ++i)
+    layerHistograms_[i]->createRootHistogram();
+  fitResHisto_.createRootHistogram();
+  ndfHisto_.createRootHistogram();
+  chi2OndfHisto_.createRootHistogram();
+  pValueHisto_.createRootHistogram();
+  stats_.createRootHistogram();
+  // histograms are owned (and deleted) by the file
+  diag.Write();
+  diag.Close();
+}
+
+unsigned int GFGblHistograms::layerOfSensor(unsigned int sensorId)
+{
+  if (sensorId < 1)
+    return 0;
+
+  // Decode VxdId and get layer in TB setup
+  unsigned int id = sensorId;
+  // skip segment (5 bits)
+  id = id >> 5;
+  unsigned int sensor = id & 7;
+  id = id >> 3;
+  unsigned int ladder = id & 31;
+  id = id >> 5;
+  unsigned int layer = id & 7;
+
+  unsigned int label = 0;
+  if (layer == 7 && ladder == 2) {
+    label = sensor;
+  } else if (layer == 7 && ladder == 3) {
+    label = sensor + 9 - 3;
+  } else {
+    label = layer + 3;
+  }
+
+  if (label < 1 || label > nLayers)
+    return 0;
+  return label;
+}
+
+}  /* End of namespace genfit */
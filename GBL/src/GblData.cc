@@ -35,18 +35,41 @@ namespace gbl {
 /// Create data block.
 /**
  * \param [in] aLabel Label of corresponding point
+ * \param [in] aType Type of (scalar) measurement
  * \param [in] aValue Value of (scalar) measurement
  * \param [in] aPrec Precision of (scalar) measurement
+ * \param [in] aTraj Trajectory number
+ * \param [in] aPoint Point number
  */
-GblData::GblData(unsigned int aLabel, double aValue, double aPrec) :
-		theLabel(aLabel), theValue(aValue), thePrecision(aPrec), theDownWeight(
-				1.), thePrediction(0.), theParameters(), theDerivatives(), globalLabels(), globalDerivatives() {
+GblData::GblData(unsigned int aLabel, dataBlockType aType, double aValue,
+		double aPrec, unsigned int aTraj, unsigned int aPoint) :
+		theType(aType), theLabel(aLabel), theRow(0), theTraj(aTraj), thePoint(
+				aPoint), theValue(aValue), thePrecision(aPrec), theDownWeight(
+				1.), thePrediction(0.), theNumParameters(0), moreParameters(), moreDerivatives() {
 
 }
 
 GblData::~GblData() {
 }
 
+/// Add (non-zero) derivative to data block.
+/**
+ * Uses the fixed size lists unless the (heap allocated) lists have been reserved.
+ * \param [in] aParameter Label of fit parameter
+ * \param [in] aDerivative Derivative
+ */
+inline void GblData::addParameter(unsigned int aParameter,
+		double aDerivative) {
+	if (moreParameters.capacity()) {
+		moreParameters.push_back(aParameter);
+		moreDerivatives.push_back(aDerivative);
+	} else {
+		theParameters[theNumParameters] = aParameter;
+		theDerivatives[theNumParameters] = aDerivative;
+		++theNumParameters;
+	}
+}
+
 /// Add derivatives from measurement.
 /**
  * Add (non-zero) derivatives to data block. Fill list of labels of used fit parameters.
@@ -55,48 +78,41 @@ GblData::~GblData() {
  * \param [in] matDer Derivatives (matrix) 'measurement vs track fit parameters'
  * \param [in] iOff Offset for row index for additional parameters
  * \param [in] derLocal Derivatives (matrix) for additional local parameters
- * \param [in] labGlobal Labels for additional global (MP-II) parameters
- * \param [in] derGlobal Derivatives (matrix) for additional global (MP-II) parameters
  * \param [in] extOff Offset for external parameters
  * \param [in] extDer Derivatives for external Parameters
  */
 void GblData::addDerivatives(unsigned int iRow,
-		const std::vector<unsigned int> &labDer, const SMatrix55 &matDer,
-		unsigned int iOff, const TMatrixD &derLocal,
-		const std::vector<int> &labGlobal, const TMatrixD &derGlobal,
-		unsigned int extOff, const TMatrixD &extDer) {
+		const std::array<unsigned int, 5> &labDer, const Matrix5x5 &matDer,
+		unsigned int iOff, const MatrixDynamic &derLocal, unsigned int extOff,
+		const MatrixDynamic &extDer) {
 
-	unsigned int nParMax = 5 + derLocal.GetNcols() + extDer.GetNcols();
-	theParameters.reserve(nParMax); // have to be sorted
-	theDerivatives.reserve(nParMax);
+	theRow = iRow - iOff;
+	unsigned int nParMax = 5 + derLocal.cols() + extDer.cols();
+	if (nParMax > 7) {
+		moreParameters.reserve(nParMax); // have to be sorted
+		moreDerivatives.reserve(nParMax);
+	}
 
-	for (int i = 0; i < derLocal.GetNcols(); ++i) // local derivatives
+	for (int i = 0; i < derLocal.cols(); ++i) // local derivatives
 			{
-		if (derLocal(iRow - iOff, i)) {
-			theParameters.push_back(i + 1);
-			theDerivatives.push_back(derLocal(iRow - iOff, i));
+		if (derLocal(theRow, i)) {
+			addParameter(i + 1, derLocal(theRow, i));
 		}
 	}
 
-	for (int i = 0; i < extDer.GetNcols(); ++i) // external derivatives
+	for (int i = 0; i < extDer.cols(); ++i) // external derivatives
 			{
-		if (extDer(iRow - iOff, i)) {
-			theParameters.push_back(extOff + i + 1);
-			theDerivatives.push_back(extDer(iRow - iOff, i));
+		if (extDer(theRow, i)) {
+			addParameter(extOff + i + 1, extDer(theRow, i));
 		}
 	}
 
 	for (unsigned int i = 0; i < 5; ++i) // curvature, offset derivatives
 			{
 		if (labDer[i] and matDer(iRow, i)) {
-			theParameters.push_back(labDer[i]);
-			theDerivatives.push_back(matDer(iRow, i));
+			addParameter(labDer[i], matDer(iRow, i));
 		}
 	}
-
-	globalLabels = labGlobal;
-	for (int i = 0; i < derGlobal.GetNcols(); ++i) // global derivatives
-		globalDerivatives.push_back(derGlobal(iRow - iOff, i));
 }
 
 /// Add derivatives from kink.
@@ -109,26 +125,27 @@ void GblData::addDerivatives(unsigned int iRow,
  * \param [in] extDer Derivatives for external Parameters
  */
 void GblData::addDerivatives(unsigned int iRow,
-		const std::vector<unsigned int> &labDer, const SMatrix27 &matDer,
-		unsigned int extOff, const TMatrixD &extDer) {
+		const std::array<unsigned int, 7> &labDer, const Matrix2x7 &matDer,
+		unsigned int extOff, const MatrixDynamic &extDer) {
 
-	unsigned int nParMax = 7 + extDer.GetNcols();
-	theParameters.reserve(nParMax); // have to be sorted
-	theDerivatives.reserve(nParMax);
+	theRow = iRow;
+	unsigned int nParMax = 7 + extDer.cols();
+	if (nParMax > 7) {
+		moreParameters.reserve(nParMax); // have to be sorted
+		moreDerivatives.reserve(nParMax);
+	}
 
-	for (int i = 0; i < extDer.GetNcols(); ++i) // external derivatives
+	for (int i = 0; i < extDer.cols(); ++i) // external derivatives
 			{
 		if (extDer(iRow, i)) {
-			theParameters.push_back(extOff + i + 1);
-			theDerivatives.push_back(extDer(iRow, i));
+			addParameter(extOff + i + 1, extDer(iRow, i));
 		}
 	}
 
 	for (unsigned int i = 0; i < 7; ++i) // curvature, offset derivatives
 			{
 		if (labDer[i] and matDer(iRow, i)) {
-			theParameters.push_back(labDer[i]);
-			theDerivatives.push_back(matDer(iRow, i));
+			addParameter(labDer[i], matDer(iRow, i));
 		}
 	}
 }
@@ -136,118 +153,97 @@ void GblData::addDerivatives(unsigned int iRow,
 /// Add derivatives from external seed.
 /**
  * Add (non-zero) derivatives to data block. Fill list of labels of used fit parameters.
+ * \param [in] nDer Number of derivatives
  * \param [in] index Labels for derivatives
  * \param [in] derivatives Derivatives (vector)
  */
-void GblData::addDerivatives(const std::vector<unsigned int> &index,
-		const std::vector<double> &derivatives) {
-	for (unsigned int i = 0; i < derivatives.size(); ++i) // any derivatives
-			{
-		if (derivatives[i]) {
-			theParameters.push_back(index[i]);
-			theDerivatives.push_back(derivatives[i]);
-		}
+void GblData::addDerivatives(unsigned int nDer, const unsigned int* index,
+		const double* derivatives) {
+	if (nDer > 7) {
+		moreParameters.reserve(nDer); // have to be sorted
+		moreDerivatives.reserve(nDer);
 	}
-}
-
-/// Calculate prediction for data from fit (by GblTrajectory::fit).
-void GblData::setPrediction(const VVector &aVector) {
-
-	thePrediction = 0.;
-	for (unsigned int i = 0; i < theDerivatives.size(); ++i) {
-		thePrediction += theDerivatives[i] * aVector(theParameters[i] - 1);
-	}
-}
-
-/// Outlier down weighting with M-estimators (by GblTrajectory::fit).
-/**
- * \param [in] aMethod M-estimator (1: Tukey, 2:Huber, 3:Cauchy)
- */
-double GblData::setDownWeighting(unsigned int aMethod) {
-
-	double aWeight = 1.;
-	double scaledResidual = fabs(theValue - thePrediction) * sqrt(thePrecision);
-	if (aMethod == 1) // Tukey
-			{
-		if (scaledResidual < 4.6851) {
-			aWeight = (1.0 - 0.045558 * scaledResidual * scaledResidual);
-			aWeight *= aWeight;
-		} else {
-			aWeight = 0.;
-		}
-	} else if (aMethod == 2) //Huber
+	for (unsigned int i = 0; i < nDer; ++i) // any derivatives
 			{
-		if (scaledResidual >= 1.345) {
-			aWeight = 1.345 / scaledResidual;
+		if (derivatives[i]) {
+			addParameter(index[i], derivatives[i]);
 		}
-	} else if (aMethod == 3) //Cauchy
-			{
-		aWeight = 1.0 / (1.0 + (scaledResidual * scaledResidual / 5.6877));
 	}
-	theDownWeight = aWeight;
-	return aWeight;
-}
-
-/// Calculate Chi2 contribution.
-/**
- * \return (down-weighted) Chi2
- */
-double GblData::getChi2() const {
-	double aDiff = theValue - thePrediction;
-	return aDiff * aDiff * thePrecision * theDownWeight;
 }
 
 /// Print data block.
 void GblData::printData() const {
 
+	unsigned int numLocal;
+	const unsigned int* indLocal;
+	const double* derLocal;
+	double aValue, aWeight;
+	getLocalData(aValue, aWeight, numLocal, indLocal, derLocal);
 	std::cout << " measurement at label " << theLabel << ": " << theValue
 			<< ", " << thePrecision << std::endl;
-	std::cout << "  param " << theParameters.size() << ":";
-	for (unsigned int i = 0; i < theParameters.size(); ++i) {
-		std::cout << " " << theParameters[i];
+	std::cout << "  param " << numLocal << ":";
+	for (unsigned int i = 0; i < numLocal; ++i) {
+		std::cout << " " << indLocal[i];
 	}
 	std::cout << std::endl;
-	std::cout << "  deriv " << theDerivatives.size() << ":";
-	for (unsigned int i = 0; i < theDerivatives.size(); ++i) {
-		std::cout << " " << theDerivatives[i];
+	std::cout << "  deriv " << numLocal << ":";
+	for (unsigned int i = 0; i < numLocal; ++i) {
+		std::cout << " " << derLocal[i];
 	}
 	std::cout << std::endl;
 }
 
+/// Get type.
+dataBlockType GblData::getType() const {
+	return theType;
+}
+
 /// Get Data for local fit.
 /**
  * \param [out] aValue Value
  * \param [out] aWeight Weight
- * \param [out] indLocal List of labels of used (local) fit parameters
- * \param [out] derLocal List of derivatives for used (local) fit parameters
+ * \param [out] numLocal Number of local labels/derivatives
+ * \param [out] indLocal Array of labels of used (local) fit parameters
+ * \param [out] derLocal Array of derivatives for used (local) fit parameters
  */
 void GblData::getLocalData(double &aValue, double &aWeight,
-		std::vector<unsigned int>* &indLocal, std::vector<double>* &derLocal) {
+		unsigned int &numLocal, const unsigned int* &indLocal,
+		const double* &derLocal) const {
 
 	aValue = theValue;
 	aWeight = thePrecision * theDownWeight;
-	indLocal = &theParameters;
-	derLocal = &theDerivatives;
+	if (not moreParameters.empty()) {
+		numLocal = moreParameters.size();
+		indLocal = moreParameters.data();
+		derLocal = moreDerivatives.data();
+	} else {
+		numLocal = theNumParameters;
+		indLocal = theParameters;
+		derLocal = theDerivatives;
+	}
 }
 
 /// Get all Data for MP-II binary record.
 /**
+ * Global derivatives are to be retrieved from the point (for internal measurements).
  * \param [out] aValue Value
  * \param [out] aErr Error
- * \param [out] indLocal List of labels of local parameters
- * \param [out] derLocal List of derivatives for local parameters
- * \param [out] labGlobal List of labels of global parameters
- * \param [out] derGlobal List of derivatives for global parameters
+ * \param [out] numLocal Number of local labels/derivatives
+ * \param [out] indLocal Array of labels of local parameters
+ * \param [out] derLocal Array of derivatives for local parameters
+ * \param [out] aTraj Trajectory number
+ * \param [out] aPoint Point number
+ * \param [out] aRow Row number
  */
-void GblData::getAllData(double &aValue, double &aErr,
-		std::vector<unsigned int>* &indLocal, std::vector<double>* &derLocal,
-		std::vector<int>* &labGlobal, std::vector<double>* &derGlobal) {
-	aValue = theValue;
+void GblData::getAllData(double &aValue, double &aErr, unsigned int &numLocal,
+		const unsigned int* &indLocal, const double* &derLocal,
+		unsigned int &aTraj, unsigned int &aPoint, unsigned int &aRow) const {
+	double aWeight;
+	getLocalData(aValue, aWeight, numLocal, indLocal, derLocal);
 	aErr = 1.0 / sqrt(thePrecision);
-	indLocal = &theParameters;
-	derLocal = &theDerivatives;
-	labGlobal = &globalLabels;
-	derGlobal = &globalDerivatives;
+	aTraj = theTraj;
+	aPoint = thePoint;
+	aRow = theRow;
 }
 
 /// Get data for residual (and errors).
@@ -255,16 +251,166 @@ void GblData::getAllData(double &aValue, double &aErr,
  * \param [out] aResidual Measurement-Prediction
  * \param [out] aVariance Variance (of measurement)
  * \param [out] aDownWeight Down-weighting factor
- * \param [out] indLocal List of labels of used (local) fit parameters
- * \param [out] derLocal List of derivatives for used (local) fit parameters
+ * \param [out] numLocal Number of local labels/derivatives
+ * \param [out] indLocal Array of labels of used (local) fit parameters
+ * \param [out] derLocal Array of derivatives for used (local) fit parameters
  */
 void GblData::getResidual(double &aResidual, double &aVariance,
-		double &aDownWeight, std::vector<unsigned int>* &indLocal,
-		std::vector<double>* &derLocal) {
+		double &aDownWeight, unsigned int &numLocal,
+		const unsigned int* &indLocal, const double* &derLocal) const {
+	double aValue, aWeight;
+	getLocalData(aValue, aWeight, numLocal, indLocal, derLocal);
 	aResidual = theValue - thePrediction;
 	aVariance = 1.0 / thePrecision;
 	aDownWeight = theDownWeight;
-	indLocal = &theParameters;
-	derLocal = &theDerivatives;
+}
+
+GblDataBlocks::GblDataBlocks() :
+		theValues(), thePrecisions(), theDownWeights(), thePredictions(), workScaledResiduals(), theOffsets(
+				1, 0), theParameters(), theDerivatives() {
+}
+
+GblDataBlocks::~GblDataBlocks() {
+}
+
+/// Fill data blocks (storage is reused).
+/**
+ * \param [in] aDataList List of data blocks
+ */
+void GblDataBlocks::assign(const std::vector<GblData> &aDataList) {
+	const unsigned int nData = aDataList.size();
+	theValues.resize(nData);
+	thePrecisions.resize(nData);
+	theDownWeights.resize(nData);
+	thePredictions.setZero(nData);
+	theOffsets.resize(nData + 1);
+	theParameters.clear();
+	theDerivatives.clear();
+	theOffsets[0] = 0;
+	for (unsigned int i = 0; i < nData; ++i) {
+		const GblData &aData = aDataList[i];
+		double aValue, aWeight;
+		unsigned int numLocal;
+		const unsigned int* indLocal;
+		const double* derLocal;
+		aData.getLocalData(aValue, aWeight, numLocal, indLocal, derLocal);
+		theValues(i) = aValue;
+		thePrecisions(i) = aData.thePrecision;
+		theDownWeights(i) = aData.theDownWeight;
+		theParameters.insert(theParameters.end(), indLocal,
+				indLocal + numLocal);
+		theDerivatives.insert(theDerivatives.end(), derLocal,
+				derLocal + numLocal);
+		theOffsets[i + 1] = theParameters.size();
+	}
+}
+
+/// Get number of data blocks.
+unsigned int GblDataBlocks::getNumData() const {
+	return theValues.size();
+}
+
+/// Calculate predictions for all data blocks from fit (by GblTrajectory::fit).
+/**
+ * \param [in] aVector Fit parameters
+ */
+void GblDataBlocks::predict(const VectorDynamic &aVector) {
+	const unsigned int nData = theValues.size();
+	const double* fitPar = aVector.data() - 1; // labels of fit parameters start at 1
+	const unsigned int* indLocal = theParameters.data();
+	const double* derLocal = theDerivatives.data();
+	for (unsigned int i = 0; i < nData; ++i) {
+		double aPrediction = 0.;
+		for (unsigned int j = theOffsets[i]; j < theOffsets[i + 1]; ++j) {
+			aPrediction += derLocal[j] * fitPar[indLocal[j]];
+		}
+		thePredictions(i) = aPrediction;
+	}
+}
+
+/// Outlier down weighting of all data blocks with M-estimators (by GblTrajectory::fit).
+/**
+ * \param [in] aMethod M-estimator (1: Tukey, 2:Huber, 3:Cauchy)
+ * \return Sum of weights lost due to down-weighting
+ */
+double GblDataBlocks::downWeight(unsigned int aMethod) {
+	workScaledResiduals = (theValues - thePredictions).abs()
+			* thePrecisions.sqrt();
+	if (aMethod == 1) // Tukey
+			{
+		theDownWeights = (workScaledResiduals < 4.6851).select(
+				(1.0 - 0.045558 * workScaledResiduals.square()).square(), 0.);
+	} else if (aMethod == 2) //Huber
+			{
+		theDownWeights = (workScaledResiduals >= 1.345).select(
+				1.345 / workScaledResiduals, 1.);
+	} else if (aMethod == 3) //Cauchy
+			{
+		theDownWeights = 1.0
+				/ (1.0 + (workScaledResiduals.square() / 5.6877));
+	} else {
+		theDownWeights.setOnes();
+	}
+	return (1. - theDownWeights).sum();
+}
+
+/// Calculate Chi2 sum of all data blocks.
+/**
+ * \return (down-weighted) Chi2
+ */
+double GblDataBlocks::getChi2() const {
+	return ((theValues - thePredictions).square() * thePrecisions
+			* theDownWeights).sum();
+}
+
+/// Copy predictions and down-weighting factors to the data blocks (by GblTrajectory::fit).
+/**
+ * \param [in,out] aDataList List of data blocks (from which these blocks were assigned)
+ */
+void GblDataBlocks::copyResults(std::vector<GblData> &aDataList) const {
+	const unsigned int nData = theValues.size();
+	for (unsigned int i = 0; i < nData; ++i) {
+		aDataList[i].thePrediction = thePredictions(i);
+		aDataList[i].theDownWeight = theDownWeights(i);
+	}
+}
+
+/// Get Data for local fit.
+/**
+ * \param [in]  aData Index of data block
+ * \param [out] aValue Value
+ * \param [out] aWeight Weight
+ * \param [out] numLocal Number of local labels/derivatives
+ * \param [out] indLocal Array of labels of used (local) fit parameters
+ * \param [out] derLocal Array of derivatives for used (local) fit parameters
+ */
+void GblDataBlocks::getLocalData(unsigned int aData, double &aValue,
+		double &aWeight, unsigned int &numLocal, const unsigned int* &indLocal,
+		const double* &derLocal) const {
+	aValue = theValues(aData);
+	aWeight = thePrecisions(aData) * theDownWeights(aData);
+	numLocal = theOffsets[aData + 1] - theOffsets[aData];
+	indLocal = theParameters.data() + theOffsets[aData];
+	derLocal = theDerivatives.data() + theOffsets[aData];
+}
+
+/// Get data for residual (and errors).
+/**
+ * \param [in]  aData Index of data block
+ * \param [out] aResidual Measurement-Prediction
+ * \param [out] aVariance Variance (of measurement)
+ * \param [out] aDownWeight Down-weighting factor
+ * \param [out] numLocal Number of local labels/derivatives
+ * \param [out] indLocal Array of labels of used (local) fit parameters
+ * \param [out] derLocal Array of derivatives for used (local) fit parameters
+ */
+void GblDataBlocks::getResidual(unsigned int aData, double &aResidual,
+		double &aVariance, double &aDownWeight, unsigned int &numLocal,
+		const unsigned int* &indLocal, const double* &derLocal) const {
+	double aValue, aWeight;
+	getLocalData(aData, aValue, aWeight, numLocal, indLocal, derLocal);
+	aResidual = aValue - thePredictions(aData);
+	aVariance = 1.0 / thePrecisions(aData);
+	aDownWeight = theDownWeights(aData);
 }
 }
@@ -64,7 +64,11 @@
 #include "ICalibrationParametersDerivatives.h"
 
 #include "Track.h"
+#include "Exception.h"
+#include "IO.h"
 #include <TFile.h>
+#include <TROOT.h>
+#include <RVersion.h>
 #include <TH1F.h>
 #include <TTree.h>
 #include <string>
@@ -74,10 +78,17 @@
 #include <HMatrixV.h>
 #include <Math/SMatrix.h>
 #include <TMatrixD.h>
+#include <TDecompLU.h>
 #include <TVectorDfwd.h>
 #include <TMatrixT.h>
 #include <TVector3.h>
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <utility>
+
 //#define DEBUG
 
 using namespace gbl;
@@ -105,11 +116,6 @@ void GblFitter::setTrackSegmentController(GblTrackSegmentController* controler)
 
 void GblFitter::processTrackWithRep(Track* trk, const AbsTrackRep* rep, bool resortHits)
 {
-  cleanGblInfo(trk, rep);
-  
-  if (resortHits)
-    sortHits(trk, rep);
-  
   // This flag enables/disables fitting of q/p parameter in GBL
   // It is switched off automatically if no B-field at (0,0,0) is detected.
   bool fitQoverP = true;
@@ -121,11 +127,200 @@ void GblFitter::processTrackWithRep(Track* trk, const AbsTrackRep* rep, bool res
   int Ndf = 0;
   // Chi2 after fit
   double Chi2 = 0.;
-  //FIXME: d-w's not used so far...
-  double lostWeight = 0.;  
 
   // Preparation of points (+add reference states) for GBL fit
   // -----------------------------------------------------------------
+  genfit::GblFitStatus* gblfs = prepareTrack(trk, rep, resortHits, fitQoverP);
+  if (m_externalIterations < 1)
+    return;
+  // -----------------------------------------------------------------
+  
+  // Iterations and updates of fitter infos and fit status
+  // ------------------------------------------------------------------- 
+  for (unsigned int iIter = 0; iIter < m_externalIterations; iIter++) {
+    // GBL refit (1st of reference, then refit of GBL trajectory itself)
+    // point list and trajectory are reused (keep their storage) for all iterations and tracks
+    unsigned int nmeas = 0;
+    int fitRes = fitIteration(trk, rep, gblfs->hasCurvature(), iIter, m_points, m_trajectory, m_labelBuffer, Chi2, Ndf, nmeas);
+    
+    // This repropagates to get new Jacobians,
+    // if planes changed, predictions are extrapolated to new planes
+    if (m_recalcJacobians > iIter)
+      recalculateJacobians(trk, rep);
+    
+    setFitStatus(gblfs, trk, iIter, fitRes, Chi2, Ndf, nmeas);
+  }  
+  // -------------------------------------------------------------------
+
+}
+
+namespace {
+  // Work space of one thread in GblFitter::processTracks
+  struct GblWorkSpace {
+    std::vector<gbl::GblPoint> points;
+    gbl::GblTrajectory trajectory;
+    std::vector<int> labelBuffer;
+  };
+
+  // Status and results of one track in GblFitter::processTracks
+  struct GblTrackResult {
+    GblTrackResult() : status(nullptr), fitRes(0), Chi2(0.), Ndf(0), nMeas(0), failed(false), error() {}
+    GblFitStatus* status;
+    int fitRes;
+    double Chi2;
+    int Ndf;
+    unsigned int nMeas;
+    bool failed;
+    std::string error;
+  };
+
+  // Fill the label caches of all calibration measurements of a track
+  void prepareCalibrationLabels(const Track* trk) {
+    for (unsigned int ip = 0; ip < trk->getNumPoints(); ip++) {
+      const TrackPoint* point = trk->getPoint(ip);
+      for (unsigned int im = 0; im < point->getNumRawMeasurements(); im++) {
+        ICalibrationParametersDerivatives* globals = dynamic_cast<ICalibrationParametersDerivatives*>(point->getRawMeasurement(im));
+        if (globals)
+          globals->prepareCalibrationLabels();
+      }
+    }
+  }
+}
+
+void GblFitter::processTracks(const std::vector<Track*>& tracks, unsigned int nThreads, gbl::MilleBinary* milleFile, bool resortHits,
+                              gbl::MilleAccumulator* accumulator)
+{
+  if (tracks.empty())
+    return;
+  
+  // see processTrackWithRep
+  bool fitQoverP = true;
+  double Bfield = genfit::FieldManager::getInstance()->getFieldVal(TVector3(0., 0., 0.)).Mag();
+  if (!(Bfield > 1.e-16))
+    fitQoverP = false;
+  
+  if (nThreads == 0)
+    nThreads = std::max(1u, std::thread::hardware_concurrency());
+  nThreads = std::min<unsigned int>(nThreads, tracks.size());
+  #if ROOT_VERSION_CODE >= ROOT_VERSION(6,0,0)
+  if (nThreads > 1)
+    ROOT::EnableThreadSafety();
+  #endif
+  
+  // Extrapolation (propagation of seeds) is done track by track: 
+  // field, material effects and track representations are not thread safe
+  std::vector<GblTrackResult> results(tracks.size());
+  for (unsigned int itrk = 0; itrk < tracks.size(); itrk++) {
+    const AbsTrackRep* rep = tracks[itrk]->getCardinalRep();
+    try {
+      results[itrk].status = prepareTrack(tracks[itrk], rep, resortHits, fitQoverP);
+      // label caches are only read in the parallel section
+      prepareCalibrationLabels(tracks[itrk]);
+    } catch (genfit::Exception& e) {
+      errorOut << e.what();
+      results[itrk].failed = true;
+    }
+  }
+  if (m_externalIterations < 1)
+    return;
+  
+  // Records for Millepede-II, written (accumulated) in order of tracks at the end
+  const bool milleOutput = (milleFile || accumulator);
+  std::vector<gbl::MilleRecord> records;
+  if (milleOutput)
+    records.assign(tracks.size(), gbl::MilleRecord(milleFile ? milleFile->isDoublePrecision() : true, 0));
+  
+  std::vector<GblWorkSpace> workSpaces(nThreads);
+  for (unsigned int iIter = 0; iIter < m_externalIterations; iIter++) {
+    const bool lastIter = (iIter == m_externalIterations - 1);
+    
+    // Fit of trajectories and update of fitter infos in parallel,
+    // each track is taken by exactly one thread
+    std::atomic<unsigned int> nextTrack(0);
+    auto worker = [&](GblWorkSpace& ws) {
+      unsigned int itrk;
+      while ((itrk = nextTrack++) < tracks.size()) {
+        GblTrackResult& result = results[itrk];
+        if (result.failed)
+          continue;
+        try {
+          result.fitRes = fitIteration(tracks[itrk], tracks[itrk]->getCardinalRep(), result.status->hasCurvature(), iIter,
+                                       ws.points, ws.trajectory, ws.labelBuffer, result.Chi2, result.Ndf, result.nMeas);
+          if (lastIter && milleOutput)
+            ws.trajectory.milleOut(records[itrk]);
+        } catch (genfit::Exception& e) {
+          result.failed = true;
+          result.error = e.what();
+        }
+      }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned int ithr = 1; ithr < nThreads; ithr++)
+      threads.emplace_back(worker, std::ref(workSpaces[ithr]));
+    worker(workSpaces[0]);
+    for (auto& thread : threads)
+      thread.join();
+    
+    // Re-propagation and fit status, track by track
+    for (unsigned int itrk = 0; itrk < tracks.size(); itrk++) {
+      GblTrackResult& result = results[itrk];
+      if (!result.error.empty()) {
+        errorOut << result.error;
+        result.error.clear();
+      }
+      if (result.failed)
+        continue;
+      const AbsTrackRep* rep = tracks[itrk]->getCardinalRep();
+      try {
+        if (m_recalcJacobians > iIter)
+          recalculateJacobians(tracks[itrk], rep);
+      } catch (genfit::Exception& e) {
+        errorOut << e.what();
+        result.failed = true;
+        continue;
+      }
+      setFitStatus(result.status, tracks[itrk], iIter, result.fitRes, result.Chi2, result.Ndf, result.nMeas);
+    }
+  }
+  
+  if (milleFile) {
+    for (unsigned int itrk = 0; itrk < tracks.size(); itrk++) {
+      if (!results[itrk].failed && !records[itrk].isEmpty())
+        milleFile->writeRecord(records[itrk]);
+    }
+  }
+  
+  if (accumulator) {
+    // local fits and elimination in parallel. Each thread sums a fixed contiguous range of tracks,
+    // and the partial sums are merged in order of threads, so the result does not depend on
+    // thread timing (only on the number of threads).
+    std::vector<gbl::MilleAccumulator> partialSums(nThreads);
+    auto worker = [&](unsigned int ithr) {
+      const unsigned int begin = tracks.size() * ithr / nThreads;
+      const unsigned int end = tracks.size() * (ithr + 1) / nThreads;
+      for (unsigned int itrk = begin; itrk < end; itrk++) {
+        if (!results[itrk].failed)
+          partialSums[ithr].addRecord(records[itrk]);
+      }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned int ithr = 1; ithr < nThreads; ithr++)
+      threads.emplace_back(worker, ithr);
+    worker(0);
+    for (auto& thread : threads)
+      thread.join();
+    for (unsigned int ithr = 0; ithr < nThreads; ithr++)
+      accumulator->merge(partialSums[ithr]);
+  }
+}
+
+GblFitStatus* GblFitter::prepareTrack(Track* trk, const AbsTrackRep* rep, bool resortHits, bool fitQoverP)
+{
+  cleanGblInfo(trk, rep);
+  
+  if (resortHits)
+    sortHits(trk, rep);
+  
   genfit::GblFitStatus* gblfs = new genfit::GblFitStatus();
   trk->setFitStatus(gblfs, rep);
   gblfs->setCurvature(fitQoverP);
@@ -143,90 +338,87 @@ void GblFitter::processTrackWithRep(Track* trk, const AbsTrackRep* rep, bool res
   //
   gblfs->setIsFittedWithReferenceTrack(true);
   gblfs->setNumIterations(0); //default value, still valid, No GBL iteration
-  if (m_externalIterations < 1)
-    return;
-  // -----------------------------------------------------------------
-  
+  return gblfs;
+}
 
-  unsigned int nFailed = 0;
-  int fitRes = 0;
-  std::vector<std::string> gblIterations;
-  gblIterations.push_back(m_gblInternalIterations);
+int GblFitter::fitIteration(Track* trk, const AbsTrackRep* rep, bool fitQoverP, unsigned int iIter,
+                            std::vector<gbl::GblPoint>& thePoints, gbl::GblTrajectory& traj, std::vector<int>& labelBuffer,
+                            double& Chi2, int& Ndf, unsigned int& nMeas)
+{
+  //FIXME: d-w's not used so far...
+  double lostWeight = 0.;  
+  int nscat = 0, ndummy = 0;
+  nMeas = 0;
+  collectGblPoints(trk, rep, thePoints, labelBuffer);
+  for(unsigned int ip = 0;ip<thePoints.size(); ip++) {
+    GblPoint & p = thePoints.at(ip);
+    if (p.hasScatterer())
+      nscat++;
+    if (p.hasMeasurement())
+      nMeas++;
+    if(!p.hasMeasurement()&&!p.hasScatterer())
+      ndummy++;
+  }
+  // swap the points into the trajectory, thePoints keeps the storage of the previous ones
+  traj.reset(std::move(thePoints), fitQoverP);
+  
+  int fitRes = traj.fit(Chi2, Ndf, lostWeight, (iIter == m_externalIterations - 1) ? m_gblInternalIterations : "");
+  
+  // Update fit results in fitterinfos
+  updateGblInfo(traj, trk, rep);
+  
+  #ifdef DEBUG
+  int npoints_meas = trk->getNumPointsWithMeasurement();  
+  int npoints_all = trk->getNumPoints();
+      
+  cout << "-------------------------------------------------------" << endl;
+  cout << "               GBL processed genfit::Track            " << endl;
+  cout << "-------------------------------------------------------" << endl;
+  cout << " # Track Points       :  " << npoints_all  << endl;
+  cout << " # Meas. Points       :  " << npoints_meas << endl;
+  cout << " # GBL points all     :  " << traj.getNumPoints();
+  if (ndummy)
+    cout << " (" << ndummy << " dummy) ";
+  cout << endl;
+  cout << " # GBL points meas    :  " << nMeas << endl;
+  cout << " # GBL points scat    :  " << nscat << endl;    
+  cout << "-------------- GBL Fit Results ----------- Iteration  " << iIter+1 << " " << ((iIter == m_externalIterations - 1) ? m_gblInternalIterations : "") << endl;
+  cout << " Fit q/p parameter    :  " << (fitQoverP ? ("True") : ("False")) << endl;
+  cout << " Valid trajectory     :  " << ((traj.isValid()) ? ("True") : ("False")) << endl;
+  cout << " Fit result           :  " << fitRes << "    (0 for success)" << endl;
+  cout << " GBL track NDF        :  " << Ndf << "    (-1 for failure)" << endl;
+  cout << " GBL track Chi2       :  " << Chi2 << endl;
+  cout << " GBL track P-value    :  " << TMath::Prob(Chi2, Ndf) << endl;
+  cout << "-------------------------------------------------------" << endl;
+  #endif
+  
+  return fitRes;
+}
 
-  // Iterations and updates of fitter infos and fit status
-  // ------------------------------------------------------------------- 
-  for (unsigned int iIter = 0; iIter < m_externalIterations; iIter++) {
-    // GBL refit (1st of reference, then refit of GBL trajectory itself)
-    int nscat = 0, nmeas = 0, ndummy = 0;
-    std::vector<gbl::GblPoint> points = collectGblPoints(trk, rep);
-    for(unsigned int ip = 0;ip<points.size(); ip++) {
-      GblPoint & p = points.at(ip);
-      if (p.hasScatterer())
-        nscat++;
-      if (p.hasMeasurement())
-        nmeas++;
-      if(!p.hasMeasurement()&&!p.hasScatterer())
-        ndummy++;
-    }
-    gbl::GblTrajectory traj(points, gblfs->hasCurvature());
-    
-    fitRes = traj.fit(Chi2, Ndf, lostWeight, (iIter == m_externalIterations - 1) ? m_gblInternalIterations : "");
-    
-    // Update fit results in fitterinfos
-    updateGblInfo(traj, trk, rep);
-    
-    // This repropagates to get new Jacobians,
-    // if planes changed, predictions are extrapolated to new planes
-    if (m_recalcJacobians > iIter) {
-      GblFitterInfo* prevFitterInfo = 0;
-      GblFitterInfo* currFitterInfo = 0;
-      for (unsigned int ip = 0; ip < trk->getNumPoints(); ip++) {
-        if (trk->getPoint(ip)->hasFitterInfo(rep) && (currFitterInfo = dynamic_cast<GblFitterInfo*>(trk->getPoint(ip)->getFitterInfo(rep)))) {
+void GblFitter::recalculateJacobians(Track* trk, const AbsTrackRep* rep) const
+{
+  GblFitterInfo* prevFitterInfo = 0;
+  GblFitterInfo* currFitterInfo = 0;
+  for (unsigned int ip = 0; ip < trk->getNumPoints(); ip++) {
+    if (trk->getPoint(ip)->hasFitterInfo(rep) && (currFitterInfo = dynamic_cast<GblFitterInfo*>(trk->getPoint(ip)->getFitterInfo(rep)))) {
 
-          currFitterInfo->recalculateJacobian(prevFitterInfo);
-          prevFitterInfo = currFitterInfo;
-        }
-      }
+      currFitterInfo->recalculateJacobian(prevFitterInfo);
+      prevFitterInfo = currFitterInfo;
     }
-        
-    gblfs->setIsFitted(true);
-    gblfs->setIsFitConvergedPartially(fitRes == 0);
-    nFailed = trk->getNumPointsWithMeasurement() - nmeas;
-    gblfs->setNFailedPoints(nFailed);
-    gblfs->setIsFitConvergedFully(fitRes == 0 && nFailed == 0);
-    gblfs->setNumIterations(iIter + 1);
-    gblfs->setChi2(Chi2);    
-    gblfs->setNdf(Ndf);
-    gblfs->setCharge(trk->getFittedState().getCharge());
-    
-    #ifdef DEBUG
-    int npoints_meas = trk->getNumPointsWithMeasurement();  
-    int npoints_all = trk->getNumPoints();
-        
-    cout << "-------------------------------------------------------" << endl;
-    cout << "               GBL processed genfit::Track            " << endl;
-    cout << "-------------------------------------------------------" << endl;
-    cout << " # Track Points       :  " << npoints_all  << endl;
-    cout << " # Meas. Points       :  " << npoints_meas << endl;
-    cout << " # GBL points all     :  " << traj.getNumPoints();
-    if (ndummy)
-      cout << " (" << ndummy << " dummy) ";
-    cout << endl;
-    cout << " # GBL points meas    :  " << nmeas << endl;
-    cout << " # GBL points scat    :  " << nscat << endl;    
-    cout << "-------------- GBL Fit Results ----------- Iteration  " << iIter+1 << " " << ((iIter < gblIterations.size()) ? gblIterations[iIter] : "") << endl;
-    cout << " Fit q/p parameter    :  " << (gblfs->hasCurvature() ? ("True") : ("False")) << endl;
-    cout << " Valid trajectory     :  " << ((traj.isValid()) ? ("True") : ("False")) << endl;
-    cout << " Fit result           :  " << fitRes << "    (0 for success)" << endl;
-    cout << " GBL track NDF        :  " << Ndf << "    (-1 for failure)" << endl;
-    cout << " GBL track Chi2       :  " << Chi2 << endl;
-    cout << " GBL track P-value    :  " << TMath::Prob(Chi2, Ndf) << endl;
-    cout << "-------------------------------------------------------" << endl;
-    #endif
-    
-  }  
-  // -------------------------------------------------------------------
+  }
+}
 
+void GblFitter::setFitStatus(GblFitStatus* gblfs, Track* trk, unsigned int iIter, int fitRes, double Chi2, int Ndf, unsigned int nMeas) const
+{
+  gblfs->setIsFitted(true);
+  gblfs->setIsFitConvergedPartially(fitRes == 0);
+  unsigned int nFailed = trk->getNumPointsWithMeasurement() - nMeas;
+  gblfs->setNFailedPoints(nFailed);
+  gblfs->setIsFitConvergedFully(fitRes == 0 && nFailed == 0);
+  gblfs->setNumIterations(iIter + 1);
+  gblfs->setChi2(Chi2);    
+  gblfs->setNdf(Ndf);
+  gblfs->setCharge(trk->getFittedState().getCharge());
 }
 
 void GblFitter::cleanGblInfo(Track* trk, const AbsTrackRep* rep) const {
@@ -273,6 +465,14 @@ void GblFitter::sortHits(Track* trk, const AbsTrackRep* rep) const {
 std::vector<gbl::GblPoint> GblFitter::collectGblPoints(genfit::Track* trk, const genfit::AbsTrackRep* rep) {
   //TODO store collected points in in fit status? need streamer for GblPoint (or something like that)
   std::vector<gbl::GblPoint> thePoints;
+  std::vector<int> labelBuffer;
+  collectGblPoints(trk, rep, thePoints, labelBuffer);
+  return thePoints;
+}
+
+void GblFitter::collectGblPoints(genfit::Track* trk, const genfit::AbsTrackRep* rep, std::vector<gbl::GblPoint>& thePoints,
+                                 std::vector<int>& labelBuffer) {
+  // clear() keeps the capacity of a reused list
   thePoints.clear();
   
   // Collect points from track and fitterInfo(rep)
@@ -280,9 +480,8 @@ std::vector<gbl::GblPoint> GblFitter::collectGblPoints(genfit::Track* trk, const
     GblFitterInfo * gblfi = dynamic_cast<GblFitterInfo*>(trk->getPoint(ip)->getFitterInfo(rep));
     if (!gblfi)
       continue;
-    thePoints.push_back(gblfi->constructGblPoint());      
+    gblfi->addGblPoint(thePoints, labelBuffer);      
   }  
-  return thePoints;
 }
 
 void GblFitter::updateGblInfo(gbl::GblTrajectory& traj, genfit::Track* trk, const genfit::AbsTrackRep* rep) {
@@ -311,6 +510,21 @@ void GblFitter::updateGblInfo(gbl::GblTrajectory& traj, genfit::Track* trk, cons
   }
 }
 
+bool GblFitter::splitSegmentJacobian(const TMatrixD& jacSegment, const TMatrixD& jacFirstPart, TMatrixD& jacSecondPart,
+                                     double maxCondition) {
+  // segment = secondPart * firstPart
+  TDecompLU decomp(jacFirstPart);
+  const double condition = decomp.Condition(); // < 0 if singular
+  if (!(condition > 0.) || condition > maxCondition)
+    return false;
+  TMatrixD jacFirstPartInv(jacFirstPart.GetNrows(), jacFirstPart.GetNcols());
+  if (!decomp.Invert(jacFirstPartInv))
+    return false;
+  jacSecondPart.ResizeTo(jacSegment.GetNrows(), jacFirstPartInv.GetNcols());
+  jacSecondPart.Mult(jacSegment, jacFirstPartInv);
+  return true;
+}
+
 void GblFitter::getScattererFromMatList(double& length,
                              double& theta, double& s, double& ds,
                              const double p, const double mass, const double charge,
@@ -380,6 +594,8 @@ double GblFitter::constructGblInfo(Track* trk, const AbsTrackRep* rep)
   // Jacobian for point with measurement = how to propagate from previous point (scat/meas)
   TMatrixD jacPointToPoint(dim, dim);
   jacPointToPoint.UnitMatrix();
+  // Jacobian of whole segment between measurements
+  TMatrixD jacSegment(dim, dim);
   
   // Prepare state for extrapolation of track seed
   // Take the state to first plane
@@ -438,8 +654,11 @@ double GblFitter::constructGblInfo(Track* trk, const AbsTrackRep* rep)
     
     // Extrapolation for multiple scattering calculation
     // Extrap to point + 1, do NOT stop at boundary
+    // The Jacobian of the whole segment is kept, so that the segment
+    // is walked only once (twice with intermediate scatterer)
     TVector3 segmentEntry = refCopy.getPos();
-    rep->extrapolateToPlane(refCopy, nextPlane, false, false);
+    double segmentStep = rep->extrapolateToPlane(refCopy, nextPlane, false, true);
+    rep->getForwardJacobianAndNoise(jacSegment, noise, deltaState);
     TVector3 segmentExit = refCopy.getPos();
     
     getScattererFromMatList(trackLen,
@@ -510,9 +729,14 @@ double GblFitter::constructGblInfo(Track* trk, const AbsTrackRep* rep)
       scattp->setFitterInfo(gblfiscat);
       // ---------------------------------------
             
-      // Finish extrapolation to next measurement
-      double nextStep = rep->extrapolateToPlane(reference, nextPlane, false, true);
-      rep->getForwardJacobianAndNoise(jacPointToPoint, noise, deltaState);
+      // Finish extrapolation to next measurement (from segment, if possible)
+      double nextStep = segmentStep - s2;
+      if (splitSegmentJacobian(jacSegment, jacMeas2Scat, jacPointToPoint)) {
+        reference = refCopy;
+      } else {
+        nextStep = rep->extrapolateToPlane(reference, nextPlane, false, true);
+        rep->getForwardJacobianAndNoise(jacPointToPoint, noise, deltaState);
+      }
       
       if (0. > nextStep) {
         cout << " ERROR: The extrapolation to measurement point " << (ipoint_meas + 2) << " stepped back by " << nextStep << "cm !!! Track will be cut before this point." << endl;
@@ -521,9 +745,10 @@ double GblFitter::constructGblInfo(Track* trk, const AbsTrackRep* rep)
       }
       
     } else {
-      // No scattering: extrapolate whole distance between measurements
-      double nextStep = rep->extrapolateToPlane(reference, nextPlane, false, true);
-      rep->getForwardJacobianAndNoise(jacPointToPoint, noise, deltaState);
+      // No scattering: segment is the whole distance between measurements
+      double nextStep = segmentStep;
+      jacPointToPoint = jacSegment;
+      reference = refCopy;
       
       if (0. > nextStep) {
         cout << " ERROR: The extrapolation to measurement point " << (ipoint_meas + 2) << " stepped back by " << nextStep << "cm !!! Track will be cut before this point." << endl;
@@ -109,10 +109,25 @@ namespace genfit {
   }
   
   gbl::GblPoint GblFitterInfo::constructGblPoint() {
-    // All meas/scat info is added from genfit data again (to cope with possible RecoHit update)
-    
+    std::vector<int> labelBuffer;
+    return constructGblPoint(labelBuffer);
+  }
+  
+  gbl::GblPoint GblFitterInfo::constructGblPoint(std::vector<int>& labelBuffer) {
     // Create GBL point with current jacobian
     gbl::GblPoint thePoint(jacobian_);
+    fillGblPoint(thePoint, labelBuffer);
+    return thePoint;
+  }
+  
+  void GblFitterInfo::addGblPoint(std::vector<gbl::GblPoint>& thePoints, std::vector<int>& labelBuffer) {
+    // Construct in place, GblPoint is large (fixed capacity global derivatives) and has no move constructor
+    thePoints.emplace_back(jacobian_);
+    fillGblPoint(thePoints.back(), labelBuffer);
+  }
+  
+  void GblFitterInfo::fillGblPoint(gbl::GblPoint& thePoint, std::vector<int>& labelBuffer) {
+    // All meas/scat info is added from genfit data again (to cope with possible RecoHit update)
     
     //NOTE: 3rd update and update anytime GblPoint is requested
     // mostly likely will update with reference as on 2nd update
@@ -170,26 +185,24 @@ namespace genfit {
     // Derivatives      
     ICalibrationParametersDerivatives* globals = nullptr;
     if (hasMeasurements() && (globals = dynamic_cast<ICalibrationParametersDerivatives*>(trackPoint_->getRawMeasurement(0)) )) {    
-      std::pair<std::vector<int>, TMatrixD> labelsAndMatrix = globals->globalDerivatives(&sop);
-      std::vector<int> labels = labelsAndMatrix.first;
-      TMatrixD derivs = labelsAndMatrix.second;
+      // fixed capacity matrix, labels usually cached by the measurement (no allocation)
+      CalibrationDerivatives derivs;
+      const std::vector<int>& labels = globals->fillGlobalDerivatives(&sop, derivs, labelBuffer);
       
-      if (derivs.GetNcols() > 0 && !labels.empty() && (unsigned int)derivs.GetNcols() == labels.size()) {
+      if (derivs.cols() > 0 && !labels.empty() && (unsigned int)derivs.cols() == labels.size()) {
         thePoint.addGlobals(labels, derivs);
       }        
-      TMatrixD locals = globals->localDerivatives(&sop);      
-      if (locals.GetNcols() > 0) {
-        thePoint.addLocals(locals);
+      const int nLocals = globals->fillLocalDerivatives(&sop, derivs);
+      if (nLocals > 0) {
+        thePoint.addLocals(derivs);
         GblFitStatus* gblfs = dynamic_cast<GblFitStatus*>(trackPoint_->getTrack()->getFitStatus(rep_));
         if (gblfs) {
-          if (gblfs->getMaxLocalFitParams() < locals.GetNcols())
-            gblfs->setMaxLocalFitParams(locals.GetNcols());
+          if (gblfs->getMaxLocalFitParams() < nLocals)
+            gblfs->setMaxLocalFitParams(nLocals);
         }
       }
     }
     
-    return thePoint;
-    
   }
   
   void GblFitterInfo::updateMeasurementAndPlane(const StateOnPlane & sop) {
@@ -29,6 +29,17 @@
 
 #include "GblPoint.h"
 
+#include "RootEigenTransformations.h"
+
+#include <Eigen/Eigenvalues>
+
+namespace {
+
+/// Matrix with dynamic size up to 5x5 (no heap allocation)
+typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 5, 5> MatrixUpTo5x5;
+
+}
+
 //! Namespace for the general broken lines package
 namespace gbl {
 
@@ -38,23 +49,98 @@ namespace gbl {
  * \param [in] aJacobian Transformation jacobian from previous point
  */
 GblPoint::GblPoint(const TMatrixD &aJacobian) :
-		theLabel(0), theOffset(0), measDim(0), transFlag(false), measTransformation(), scatFlag(
-				false), localDerivatives(), globalLabels(), globalDerivatives() {
+		theLabel(0), theOffset(0), p2pJacobian(
+				genfit::rootMatrixView(aJacobian).topLeftCorner<5, 5>()), prevJacobian(
+				Matrix5x5::Zero()), nextJacobian(Matrix5x5::Zero()), measDim(0), measProjection(
+				Matrix5x5::Zero()), measResiduals(Vector5::Zero()), measPrecision(
+				Vector5::Zero()), transFlag(false), measTransformation(
+				Matrix5x5::Identity()), scatFlag(false), scatTransformation(
+				Matrix2x2::Identity()), scatResiduals(Vector2::Zero()), scatPrecision(
+				Vector2::Zero()), localDerivatives(), globalLabels(), globalDerivatives() {
+}
+
+GblPoint::GblPoint(const Matrix5x5 &aJacobian) :
+		theLabel(0), theOffset(0), p2pJacobian(aJacobian), prevJacobian(
+				Matrix5x5::Zero()), nextJacobian(Matrix5x5::Zero()), measDim(0), measProjection(
+				Matrix5x5::Zero()), measResiduals(Vector5::Zero()), measPrecision(
+				Vector5::Zero()), transFlag(false), measTransformation(
+				Matrix5x5::Identity()), scatFlag(false), scatTransformation(
+				Matrix2x2::Identity()), scatResiduals(Vector2::Zero()), scatPrecision(
+				Vector2::Zero()), localDerivatives(), globalLabels(), globalDerivatives() {
+}
 
-	for (unsigned int i = 0; i < 5; ++i) {
-		for (unsigned int j = 0; j < 5; ++j) {
-			p2pJacobian(i, j) = aJacobian(i, j);
-		}
-	}
+GblPoint::~GblPoint() {
 }
 
-GblPoint::GblPoint(const SMatrix55 &aJacobian) :
-		theLabel(0), theOffset(0), p2pJacobian(aJacobian), measDim(0), transFlag(
-				false), measTransformation(), scatFlag(false), localDerivatives(), globalLabels(), globalDerivatives() {
+/// Store measurement with diagonal precision.
+/**
+ * \param [in] aProjection Projection from local to measurement system
+ * \param [in] aResiduals Measurement residuals
+ * \param [in] aPrecision Measurement precision (diagonal)
+ * \param [in] minPrecision Minimal precision to accept measurement
+ */
+template<typename Projection, typename Residuals, typename Precision>
+void GblPoint::setMeasurement(const Projection &aProjection,
+		const Residuals &aResiduals, const Precision &aPrecision,
+		double minPrecision) {
+	measDim = aResiduals.rows();
+	unsigned int iOff = 5 - measDim;
+	for (unsigned int i = 0; i < measDim; ++i) {
+		measResiduals(iOff + i) = aResiduals(i);
+		measPrecision(iOff + i) = (
+				aPrecision(i) >= minPrecision ? aPrecision(i) : 0.);
+	}
+	measProjection.bottomRightCorner(measDim, measDim) =
+			aProjection.topLeftCorner(measDim, measDim);
+}
 
+/// Store measurement with arbitrary precision, diagonalize it.
+/**
+ * Eigenvalues are sorted in decreasing order.
+ * \param [in] aProjection Projection from local to measurement system
+ * \param [in] aResiduals Measurement residuals
+ * \param [in] aPrecision Measurement precision (matrix)
+ * \param [in] minPrecision Minimal precision to accept measurement
+ */
+template<typename Projection, typename Residuals, typename Precision>
+void GblPoint::setDiagonalizedMeasurement(const Projection &aProjection,
+		const Residuals &aResiduals, const Precision &aPrecision,
+		double minPrecision) {
+	measDim = aResiduals.rows();
+	const MatrixUpTo5x5 aSymPrecision(aPrecision);
+	Eigen::SelfAdjointEigenSolver<MatrixUpTo5x5> measEigen(aSymPrecision);
+	measTransformation.topLeftCorner(measDim, measDim) =
+			measEigen.eigenvectors().transpose().colwise().reverse();
+	transFlag = true;
+	unsigned int iOff = 5 - measDim;
+	measResiduals.tail(measDim).noalias() = measTransformation.topLeftCorner(
+			measDim, measDim) * aResiduals;
+	measProjection.bottomRightCorner(measDim, measDim).noalias() =
+			measTransformation.topLeftCorner(measDim, measDim)
+					* aProjection.topLeftCorner(measDim, measDim);
+	for (unsigned int i = 0; i < measDim; ++i) {
+		const double transPrecision = measEigen.eigenvalues()(
+				measDim - 1 - i);
+		measPrecision(iOff + i) = (
+				transPrecision >= minPrecision ? transPrecision : 0.);
+	}
 }
 
-GblPoint::~GblPoint() {
+/// Store (local or global) derivatives in (diagonalized) measurement system.
+/**
+ * \param [in] aDerivatives Derivatives (matrix)
+ * \param [out] aTarget Stored derivatives
+ */
+template<typename Derivatives, typename Target>
+void GblPoint::setTransformedDerivatives(const Derivatives &aDerivatives,
+		Target &aTarget) const {
+	aTarget.resize(aDerivatives.rows(), aDerivatives.cols());
+	if (transFlag) {
+		aTarget.noalias() = measTransformation.topLeftCorner(measDim, measDim)
+				* aDerivatives;
+	} else {
+		aTarget = aDerivatives;
+	}
 }
 
 /// Add a measurement to a point.
@@ -69,16 +155,9 @@ GblPoint::~GblPoint() {
 void GblPoint::addMeasurement(const TMatrixD &aProjection,
 		const TVectorD &aResiduals, const TVectorD &aPrecision,
 		double minPrecision) {
-	measDim = aResiduals.GetNrows();
-	unsigned int iOff = 5 - measDim;
-	for (unsigned int i = 0; i < measDim; ++i) {
-		measResiduals(iOff + i) = aResiduals[i];
-		measPrecision(iOff + i) = (
-				aPrecision[i] >= minPrecision ? aPrecision[i] : 0.);
-		for (unsigned int j = 0; j < measDim; ++j) {
-			measProjection(iOff + i, iOff + j) = aProjection(i, j);
-		}
-	}
+	setMeasurement(genfit::rootMatrixView(aProjection),
+			genfit::rootVectorView(aResiduals),
+			genfit::rootVectorView(aPrecision), minPrecision);
 }
 
 /// Add a measurement to a point.
@@ -94,24 +173,9 @@ void GblPoint::addMeasurement(const TMatrixD &aProjection,
 void GblPoint::addMeasurement(const TMatrixD &aProjection,
 		const TVectorD &aResiduals, const TMatrixDSym &aPrecision,
 		double minPrecision) {
-	measDim = aResiduals.GetNrows();
-	TMatrixDSymEigen measEigen(aPrecision);
-	measTransformation.ResizeTo(measDim, measDim);
-	measTransformation = measEigen.GetEigenVectors();
-	measTransformation.T();
-	transFlag = true;
-	TVectorD transResiduals = measTransformation * aResiduals;
-	TVectorD transPrecision = measEigen.GetEigenValues();
-	TMatrixD transProjection = measTransformation * aProjection;
-	unsigned int iOff = 5 - measDim;
-	for (unsigned int i = 0; i < measDim; ++i) {
-		measResiduals(iOff + i) = transResiduals[i];
-		measPrecision(iOff + i) = (
-				transPrecision[i] >= minPrecision ? transPrecision[i] : 0.);
-		for (unsigned int j = 0; j < measDim; ++j) {
-			measProjection(iOff + i, iOff + j) = transProjection(i, j);
-		}
-	}
+	setDiagonalizedMeasurement(genfit::rootMatrixView(aProjection),
+			genfit::rootVectorView(aResiduals),
+			genfit::rootMatrixView(aPrecision), minPrecision);
 }
 
 /// Add a measurement to a point.
@@ -124,14 +188,10 @@ void GblPoint::addMeasurement(const TMatrixD &aProjection,
  */
 void GblPoint::addMeasurement(const TVectorD &aResiduals,
 		const TVectorD &aPrecision, double minPrecision) {
-	measDim = aResiduals.GetNrows();
-	unsigned int iOff = 5 - measDim;
-	for (unsigned int i = 0; i < measDim; ++i) {
-		measResiduals(iOff + i) = aResiduals[i];
-		measPrecision(iOff + i) = (
-				aPrecision[i] >= minPrecision ? aPrecision[i] : 0.);
-	}
-	measProjection = ROOT::Math::SMatrixIdentity();
+	const unsigned int nDim = aResiduals.GetNrows();
+	setMeasurement(MatrixUpTo5x5::Identity(nDim, nDim),
+			genfit::rootVectorView(aResiduals),
+			genfit::rootVectorView(aPrecision), minPrecision);
 }
 
 /// Add a measurement to a point.
@@ -145,23 +205,69 @@ void GblPoint::addMeasurement(const TVectorD &aResiduals,
  */
 void GblPoint::addMeasurement(const TVectorD &aResiduals,
 		const TMatrixDSym &aPrecision, double minPrecision) {
-	measDim = aResiduals.GetNrows();
-	TMatrixDSymEigen measEigen(aPrecision);
-	measTransformation.ResizeTo(measDim, measDim);
-	measTransformation = measEigen.GetEigenVectors();
-	measTransformation.T();
-	transFlag = true;
-	TVectorD transResiduals = measTransformation * aResiduals;
-	TVectorD transPrecision = measEigen.GetEigenValues();
-	unsigned int iOff = 5 - measDim;
-	for (unsigned int i = 0; i < measDim; ++i) {
-		measResiduals(iOff + i) = transResiduals[i];
-		measPrecision(iOff + i) = (
-				transPrecision[i] >= minPrecision ? transPrecision[i] : 0.);
-		for (unsigned int j = 0; j < measDim; ++j) {
-			measProjection(iOff + i, iOff + j) = measTransformation(i, j);
-		}
-	}
+	const unsigned int nDim = aResiduals.GetNrows();
+	setDiagonalizedMeasurement(MatrixUpTo5x5::Identity(nDim, nDim),
+			genfit::rootVectorView(aResiduals),
+			genfit::rootMatrixView(aPrecision), minPrecision);
+}
+
+/// Add a measurement to a point.
+/**
+ * Add measurement (in meas. system) with diagonal precision (inverse covariance) matrix.
+ * \param [in] aProjection Projection from local to measurement system
+ * \param [in] aResiduals Measurement residuals
+ * \param [in] aPrecision Measurement precision (diagonal)
+ * \param [in] minPrecision Minimal precision to accept measurement
+ */
+void GblPoint::addMeasurement(const MatrixDynamic &aProjection,
+		const VectorDynamic &aResiduals, const VectorDynamic &aPrecision,
+		double minPrecision) {
+	setMeasurement(aProjection, aResiduals, aPrecision, minPrecision);
+}
+
+/// Add a measurement to a point.
+/**
+ * Add measurement (in meas. system) with arbitrary precision (inverse covariance) matrix.
+ * Will be diagonalized.
+ * \param [in] aProjection Projection from local to measurement system
+ * \param [in] aResiduals Measurement residuals
+ * \param [in] aPrecision Measurement precision (matrix)
+ * \param [in] minPrecision Minimal precision to accept measurement
+ */
+void GblPoint::addMeasurement(const MatrixDynamic &aProjection,
+		const VectorDynamic &aResiduals, const MatrixDynamic &aPrecision,
+		double minPrecision) {
+	setDiagonalizedMeasurement(aProjection, aResiduals, aPrecision,
+			minPrecision);
+}
+
+/// Add a measurement to a point.
+/**
+ * Add measurement in local system with diagonal precision (inverse covariance) matrix.
+ * \param [in] aResiduals Measurement residuals
+ * \param [in] aPrecision Measurement precision (diagonal)
+ * \param [in] minPrecision Minimal precision to accept measurement
+ */
+void GblPoint::addMeasurement(const VectorDynamic &aResiduals,
+		const VectorDynamic &aPrecision, double minPrecision) {
+	const unsigned int nDim = aResiduals.rows();
+	setMeasurement(MatrixUpTo5x5::Identity(nDim, nDim), aResiduals,
+			aPrecision, minPrecision);
+}
+
+/// Add a measurement to a point.
+/**
+ * Add measurement in local system with arbitrary precision (inverse covariance) matrix.
+ * Will be diagonalized.
+ * \param [in] aResiduals Measurement residuals
+ * \param [in] aPrecision Measurement precision (matrix)
+ * \param [in] minPrecision Minimal precision to accept measurement
+ */
+void GblPoint::addMeasurement(const VectorDynamic &aResiduals,
+		const MatrixDynamic &aPrecision, double minPrecision) {
+	const unsigned int nDim = aResiduals.rows();
+	setDiagonalizedMeasurement(MatrixUpTo5x5::Identity(nDim, nDim),
+			aResiduals, aPrecision, minPrecision);
 }
 
 /// Check for measurement at a point.
@@ -179,8 +285,8 @@ unsigned int GblPoint::hasMeasurement() const {
  * \param [out] aResiduals Measurement residuals
  * \param [out] aPrecision Measurement precision (diagonal)
  */
-void GblPoint::getMeasurement(SMatrix55 &aProjection, SVector5 &aResiduals,
-		SVector5 &aPrecision) const {
+void GblPoint::getMeasurement(Matrix5x5 &aProjection, Vector5 &aResiduals,
+		Vector5 &aPrecision) const {
 	aProjection = measProjection;
 	aResiduals = measResiduals;
 	aPrecision = measPrecision;
@@ -193,7 +299,11 @@ void GblPoint::getMeasurement(SMatrix55 &aProjection, SVector5 &aResiduals,
 void GblPoint::getMeasTransformation(TMatrixD &aTransformation) const {
 	aTransformation.ResizeTo(measDim, measDim);
 	if (transFlag) {
-		aTransformation = measTransformation;
+		for (unsigned int i = 0; i < measDim; ++i) {
+			for (unsigned int j = 0; j < measDim; ++j) {
+				aTransformation(i, j) = measTransformation(i, j);
+			}
+		}
 	} else {
 		aTransformation.UnitMatrix();
 	}
@@ -209,12 +319,8 @@ void GblPoint::getMeasTransformation(TMatrixD &aTransformation) const {
  */
 void GblPoint::addScatterer(const TVectorD &aResiduals,
 		const TVectorD &aPrecision) {
-	scatFlag = true;
-	scatResiduals(0) = aResiduals[0];
-	scatResiduals(1) = aResiduals[1];
-	scatPrecision(0) = aPrecision[0];
-	scatPrecision(1) = aPrecision[1];
-	scatTransformation = ROOT::Math::SMatrixIdentity();
+	addScatterer(Vector2(aResiduals[0], aResiduals[1]),
+			Vector2(aPrecision[0], aPrecision[1]));
 }
 
 /// Add a (thin) scatterer to a point.
@@ -235,19 +341,42 @@ void GblPoint::addScatterer(const TVectorD &aResiduals,
  */
 void GblPoint::addScatterer(const TVectorD &aResiduals,
 		const TMatrixDSym &aPrecision) {
+	addScatterer(Vector2(aResiduals[0], aResiduals[1]),
+			Matrix2x2(genfit::rootMatrixView(aPrecision).topLeftCorner<2, 2>()));
+}
+
+/// Add a (thin) scatterer to a point.
+/**
+ * Add scatterer with diagonal precision (inverse covariance) matrix.
+ * Changes local track direction.
+ *
+ * \param [in] aResiduals Scatterer residuals
+ * \param [in] aPrecision Scatterer precision (diagonal of inverse covariance matrix)
+ */
+void GblPoint::addScatterer(const Vector2 &aResiduals,
+		const Vector2 &aPrecision) {
 	scatFlag = true;
-	TMatrixDSymEigen scatEigen(aPrecision);
-	TMatrixD aTransformation = scatEigen.GetEigenVectors();
-	aTransformation.T();
-	TVectorD transResiduals = aTransformation * aResiduals;
-	TVectorD transPrecision = scatEigen.GetEigenValues();
-	for (unsigned int i = 0; i < 2; ++i) {
-		scatResiduals(i) = transResiduals[i];
-		scatPrecision(i) = transPrecision[i];
-		for (unsigned int j = 0; j < 2; ++j) {
-			scatTransformation(i, j) = aTransformation(i, j);
-		}
-	}
+	scatResiduals = aResiduals;
+	scatPrecision = aPrecision;
+	scatTransformation.setIdentity();
+}
+
+/// Add a (thin) scatterer to a point.
+/**
+ * Add scatterer with arbitrary precision (inverse covariance) matrix.
+ * Will be diagonalized (eigenvalues in decreasing order). Changes local track direction.
+ *
+ * \param [in] aResiduals Scatterer residuals
+ * \param [in] aPrecision Scatterer precision (matrix)
+ */
+void GblPoint::addScatterer(const Vector2 &aResiduals,
+		const Matrix2x2 &aPrecision) {
+	scatFlag = true;
+	Eigen::SelfAdjointEigenSolver<Matrix2x2> scatEigen(aPrecision);
+	scatTransformation =
+			scatEigen.eigenvectors().transpose().colwise().reverse();
+	scatResiduals = scatTransformation * aResiduals;
+	scatPrecision = scatEigen.eigenvalues().reverse();
 }
 
 /// Check for scatterer at a point.
@@ -261,8 +390,8 @@ bool GblPoint::hasScatterer() const {
  * \param [out] aResiduals Scatterer residuals
  * \param [out] aPrecision Scatterer precision (diagonal)
  */
-void GblPoint::getScatterer(SMatrix22 &aTransformation, SVector2 &aResiduals,
-		SVector2 &aPrecision) const {
+void GblPoint::getScatterer(Matrix2x2 &aTransformation, Vector2 &aResiduals,
+		Vector2 &aPrecision) const {
 	aTransformation = scatTransformation;
 	aResiduals = scatResiduals;
 	aPrecision = scatPrecision;
@@ -292,25 +421,51 @@ void GblPoint::getScatTransformation(TMatrixD &aTransformation) const {
  */
 void GblPoint::addLocals(const TMatrixD &aDerivatives) {
 	if (measDim) {
-		localDerivatives.ResizeTo(aDerivatives);
-		if (transFlag) {
-			localDerivatives = measTransformation * aDerivatives;
-		} else {
-			localDerivatives = aDerivatives;
-		}
+		setTransformedDerivatives(genfit::rootMatrixView(aDerivatives), localDerivatives);
+	}
+}
+
+/// Add local derivatives to a point.
+/**
+ * Point needs to have a measurement.
+ * \param [in] aDerivatives Local derivatives (matrix, e.g. genfit::CalibrationDerivatives without copy)
+ */
+void GblPoint::addLocals(const Eigen::Ref<const MatrixDynamic> &aDerivatives) {
+	if (measDim) {
+		setTransformedDerivatives(aDerivatives, localDerivatives);
 	}
 }
 
 /// Retrieve number of local derivatives from a point.
 unsigned int GblPoint::getNumLocals() const {
-	return localDerivatives.GetNcols();
+	return localDerivatives.cols();
 }
 
 /// Retrieve local derivatives from a point.
-const TMatrixD& GblPoint::getLocalDerivatives() const {
+const MatrixDynamic& GblPoint::getLocalDerivatives() const {
 	return localDerivatives;
 }
 
+/// Store global labels and derivatives.
+/**
+ * Labels and derivatives are kept in storage of fixed capacity
+ * (genfit::maxCalibrationParameters), so points do not allocate.
+ * \param [in] aLabels Global derivatives labels
+ * \param [in] aDerivatives Global derivatives (matrix)
+ */
+template<typename Derivatives>
+void GblPoint::setGlobals(const std::vector<int> &aLabels,
+		const Derivatives &aDerivatives) {
+	if (!measDim)
+		return;
+	if (aLabels.size() > (unsigned int) genfit::maxCalibrationParameters
+			or aDerivatives.cols() > genfit::maxCalibrationParameters) {
+		throw std::length_error("Too many global derivatives at point");
+	}
+	globalLabels = Eigen::Map<const Eigen::VectorXi>(aLabels.data(), aLabels.size());
+	setTransformedDerivatives(aDerivatives, globalDerivatives);
+}
+
 /// Add global derivatives to a point.
 /**
  * Point needs to have a measurement.
@@ -319,33 +474,52 @@ const TMatrixD& GblPoint::getLocalDerivatives() const {
  */
 void GblPoint::addGlobals(const std::vector<int> &aLabels,
 		const TMatrixD &aDerivatives) {
-	if (measDim) {
-		globalLabels = aLabels;
-		globalDerivatives.ResizeTo(aDerivatives);
-		if (transFlag) {
-			globalDerivatives = measTransformation * aDerivatives;
-		} else {
-			globalDerivatives = aDerivatives;
-		}
+	setGlobals(aLabels, genfit::rootMatrixView(aDerivatives));
+}
 
-	}
+/// Add global derivatives to a point.
+/**
+ * Point needs to have a measurement.
+ * \param [in] aLabels Global derivatives labels
+ * \param [in] aDerivatives Global derivatives (matrix, e.g. genfit::CalibrationDerivatives without copy)
+ */
+void GblPoint::addGlobals(const std::vector<int> &aLabels,
+		const Eigen::Ref<const MatrixDynamic> &aDerivatives) {
+	setGlobals(aLabels, aDerivatives);
 }
 
 /// Retrieve number of global derivatives from a point.
 unsigned int GblPoint::getNumGlobals() const {
-	return globalDerivatives.GetNcols();
+	return globalDerivatives.cols();
 }
 
 /// Retrieve global derivatives labels from a point.
-std::vector<int> GblPoint::getGlobalLabels() const {
+const genfit::CalibrationLabels& GblPoint::getGlobalLabels() const {
 	return globalLabels;
 }
 
 /// Retrieve global derivatives from a point.
-const TMatrixD& GblPoint::getGlobalDerivatives() const {
+const genfit::CalibrationDerivatives& GblPoint::getGlobalDerivatives() const {
 	return globalDerivatives;
 }
 
+/// Retrieve global derivatives for single row of (diagonalized) measurement.
+/**
+ * Output lists are cleared first, their capacity is reused.
+ * \param [in] aRow Row in measurement
+ * \param [out] aLabels Global labels
+ * \param [out] aDerivatives Global derivatives
+ */
+void GblPoint::getGlobalLabelsAndDerivatives(unsigned int aRow,
+		std::vector<int> &aLabels, std::vector<double> &aDerivatives) const {
+	aLabels.clear();
+	aDerivatives.clear();
+	for (unsigned int i = 0; i < globalDerivatives.cols(); ++i) {
+		aLabels.push_back(globalLabels[i]);
+		aDerivatives.push_back(globalDerivatives(aRow, i));
+	}
+}
+
 /// Define label of point (by GBLTrajectory constructor)
 /**
  * \param [in] aLabel Label identifying point
@@ -373,7 +547,7 @@ int GblPoint::getOffset() const {
 }
 
 /// Retrieve point-to-(previous)point jacobian
-const SMatrix55& GblPoint::getP2pJacobian() const {
+const Matrix5x5& GblPoint::getP2pJacobian() const {
 	return p2pJacobian;
 }
 
@@ -381,24 +555,24 @@ const SMatrix55& GblPoint::getP2pJacobian() const {
 /**
  * \param [in] aJac Jacobian
  */
-void GblPoint::addPrevJacobian(const SMatrix55 &aJac) {
-	int ifail = 0;
+void GblPoint::addPrevJacobian(const Matrix5x5 &aJac) {
 // to optimize: need only two last rows of inverse
-//	prevJacobian = aJac.InverseFast(ifail);
+//	prevJacobian = aJac.inverse();
 //  block matrix algebra
-	SMatrix23 CA = aJac.Sub<SMatrix23>(3, 0)
-			* aJac.Sub<SMatrix33>(0, 0).InverseFast(ifail); // C*A^-1
-	SMatrix22 DCAB = aJac.Sub<SMatrix22>(3, 3) - CA * aJac.Sub<SMatrix32>(0, 3); // D - C*A^-1 *B
-	DCAB.InvertFast();
-	prevJacobian.Place_at(DCAB, 3, 3);
-	prevJacobian.Place_at(-DCAB * CA, 3, 0);
+	const Matrix2x3 CA = aJac.block<2, 3>(3, 0)
+			* aJac.block<3, 3>(0, 0).inverse(); // C*A^-1
+	const Matrix2x2 DCAB = aJac.block<2, 2>(3, 3)
+			- CA * aJac.block<3, 2>(0, 3); // D - C*A^-1 *B
+	const Matrix2x2 DCABInv = DCAB.inverse();
+	prevJacobian.block<2, 2>(3, 3) = DCABInv;
+	prevJacobian.block<2, 3>(3, 0) = -DCABInv * CA;
 }
 
 /// Define jacobian to next scatterer (by GBLTrajectory constructor)
 /**
  * \param [in] aJac Jacobian
  */
-void GblPoint::addNextJacobian(const SMatrix55 &aJac) {
+void GblPoint::addNextJacobian(const Matrix5x5 &aJac) {
 	nextJacobian = aJac;
 }
 
@@ -412,22 +586,22 @@ void GblPoint::addNextJacobian(const SMatrix55 &aJac) {
  * \param [out] vecWd W*d
  * \exception std::overflow_error : matrix S is singular.
  */
-void GblPoint::getDerivatives(int aDirection, SMatrix22 &matW, SMatrix22 &matWJ,
-		SVector2 &vecWd) const {
+void GblPoint::getDerivatives(int aDirection, Matrix2x2 &matW,
+		Matrix2x2 &matWJ, Vector2 &vecWd) const {
 
-	SMatrix22 matJ;
-	SVector2 vecd;
+	Matrix2x2 matJ;
+	Vector2 vecd;
 	if (aDirection < 1) {
-		matJ = prevJacobian.Sub<SMatrix22>(3, 3);
-		matW = -prevJacobian.Sub<SMatrix22>(3, 1);
-		vecd = prevJacobian.SubCol<SVector2>(0, 3);
+		matJ = prevJacobian.block<2, 2>(3, 3);
+		matW = -prevJacobian.block<2, 2>(3, 1);
+		vecd = prevJacobian.block<2, 1>(3, 0);
 	} else {
-		matJ = nextJacobian.Sub<SMatrix22>(3, 3);
-		matW = nextJacobian.Sub<SMatrix22>(3, 1);
-		vecd = nextJacobian.SubCol<SVector2>(0, 3);
+		matJ = nextJacobian.block<2, 2>(3, 3);
+		matW = nextJacobian.block<2, 2>(3, 1);
+		vecd = nextJacobian.block<2, 1>(3, 0);
 	}
 
-	if (!matW.InvertFast()) {
+	if (matW.determinant() == 0.) {
 		std::cout << " GblPoint::getDerivatives failed to invert matrix: "
 				<< matW << std::endl;
 		std::cout
@@ -435,6 +609,7 @@ void GblPoint::getDerivatives(int aDirection, SMatrix22 &matW, SMatrix22 &matWJ,
 				<< std::endl;
 		throw std::overflow_error("Singular matrix inversion exception");
 	}
+	matW = matW.inverse().eval();
 	matWJ = matW * matJ;
 	vecWd = matW * vecd;
 
@@ -461,13 +636,11 @@ void GblPoint::printPoint(unsigned int level) const {
 	if (transFlag) {
 		std::cout << ", diagonalized";
 	}
-	if (localDerivatives.GetNcols()) {
-		std::cout << ", " << localDerivatives.GetNcols()
-				<< " local derivatives";
+	if (localDerivatives.cols()) {
+		std::cout << ", " << localDerivatives.cols() << " local derivatives";
 	}
-	if (globalDerivatives.GetNcols()) {
-		std::cout << ", " << globalDerivatives.GetNcols()
-				<< " global derivatives";
+	if (globalDerivatives.cols()) {
+		std::cout << ", " << globalDerivatives.cols() << " global derivatives";
 	}
 	std::cout << std::endl;
 	if (level > 0) {
@@ -475,26 +648,30 @@ void GblPoint::printPoint(unsigned int level) const {
 			std::cout << "  Measurement" << std::endl;
 			std::cout << "   Projection: " << std::endl << measProjection
 					<< std::endl;
-			std::cout << "   Residuals: " << measResiduals << std::endl;
-			std::cout << "   Precision: " << measPrecision << std::endl;
+			std::cout << "   Residuals: " << measResiduals.transpose()
+					<< std::endl;
+			std::cout << "   Precision: " << measPrecision.transpose()
+					<< std::endl;
 		}
 		if (scatFlag) {
 			std::cout << "  Scatterer" << std::endl;
-			std::cout << "   Residuals: " << scatResiduals << std::endl;
-			std::cout << "   Precision: " << scatPrecision << std::endl;
+			std::cout << "   Residuals: " << scatResiduals.transpose()
+					<< std::endl;
+			std::cout << "   Precision: " << scatPrecision.transpose()
+					<< std::endl;
 		}
-		if (localDerivatives.GetNcols()) {
-			std::cout << "  Local Derivatives:" << std::endl;
-			localDerivatives.Print();
+		if (localDerivatives.cols()) {
+			std::cout << "  Local Derivatives:" << std::endl
+					<< localDerivatives << std::endl;
 		}
-		if (globalDerivatives.GetNcols()) {
+		if (globalDerivatives.cols()) {
 			std::cout << "  Global Labels:";
 			for (unsigned int i = 0; i < globalLabels.size(); ++i) {
 				std::cout << " " << globalLabels[i];
 			}
 			std::cout << std::endl;
-			std::cout << "  Global Derivatives:" << std::endl;
-			globalDerivatives.Print();
+			std::cout << "  Global Derivatives:" << std::endl
+					<< globalDerivatives << std::endl;
 		}
 		std::cout << "  Jacobian " << std::endl;
 		std::cout << "   Point-to-point " << std::endl << p2pJacobian
@@ -118,9 +118,12 @@
  *
  *  Implementation
  *
- *  Matrices are implemented with ROOT (root.cern.ch). User input or output is in the
- *  form of TMatrices. Internally SMatrices are used for fixes sized and simple matrices
- *  based on std::vector<> for variable sized matrices.
+ *  Matrices are implemented with Eigen. User input or output is in the
+ *  form of TMatrices (ROOT) or Eigen matrices. Internally fixed sized Eigen matrices
+ *  are used for the track parameters and dynamic sized ones for (additional) local
+ *  parameters and the linear equation system. Work space is kept with the trajectory
+ *  and with the data blocks (fixed size lists for track parameters) so that
+ *  constructing and fitting a trajectory needs no heap allocation per point.
  *
  *  References
  *    - V. Blobel, C. Kleinwort, F. Meier,
@@ -131,10 +134,25 @@
  */
 
 #include "GblTrajectory.h"
+#include "RootEigenTransformations.h"
+
+#include <Eigen/Eigenvalues>
 
 //! Namespace for the general broken lines package
 namespace gbl {
 
+/// Create empty trajectory.
+/**
+ * The (invalid) trajectory has to be filled with \link reset \endlink before use.
+ * Intended as (per thread) work space reused for many tracks.
+ */
+GblTrajectory::GblTrajectory() :
+		numAllPoints(0), numPoints(), numTrajectories(0), numOffsets(0), numInnerTrans(
+				0), numCurvature(0), numParameters(0), numLocals(0), numMeasurements(
+				0), externalPoint(0), constructOK(false), fitOK(false), theDimension(
+				0), thePoints(), theData(), measDataIndex(), scatDataIndex(), externalSeed(), innerTransformations(), externalDerivatives(), externalMeasurements(), externalPrecisions() {
+}
+
 /// Create new (simple) trajectory from list of points.
 /**
  * Curved trajectory in space (default) or without curvature (q/p) or in one
@@ -175,6 +193,36 @@ GblTrajectory::GblTrajectory(const std::vector<GblPoint> &aPointList,
 GblTrajectory::GblTrajectory(const std::vector<GblPoint> &aPointList,
 		unsigned int aLabel, const TMatrixDSym &aSeed, bool flagCurv,
 		bool flagU1dir, bool flagU2dir) :
+		numAllPoints(aPointList.size()), numPoints(), numOffsets(0), numInnerTrans(
+				0), numCurvature(flagCurv ? 1 : 0), numParameters(0), numLocals(
+				0), numMeasurements(0), externalPoint(aLabel), theDimension(0), thePoints(), theData(), measDataIndex(), scatDataIndex(), externalSeed(
+				genfit::rootMatrixView(aSeed)), innerTransformations(), externalDerivatives(), externalMeasurements(), externalPrecisions() {
+
+	if (flagU1dir)
+		theDimension.push_back(0);
+	if (flagU2dir)
+		theDimension.push_back(1);
+	// simple (single) trajectory
+	thePoints.push_back(aPointList);
+	numPoints.push_back(numAllPoints);
+	construct(); // construct trajectory
+}
+
+/// Create new (simple) trajectory from list of points with external seed.
+/**
+ * Curved trajectory in space (default) or without curvature (q/p) or in one
+ * plane (u-direction) only.
+ * \param [in] aPointList List of points
+ * \param [in] aLabel (Signed) label of point for external seed
+ * (<0: in front, >0: after point, slope changes at scatterer!)
+ * \param [in] aSeed Precision matrix of external seed
+ * \param [in] flagCurv Use q/p
+ * \param [in] flagU1dir Use in u1 direction
+ * \param [in] flagU2dir Use in u2 direction
+ */
+GblTrajectory::GblTrajectory(const std::vector<GblPoint> &aPointList,
+		unsigned int aLabel, const MatrixDynamic &aSeed, bool flagCurv,
+		bool flagU1dir, bool flagU2dir) :
 		numAllPoints(aPointList.size()), numPoints(), numOffsets(0), numInnerTrans(
 				0), numCurvature(flagCurv ? 1 : 0), numParameters(0), numLocals(
 				0), numMeasurements(0), externalPoint(aLabel), theDimension(0), thePoints(), theData(), measDataIndex(), scatDataIndex(), externalSeed(
@@ -205,11 +253,12 @@ GblTrajectory::GblTrajectory(
 		thePoints.push_back(aPointsAndTransList[iTraj].first);
 		numPoints.push_back(thePoints.back().size());
 		numAllPoints += numPoints.back();
-		innerTransformations.push_back(aPointsAndTransList[iTraj].second);
+		innerTransformations.push_back(
+				genfit::rootMatrixView(aPointsAndTransList[iTraj].second));
 	}
 	theDimension.push_back(0);
 	theDimension.push_back(1);
-	numCurvature = innerTransformations[0].GetNcols();
+	numCurvature = innerTransformations[0].cols();
 	construct(); // construct (composed) trajectory
 }
 
@@ -228,18 +277,20 @@ GblTrajectory::GblTrajectory(
 		numAllPoints(), numPoints(), numOffsets(0), numInnerTrans(
 				aPointsAndTransList.size()), numParameters(0), numLocals(0), numMeasurements(
 				0), externalPoint(0), theDimension(0), thePoints(), theData(), measDataIndex(), scatDataIndex(), externalSeed(), innerTransformations(), externalDerivatives(
-				extDerivatives), externalMeasurements(extMeasurements), externalPrecisions(
-				extPrecisions) {
+				genfit::rootMatrixView(extDerivatives)), externalMeasurements(
+				genfit::rootVectorView(extMeasurements)), externalPrecisions(
+				genfit::rootVectorView(extPrecisions)) {
 
 	for (unsigned int iTraj = 0; iTraj < aPointsAndTransList.size(); ++iTraj) {
 		thePoints.push_back(aPointsAndTransList[iTraj].first);
 		numPoints.push_back(thePoints.back().size());
 		numAllPoints += numPoints.back();
-		innerTransformations.push_back(aPointsAndTransList[iTraj].second);
+		innerTransformations.push_back(
+				genfit::rootMatrixView(aPointsAndTransList[iTraj].second));
 	}
 	theDimension.push_back(0);
 	theDimension.push_back(1);
-	numCurvature = innerTransformations[0].GetNcols();
+	numCurvature = innerTransformations[0].cols();
 	construct(); // construct (composed) trajectory
 }
 
@@ -260,31 +311,148 @@ GblTrajectory::GblTrajectory(
 				0), externalPoint(0), theDimension(0), thePoints(), theData(), measDataIndex(), scatDataIndex(), externalSeed(), innerTransformations() {
 
 	// diagonalize external measurement
-	TMatrixDSymEigen extEigen(extPrecisions);
-	TMatrixD extTransformation = extEigen.GetEigenVectors();
-	extTransformation.T();
-	externalDerivatives.ResizeTo(extDerivatives);
-	externalDerivatives = extTransformation * extDerivatives;
-	externalMeasurements.ResizeTo(extMeasurements);
-	externalMeasurements = extTransformation * extMeasurements;
-	externalPrecisions.ResizeTo(extMeasurements);
-	externalPrecisions = extEigen.GetEigenValues();
+	Eigen::SelfAdjointEigenSolver<MatrixDynamic> extEigen(
+			genfit::rootMatrixView(extPrecisions));
+	const MatrixDynamic extTransformation =
+			extEigen.eigenvectors().transpose();
+	externalDerivatives = extTransformation
+			* genfit::rootMatrixView(extDerivatives);
+	externalMeasurements = extTransformation
+			* genfit::rootVectorView(extMeasurements);
+	externalPrecisions = extEigen.eigenvalues();
 
 	for (unsigned int iTraj = 0; iTraj < aPointsAndTransList.size(); ++iTraj) {
 		thePoints.push_back(aPointsAndTransList[iTraj].first);
 		numPoints.push_back(thePoints.back().size());
 		numAllPoints += numPoints.back();
-		innerTransformations.push_back(aPointsAndTransList[iTraj].second);
+		innerTransformations.push_back(
+				genfit::rootMatrixView(aPointsAndTransList[iTraj].second));
 	}
 	theDimension.push_back(0);
 	theDimension.push_back(1);
-	numCurvature = innerTransformations[0].GetNcols();
+	numCurvature = innerTransformations[0].cols();
 	construct(); // construct (composed) trajectory
 }
 
 GblTrajectory::~GblTrajectory() {
 }
 
+/// Reset to new (simple) trajectory from list of points.
+/**
+ * Equivalent to the corresponding constructor, but keeps the storage of the
+ * previous trajectory (points, data blocks, linear equation system,
+ * index lists and work space) so that reusing one trajectory for many
+ * tracks does not reallocate once the capacity is large enough.
+ * \param [in] aPointList List of points
+ * \param [in] flagCurv Use q/p
+ * \param [in] flagU1dir Use in u1 direction
+ * \param [in] flagU2dir Use in u2 direction
+ */
+void GblTrajectory::reset(const std::vector<GblPoint> &aPointList,
+		bool flagCurv, bool flagU1dir, bool flagU2dir) {
+	externalPoint = 0;
+	externalSeed.resize(0, 0);
+	// assignment reuses storage of points
+	thePoints.resize(1);
+	thePoints[0] = aPointList;
+	resetSimple(flagCurv, flagU1dir, flagU2dir);
+}
+
+/// Reset to new (simple) trajectory, taking over a list of points.
+/**
+ * Same as the copying version, but the points are swapped in instead of
+ * copied. The moved-from list receives the storage of the previous points,
+ * so a caller alternating between one list and one trajectory allocates
+ * nothing once both are large enough.
+ * \param [in] aPointList List of points (moved-from, reusable after clear())
+ * \param [in] flagCurv Use q/p
+ * \param [in] flagU1dir Use in u1 direction
+ * \param [in] flagU2dir Use in u2 direction
+ */
+void GblTrajectory::reset(std::vector<GblPoint> &&aPointList, bool flagCurv,
+		bool flagU1dir, bool flagU2dir) {
+	externalPoint = 0;
+	externalSeed.resize(0, 0);
+	thePoints.resize(1);
+	thePoints[0].swap(aPointList);
+	resetSimple(flagCurv, flagU1dir, flagU2dir);
+}
+
+/// Reset to new (simple) trajectory from list of points with external seed.
+/**
+ * Equivalent to the corresponding constructor, but keeps the storage of the
+ * previous trajectory.
+ * \param [in] aPointList List of points
+ * \param [in] aLabel (Signed) label of point for external seed
+ * (<0: in front, >0: after point, slope changes at scatterer!)
+ * \param [in] aSeed Precision matrix of external seed
+ * \param [in] flagCurv Use q/p
+ * \param [in] flagU1dir Use in u1 direction
+ * \param [in] flagU2dir Use in u2 direction
+ */
+void GblTrajectory::reset(const std::vector<GblPoint> &aPointList,
+		unsigned int aLabel, const TMatrixDSym &aSeed, bool flagCurv,
+		bool flagU1dir, bool flagU2dir) {
+	externalPoint = aLabel;
+	externalSeed = genfit::rootMatrixView(aSeed);
+	thePoints.resize(1);
+	thePoints[0] = aPointList;
+	resetSimple(flagCurv, flagU1dir, flagU2dir);
+}
+
+/// Reset to new (simple) trajectory from list of points with external seed.
+/**
+ * Equivalent to the corresponding constructor, but keeps the storage of the
+ * previous trajectory.
+ * \param [in] aPointList List of points
+ * \param [in] aLabel (Signed) label of point for external seed
+ * (<0: in front, >0: after point, slope changes at scatterer!)
+ * \param [in] aSeed Precision matrix of external seed
+ * \param [in] flagCurv Use q/p
+ * \param [in] flagU1dir Use in u1 direction
+ * \param [in] flagU2dir Use in u2 direction
+ */
+void GblTrajectory::reset(const std::vector<GblPoint> &aPointList,
+		unsigned int aLabel, const MatrixDynamic &aSeed, bool flagCurv,
+		bool flagU1dir, bool flagU2dir) {
+	externalPoint = aLabel;
+	externalSeed = aSeed;
+	thePoints.resize(1);
+	thePoints[0] = aPointList;
+	resetSimple(flagCurv, flagU1dir, flagU2dir);
+}
+
+/// Reset counters and lists for new simple trajectory and construct it.
+/**
+ * (External seed and the single list of points have to be set before.)
+ * \param [in] flagCurv Use q/p
+ * \param [in] flagU1dir Use in u1 direction
+ * \param [in] flagU2dir Use in u2 direction
+ */
+void GblTrajectory::resetSimple(bool flagCurv, bool flagU1dir,
+		bool flagU2dir) {
+	numAllPoints = thePoints[0].size();
+	numOffsets = 0;
+	numInnerTrans = 0;
+	numCurvature = flagCurv ? 1 : 0;
+	numParameters = 0;
+	numLocals = 0;
+	numMeasurements = 0;
+	theDimension.clear();
+	if (flagU1dir)
+		theDimension.push_back(0);
+	if (flagU2dir)
+		theDimension.push_back(1);
+	// simple (single) trajectory
+	numPoints.assign(1, numAllPoints);
+	theData.clear();
+	innerTransformations.clear();
+	externalDerivatives.resize(0, 0);
+	externalMeasurements.resize(0);
+	externalPrecisions.resize(0);
+	construct(); // construct trajectory
+}
+
 /// Retrieve validity of trajectory
 bool GblTrajectory::isValid() const {
 	return constructOK;
@@ -365,7 +533,7 @@ void GblTrajectory::defineOffsets() {
 /// Calculate Jacobians to previous/next scatterer from point to point ones.
 void GblTrajectory::calcJacobians() {
 
-	SMatrix55 scatJacobian;
+	Matrix5x5 scatJacobian;
 	// loop over trajectories
 	for (unsigned int iTraj = 0; iTraj < numTrajectories; ++iTraj) {
 		// forward propagation (all)
@@ -404,13 +572,12 @@ void GblTrajectory::calcJacobians() {
 /**
  * Jacobian broken lines (q/p,..,u_i,u_i+1..) to track (q/p,u',u) parameters
  * including additional local parameters.
+ * The list of fit parameters with non zero derivatives and the corresponding
+ * transformation matrix are stored in the work space (workIndex, workJacobian).
  * \param [in] aSignedLabel (Signed) label of point for external seed
  * (<0: in front, >0: after point, slope changes at scatterer!)
- * \return List of fit parameters with non zero derivatives and
- * corresponding transformation matrix
  */
-std::pair<std::vector<unsigned int>, TMatrixD> GblTrajectory::getJacobian(
-		int aSignedLabel) const {
+void GblTrajectory::getJacobian(int aSignedLabel) const {
 
 	unsigned int nDim = theDimension.size();
 	unsigned int nCurv = numCurvature;
@@ -418,10 +585,9 @@ std::pair<std::vector<unsigned int>, TMatrixD> GblTrajectory::getJacobian(
 	unsigned int nBorder = nCurv + nLocals;
 	unsigned int nParBRL = nBorder + 2 * nDim;
 	unsigned int nParLoc = nLocals + 5;
-	std::vector<unsigned int> anIndex;
-	anIndex.reserve(nParBRL);
-	TMatrixD aJacobian(nParLoc, nParBRL);
-	aJacobian.Zero();
+	workIndex.clear();
+	workIndex.reserve(nParBRL);
+	workJacobian.setZero(nParLoc, nParBRL);
 
 	unsigned int aLabel = abs(aSignedLabel);
 	unsigned int firstLabel = 1;
@@ -451,28 +617,26 @@ std::pair<std::vector<unsigned int>, TMatrixD> GblTrajectory::getJacobian(
 			nJacobian = 1;
 		}
 	}
-	const GblPoint aPoint = thePoints[aTrajectory][aLabel - firstLabel];
-	std::vector<unsigned int> labDer(5);
-	SMatrix55 matDer;
+	const GblPoint &aPoint = thePoints[aTrajectory][aLabel - firstLabel];
+	std::array<unsigned int, 5> labDer;
+	labDer.fill(0);
+	Matrix5x5 matDer = Matrix5x5::Zero();
 	getFitToLocalJacobian(labDer, matDer, aPoint, 5, nJacobian);
 
 	// from local parameters
 	for (unsigned int i = 0; i < nLocals; ++i) {
-		aJacobian(i + 5, i) = 1.0;
-		anIndex.push_back(i + 1);
+		workJacobian(i + 5, i) = 1.0;
+		workIndex.push_back(i + 1);
 	}
 	// from trajectory parameters
 	unsigned int iCol = nLocals;
 	for (unsigned int i = 0; i < 5; ++i) {
 		if (labDer[i] > 0) {
-			anIndex.push_back(labDer[i]);
-			for (unsigned int j = 0; j < 5; ++j) {
-				aJacobian(j, iCol) = matDer(j, i);
-			}
+			workIndex.push_back(labDer[i]);
+			workJacobian.block<5, 1>(0, iCol) = matDer.col(i);
 			++iCol;
 		}
 	}
-	return std::make_pair(anIndex, aJacobian);
 }
 
 /// Get (part of) jacobian for transformation from (trajectory) fit to track parameters at point.
@@ -485,8 +649,8 @@ std::pair<std::vector<unsigned int>, TMatrixD> GblTrajectory::getJacobian(
  * (<=2: calculate only offset part, >2: complete matrix)
  * \param [in] nJacobian Direction (0: to previous offset, 1: to next offset)
  */
-void GblTrajectory::getFitToLocalJacobian(std::vector<unsigned int> &anIndex,
-		SMatrix55 &aJacobian, const GblPoint &aPoint, unsigned int measDim,
+void GblTrajectory::getFitToLocalJacobian(std::array<unsigned int, 5> &anIndex,
+		Matrix5x5 &aJacobian, const GblPoint &aPoint, unsigned int measDim,
 		unsigned int nJacobian) const {
 
 	unsigned int nDim = theDimension.size();
@@ -497,28 +661,27 @@ void GblTrajectory::getFitToLocalJacobian(std::vector<unsigned int> &anIndex,
 
 	if (nOffset < 0) // need interpolation
 			{
-		SMatrix22 prevW, prevWJ, nextW, nextWJ, matN;
-		SVector2 prevWd, nextWd;
-		int ierr;
+		Matrix2x2 prevW, prevWJ, nextW, nextWJ, matN;
+		Vector2 prevWd, nextWd;
 		aPoint.getDerivatives(0, prevW, prevWJ, prevWd); // W-, W- * J-, W- * d-
 		aPoint.getDerivatives(1, nextW, nextWJ, nextWd); // W-, W- * J-, W- * d-
-		const SMatrix22 sumWJ(prevWJ + nextWJ);
-		matN = sumWJ.Inverse(ierr); // N = (W- * J- + W+ * J+)^-1
+		const Matrix2x2 sumWJ(prevWJ + nextWJ);
+		matN = sumWJ.inverse(); // N = (W- * J- + W+ * J+)^-1
 		// derivatives for u_int
-		const SMatrix22 prevNW(matN * prevW); // N * W-
-		const SMatrix22 nextNW(matN * nextW); // N * W+
-		const SVector2 prevNd(matN * prevWd); // N * W- * d-
-		const SVector2 nextNd(matN * nextWd); // N * W+ * d+
+		const Matrix2x2 prevNW(matN * prevW); // N * W-
+		const Matrix2x2 nextNW(matN * nextW); // N * W+
+		const Vector2 prevNd(matN * prevWd); // N * W- * d-
+		const Vector2 nextNd(matN * nextWd); // N * W+ * d+
 
 		unsigned int iOff = nDim * (-nOffset - 1) + nLocals + nCurv + 1; // first offset ('i' in u_i)
 
 		// local offset
 		if (nCurv > 0) {
-			aJacobian.Place_in_col(-prevNd - nextNd, 3, 0); // from curvature
+			aJacobian.block<2, 1>(3, 0) = -prevNd - nextNd; // from curvature
 			anIndex[0] = nLocals + 1;
 		}
-		aJacobian.Place_at(prevNW, 3, 1); // from 1st Offset
-		aJacobian.Place_at(nextNW, 3, 3); // from 2nd Offset
+		aJacobian.block<2, 2>(3, 1) = prevNW; // from 1st Offset
+		aJacobian.block<2, 2>(3, 3) = nextNW; // from 2nd Offset
 		for (unsigned int i = 0; i < nDim; ++i) {
 			anIndex[1 + theDimension[i]] = iOff + i;
 			anIndex[3 + theDimension[i]] = iOff + nDim + i;
@@ -527,16 +690,16 @@ void GblTrajectory::getFitToLocalJacobian(std::vector<unsigned int> &anIndex,
 		// local slope and curvature
 		if (measDim > 2) {
 			// derivatives for u'_int
-			const SMatrix22 prevWPN(nextWJ * prevNW); // W+ * J+ * N * W-
-			const SMatrix22 nextWPN(prevWJ * nextNW); // W- * J- * N * W+
-			const SVector2 prevWNd(nextWJ * prevNd); // W+ * J+ * N * W- * d-
-			const SVector2 nextWNd(prevWJ * nextNd); // W- * J- * N * W+ * d+
+			const Matrix2x2 prevWPN(nextWJ * prevNW); // W+ * J+ * N * W-
+			const Matrix2x2 nextWPN(prevWJ * nextNW); // W- * J- * N * W+
+			const Vector2 prevWNd(nextWJ * prevNd); // W+ * J+ * N * W- * d-
+			const Vector2 nextWNd(prevWJ * nextNd); // W- * J- * N * W+ * d+
 			if (nCurv > 0) {
 				aJacobian(0, 0) = 1.0;
-				aJacobian.Place_in_col(prevWNd - nextWNd, 1, 0); // from curvature
+				aJacobian.block<2, 1>(1, 0) = prevWNd - nextWNd; // from curvature
 			}
-			aJacobian.Place_at(-prevWPN, 1, 1); // from 1st Offset
-			aJacobian.Place_at(nextWPN, 1, 3); // from 2nd Offset
+			aJacobian.block<2, 2>(1, 1) = -prevWPN; // from 1st Offset
+			aJacobian.block<2, 2>(1, 3) = nextWPN; // from 2nd Offset
 		}
 	} else { // at point
 		// anIndex must be sorted
@@ -555,17 +718,17 @@ void GblTrajectory::getFitToLocalJacobian(std::vector<unsigned int> &anIndex,
 
 		// local slope and curvature
 		if (measDim > 2) {
-			SMatrix22 matW, matWJ;
-			SVector2 vecWd;
+			Matrix2x2 matW, matWJ;
+			Vector2 vecWd;
 			aPoint.getDerivatives(nJacobian, matW, matWJ, vecWd); // W, W * J, W * d
 			double sign = (nJacobian > 0) ? 1. : -1.;
 			if (nCurv > 0) {
 				aJacobian(0, 0) = 1.0;
-				aJacobian.Place_in_col(-sign * vecWd, 1, 0); // from curvature
+				aJacobian.block<2, 1>(1, 0) = -sign * vecWd; // from curvature
 				anIndex[0] = nLocals + 1;
 			}
-			aJacobian.Place_at(-sign * matWJ, 1, index1); // from 1st Offset
-			aJacobian.Place_at(sign * matW, 1, index2); // from 2nd Offset
+			aJacobian.block<2, 2>(1, index1) = -sign * matWJ; // from 1st Offset
+			aJacobian.block<2, 2>(1, index2) = sign * matW; // from 2nd Offset
 			for (unsigned int i = 0; i < nDim; ++i) {
 				anIndex[index2 + theDimension[i]] = iOff2 + i;
 			}
@@ -580,8 +743,8 @@ void GblTrajectory::getFitToLocalJacobian(std::vector<unsigned int> &anIndex,
  * \param [out] aJacobian Corresponding transformation matrix
  * \param [in] aPoint Point to use
  */
-void GblTrajectory::getFitToKinkJacobian(std::vector<unsigned int> &anIndex,
-		SMatrix27 &aJacobian, const GblPoint &aPoint) const {
+void GblTrajectory::getFitToKinkJacobian(std::array<unsigned int, 7> &anIndex,
+		Matrix2x7 &aJacobian, const GblPoint &aPoint) const {
 
 	unsigned int nDim = theDimension.size();
 	unsigned int nCurv = numCurvature;
@@ -589,23 +752,23 @@ void GblTrajectory::getFitToKinkJacobian(std::vector<unsigned int> &anIndex,
 
 	int nOffset = aPoint.getOffset();
 
-	SMatrix22 prevW, prevWJ, nextW, nextWJ;
-	SVector2 prevWd, nextWd;
+	Matrix2x2 prevW, prevWJ, nextW, nextWJ;
+	Vector2 prevWd, nextWd;
 	aPoint.getDerivatives(0, prevW, prevWJ, prevWd); // W-, W- * J-, W- * d-
 	aPoint.getDerivatives(1, nextW, nextWJ, nextWd); // W-, W- * J-, W- * d-
-	const SMatrix22 sumWJ(prevWJ + nextWJ); // W- * J- + W+ * J+
-	const SVector2 sumWd(prevWd + nextWd); // W+ * d+ + W- * d-
+	const Matrix2x2 sumWJ(prevWJ + nextWJ); // W- * J- + W+ * J+
+	const Vector2 sumWd(prevWd + nextWd); // W+ * d+ + W- * d-
 
 	unsigned int iOff = (nOffset - 1) * nDim + nCurv + nLocals + 1; // first offset ('i' in u_i)
 
 	// local offset
 	if (nCurv > 0) {
-		aJacobian.Place_in_col(-sumWd, 0, 0); // from curvature
+		aJacobian.block<2, 1>(0, 0) = -sumWd; // from curvature
 		anIndex[0] = nLocals + 1;
 	}
-	aJacobian.Place_at(prevW, 0, 1); // from 1st Offset
-	aJacobian.Place_at(-sumWJ, 0, 3); // from 2nd Offset
-	aJacobian.Place_at(nextW, 0, 5); // from 1st Offset
+	aJacobian.block<2, 2>(0, 1) = prevW; // from 1st Offset
+	aJacobian.block<2, 2>(0, 3) = -sumWJ; // from 2nd Offset
+	aJacobian.block<2, 2>(0, 5) = nextW; // from 1st Offset
 	for (unsigned int i = 0; i < nDim; ++i) {
 		anIndex[1 + theDimension[i]] = iOff + i;
 		anIndex[3 + theDimension[i]] = iOff + nDim + i;
@@ -630,18 +793,48 @@ void GblTrajectory::getFitToKinkJacobian(std::vector<unsigned int> &anIndex,
  */
 unsigned int GblTrajectory::getResults(int aSignedLabel, TVectorD &localPar,
 		TMatrixDSym &localCov) const {
+	unsigned int ierr = getResults(aSignedLabel, workParameters,
+			workCovariance);
+	if (ierr)
+		return ierr;
+	const int nParLoc = workParameters.rows();
+	localPar.ResizeTo(nParLoc);
+	localCov.ResizeTo(nParLoc, nParLoc);
+	for (int i = 0; i < nParLoc; ++i) {
+		localPar[i] = workParameters(i);
+		for (int j = 0; j < nParLoc; ++j) {
+			localCov(i, j) = workCovariance(i, j);
+		}
+	}
+	return 0;
+}
+
+/// Get fit results at point.
+/**
+ * Get corrections and covariance matrix for local track and additional parameters
+ * in forward or backward direction.
+ *
+ * \param [in] aSignedLabel (Signed) label of point on trajectory
+ * (<0: in front, >0: after point, slope changes at scatterer!)
+ * \param [out] localPar Corrections for local parameters
+ * \param [out] localCov Covariance for local parameters
+ * \return error code (non-zero if trajectory not fitted successfully)
+ */
+unsigned int GblTrajectory::getResults(int aSignedLabel,
+		VectorDynamic &localPar, MatrixDynamic &localCov) const {
 	if (not fitOK)
 		return 1;
-	std::pair<std::vector<unsigned int>, TMatrixD> indexAndJacobian =
-			getJacobian(aSignedLabel);
-	unsigned int nParBrl = indexAndJacobian.first.size();
-	TVectorD aVec(nParBrl); // compressed vector
+	getJacobian(aSignedLabel);
+	unsigned int nParBrl = workIndex.size();
+	workVector.resize(nParBrl); // compressed vector
 	for (unsigned int i = 0; i < nParBrl; ++i) {
-		aVec[i] = theVector(indexAndJacobian.first[i] - 1);
+		workVector(i) = theVector(workIndex[i] - 1);
 	}
-	TMatrixDSym aMat = theMatrix.getBlockMatrix(indexAndJacobian.first); // compressed matrix
-	localPar = indexAndJacobian.second * aVec;
-	localCov = aMat.Similarity(indexAndJacobian.second);
+	theMatrix.getBlockMatrix(nParBrl, workIndex.data(), workMatrix); // compressed matrix
+	localPar.noalias() = workJacobian.leftCols(nParBrl) * workVector;
+	workProduct.noalias() = workJacobian.leftCols(nParBrl) * workMatrix;
+	localCov.noalias() = workProduct
+			* workJacobian.leftCols(nParBrl).transpose();
 	return 0;
 }
 
@@ -674,6 +867,40 @@ unsigned int GblTrajectory::getMeasResults(unsigned int aLabel,
 	return 0;
 }
 
+/// Get residuals from fit at point for measurement.
+/**
+ * Get (diagonalized) residual, error of measurement and residual and down-weighting
+ * factor for measurement at point (output vectors are resized to number of data blocks).
+ *
+ * \param [in]  aLabel Label of point on trajectory
+ * \param [out] numData Number of data blocks from measurement at point
+ * \param [out] aResiduals Measurements-Predictions
+ * \param [out] aMeasErrors Errors of Measurements
+ * \param [out] aResErrors Errors of Residuals (including correlations from track fit)
+ * \param [out] aDownWeights Down-Weighting factors
+ * \return error code (non-zero if trajectory not fitted successfully)
+ */
+unsigned int GblTrajectory::getMeasResults(unsigned int aLabel,
+		unsigned int &numData, VectorDynamic &aResiduals,
+		VectorDynamic &aMeasErrors, VectorDynamic &aResErrors,
+		VectorDynamic &aDownWeights) {
+	numData = 0;
+	if (not fitOK)
+		return 1;
+
+	unsigned int firstData = measDataIndex[aLabel - 1]; // first data block with measurement
+	numData = measDataIndex[aLabel] - firstData; // number of data blocks
+	aResiduals.resize(numData);
+	aMeasErrors.resize(numData);
+	aResErrors.resize(numData);
+	aDownWeights.resize(numData);
+	for (unsigned int i = 0; i < numData; ++i) {
+		getResAndErr(firstData + i, aResiduals(i), aMeasErrors(i),
+				aResErrors(i), aDownWeights(i));
+	}
+	return 0;
+}
+
 /// Get (kink) residuals from fit at point for scatterer.
 /**
  * Get (diagonalized) residual, error of measurement and residual and down-weighting
@@ -703,6 +930,40 @@ unsigned int GblTrajectory::getScatResults(unsigned int aLabel,
 	return 0;
 }
 
+/// Get (kink) residuals from fit at point for scatterer.
+/**
+ * Get (diagonalized) residual, error of measurement and residual and down-weighting
+ * factor for scatterering kinks at point (output vectors are resized to number of data blocks).
+ *
+ * \param [in]  aLabel Label of point on trajectory
+ * \param [out] numData Number of data blocks from scatterer at point
+ * \param [out] aResiduals (kink)Measurements-(kink)Predictions
+ * \param [out] aMeasErrors Errors of (kink)Measurements
+ * \param [out] aResErrors Errors of Residuals (including correlations from track fit)
+ * \param [out] aDownWeights Down-Weighting factors
+ * \return error code (non-zero if trajectory not fitted successfully)
+ */
+unsigned int GblTrajectory::getScatResults(unsigned int aLabel,
+		unsigned int &numData, VectorDynamic &aResiduals,
+		VectorDynamic &aMeasErrors, VectorDynamic &aResErrors,
+		VectorDynamic &aDownWeights) {
+	numData = 0;
+	if (not fitOK)
+		return 1;
+
+	unsigned int firstData = scatDataIndex[aLabel - 1]; // first data block with scatterer
+	numData = scatDataIndex[aLabel] - firstData; // number of data blocks
+	aResiduals.resize(numData);
+	aMeasErrors.resize(numData);
+	aResErrors.resize(numData);
+	aDownWeights.resize(numData);
+	for (unsigned int i = 0; i < numData; ++i) {
+		getResAndErr(firstData + i, aResiduals(i), aMeasErrors(i),
+				aResErrors(i), aDownWeights(i));
+	}
+	return 0;
+}
+
 /// Get (list of) labels of points on (simple) valid trajectory
 /**
  * \param [out] aLabelList List of labels (aLabelList[i] = i+1)
@@ -757,17 +1018,15 @@ void GblTrajectory::getResAndErr(unsigned int aData, double &aResidual,
 		double &aMeasError, double &aResError, double &aDownWeight) {
 
 	double aMeasVar;
-	std::vector<unsigned int>* indLocal;
-	std::vector<double>* derLocal;
-	theData[aData].getResidual(aResidual, aMeasVar, aDownWeight, indLocal,
-			derLocal);
-	unsigned int nParBrl = (*indLocal).size();
-	TVectorD aVec(nParBrl); // compressed vector of derivatives
-	for (unsigned int j = 0; j < nParBrl; ++j) {
-		aVec[j] = (*derLocal)[j];
-	}
-	TMatrixDSym aMat = theMatrix.getBlockMatrix(*indLocal); // compressed (covariance) matrix
-	double aFitVar = aMat.Similarity(aVec); // variance from track fit
+	unsigned int numLocal;
+	const unsigned int* indLocal;
+	const double* derLocal;
+	theDataBlocks.getResidual(aData, aResidual, aMeasVar, aDownWeight,
+			numLocal, indLocal, derLocal);
+	const Eigen::Map<const VectorDynamic> aVec(derLocal, numLocal); // compressed vector of derivatives
+	theMatrix.getBlockMatrix(numLocal, indLocal, workMatrix); // compressed (covariance) matrix
+	workVector.noalias() = workMatrix * aVec;
+	double aFitVar = aVec.dot(workVector); // variance from track fit
 	aMeasError = sqrt(aMeasVar); // error of measurement
 	aResError = (aFitVar < aMeasVar ? sqrt(aMeasVar - aFitVar) : 0.); // error of residual
 }
@@ -775,18 +1034,20 @@ void GblTrajectory::getResAndErr(unsigned int aData, double &aResidual,
 /// Build linear equation system from data (blocks).
 void GblTrajectory::buildLinearEquationSystem() {
 	unsigned int nBorder = numCurvature + numLocals;
-	theVector.resize(numParameters);
+	theVector.setZero(numParameters);
 	theMatrix.resize(numParameters, nBorder);
 	double aValue, aWeight;
-	std::vector<unsigned int>* indLocal;
-	std::vector<double>* derLocal;
-	std::vector<GblData>::iterator itData;
-	for (itData = theData.begin(); itData < theData.end(); ++itData) {
-		itData->getLocalData(aValue, aWeight, indLocal, derLocal);
-		for (unsigned int j = 0; j < indLocal->size(); ++j) {
-			theVector((*indLocal)[j] - 1) += (*derLocal)[j] * aWeight * aValue;
+	unsigned int numLocal;
+	const unsigned int* indLocal;
+	const double* derLocal;
+	const unsigned int nData = theDataBlocks.getNumData();
+	for (unsigned int iData = 0; iData < nData; ++iData) {
+		theDataBlocks.getLocalData(iData, aValue, aWeight, numLocal, indLocal,
+				derLocal);
+		for (unsigned int j = 0; j < numLocal; ++j) {
+			theVector(indLocal[j] - 1) += derLocal[j] * aWeight * aValue;
 		}
-		theMatrix.addBlockMatrix(aWeight, indLocal, derLocal);
+		theMatrix.addBlockMatrix(aWeight, numLocal, indLocal, derLocal);
 	}
 }
 
@@ -798,13 +1059,13 @@ void GblTrajectory::prepare() {
 	unsigned int nDim = theDimension.size();
 	// upper limit
 	unsigned int maxData = numMeasurements + nDim * (numOffsets - 2)
-			+ externalSeed.GetNrows();
+			+ externalSeed.rows();
 	theData.reserve(maxData);
 	measDataIndex.resize(numAllPoints + 3); // include external seed and measurements
 	scatDataIndex.resize(numAllPoints + 1);
 	unsigned int nData = 0;
-	std::vector<TMatrixD> innerTransDer;
-	std::vector<std::vector<unsigned int> > innerTransLab;
+	std::vector<MatrixDynamic> innerTransDer;
+	std::vector<std::array<unsigned int, 5> > innerTransLab;
 	// composed trajectory ?
 	if (numInnerTrans > 0) {
 		//std::cout << "composed trajectory" << std::endl;
@@ -812,42 +1073,38 @@ void GblTrajectory::prepare() {
 			// innermost point
 			GblPoint* innerPoint = &thePoints[iTraj].front();
 			// transformation fit to local track parameters
-			std::vector<unsigned int> firstLabels(5);
-			SMatrix55 matFitToLocal, matLocalToFit;
+			std::array<unsigned int, 5> firstLabels;
+			firstLabels.fill(0);
+			Matrix5x5 matFitToLocal = Matrix5x5::Zero();
 			getFitToLocalJacobian(firstLabels, matFitToLocal, *innerPoint, 5);
 			// transformation local track to fit parameters
-			int ierr;
-			matLocalToFit = matFitToLocal.Inverse(ierr);
-			TMatrixD localToFit(5, 5);
-			for (unsigned int i = 0; i < 5; ++i) {
-				for (unsigned int j = 0; j < 5; ++j) {
-					localToFit(i, j) = matLocalToFit(i, j);
-				}
-			}
+			const Matrix5x5 matLocalToFit = matFitToLocal.inverse();
 			// transformation external to fit parameters at inner (first) point
-			innerTransDer.push_back(localToFit * innerTransformations[iTraj]);
+			innerTransDer.push_back(matLocalToFit * innerTransformations[iTraj]);
 			innerTransLab.push_back(firstLabels);
 		}
 	}
+	// transformation for external parameters (composed trajectory only)
+	Eigen::Matrix<double, Eigen::Dynamic, 5, 0, 5, 5> proDer;
+	MatrixDynamic transDer;
 	// measurements
-	SMatrix55 matP;
+	Matrix5x5 matP;
 	// loop over trajectories
 	std::vector<GblPoint>::iterator itPoint;
 	for (unsigned int iTraj = 0; iTraj < numTrajectories; ++iTraj) {
 		for (itPoint = thePoints[iTraj].begin();
 				itPoint < thePoints[iTraj].end(); ++itPoint) {
-			SVector5 aMeas, aPrec;
+			Vector5 aMeas, aPrec;
 			unsigned int nLabel = itPoint->getLabel();
 			unsigned int measDim = itPoint->hasMeasurement();
 			if (measDim) {
-				const TMatrixD localDer = itPoint->getLocalDerivatives();
-				const std::vector<int> globalLab = itPoint->getGlobalLabels();
-				const TMatrixD globalDer = itPoint->getGlobalDerivatives();
-				TMatrixD transDer;
+				const MatrixDynamic &localDer = itPoint->getLocalDerivatives();
 				itPoint->getMeasurement(matP, aMeas, aPrec);
 				unsigned int iOff = 5 - measDim; // first active component
-				std::vector<unsigned int> labDer(5);
-				SMatrix55 matDer, matPDer;
+				std::array<unsigned int, 5> labDer;
+				labDer.fill(0);
+				Matrix5x5 matDer = Matrix5x5::Zero();
+				Matrix5x5 matPDer = Matrix5x5::Zero();
 				unsigned int nJacobian =
 						(itPoint < thePoints[iTraj].end() - 1) ? 1 : 0; // last point needs backward propagation
 				getFitToLocalJacobian(labDer, matDer, *itPoint, measDim,
@@ -855,21 +1112,21 @@ void GblTrajectory::prepare() {
 				if (measDim > 2) {
 					matPDer = matP * matDer;
 				} else { // 'shortcut' for position measurements
-					matPDer.Place_at(
-							matP.Sub<SMatrix22>(3, 3)
-									* matDer.Sub<SMatrix25>(3, 0), 3, 0);
+					matPDer.block<2, 5>(3, 0) = matP.block<2, 2>(3, 3)
+							* matDer.block<2, 5>(3, 0);
 				}
 
 				if (numInnerTrans > 0) {
 					// transform for external parameters
-					TMatrixD proDer(measDim, 5);
+					proDer.setZero(measDim, 5);
 					// match parameters
 					unsigned int ifirst = 0;
 					unsigned int ilabel = 0;
 					while (ilabel < 5) {
 						if (labDer[ilabel] > 0) {
-							while (innerTransLab[iTraj][ifirst]
-									!= labDer[ilabel] and ifirst < 5) {
+							while (ifirst < 5
+									and innerTransLab[iTraj][ifirst]
+											!= labDer[ilabel]) {
 								++ifirst;
 							}
 							if (ifirst >= 5) {
@@ -885,14 +1142,15 @@ void GblTrajectory::prepare() {
 						}
 						++ilabel;
 					}
-					transDer.ResizeTo(measDim, numCurvature);
-					transDer = proDer * innerTransDer[iTraj];
+					transDer.noalias() = proDer * innerTransDer[iTraj];
 				}
 				for (unsigned int i = iOff; i < 5; ++i) {
 					if (aPrec(i) > 0.) {
-						GblData aData(nLabel, aMeas(i), aPrec(i));
+						GblData aData(nLabel, InternalMeasurement, aMeas(i),
+								aPrec(i), iTraj,
+								itPoint - thePoints[iTraj].begin());
 						aData.addDerivatives(i, labDer, matPDer, iOff, localDer,
-								globalLab, globalDer, numLocals, transDer);
+								numLocals, transDer);
 						theData.push_back(aData);
 						nData++;
 					}
@@ -904,32 +1162,33 @@ void GblTrajectory::prepare() {
 	}
 
 	// pseudo measurements from kinks
-	SMatrix22 matT;
+	Matrix2x2 matT;
 	scatDataIndex[0] = nData;
 	scatDataIndex[1] = nData;
 	// loop over trajectories
 	for (unsigned int iTraj = 0; iTraj < numTrajectories; ++iTraj) {
 		for (itPoint = thePoints[iTraj].begin() + 1;
 				itPoint < thePoints[iTraj].end() - 1; ++itPoint) {
-			SVector2 aMeas, aPrec;
+			Vector2 aMeas, aPrec;
 			unsigned int nLabel = itPoint->getLabel();
 			if (itPoint->hasScatterer()) {
 				itPoint->getScatterer(matT, aMeas, aPrec);
-				TMatrixD transDer;
-				std::vector<unsigned int> labDer(7);
-				SMatrix27 matDer, matTDer;
+				std::array<unsigned int, 7> labDer;
+				labDer.fill(0);
+				Matrix2x7 matDer = Matrix2x7::Zero();
 				getFitToKinkJacobian(labDer, matDer, *itPoint);
-				matTDer = matT * matDer;
+				const Matrix2x7 matTDer = matT * matDer;
 				if (numInnerTrans > 0) {
 					// transform for external parameters
-					TMatrixD proDer(nDim, 5);
+					proDer.setZero(nDim, 5);
 					// match parameters
 					unsigned int ifirst = 0;
 					unsigned int ilabel = 0;
 					while (ilabel < 7) {
 						if (labDer[ilabel] > 0) {
-							while (innerTransLab[iTraj][ifirst]
-									!= labDer[ilabel] and ifirst < 5) {
+							while (ifirst < 5
+									and innerTransLab[iTraj][ifirst]
+											!= labDer[ilabel]) {
 								++ifirst;
 							}
 							if (ifirst >= 5) {
@@ -944,13 +1203,14 @@ void GblTrajectory::prepare() {
 						}
 						++ilabel;
 					}
-					transDer.ResizeTo(nDim, numCurvature);
-					transDer = proDer * innerTransDer[iTraj];
+					transDer.noalias() = proDer * innerTransDer[iTraj];
 				}
 				for (unsigned int i = 0; i < nDim; ++i) {
 					unsigned int iDim = theDimension[i];
 					if (aPrec(iDim) > 0.) {
-						GblData aData(nLabel, aMeas(iDim), aPrec(iDim));
+						GblData aData(nLabel, InternalKink, aMeas(iDim),
+								aPrec(iDim), iTraj,
+								itPoint - thePoints[iTraj].begin());
 						aData.addDerivatives(iDim, labDer, matTDer, numLocals,
 								transDer);
 						theData.push_back(aData);
@@ -965,22 +1225,20 @@ void GblTrajectory::prepare() {
 
 	// external seed
 	if (externalPoint > 0) {
-		std::pair<std::vector<unsigned int>, TMatrixD> indexAndJacobian =
-				getJacobian(externalPoint);
-		std::vector<unsigned int> externalSeedIndex = indexAndJacobian.first;
-		std::vector<double> externalSeedDerivatives(externalSeedIndex.size());
-		const TMatrixDSymEigen externalSeedEigen(externalSeed);
-		const TVectorD valEigen = externalSeedEigen.GetEigenValues();
-		TMatrixD vecEigen = externalSeedEigen.GetEigenVectors();
-		vecEigen = vecEigen.T() * indexAndJacobian.second;
-		for (int i = 0; i < externalSeed.GetNrows(); ++i) {
+		getJacobian(externalPoint);
+		unsigned int nParBrl = workIndex.size();
+		Eigen::SelfAdjointEigenSolver<MatrixDynamic> externalSeedEigen(
+				externalSeed);
+		const VectorDynamic valEigen = externalSeedEigen.eigenvalues();
+		const MatrixDynamic vecEigen =
+				externalSeedEigen.eigenvectors().transpose()
+						* workJacobian.leftCols(nParBrl);
+		for (int i = 0; i < externalSeed.rows(); ++i) {
 			if (valEigen(i) > 0.) {
-				for (int j = 0; j < externalSeed.GetNcols(); ++j) {
-					externalSeedDerivatives[j] = vecEigen(i, j);
-				}
-				GblData aData(externalPoint, 0., valEigen(i));
-				aData.addDerivatives(externalSeedIndex,
-						externalSeedDerivatives);
+				workVector = vecEigen.row(i).transpose();
+				GblData aData(externalPoint, ExternalSeed, 0., valEigen(i));
+				aData.addDerivatives(nParBrl, workIndex.data(),
+						workVector.data());
 				theData.push_back(aData);
 				nData++;
 			}
@@ -988,7 +1246,7 @@ void GblTrajectory::prepare() {
 	}
 	measDataIndex[numAllPoints + 1] = nData;
 	// external measurements
-	unsigned int nExt = externalMeasurements.GetNrows();
+	unsigned int nExt = externalMeasurements.rows();
 	if (nExt > 0) {
 		std::vector<unsigned int> index(numCurvature);
 		std::vector<double> derivatives(numCurvature);
@@ -997,22 +1255,21 @@ void GblTrajectory::prepare() {
 				index[iCol] = numLocals + iCol + 1;
 				derivatives[iCol] = externalDerivatives(iExt, iCol);
 			}
-			GblData aData(1U, externalMeasurements(iExt),
+			GblData aData(1U, ExternalMeasurement, externalMeasurements(iExt),
 					externalPrecisions(iExt));
-			aData.addDerivatives(index, derivatives);
+			aData.addDerivatives(numCurvature, index.data(),
+					derivatives.data());
 			theData.push_back(aData);
 			nData++;
 		}
 	}
 	measDataIndex[numAllPoints + 2] = nData;
+	theDataBlocks.assign(theData);
 }
 
 /// Calculate predictions for all points.
 void GblTrajectory::predict() {
-	std::vector<GblData>::iterator itData;
-	for (itData = theData.begin(); itData < theData.end(); ++itData) {
-		itData->setPrediction(theVector);
-	}
+	theDataBlocks.predict(theVector);
 }
 
 /// Down-weight all points.
@@ -1020,12 +1277,7 @@ void GblTrajectory::predict() {
  * \param [in] aMethod M-estimator (1: Tukey, 2:Huber, 3:Cauchy)
  */
 double GblTrajectory::downWeight(unsigned int aMethod) {
-	double aLoss = 0.;
-	std::vector<GblData>::iterator itData;
-	for (itData = theData.begin(); itData < theData.end(); ++itData) {
-		aLoss += (1. - itData->setDownWeighting(aMethod));
-	}
-	return aLoss;
+	return theDataBlocks.downWeight(aMethod);
 }
 
 /// Perform fit of (valid) trajectory.
@@ -1073,11 +1325,8 @@ unsigned int GblTrajectory::fit(double &Chi2, int &Ndf, double &lostWeight,
 			}
 		}
 		Ndf = theData.size() - numParameters;
-		Chi2 = 0.;
-		for (unsigned int i = 0; i < theData.size(); ++i) {
-			Chi2 += theData[i].getChi2();
-		}
-		Chi2 /= normChi2[aMethod];
+		Chi2 = theDataBlocks.getChi2() / normChi2[aMethod];
+		theDataBlocks.copyResults(theData);
 		fitOK = true;
 
 	} catch (int e) {
@@ -1089,25 +1338,55 @@ unsigned int GblTrajectory::fit(double &Chi2, int &Ndf, double &lostWeight,
 
 /// Write valid trajectory to Millepede-II binary file.
 void GblTrajectory::milleOut(MilleBinary &aMille) {
-	double aValue;
-	double aErr;
-	std::vector<unsigned int>* indLocal;
-	std::vector<double>* derLocal;
-	std::vector<int>* labGlobal;
-	std::vector<double>* derGlobal;
+	if (not constructOK)
+		return;
+
+	addMilleData(aMille);
+	aMille.writeRecord();
+}
 
+/// Write valid trajectory to Millepede-II record.
+/**
+ * The record is cleared first. It can be filled independently for
+ * many trajectories (e.g. in parallel) and written later to a
+ * \link MilleBinary \endlink file.
+ * \param [out] aRecord Record (empty for invalid trajectory)
+ */
+void GblTrajectory::milleOut(MilleRecord &aRecord) {
+	aRecord.clear();
 	if (not constructOK)
 		return;
 
+	addMilleData(aRecord);
+}
+
+/// Add data blocks of trajectory to Millepede-II output.
+/**
+ * \param [in,out] aMille Binary file or record (with \a addData method)
+ */
+template<typename MilleOutput>
+void GblTrajectory::addMilleData(MilleOutput &aMille) {
+	double aValue;
+	double aErr;
+	unsigned int numLocal, aTraj, aPoint, aRow;
+	const unsigned int* indLocal;
+	const double* derLocal;
+
 //   data: measurements, kinks and external seed
 	std::vector<GblData>::iterator itData;
 	for (itData = theData.begin(); itData != theData.end(); ++itData) {
-		itData->getAllData(aValue, aErr, indLocal, derLocal, labGlobal,
-				derGlobal);
-		aMille.addData(aValue, aErr, *indLocal, *derLocal, *labGlobal,
-				*derGlobal);
+		itData->getAllData(aValue, aErr, numLocal, indLocal, derLocal, aTraj,
+				aPoint, aRow);
+		if (itData->getType() == InternalMeasurement) {
+			thePoints[aTraj][aPoint].getGlobalLabelsAndDerivatives(aRow,
+					workGlobalLabels, workGlobalDerivatives);
+		} else {
+			workGlobalLabels.clear();
+			workGlobalDerivatives.clear();
+		}
+		aMille.addData(aValue, aErr, numLocal, indLocal, derLocal,
+				workGlobalLabels, workGlobalDerivatives);
 	}
-	aMille.writeRecord();
 }
 
 /// Print GblTrajectory
@@ -1131,9 +1410,9 @@ void GblTrajectory::printTrajectory(unsigned int level) {
 			<< std::endl;
 	std::cout << " Number of measurements       : " << numMeasurements
 			<< std::endl;
-	if (externalMeasurements.GetNrows()) {
+	if (externalMeasurements.rows()) {
 		std::cout << " Number of ext. measurements  : "
-				<< externalMeasurements.GetNrows() << std::endl;
+				<< externalMeasurements.rows() << std::endl;
 	}
 	if (externalPoint) {
 		std::cout << " Label of point with ext. seed: " << externalPoint
@@ -1149,26 +1428,26 @@ void GblTrajectory::printTrajectory(unsigned int level) {
 		if (numInnerTrans) {
 			std::cout << " Inner transformations" << std::endl;
 			for (unsigned int i = 0; i < numInnerTrans; ++i) {
-				innerTransformations[i].Print();
+				std::cout << innerTransformations[i] << std::endl;
 			}
 		}
-		if (externalMeasurements.GetNrows()) {
+		if (externalMeasurements.rows()) {
 			std::cout << " External measurements" << std::endl;
 			std::cout << "  Measurements:" << std::endl;
-			externalMeasurements.Print();
+			std::cout << externalMeasurements.transpose() << std::endl;
 			std::cout << "  Precisions:" << std::endl;
-			externalPrecisions.Print();
+			std::cout << externalPrecisions.transpose() << std::endl;
 			std::cout << "  Derivatives:" << std::endl;
-			externalDerivatives.Print();
+			std::cout << externalDerivatives << std::endl;
 		}
 		if (externalPoint) {
 			std::cout << " External seed:" << std::endl;
-			externalSeed.Print();
+			std::cout << externalSeed << std::endl;
 		}
 		if (fitOK) {
 			std::cout << " Fit results" << std::endl;
 			std::cout << "  Parameters:" << std::endl;
-			theVector.print();
+			std::cout << theVector.transpose() << std::endl;
 			std::cout << "  Covariance matrix (bordered band part):"
 					<< std::endl;
 			theMatrix.printMatrix();
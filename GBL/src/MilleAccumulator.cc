@@ -0,0 +1,347 @@
+/*
+ * MilleAccumulator.cc
+ *
+ *  This file is part of GENFIT.
+ *
+ *  GENFIT is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published
+ *  by the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  GENFIT is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file
+ *  MilleAccumulator methods.
+ */
+
+#include "MilleAccumulator.h"
+#include "GblTrajectory.h"
+
+#include <Eigen/SparseCore>
+#include <Eigen/SparseCholesky>
+
+//! Namespace for the general broken lines package
+namespace gbl {
+
+namespace {
+/// Key of matrix element (upper triangle)
+inline unsigned long long matrixKey(unsigned int aRow, unsigned int aCol) {
+	return (static_cast<unsigned long long>(aRow) << 32) | aCol;
+}
+}
+
+/// Create empty accumulator.
+MilleAccumulator::MilleAccumulator() :
+		numRecords(0), numRejected(0), sumChi2(0.), sumNdf(0), labelToIndex(), indexToLabel(), theVector(), theMatrix(), workRecord(
+				true), workGlobalLabel(), workGlobalIndex(), workPosition(), workLocalMatrix(), workMixedMatrix(), workGlobalMatrix(), workLocalVector(), workGlobalVector() {
+}
+
+MilleAccumulator::~MilleAccumulator() {
+}
+
+/// Add (local fit of) record to normal equations.
+/**
+ * \param [in] aRecord Record (as for Millepede-II binary file)
+ * \return error code (0: OK, 1: broken record, 2: bad error, 3: singular local fit)
+ */
+unsigned int MilleAccumulator::addRecord(const MilleRecord &aRecord) {
+	if (aRecord.isEmpty())
+		return 0;
+	const unsigned int ierr =
+			aRecord.doublePrecision ?
+					addRecordData(aRecord.doubleBuffer, aRecord.intBuffer) :
+					addRecordData(aRecord.floatBuffer, aRecord.intBuffer);
+	if (ierr)
+		numRejected++;
+	else
+		numRecords++;
+	return ierr;
+}
+
+/// Add (local fit of) valid trajectory to normal equations.
+/**
+ * \param [in] aTrajectory Trajectory (fitted or not)
+ * \return error code (see \link addRecord \endlink)
+ */
+unsigned int MilleAccumulator::addTrajectory(GblTrajectory &aTrajectory) {
+	aTrajectory.milleOut(workRecord);
+	return addRecord(workRecord);
+}
+
+/// Add other accumulator (e.g. partial sums of other thread).
+/**
+ * \param [in] anAccumulator Accumulator to add
+ */
+void MilleAccumulator::merge(const MilleAccumulator &anAccumulator) {
+	std::vector<unsigned int> otherToIndex(anAccumulator.indexToLabel.size());
+	for (unsigned int i = 0; i < anAccumulator.indexToLabel.size(); ++i) {
+		otherToIndex[i] = getIndex(anAccumulator.indexToLabel[i]);
+		theVector[otherToIndex[i]] += anAccumulator.theVector[i];
+	}
+	std::unordered_map<unsigned long long, double>::const_iterator itMatrix;
+	for (itMatrix = anAccumulator.theMatrix.begin();
+			itMatrix != anAccumulator.theMatrix.end(); ++itMatrix) {
+		const unsigned int iRow = otherToIndex[itMatrix->first >> 32];
+		const unsigned int iCol = otherToIndex[itMatrix->first & 0xFFFFFFFFu];
+		addToMatrix(iRow, iCol, itMatrix->second);
+	}
+	numRecords += anAccumulator.numRecords;
+	numRejected += anAccumulator.numRejected;
+	sumChi2 += anAccumulator.sumChi2;
+	sumNdf += anAccumulator.sumNdf;
+}
+
+/// Remove all accumulated data (e.g. for next alignment iteration).
+void MilleAccumulator::clear() {
+	numRecords = 0;
+	numRejected = 0;
+	sumChi2 = 0.;
+	sumNdf = 0;
+	labelToIndex.clear();
+	indexToLabel.clear();
+	theVector.clear();
+	theMatrix.clear();
+}
+
+/// Solve normal equations for correction of global parameters.
+/**
+ * The sparse symmetric matrix is decomposed (LDL^T). Parameters without
+ * any (diagonal) contribution are not determined (zero correction).
+ * Undefined linear combinations (e.g. global shifts) have to be fixed by
+ * the regularization (added to all diagonal elements).
+ * \param [out] aCorrection Correction for all global parameters (by label)
+ * \param [in] aRegularization Value added to diagonal
+ * \return error code (0: OK, 1: decomposition failed)
+ */
+unsigned int MilleAccumulator::solve(std::map<int, double> &aCorrection,
+		double aRegularization) const {
+	aCorrection.clear();
+	const unsigned int nPar = indexToLabel.size();
+	if (!nPar)
+		return 0;
+
+	VectorDynamic diagonal = VectorDynamic::Zero(nPar);
+	std::vector<Eigen::Triplet<double> > elements;
+	elements.reserve(theMatrix.size() + nPar);
+	std::unordered_map<unsigned long long, double>::const_iterator itMatrix;
+	for (itMatrix = theMatrix.begin(); itMatrix != theMatrix.end(); ++itMatrix) {
+		const unsigned int iRow = itMatrix->first >> 32;
+		const unsigned int iCol = itMatrix->first & 0xFFFFFFFFu;
+		if (iRow == iCol)
+			diagonal(iRow) = itMatrix->second;
+		else
+			elements.push_back(
+					Eigen::Triplet<double>(iRow, iCol, itMatrix->second));
+	}
+	for (unsigned int i = 0; i < nPar; ++i)
+		elements.push_back(
+				Eigen::Triplet<double>(i, i,
+						(diagonal(i) != 0.) ?
+								diagonal(i) + aRegularization : 1.));
+	Eigen::SparseMatrix<double> matrix(nPar, nPar);
+	matrix.setFromTriplets(elements.begin(), elements.end());
+
+	Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>, Eigen::Upper> solver(
+			matrix);
+	if (solver.info() != Eigen::Success)
+		return 1;
+	const VectorDynamic rhs = Eigen::Map<const VectorDynamic>(&theVector[0],
+			nPar);
+	const VectorDynamic solution = solver.solve(rhs);
+	if (solver.info() != Eigen::Success)
+		return 1;
+
+	for (unsigned int i = 0; i < nPar; ++i)
+		aCorrection[indexToLabel[i]] = (diagonal(i) != 0.) ? solution(i) : 0.;
+	return 0;
+}
+
+/// Get number of accumulated records.
+unsigned int MilleAccumulator::getNumRecords() const {
+	return numRecords;
+}
+
+/// Get number of rejected records.
+unsigned int MilleAccumulator::getNumRejected() const {
+	return numRejected;
+}
+
+/// Get number of global parameters.
+unsigned int MilleAccumulator::getNumParameters() const {
+	return indexToLabel.size();
+}
+
+/// Get sum of Chi2 of local fits.
+double MilleAccumulator::getChi2() const {
+	return sumChi2;
+}
+
+/// Get sum of degrees of freedom of local fits.
+int MilleAccumulator::getNdf() const {
+	return sumNdf;
+}
+
+/// Get index of global parameter (create new one for new label).
+/**
+ * \param [in] aLabel Label
+ * \return index
+ */
+unsigned int MilleAccumulator::getIndex(int aLabel) {
+	std::map<int, unsigned int>::iterator itLabel = labelToIndex.find(aLabel);
+	if (itLabel != labelToIndex.end())
+		return itLabel->second;
+	const unsigned int index = indexToLabel.size();
+	labelToIndex[aLabel] = index;
+	indexToLabel.push_back(aLabel);
+	theVector.push_back(0.);
+	return index;
+}
+
+/// Add to (symmetric) matrix element.
+/**
+ * \param [in] aRow Row index
+ * \param [in] aCol Column index
+ * \param [in] aValue Value to add
+ */
+void MilleAccumulator::addToMatrix(unsigned int aRow, unsigned int aCol,
+		double aValue) {
+	theMatrix[aRow <= aCol ? matrixKey(aRow, aCol) : matrixKey(aCol, aRow)] +=
+			aValue;
+}
+
+/// Add (local fit of) record data to normal equations.
+/**
+ * First pass determines the local and global parameters, second pass
+ * accumulates the local normal equations of the record. Then the local
+ * parameters are eliminated. Global parameters are only created for
+ * accepted records.
+ *
+ * \param [in] realData Real array of record
+ * \param [in] intData Integer array of record
+ * \return error code
+ */
+template<typename Real>
+unsigned int MilleAccumulator::addRecordData(const std::vector<Real> &realData,
+		const std::vector<int> &intData) {
+	const unsigned int nData = intData.size();
+	unsigned int nLocal = 0, nMeas = 0;
+	double sumWeightedSquares = 0.;
+	workGlobalLabel.clear();
+	workPosition.assign(nData, 0);
+
+	for (unsigned int iPass = 0; iPass < 2; ++iPass) {
+		unsigned int i = 1;
+		while (i < nData) {
+			// measured value, local derivatives, error, global derivatives
+			const double aMeas = realData[i];
+			const unsigned int firstLocal = ++i;
+			while (i < nData and intData[i] != 0)
+				++i;
+			const unsigned int endLocal = i;
+			if (i >= nData)
+				return 1;
+			const double aErr = realData[i];
+			const unsigned int firstGlobal = ++i;
+			while (i < nData and intData[i] != 0)
+				++i;
+			const unsigned int endGlobal = i;
+
+			if (iPass == 0) {
+				if (aErr <= 0.)
+					return 2;
+				nMeas++;
+				for (unsigned int k = firstLocal; k < endLocal; ++k)
+					if (static_cast<unsigned int>(intData[k]) > nLocal)
+						nLocal = intData[k];
+				for (unsigned int k = firstGlobal; k < endGlobal; ++k) {
+					if (realData[k] == 0.)
+						continue;
+					unsigned int iPos = 0;
+					while (iPos < workGlobalLabel.size()
+							and workGlobalLabel[iPos] != intData[k])
+						++iPos;
+					if (iPos == workGlobalLabel.size())
+						workGlobalLabel.push_back(intData[k]);
+					workPosition[k] = iPos;
+				}
+				continue;
+			}
+
+			const double aWeight = 1. / (aErr * aErr);
+			sumWeightedSquares += aWeight * aMeas * aMeas;
+			for (unsigned int k = firstLocal; k < endLocal; ++k) {
+				const unsigned int iLocal = intData[k] - 1;
+				const double wDer = aWeight * realData[k];
+				workLocalVector(iLocal) += wDer * aMeas;
+				for (unsigned int l = firstLocal; l < endLocal; ++l)
+					workLocalMatrix(iLocal, intData[l] - 1) += wDer
+							* realData[l];
+				for (unsigned int l = firstGlobal; l < endGlobal; ++l)
+					if (realData[l] != 0.)
+						workMixedMatrix(iLocal, workPosition[l]) += wDer
+								* realData[l];
+			}
+			for (unsigned int k = firstGlobal; k < endGlobal; ++k) {
+				if (realData[k] == 0.)
+					continue;
+				const unsigned int iPos = workPosition[k];
+				const double wDer = aWeight * realData[k];
+				workGlobalVector(iPos) += wDer * aMeas;
+				for (unsigned int l = firstGlobal; l < endGlobal; ++l)
+					if (realData[l] != 0.)
+						workGlobalMatrix(iPos, workPosition[l]) += wDer
+								* realData[l];
+			}
+		}
+
+		if (iPass == 0) {
+			const unsigned int nGlobal = workGlobalLabel.size();
+			workLocalMatrix.setZero(nLocal, nLocal);
+			workMixedMatrix.setZero(nLocal, nGlobal);
+			workGlobalMatrix.setZero(nGlobal, nGlobal);
+			workLocalVector.setZero(nLocal);
+			workGlobalVector.setZero(nGlobal);
+		}
+	}
+
+	// local fit, unused local parameters are fixed
+	unsigned int nUsed = 0;
+	for (unsigned int i = 0; i < nLocal; ++i) {
+		if (workLocalMatrix(i, i) != 0.)
+			nUsed++;
+		else
+			workLocalMatrix(i, i) = 1.;
+	}
+	Eigen::LLT<MatrixDynamic> localFit(workLocalMatrix);
+	if (localFit.info() != Eigen::Success)
+		return 3;
+	const VectorDynamic localSolution = localFit.solve(workLocalVector);
+	sumChi2 += sumWeightedSquares - workLocalVector.dot(localSolution);
+	sumNdf += nMeas - nUsed;
+
+	// elimination of local parameters
+	const MatrixDynamic mixedSolution = localFit.solve(workMixedMatrix);
+	workGlobalMatrix.noalias() -= workMixedMatrix.transpose() * mixedSolution;
+	workGlobalVector.noalias() -= workMixedMatrix.transpose() * localSolution;
+
+	// record accepted, create new global parameters
+	workGlobalIndex.resize(workGlobalLabel.size());
+	for (unsigned int i = 0; i < workGlobalLabel.size(); ++i)
+		workGlobalIndex[i] = getIndex(workGlobalLabel[i]);
+	for (unsigned int i = 0; i < workGlobalIndex.size(); ++i) {
+		theVector[workGlobalIndex[i]] += workGlobalVector(i);
+		for (unsigned int j = i; j < workGlobalIndex.size(); ++j)
+			addToMatrix(workGlobalIndex[i], workGlobalIndex[j],
+					workGlobalMatrix(i, j));
+	}
+	return 0;
+}
+
+}
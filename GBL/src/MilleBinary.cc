@@ -29,19 +29,26 @@
 
 #include "MilleBinary.h"
 
+#include <iostream>
+#ifdef GBL_USE_ZLIB
+#include <zlib.h>
+#endif
+
 //! Namespace for the general broken lines package
 namespace gbl {
 
-/// Create binary file.
+namespace {
+/// Block size for (background) output, full buffers are written in multiples of it
+const size_t blockSize = 4096;
+}
+
+/// Create (empty) record.
 /**
- * \param [in] fileName File name
  * \param [in] doublePrec Flag for storage as double values
  * \param [in] aSize Buffer size
  */
-MilleBinary::MilleBinary(const std::string fileName, bool doublePrec,
-		unsigned int aSize) :
-		binaryFile(fileName.c_str(), std::ios::binary | std::ios::out), intBuffer(), floatBuffer(), doubleBuffer(), doublePrecision(
-				doublePrec) {
+MilleRecord::MilleRecord(bool doublePrec, unsigned int aSize) :
+		intBuffer(), floatBuffer(), doubleBuffer(), doublePrecision(doublePrec) {
 	intBuffer.reserve(aSize);
 	intBuffer.push_back(0); // first word is error counter
 	if (doublePrecision) {
@@ -54,29 +61,29 @@ MilleBinary::MilleBinary(const std::string fileName, bool doublePrec,
 	}
 }
 
-MilleBinary::~MilleBinary() {
-	binaryFile.close();
+MilleRecord::~MilleRecord() {
 }
 
 /// Add data block to (end of) record.
 /**
  * \param [in] aMeas Value
  * \param [in] aErr Error
+ * \param [in] numLocal Number of local labels/derivatives
  * \param [in] indLocal List of labels of local parameters
  * \param [in] derLocal List of derivatives for local parameters
  * \param [in] labGlobal List of labels of global parameters
  * \param [in] derGlobal List of derivatives for global parameters
  */
-void MilleBinary::addData(double aMeas, double aErr,
-		const std::vector<unsigned int> &indLocal,
-		const std::vector<double> &derLocal, const std::vector<int> &labGlobal,
+void MilleRecord::addData(double aMeas, double aErr, unsigned int numLocal,
+		const unsigned int* indLocal, const double* derLocal,
+		const std::vector<int> &labGlobal,
 		const std::vector<double> &derGlobal) {
 
 	if (doublePrecision) {
 		// double values
 		intBuffer.push_back(0);
 		doubleBuffer.push_back(aMeas);
-		for (unsigned int i = 0; i < indLocal.size(); ++i) {
+		for (unsigned int i = 0; i < numLocal; ++i) {
 			intBuffer.push_back(indLocal[i]);
 			doubleBuffer.push_back(derLocal[i]);
 		}
@@ -92,7 +99,7 @@ void MilleBinary::addData(double aMeas, double aErr,
 		// float values
 		intBuffer.push_back(0);
 		floatBuffer.push_back(aMeas);
-		for (unsigned int i = 0; i < indLocal.size(); ++i) {
+		for (unsigned int i = 0; i < numLocal; ++i) {
 			intBuffer.push_back(indLocal[i]);
 			floatBuffer.push_back(derLocal[i]);
 		}
@@ -107,26 +114,219 @@ void MilleBinary::addData(double aMeas, double aErr,
 	}
 }
 
-/// Write record to file.
-void MilleBinary::writeRecord() {
-
-	const int recordLength =
-			(doublePrecision) ? -intBuffer.size() * 2 : intBuffer.size() * 2;
-	binaryFile.write(reinterpret_cast<const char*>(&recordLength),
-			sizeof(recordLength));
-	if (doublePrecision)
-		binaryFile.write(reinterpret_cast<char*>(&doubleBuffer[0]),
-				doubleBuffer.size() * sizeof(doubleBuffer[0]));
-	else
-		binaryFile.write(reinterpret_cast<char*>(&floatBuffer[0]),
-				floatBuffer.size() * sizeof(floatBuffer[0]));
-	binaryFile.write(reinterpret_cast<char*>(&intBuffer[0]),
-			intBuffer.size() * sizeof(intBuffer[0]));
-// start with new record
+/// Start new (empty) record (buffers keep their capacity).
+void MilleRecord::clear() {
 	intBuffer.resize(1);
 	if (doublePrecision)
 		doubleBuffer.resize(1);
 	else
 		floatBuffer.resize(1);
 }
+
+/// Check for empty record (no data blocks).
+bool MilleRecord::isEmpty() const {
+	return intBuffer.size() <= 1;
+}
+
+/// Check for storage as double values.
+bool MilleRecord::isDoublePrecision() const {
+	return doublePrecision;
+}
+
+/// Create binary file.
+/**
+ * \param [in] fileName File name (compressed output for ".gz", if available)
+ * \param [in] doublePrec Flag for storage as double values
+ * \param [in] aSize Buffer size (of record)
+ * \param [in] aBufferSize Size of output buffer (0: write records synchronously)
+ */
+MilleBinary::MilleBinary(const std::string fileName, bool doublePrec,
+		unsigned int aSize, unsigned int aBufferSize) :
+		binaryFile(), compressedFile(0), theRecord(doublePrec, aSize), bufferSize(
+				aBufferSize), fillBuffer(), writeBuffer(), writePending(false), stopWriter(
+				false), bufferMutex(), bufferCondition(), writerThread() {
+	const bool compress = fileName.size() > 3
+			and fileName.compare(fileName.size() - 3, 3, ".gz") == 0;
+	if (compress) {
+#ifdef GBL_USE_ZLIB
+		compressedFile = gzopen(fileName.c_str(), "wb");
+#else
+		std::cout << " MilleBinary: no zlib support, " << fileName
+				<< " written uncompressed" << std::endl;
+#endif
+	}
+	if (!compressedFile)
+		binaryFile.open(fileName.c_str(), std::ios::binary | std::ios::out);
+	if (bufferSize) {
+		fillBuffer.reserve(bufferSize);
+		writeBuffer.reserve(bufferSize);
+		writerThread = std::thread(&MilleBinary::writerLoop, this);
+	}
+}
+
+MilleBinary::~MilleBinary() {
+	if (writerThread.joinable()) {
+		std::unique_lock<std::mutex> lock(bufferMutex);
+		handOver(lock, true);
+		bufferCondition.wait(lock, [this] {return !writePending;});
+		stopWriter = true;
+		lock.unlock();
+		bufferCondition.notify_all();
+		writerThread.join();
+	}
+#ifdef GBL_USE_ZLIB
+	if (compressedFile)
+		gzclose(compressedFile);
+#endif
+	binaryFile.close();
+}
+
+/// Add data block to (end of) current record.
+/**
+ * \param [in] aMeas Value
+ * \param [in] aErr Error
+ * \param [in] numLocal Number of local labels/derivatives
+ * \param [in] indLocal List of labels of local parameters
+ * \param [in] derLocal List of derivatives for local parameters
+ * \param [in] labGlobal List of labels of global parameters
+ * \param [in] derGlobal List of derivatives for global parameters
+ */
+void MilleBinary::addData(double aMeas, double aErr, unsigned int numLocal,
+		const unsigned int* indLocal, const double* derLocal,
+		const std::vector<int> &labGlobal,
+		const std::vector<double> &derGlobal) {
+	theRecord.addData(aMeas, aErr, numLocal, indLocal, derLocal, labGlobal,
+			derGlobal);
+}
+
+/// Write current record to file.
+void MilleBinary::writeRecord() {
+	writeRecord(theRecord);
+// start with new record
+	theRecord.clear();
+}
+
+/// Write record to file.
+/**
+ * The record is copied to the output buffer (or written directly
+ * without output buffer). Can be called from several threads.
+ * \param [in] aRecord Record to write
+ */
+void MilleBinary::writeRecord(const MilleRecord &aRecord) {
+	std::unique_lock<std::mutex> lock(bufferMutex);
+	appendRecord(aRecord);
+	if (!bufferSize) {
+		writeBlock(fillBuffer);
+		fillBuffer.clear();
+	} else if (fillBuffer.size() >= bufferSize) {
+		handOver(lock, false);
+	}
+}
+
+/// Write all buffered records to file.
+void MilleBinary::flush() {
+	std::unique_lock<std::mutex> lock(bufferMutex);
+	if (bufferSize) {
+		handOver(lock, true);
+		bufferCondition.wait(lock, [this] {return !writePending;});
+	}
+#ifdef GBL_USE_ZLIB
+	if (compressedFile)
+		gzflush(compressedFile, Z_SYNC_FLUSH);
+#endif
+	if (!compressedFile)
+		binaryFile.flush();
+}
+
+/// Check for storage as double values.
+bool MilleBinary::isDoublePrecision() const {
+	return theRecord.isDoublePrecision();
+}
+
+/// Append record to output buffer (with locked buffer).
+/**
+ * \param [in] aRecord Record to append
+ */
+void MilleBinary::appendRecord(const MilleRecord &aRecord) {
+	const int recordLength =
+			(aRecord.doublePrecision) ?
+					-aRecord.intBuffer.size() * 2 :
+					aRecord.intBuffer.size() * 2;
+	const char* realData =
+			(aRecord.doublePrecision) ?
+					reinterpret_cast<const char*>(&aRecord.doubleBuffer[0]) :
+					reinterpret_cast<const char*>(&aRecord.floatBuffer[0]);
+	const size_t realSize =
+			(aRecord.doublePrecision) ?
+					aRecord.doubleBuffer.size()
+							* sizeof(aRecord.doubleBuffer[0]) :
+					aRecord.floatBuffer.size() * sizeof(aRecord.floatBuffer[0]);
+	const char* intData = reinterpret_cast<const char*>(&aRecord.intBuffer[0]);
+	const size_t intSize = aRecord.intBuffer.size()
+			* sizeof(aRecord.intBuffer[0]);
+
+	fillBuffer.insert(fillBuffer.end(),
+			reinterpret_cast<const char*>(&recordLength),
+			reinterpret_cast<const char*>(&recordLength)
+					+ sizeof(recordLength));
+	fillBuffer.insert(fillBuffer.end(), realData, realData + realSize);
+	fillBuffer.insert(fillBuffer.end(), intData, intData + intSize);
+}
+
+/// Hand over filled output buffer to background thread (with locked buffer).
+/**
+ * Waits for the previous output to finish. Unless complete output is
+ * requested only a multiple of the block size is handed over, the rest
+ * stays in the fill buffer.
+ * \param [in] aLock Lock of buffer mutex
+ * \param [in] complete Hand over all (e.g. for final output)
+ */
+void MilleBinary::handOver(std::unique_lock<std::mutex> &aLock,
+		bool complete) {
+	bufferCondition.wait(aLock, [this] {return !writePending;});
+	const size_t handOverSize =
+			complete ?
+					fillBuffer.size() :
+					fillBuffer.size() - fillBuffer.size() % blockSize;
+	if (!handOverSize)
+		return;
+	fillBuffer.swap(writeBuffer);
+	fillBuffer.assign(writeBuffer.begin() + handOverSize, writeBuffer.end());
+	writeBuffer.resize(handOverSize);
+	writePending = true;
+	bufferCondition.notify_all();
+}
+
+/// Write block of data to file.
+/**
+ * \param [in] aBlock Data to write
+ */
+void MilleBinary::writeBlock(const std::vector<char> &aBlock) {
+	if (aBlock.empty())
+		return;
+#ifdef GBL_USE_ZLIB
+	if (compressedFile) {
+		gzwrite(compressedFile, &aBlock[0], aBlock.size());
+		return;
+	}
+#endif
+	binaryFile.write(&aBlock[0], aBlock.size());
+}
+
+/// Background thread: write handed over buffers to file.
+void MilleBinary::writerLoop() {
+	std::unique_lock<std::mutex> lock(bufferMutex);
+	while (true) {
+		bufferCondition.wait(lock, [this] {return writePending or stopWriter;});
+		if (!writePending)
+			break;
+		// write without lock, new records are collected meanwhile in fill buffer
+		lock.unlock();
+		writeBlock(writeBuffer);
+		writeBuffer.clear();
+		lock.lock();
+		writePending = false;
+		bufferCondition.notify_all();
+	}
+}
 }
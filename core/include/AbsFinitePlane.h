@@ -51,6 +51,15 @@ class AbsFinitePlane {
   //! in child class.
   virtual bool isInActive(double u, double v) const = 0;
 
+  /**
+   * @brief Test n points (u[i], v[i]) at once, inActive[i] is set to isInActive(u[i], v[i]).
+   *
+   * Only one virtual call for all points; the shapes implement the loop in isInActiveBatch.
+   */
+  void areInActive(const double* u, const double* v, unsigned int n, bool* inActive) const {
+    isInActiveBatch(u, v, n, inActive);
+  }
+
   //! Deep copy ctor for polymorphic class.
   virtual AbsFinitePlane* clone() const = 0;
 
@@ -59,6 +68,12 @@ class AbsFinitePlane {
 
  protected:
 
+  //! Loop of areInActive; shapes should override it with a loop that does not call virtual functions.
+  virtual void isInActiveBatch(const double* u, const double* v, unsigned int n, bool* inActive) const {
+    for (unsigned int i = 0; i < n; ++i)
+      inActive[i] = isInActive(u[i], v[i]);
+  }
+
   // protect from calling copy c'tor or assignment operator from outside the class. Use #clone() if you want a copy!
   AbsFinitePlane(const AbsFinitePlane&) {;}
   AbsFinitePlane& operator=(const AbsFinitePlane&);
@@ -0,0 +1,133 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @addtogroup genfit
+ * @{
+ */
+
+#ifndef genfit_CachedTrajectory_h
+#define genfit_CachedTrajectory_h
+
+#include "EigenMatrixTypedefs.h"
+#include "MeasuredStateOnPlane.h"
+#include "SharedPlanePtr.h"
+
+#include <TVector3.h>
+
+#include <vector>
+
+
+namespace genfit {
+
+class Track;
+
+/**
+ * @brief Sampled trajectory of a fitted track for repeated queries.
+ *
+ * The fitted states of a track are transported to the next fitted state in steps of
+ * maxStep (the last step of each segment can be shorter); each step is stored as a node (track length, position, direction, momentum and the
+ * transported MeasuredStateOnPlane). Between the nodes the position is a cubic Hermite interpolation
+ * of positions and directions.
+ *
+ * Position and momentum queries are a binary search in the track length and need no extrapolation.
+ * States on planes, at points or at a given track length are obtained by a short extrapolation
+ * with the track representation from the nearest node before, so they are exact (with covariance)
+ * but only integrate over at most one step.
+ *
+ * Track lengths are counted from the first fitted state.
+ */
+class CachedTrajectory {
+
+ public:
+
+  CachedTrajectory();
+
+  //! Maximum distance between nodes (cm), default 5 cm
+  void setMaxStep(double step);
+  double getMaxStep() const {return maxStep_;}
+
+  //! Sample the fitted states (biased) of the track (default: cardinal representation).
+  void build(const Track& track, const AbsTrackRep* rep = nullptr);
+  //! Sample the trajectory through the states (same track representation, in the order of the track).
+  void build(const std::vector<const MeasuredStateOnPlane*>& states);
+  void clear();
+
+  unsigned int getNNodes() const {return length_.size();}
+  double getStartLength() const {return length_.front();}
+  double getEndLength() const {return length_.back();}
+
+  //! Interpolated position at track length s
+  TVector3 getPos(double s) const;
+  //! Interpolated position and momentum at track length s
+  void getPosMom(double s, TVector3& pos, TVector3& mom) const;
+
+  /**
+   * @brief Point of closest approach of the interpolated trajectory to point.
+   *
+   * Bisection of the nodes, O(log n). For trajectories that pass the point several times
+   * (loopers) this is a local minimum of the distance.
+   *
+   * @return track length of the POCA
+   */
+  double getPOCA(const TVector3& point, TVector3& poca) const;
+
+  //! State at track length s, extrapolated from the nearest node.
+  MeasuredStateOnPlane getState(double s) const;
+
+  /**
+   * @brief State on the first plane crossed by the trajectory, extrapolated from the node before.
+   *
+   * @return track length of the crossing
+   */
+  double extrapolateToPlane(const SharedPlanePtr& plane, MeasuredStateOnPlane& state) const;
+
+  /**
+   * @brief State at the POCA to point, extrapolated from the nearest node.
+   *
+   * @return track length of the POCA
+   */
+  double extrapolateToPoint(const TVector3& point, MeasuredStateOnPlane& state) const;
+
+ private:
+
+  void checkBuilt(const char* method) const;
+  void addNode(double s, const MeasuredStateOnPlane& state);
+  //! Index of the node at or before s (clamped to the nodes)
+  unsigned int findNode(double s) const;
+  //! Hermite interpolation in the segment after node
+  void interpolate(unsigned int node, double s, Vector3& pos, Vector3& dir) const;
+  //! Is the point ahead of the node (in direction of the track)
+  bool isAhead(unsigned int node, const Vector3& point) const;
+  //! Distance squared of the point to the segment after node, minimized in s
+  double closestInSegment(unsigned int node, const Vector3& point, double& s) const;
+
+  double maxStep_;
+
+  // nodes
+  std::vector<double> length_;
+  std::vector<Vector3> pos_;
+  std::vector<Vector3> dir_;
+  std::vector<double> mom_;
+  std::vector<MeasuredStateOnPlane> states_;
+
+};
+
+} /* End of namespace genfit */
+/** @} */
+
+#endif // genfit_CachedTrajectory_h
@@ -36,6 +36,7 @@
 #include <TObject.h>
 #include <TVector3.h>
 
+#include <algorithm>
 #include <memory>
 
 
@@ -166,6 +167,15 @@ class DetPlane : public TObject {
     return isInActive(v.X(),v.Y());
   }
 
+  //! Test n points (u[i], v[i]) at once, c.f. AbsFinitePlane::areInActive. All points are active without finite plane.
+  void areInActive(const double* u, const double* v, unsigned int n, bool* inActive) const{
+    if(finitePlane_.get() == nullptr) {
+      std::fill(inActive, inActive + n, true);
+      return;
+    }
+    finitePlane_->areInActive(u, v, n, inActive);
+  }
+
   bool isFinite() const {
     return (finitePlane_.get() != nullptr);
   }
@@ -7,20 +7,36 @@ namespace genfit {
 
     typedef Precision Scalar;
 
+    typedef Eigen::Matrix<Precision, 2, 1> Vector2;
     typedef Eigen::Matrix<Precision, 3, 1> Vector3;
     typedef Eigen::Matrix<Precision, 5, 1> Vector5;
     typedef Eigen::Matrix<Precision, 6, 1> Vector6;
     typedef Eigen::Matrix<Precision, 7, 1> Vector7;
 
+    typedef Eigen::Matrix<Precision, 2, 2> Matrix2x2;
     typedef Eigen::Matrix<Precision, 3, 3> Matrix3x3;
     typedef Eigen::Matrix<Precision, 4, 4> Matrix4x4;
     typedef Eigen::Matrix<Precision, 5, 5> Matrix5x5;
     typedef Eigen::Matrix<Precision, 6, 6> Matrix6x6;
     typedef Eigen::Matrix<Precision, 7, 7> Matrix7x7;
 
+    typedef Eigen::Matrix<Precision, 2, 3> Matrix2x3;
+    typedef Eigen::Matrix<Precision, 2, 5> Matrix2x5;
+    typedef Eigen::Matrix<Precision, 2, 7> Matrix2x7;
+    typedef Eigen::Matrix<Precision, 3, 2> Matrix3x2;
+    typedef Eigen::Matrix<Precision, 3, 5> Matrix3x5;
+    typedef Eigen::Matrix<Precision, 5, 3> Matrix5x3;
+
     typedef Eigen::Matrix<Precision, Eigen::Dynamic, 1> VectorDynamic;
     typedef Eigen::Matrix<Precision, Eigen::Dynamic, Eigen::Dynamic> MatrixDynamic;
 
+    /// Maximal number of calibration parameters of one measurement (see CalibrationDerivatives)
+    const int maxCalibrationParameters = 32;
+    /// Derivatives of (up to 5D) residuals w.r.t. calibration parameters, fixed capacity (no heap allocation)
+    typedef Eigen::Matrix<Precision, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor | Eigen::DontAlign, 5, maxCalibrationParameters> CalibrationDerivatives;
+    /// Labels of calibration parameters, fixed capacity (no heap allocation)
+    typedef Eigen::Matrix<int, Eigen::Dynamic, 1, Eigen::ColMajor | Eigen::DontAlign, maxCalibrationParameters, 1> CalibrationLabels;
+
     typedef Matrix3x3 Matrix3x3Sym;
     typedef Matrix4x4 Matrix4x4Sym;
     typedef Matrix5x5 Matrix5x5Sym;
@@ -83,7 +83,7 @@ class FitStatus {
 
   FitStatus() :
     isFitted_(false), isFitConvergedFully_(false), isFitConvergedPartially_(false), nFailedPoints_(0),
-    trackHasChanged_(false), pruneFlags_(), charge_(0), chi2_(-1e99), ndf_(-1e99)
+    trackHasChanged_(false), pruneFlags_(), charge_(0), chi2_(-1e99), ndf_(-1e99), pVal_(-1.)
   {;}
 
   virtual ~FitStatus() {};
@@ -124,8 +124,13 @@ class FitStatus {
    * @brief Get the p value of the fit.
    *
    * Virtual, because the fitter may use a different probability distribution.
+   * Calculated on the first call after chi^2 or ndf have been set.
    */
-  virtual double getPVal() const {return std::max(0.,ROOT::Math::chisquared_cdf_c(chi2_, ndf_));}
+  virtual double getPVal() const {
+    if (pVal_ < 0)
+      pVal_ = std::max(0.,ROOT::Math::chisquared_cdf_c(chi2_, ndf_));
+    return pVal_;
+  }
 
   void setIsFitted(bool fitted = true) {isFitted_ = fitted;}
   void setIsFitConvergedFully(bool fitConverged = true) {isFitConvergedFully_ = fitConverged;}
@@ -136,8 +141,8 @@ class FitStatus {
 
   PruneFlags& getPruneFlags() {return pruneFlags_;}
 
-  void setChi2(const double& chi2) {chi2_ = chi2;}
-  void setNdf(const double& ndf) {ndf_ = ndf;}
+  void setChi2(const double& chi2) {chi2_ = chi2; pVal_ = -1.;}
+  void setNdf(const double& ndf) {ndf_ = ndf; pVal_ = -1.;}
 
   virtual void Print(const Option_t* = "") const;
 
@@ -162,6 +167,8 @@ class FitStatus {
   //! For the Kalman-derived fitters in particular, this corresponds to the backwards fit.
   double chi2_;
   double ndf_;
+  //! p value of chi2_ and ndf_, negative if not calculated yet
+  mutable double pVal_; //!
 
   ClassDef(FitStatus, 3);
 };
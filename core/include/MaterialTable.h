@@ -0,0 +1,106 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @addtogroup genfit
+ * @{
+ */
+
+#ifndef genfit_MaterialTable_h
+#define genfit_MaterialTable_h
+
+#include "Material.h"
+
+#include <deque>
+#include <unordered_map>
+
+
+namespace genfit {
+
+//! Index of a Material in the MaterialTable
+typedef unsigned int MaterialId;
+
+/**
+ * @brief Material with constants derived from it, precomputed once per material.
+ */
+struct MaterialConstants {
+
+  explicit MaterialConstants(const Material& mat);
+
+  Material material_;
+  bool isVacuum_; // Z <= 1E-3, no energy loss
+  double zOverADensity_; // Z / A * density
+  double logMEE_; // log of the mean excitation energy in MeV
+  double invRadiationLength_; // 1 / radiation length
+  double coulombFactor_; // Z/(Z+1) * ln(159*Z^(-1/3)) / ln(287*Z^(-1/2))
+  // energy loss fluctuations, Urban model (GEANT 3)
+  double urbanI_; // eV
+  double urbanF1_;
+  double urbanF2_;
+  double urbanE1_; // eV
+  double urbanE2_; // eV
+
+};
+
+
+/**
+ * @brief Table of all materials seen by the extrapolation, each stored once.
+ *
+ * Materials are referred to by a small MaterialId, so boundary checks and cached
+ * steps compare and store integers instead of five doubles. Entries are never removed,
+ * ids stay valid for the lifetime of the table. Id 0 is vacuum (Material()).
+ *
+ * Like the MaterialEffects, the table is not thread safe for interning.
+ */
+class MaterialTable {
+
+ public:
+
+  static MaterialTable* getInstance();
+  static void destruct();
+
+  static const MaterialId vacuumId = 0;
+
+  //! Id of the material; adds it to the table if it is not known yet.
+  MaterialId intern(const Material& material);
+
+  const Material& getMaterial(MaterialId id) const {return constants_[id].material_;}
+  const MaterialConstants& getConstants(MaterialId id) const {return constants_[id];}
+  unsigned int getNMaterials() const {return constants_.size();}
+
+ private:
+
+  MaterialTable();
+  MaterialTable(const MaterialTable&);
+  MaterialTable& operator=(const MaterialTable&);
+
+  struct MaterialHash {
+    size_t operator()(const Material& material) const;
+  };
+
+  static MaterialTable* instance_;
+
+  std::deque<MaterialConstants> constants_; // deque: references stay valid while interning
+  std::unordered_map<Material, MaterialId, MaterialHash> ids_;
+  MaterialId lastId_; // materials are mostly interned repeatedly in a row
+
+};
+
+} /* End of namespace genfit */
+/** @} */
+
+#endif // genfit_MaterialTable_h
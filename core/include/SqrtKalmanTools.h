@@ -0,0 +1,138 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @addtogroup genfit
+ * @{
+ */
+
+#ifndef genfit_SqrtKalmanTools_h
+#define genfit_SqrtKalmanTools_h
+
+#include "EigenMatrixTypedefs.h"
+
+#include <TVectorD.h>
+#include <TMatrixD.h>
+#include <TMatrixDSym.h>
+
+#include <Eigen/Cholesky>
+#include <Eigen/QR>
+
+#include <cmath>
+
+
+/**
+ * @brief Square-root Kalman filter with fixed size Eigen matrices.
+ *
+ * Same algebra as tools::noiseMatrixSqrt(), tools::kalmanPredictionCovSqrt() and tools::kalmanUpdateSqrt(),
+ * but with Householder QR and Cholesky decompositions of fixed size, i.e. without heap allocations.
+ * Covariance square roots S are upper triangular with cov = S^T S.
+ */
+namespace genfit {
+
+class AbsHMatrix;
+
+namespace tools {
+
+/** @brief Square root of the positive semidefinite noise matrix, noise = noiseSqrt * noiseSqrt^T.
+ *
+ *  Uses the pivoted LDL^T decomposition; negative pivots from rounding are set to 0.
+ */
+template <int dim>
+void noiseMatrixSqrt(const Eigen::Matrix<double, dim, dim>& noise, Eigen::Matrix<double, dim, dim>& noiseSqrt)
+{
+  const Eigen::LDLT<Eigen::Matrix<double, dim, dim> > ldlt(noise);
+  // noise = P^T L D L^T P
+  noiseSqrt = ldlt.transpositionsP().transpose() * Eigen::Matrix<double, dim, dim>(ldlt.matrixL());
+  const Eigen::Matrix<double, dim, 1>& D = ldlt.vectorD();
+  for (int i = 0; i < dim; ++i)
+    noiseSqrt.col(i) *= D(i) > 0 ? sqrt(D(i)) : 0.;
+}
+
+/** @brief Covariance square root after the prediction with transport matrix F and noise square root Q.
+ *
+ *  S and Snew may be the same object.
+ */
+template <int dim>
+void kalmanPredictionCovSqrt(const Eigen::Matrix<double, dim, dim>& S,
+                             const Eigen::Matrix<double, dim, dim>& F, const Eigen::Matrix<double, dim, dim>& Q,
+                             Eigen::Matrix<double, dim, dim>& Snew)
+{
+  // F C F^T + N = pre^T pre
+  Eigen::Matrix<double, 2 * dim, dim> pre;
+  pre.template topRows<dim>() = S * F.transpose();
+  pre.template bottomRows<dim>() = Q.transpose();
+
+  const Eigen::HouseholderQR<Eigen::Matrix<double, 2 * dim, dim> > qr(pre);
+  Snew = qr.matrixQR().template topRows<dim>().template triangularView<Eigen::Upper>();
+}
+
+/** @brief Kalman measurement update (no transport).
+ *
+ *  S : covariance square root of the prediction
+ *  res, R, H : residual of the prediction, measurement covariance square root, H matrix of the measurement
+ *  Gives the update (new state = prediction + update) and the updated covariance square root Snew,
+ *  which may be the same object as S.
+ *  Returns the chi2 increment res^T (V + H C H^T)^(-1) res, which equals the one of the updated residual.
+ */
+template <int dim, int mDim>
+double kalmanUpdateSqrt(const Eigen::Matrix<double, dim, dim>& S,
+                        const Eigen::Matrix<double, mDim, 1>& res, const Eigen::Matrix<double, mDim, mDim>& R,
+                        const Eigen::Matrix<double, mDim, dim>& H,
+                        Eigen::Matrix<double, dim, 1>& update, Eigen::Matrix<double, dim, dim>& Snew)
+{
+  Eigen::Matrix<double, mDim + dim, mDim + dim> pre;
+  pre.template topLeftCorner<mDim, mDim>() = R;
+  pre.template topRightCorner<mDim, dim>().setZero();
+  pre.template bottomLeftCorner<dim, mDim>() = S * H.transpose();
+  pre.template bottomRightCorner<dim, dim>() = S;
+
+  // r = [[a, K^T], [0, Snew]] with a^T a = V + H C H^T
+  const Eigen::HouseholderQR<Eigen::Matrix<double, mDim + dim, mDim + dim> > qr(pre);
+  const Eigen::Matrix<double, mDim + dim, mDim + dim>& r = qr.matrixQR();
+
+  const Eigen::Matrix<double, mDim, 1> whitenedRes =
+    r.template topLeftCorner<mDim, mDim>().template triangularView<Eigen::Upper>().transpose().solve(res);
+  update = r.template topRightCorner<mDim, dim>().transpose() * whitenedRes;
+  Snew = r.template bottomRightCorner<dim, dim>().template triangularView<Eigen::Upper>();
+
+  return whitenedRes.squaredNorm();
+}
+
+
+/** @brief Upper triangular square root S of the 5x5 covariance, cov = S^T S. Throws an Exception if cov is not positive definite. */
+void covSqrt(const TMatrixDSym& cov, Matrix5x5& S);
+
+/** @brief Writes the covariance S^T S of the square root S into cov. */
+void covFromSqrt(const Matrix5x5& S, TMatrixDSym& cov);
+
+/** @brief Replaces S by the covariance square root after the prediction with transport matrix F and noise matrix N. */
+void kalmanPredictionCovSqrt(const TMatrixD& F, const TMatrixDSym& N, Matrix5x5& S);
+
+/** @brief Kalman measurement update of the 5D state with the measurement, its H matrix and covariance V / weight.
+ *
+ *  Updates state and its covariance square root S in place, without heap allocations.
+ *  Returns the chi2 increment. Measurements with up to 5 dimensions are supported.
+ */
+double kalmanUpdateSqrt(Matrix5x5& S, TVectorD& state, const TVectorD& measurement, const TMatrixDSym& V,
+                        double weight, const AbsHMatrix* H);
+
+} /* End of namespace tools */
+} /* End of namespace genfit */
+/** @} */
+
+#endif // genfit_SqrtKalmanTools_h
@@ -0,0 +1,147 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @addtogroup genfit
+ * @{
+ */
+
+#ifndef genfit_SurfaceExtrapolator_h
+#define genfit_SurfaceExtrapolator_h
+
+#include "MeasuredStateOnPlane.h"
+#include "SharedPlanePtr.h"
+
+#include <TVector3.h>
+
+#include <vector>
+
+
+namespace genfit {
+
+class Track;
+
+/**
+ * @brief Surface for the SurfaceExtrapolator: plane (disk), cylinder or sphere.
+ *
+ * Planes can be limited with a finite plane (DetPlane::setFinitePlane),
+ * cylinders with a half length along their axis.
+ */
+struct ExtrapolationSurface {
+
+  enum SurfaceType {
+    kPlane,
+    kCylinder,
+    kSphere
+  };
+
+  //! Plane, limited to the active area of its finite plane (if any)
+  explicit ExtrapolationSurface(const SharedPlanePtr& plane);
+  //! Cylinder around the line (point, direction); halfLength < 0: infinite
+  ExtrapolationSurface(double radius, const TVector3& point, const TVector3& direction, double halfLength = -1.);
+  //! Sphere around point
+  ExtrapolationSurface(double radius, const TVector3& point);
+
+  SurfaceType type_;
+  SharedPlanePtr plane_;
+  double radius_;
+  TVector3 point_;
+  TVector3 direction_;
+  double halfLength_;
+
+};
+
+
+/**
+ * @brief Crossing of a track with a surface of the SurfaceExtrapolator.
+ */
+struct SurfaceCrossing {
+
+  SurfaceCrossing() : surfaceId_(0), trackLength_(0), state_() {;}
+
+  unsigned int surfaceId_; // index of the surface
+  double trackLength_; // track length from the start state
+  MeasuredStateOnPlane state_; // state on the surface; covariance is zero if not calculated
+
+};
+
+
+/**
+ * @brief Extrapolation of tracks to an ordered list of surfaces (e.g. TOF, calorimeter, muon stations).
+ *
+ * Each track is propagated once outward: the extrapolation to a surface starts from the
+ * crossing with the previous one, so the surfaces have to be added in the order in which
+ * the tracks cross them. Surfaces that are not reached going forward (extrapolation fails,
+ * negative track length, outside of the finite plane or the length of the cylinder) are skipped
+ * and the walk continues from the last crossing.
+ *
+ * The covariance is only propagated if requested (setCalcCovariance).
+ * Many tracks can be given in one call; they are extrapolated one after the other, since
+ * the track representations, the field and the material effects are not thread safe.
+ */
+class SurfaceExtrapolator {
+
+ public:
+
+  SurfaceExtrapolator();
+
+  //! Add a surface; returns its index (surfaceId_ of the crossings).
+  unsigned int addSurface(const ExtrapolationSurface& surface);
+  void clearSurfaces() {surfaces_.clear();}
+  unsigned int getNSurfaces() const {return surfaces_.size();}
+  const ExtrapolationSurface& getSurface(unsigned int i) const {return surfaces_.at(i);}
+
+  void setCalcCovariance(bool calcCov = true) {calcCov_ = calcCov;}
+  bool getCalcCovariance() const {return calcCov_;}
+
+  /**
+   * @brief Extrapolate one track from start to the surfaces.
+   *
+   * @param crossings Crossings in the order of the surfaces (overwritten)
+   * @return number of crossings
+   */
+  unsigned int extrapolate(const MeasuredStateOnPlane& start, std::vector<SurfaceCrossing>& crossings);
+
+  //! Extrapolate many tracks, crossings[i] for states[i]
+  void extrapolate(const std::vector<const MeasuredStateOnPlane*>& states, std::vector<std::vector<SurfaceCrossing> >& crossings);
+
+  //! Extrapolate many tracks from their last fitted state (cardinal representation)
+  void extrapolate(const std::vector<Track*>& tracks, std::vector<std::vector<SurfaceCrossing> >& crossings);
+
+ private:
+
+  template<class State>
+  unsigned int walk(State& state, State& trial, std::vector<SurfaceCrossing>& crossings) const;
+
+  //! Extrapolate trial to the surface, returns false if it is not crossed going forward.
+  bool extrapolateToSurface(StateOnPlane& trial, const ExtrapolationSurface& surface, double& length) const;
+
+  std::vector<ExtrapolationSurface> surfaces_;
+  bool calcCov_;
+
+  // work space (reused)
+  StateOnPlane state_;
+  StateOnPlane trial_;
+  MeasuredStateOnPlane measuredState_;
+  MeasuredStateOnPlane measuredTrial_;
+
+};
+
+} /* End of namespace genfit */
+/** @} */
+
+#endif // genfit_SurfaceExtrapolator_h
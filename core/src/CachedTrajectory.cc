@@ -0,0 +1,306 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CachedTrajectory.h"
+
+#include "AbsFitterInfo.h"
+#include "Exception.h"
+#include "Track.h"
+#include "TrackPoint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+
+namespace genfit {
+
+CachedTrajectory::CachedTrajectory() :
+  maxStep_(5.), length_(), pos_(), dir_(), mom_(), states_()
+{
+  ;
+}
+
+
+void CachedTrajectory::setMaxStep(double step) {
+  if (step <= 0.) {
+    Exception exc("CachedTrajectory::setMaxStep ==> step must be positive.",__LINE__,__FILE__);
+    exc.setFatal();
+    throw exc;
+  }
+  maxStep_ = step;
+}
+
+
+void CachedTrajectory::build(const Track& track, const AbsTrackRep* rep) {
+  if (rep == nullptr)
+    rep = track.getCardinalRep();
+
+  std::vector<const MeasuredStateOnPlane*> states;
+  for (unsigned int i = 0; i < track.getNumPoints(); ++i) {
+    const TrackPoint* point = track.getPoint(i);
+    if (point->hasFitterInfo(rep))
+      states.push_back(&(point->getFitterInfo(rep)->getFittedState(true)));
+  }
+  build(states);
+}
+
+
+void CachedTrajectory::build(const std::vector<const MeasuredStateOnPlane*>& states) {
+  clear();
+  if (states.empty())
+    return;
+
+  double s = 0;
+  addNode(s, *(states[0]));
+
+  for (unsigned int i = 0; i + 1 < states.size(); ++i) {
+    MeasuredStateOnPlane state(*(states[i]));
+    const AbsTrackRep* rep = state.getRep();
+    const TVector3 nextPos = states[i + 1]->getPos();
+    const Vector3 next(nextPos.X(), nextPos.Y(), nextPos.Z());
+
+    // transport the state (with covariance) in steps of maxStep while the next state is
+    // further ahead than that, the chord is a lower bound of the remaining length
+    double length = 0;
+    Vector3 ahead = next - pos_.back();
+    while (ahead.norm() > maxStep_ && ahead.dot(dir_.back()) > 0.) {
+      length += rep->extrapolateBy(state, maxStep_);
+      addNode(s + length, state);
+      ahead = next - pos_.back();
+    }
+
+    // rest of the segment to the next state, without covariance
+    StateOnPlane probe(state);
+    length += rep->extrapolateToPlane(probe, states[i + 1]->getPlane());
+    if (length <= 0.) {
+      Exception exc("CachedTrajectory::build ==> states are not ordered along the track.",__LINE__,__FILE__);
+      throw exc;
+    }
+
+    s += length;
+    addNode(s, *(states[i + 1]));
+  }
+}
+
+
+void CachedTrajectory::clear() {
+  length_.clear();
+  pos_.clear();
+  dir_.clear();
+  mom_.clear();
+  states_.clear();
+}
+
+
+TVector3 CachedTrajectory::getPos(double s) const {
+  checkBuilt("getPos");
+  Vector3 pos, dir;
+  interpolate(findNode(s), s, pos, dir);
+  return TVector3(pos(0), pos(1), pos(2));
+}
+
+
+void CachedTrajectory::getPosMom(double s, TVector3& pos, TVector3& mom) const {
+  checkBuilt("getPosMom");
+  const unsigned int node = findNode(s);
+  Vector3 position, dir;
+  interpolate(node, s, position, dir);
+
+  double p = mom_[node];
+  if (node + 1 < length_.size() && s > length_[node]) {
+    const double t = (s - length_[node]) / (length_[node + 1] - length_[node]);
+    p += t * (mom_[node + 1] - mom_[node]);
+  }
+  pos.SetXYZ(position(0), position(1), position(2));
+  mom.SetXYZ(p * dir(0), p * dir(1), p * dir(2));
+}
+
+
+double CachedTrajectory::getPOCA(const TVector3& point, TVector3& poca) const {
+  checkBuilt("getPOCA");
+  const Vector3 x(point.X(), point.Y(), point.Z());
+  const unsigned int nNodes = length_.size();
+
+  double s = length_[0];
+  if (nNodes == 1) {
+    s += (x - pos_[0]).dot(dir_[0]);
+  }
+  else {
+    // Bisection of the nodes for the segment where the point passes from ahead of
+    // to behind the trajectory, i.e. where (x - pos).dir changes sign.
+    // Outside of the nodes the first or last segment is taken.
+    unsigned int low = 0;
+    unsigned int high = nNodes - 1;
+    if (isAhead(high, x)) {
+      low = high - 1;
+    }
+    else if (isAhead(low, x)) {
+      while (high - low > 1) {
+        const unsigned int middle = (low + high) / 2;
+        if (isAhead(middle, x))
+          low = middle;
+        else
+          high = middle;
+      }
+    }
+    closestInSegment(low, x, s);
+  }
+
+  poca = getPos(s);
+  return s;
+}
+
+
+MeasuredStateOnPlane CachedTrajectory::getState(double s) const {
+  checkBuilt("getState");
+  const unsigned int node = findNode(s);
+  MeasuredStateOnPlane state(states_[node]);
+  state.getRep()->extrapolateBy(state, s - length_[node]);
+  return state;
+}
+
+
+double CachedTrajectory::extrapolateToPlane(const SharedPlanePtr& plane, MeasuredStateOnPlane& state) const {
+  checkBuilt("extrapolateToPlane");
+  const Vector3 o(plane->getO().X(), plane->getO().Y(), plane->getO().Z());
+  const TVector3 normal = plane->getNormal();
+  const Vector3 n(normal.X(), normal.Y(), normal.Z());
+
+  // first segment with a sign change of the distance to the plane
+  unsigned int node = 0;
+  double dist = (pos_[0] - o).dot(n);
+  bool found = (length_.size() == 1);
+  for (unsigned int i = 0; i + 1 < length_.size(); ++i) {
+    const double nextDist = (pos_[i + 1] - o).dot(n);
+    if (dist * nextDist <= 0.) {
+      node = i;
+      found = true;
+      break;
+    }
+    dist = nextDist;
+  }
+  if (!found) {
+    Exception exc("CachedTrajectory::extrapolateToPlane ==> plane is not crossed by the trajectory.",__LINE__,__FILE__);
+    throw exc;
+  }
+
+  state = states_[node];
+  return length_[node] + state.getRep()->extrapolateToPlane(state, plane);
+}
+
+
+double CachedTrajectory::extrapolateToPoint(const TVector3& point, MeasuredStateOnPlane& state) const {
+  TVector3 poca;
+  const unsigned int node = findNode(getPOCA(point, poca));
+  state = states_[node];
+  return length_[node] + state.getRep()->extrapolateToPoint(state, point);
+}
+
+
+void CachedTrajectory::checkBuilt(const char* method) const {
+  if (length_.empty()) {
+    Exception exc(std::string("CachedTrajectory::") + method + " ==> trajectory is empty.",__LINE__,__FILE__);
+    exc.setFatal();
+    throw exc;
+  }
+}
+
+
+void CachedTrajectory::addNode(double s, const MeasuredStateOnPlane& state) {
+  TVector3 pos, mom;
+  state.getRep()->getPosMom(state, pos, mom);
+
+  // a fitted state at the end of a segment replaces the transported one
+  if (!length_.empty() && s - length_.back() < 1.E-9) {
+    length_.pop_back();
+    pos_.pop_back();
+    dir_.pop_back();
+    mom_.pop_back();
+    states_.pop_back();
+  }
+
+  length_.push_back(s);
+  pos_.push_back(Vector3(pos.X(), pos.Y(), pos.Z()));
+  dir_.push_back(Vector3(mom.X(), mom.Y(), mom.Z()).normalized());
+  mom_.push_back(mom.Mag());
+  states_.push_back(state);
+}
+
+
+unsigned int CachedTrajectory::findNode(double s) const {
+  const std::vector<double>::const_iterator it = std::upper_bound(length_.begin(), length_.end(), s);
+  if (it == length_.begin())
+    return 0;
+  return (it - length_.begin()) - 1;
+}
+
+
+void CachedTrajectory::interpolate(unsigned int node, double s, Vector3& pos, Vector3& dir) const {
+  // straight line outside of the nodes
+  if (node + 1 >= length_.size() || s < length_[node]) {
+    dir = dir_[node];
+    pos = pos_[node] + (s - length_[node]) * dir;
+    return;
+  }
+
+  const double h = length_[node + 1] - length_[node];
+  const double t = (s - length_[node]) / h;
+  const double t2 = t * t;
+  const double t3 = t2 * t;
+
+  const Vector3& p0 = pos_[node];
+  const Vector3& p1 = pos_[node + 1];
+  const Vector3& d0 = dir_[node];
+  const Vector3& d1 = dir_[node + 1];
+
+  pos = (2. * t3 - 3. * t2 + 1.) * p0 + (t3 - 2. * t2 + t) * h * d0
+      + (-2. * t3 + 3. * t2) * p1 + (t3 - t2) * h * d1;
+  dir = (6. * t2 - 6. * t) / h * (p0 - p1) + (3. * t2 - 4. * t + 1.) * d0 + (3. * t2 - 2. * t) * d1;
+  dir.normalize();
+}
+
+
+bool CachedTrajectory::isAhead(unsigned int node, const Vector3& point) const {
+  return (point - pos_[node]).dot(dir_[node]) > 0.;
+}
+
+
+double CachedTrajectory::closestInSegment(unsigned int node, const Vector3& point, double& s) const {
+  const double s0 = length_[node];
+  const double s1 = length_[node + 1];
+  Vector3 pos, dir;
+
+  // Newton steps along the (unit) direction
+  s = 0.5 * (s0 + s1);
+  for (unsigned int iter = 0; iter < 20; ++iter) {
+    interpolate(node, s, pos, dir);
+    const double ds = (point - pos).dot(dir);
+    const double sNew = std::min(s1, std::max(s0, s + ds));
+    const bool converged = std::fabs(sNew - s) < 1.E-9;
+    s = sNew;
+    if (converged)
+      break;
+  }
+
+  interpolate(node, s, pos, dir);
+  return (pos - point).squaredNorm();
+}
+
+} /* End of namespace genfit */
@@ -0,0 +1,106 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "MaterialTable.h"
+
+#include <cmath>
+#include <functional>
+
+
+namespace genfit {
+
+MaterialConstants::MaterialConstants(const Material& mat) :
+  material_(mat), isVacuum_(!(mat.Z > 1.E-3)),
+  zOverADensity_(0), logMEE_(0), invRadiationLength_(0), coulombFactor_(0),
+  urbanI_(0), urbanF1_(0), urbanF2_(0), urbanE1_(0), urbanE2_(0)
+{
+  if (mat.radiationLength > 0.)
+    invRadiationLength_ = 1. / mat.radiationLength;
+
+  if (isVacuum_)
+    return;
+
+  zOverADensity_ = mat.Z / mat.A * mat.density;
+  logMEE_ = log(1.E-6 * mat.mEE);
+  coulombFactor_ = mat.Z / (mat.Z + 1) * log(159.*pow(mat.Z, -1. / 3.)) / log(287.*pow(mat.Z, -0.5));
+
+  urbanI_ = 16. * pow(mat.Z, 0.9);
+  urbanF2_ = (mat.Z > 2.) ? 2. / mat.Z : 0.;
+  urbanF1_ = 1. - urbanF2_;
+  urbanE2_ = 10. * mat.Z * mat.Z;
+  urbanE1_ = pow((urbanI_ / pow(urbanE2_, urbanF2_)), 1. / urbanF1_);
+}
+
+
+MaterialTable* MaterialTable::instance_ = nullptr;
+const MaterialId MaterialTable::vacuumId;
+
+
+MaterialTable::MaterialTable() :
+  constants_(), ids_(), lastId_(vacuumId)
+{
+  intern(Material());
+}
+
+
+MaterialTable* MaterialTable::getInstance()
+{
+  if (instance_ == nullptr) instance_ = new MaterialTable();
+  return instance_;
+}
+
+
+void MaterialTable::destruct()
+{
+  if (instance_ != nullptr) {
+    delete instance_;
+    instance_ = nullptr;
+  }
+}
+
+
+MaterialId MaterialTable::intern(const Material& material)
+{
+  if (!constants_.empty() && constants_[lastId_].material_ == material)
+    return lastId_;
+
+  std::unordered_map<Material, MaterialId, MaterialHash>::const_iterator it = ids_.find(material);
+  if (it != ids_.end()) {
+    lastId_ = it->second;
+    return lastId_;
+  }
+
+  lastId_ = constants_.size();
+  constants_.push_back(MaterialConstants(material));
+  ids_.insert(std::make_pair(material, lastId_));
+  return lastId_;
+}
+
+
+size_t MaterialTable::MaterialHash::operator()(const Material& material) const
+{
+  std::hash<double> hasher;
+  size_t seed = 0;
+  // + 0. maps -0. to 0., which compare equal
+  for (double value : {material.density, material.Z, material.A, material.radiationLength, material.mEE})
+    seed ^= hasher(value + 0.) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  return seed;
+}
+
+} /* End of namespace genfit */
@@ -0,0 +1,119 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SqrtKalmanTools.h"
+
+#include "AbsHMatrix.h"
+#include "Exception.h"
+
+#include <cassert>
+
+
+namespace genfit {
+
+namespace {
+
+  typedef Eigen::Matrix<double, 5, 5, Eigen::RowMajor> RootMatrix5x5; // storage of the ROOT matrices
+
+  template <int mDim>
+  double updateSqrt(Matrix5x5& S, TVectorD& state, const TVectorD& measurement, const TMatrixDSym& V,
+                    double weight, const TMatrixD& H)
+  {
+    // views on the ROOT storage, nothing is copied to the heap
+    const Eigen::Map<const Eigen::Matrix<double, mDim, 1> > eigenMeasurement(measurement.GetMatrixArray());
+    const Eigen::Map<const Eigen::Matrix<double, mDim, mDim, Eigen::RowMajor> > eigenV(V.GetMatrixArray());
+    const Eigen::Map<const Eigen::Matrix<double, mDim, 5, Eigen::RowMajor> > eigenH(H.GetMatrixArray());
+    Eigen::Map<Vector5> eigenState(state.GetMatrixArray());
+
+    const Eigen::LLT<Eigen::Matrix<double, mDim, mDim> > llt(eigenV);
+    if (llt.info() != Eigen::Success) {
+      Exception e("tools::kalmanUpdateSqrt - measurement covariance is not positive definite",
+          __LINE__,__FILE__);
+      throw e;
+    }
+    // V / weight = R^T R
+    Eigen::Matrix<double, mDim, mDim> R = llt.matrixU();
+    if (weight != 1.)
+      R /= sqrt(weight);
+
+    const Eigen::Matrix<double, mDim, 1> res = eigenMeasurement - eigenH * eigenState;
+    Vector5 update;
+    const double chi2inc = tools::kalmanUpdateSqrt<5, mDim>(S, res, R, eigenH, update, S);
+    eigenState += update;
+
+    return chi2inc;
+  }
+
+}
+
+
+void tools::covSqrt(const TMatrixDSym& cov, Matrix5x5& S)
+{
+  assert(cov.GetNrows() == 5);
+
+  const Eigen::LLT<Matrix5x5> llt(Eigen::Map<const RootMatrix5x5>(cov.GetMatrixArray()));
+  if (llt.info() != Eigen::Success) {
+    Exception e("tools::covSqrt - covariance is not positive definite",
+        __LINE__,__FILE__);
+    throw e;
+  }
+  S = llt.matrixU();
+}
+
+
+void tools::covFromSqrt(const Matrix5x5& S, TMatrixDSym& cov)
+{
+  cov.ResizeTo(5, 5);
+  Eigen::Map<RootMatrix5x5>(cov.GetMatrixArray()).noalias() = S.transpose() * S;
+}
+
+
+void tools::kalmanPredictionCovSqrt(const TMatrixD& F, const TMatrixDSym& N, Matrix5x5& S)
+{
+  assert(F.GetNrows() == 5 && F.GetNcols() == 5);
+  assert(N.GetNrows() == 5);
+
+  Matrix5x5 Q;
+  tools::noiseMatrixSqrt<5>(Eigen::Map<const RootMatrix5x5>(N.GetMatrixArray()), Q);
+  tools::kalmanPredictionCovSqrt<5>(S, Eigen::Map<const RootMatrix5x5>(F.GetMatrixArray()), Q, S);
+}
+
+
+double tools::kalmanUpdateSqrt(Matrix5x5& S, TVectorD& state, const TVectorD& measurement, const TMatrixDSym& V,
+                               double weight, const AbsHMatrix* H)
+{
+  const TMatrixD& HMatrix = H->getMatrix();
+  assert(state.GetNrows() == 5);
+  assert(HMatrix.GetNcols() == 5);
+
+  switch (measurement.GetNrows()) {
+    case 1: return updateSqrt<1>(S, state, measurement, V, weight, HMatrix);
+    case 2: return updateSqrt<2>(S, state, measurement, V, weight, HMatrix);
+    case 3: return updateSqrt<3>(S, state, measurement, V, weight, HMatrix);
+    case 4: return updateSqrt<4>(S, state, measurement, V, weight, HMatrix);
+    case 5: return updateSqrt<5>(S, state, measurement, V, weight, HMatrix);
+    default: {
+      Exception e("tools::kalmanUpdateSqrt - measurements with more than 5 dimensions are not supported",
+          __LINE__,__FILE__);
+      throw e;
+    }
+  }
+}
+
+} /* End of namespace genfit */
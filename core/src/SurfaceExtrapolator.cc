@@ -0,0 +1,180 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SurfaceExtrapolator.h"
+
+#include "Exception.h"
+#include "IO.h"
+#include "Track.h"
+
+#include <cmath>
+
+
+namespace genfit {
+
+namespace {
+
+  void setCrossingState(SurfaceCrossing& crossing, const StateOnPlane& state) {
+    const unsigned int dim = state.getState().GetNrows();
+    crossing.state_ = MeasuredStateOnPlane(state, TMatrixDSym(dim));
+  }
+
+  void setCrossingState(SurfaceCrossing& crossing, const MeasuredStateOnPlane& state) {
+    crossing.state_ = state;
+  }
+
+}
+
+
+ExtrapolationSurface::ExtrapolationSurface(const SharedPlanePtr& plane) :
+  type_(kPlane), plane_(plane), radius_(0), point_(), direction_(), halfLength_(-1.)
+{
+  ;
+}
+
+
+ExtrapolationSurface::ExtrapolationSurface(double radius, const TVector3& point, const TVector3& direction, double halfLength) :
+  type_(kCylinder), plane_(), radius_(radius), point_(point), direction_(direction.Unit()), halfLength_(halfLength)
+{
+  ;
+}
+
+
+ExtrapolationSurface::ExtrapolationSurface(double radius, const TVector3& point) :
+  type_(kSphere), plane_(), radius_(radius), point_(point), direction_(), halfLength_(-1.)
+{
+  ;
+}
+
+
+SurfaceExtrapolator::SurfaceExtrapolator() :
+  surfaces_(), calcCov_(false), state_(), trial_(), measuredState_(), measuredTrial_()
+{
+  ;
+}
+
+
+unsigned int SurfaceExtrapolator::addSurface(const ExtrapolationSurface& surface) {
+  if (surface.type_ == ExtrapolationSurface::kPlane && surface.plane_.get() == nullptr) {
+    Exception exc("SurfaceExtrapolator::addSurface ==> plane is nullptr.",__LINE__,__FILE__);
+    exc.setFatal();
+    throw exc;
+  }
+  surfaces_.push_back(surface);
+  return surfaces_.size() - 1;
+}
+
+
+unsigned int SurfaceExtrapolator::extrapolate(const MeasuredStateOnPlane& start, std::vector<SurfaceCrossing>& crossings) {
+  crossings.clear();
+  if (calcCov_) {
+    measuredState_ = start;
+    return walk(measuredState_, measuredTrial_, crossings);
+  }
+  state_ = start;
+  return walk(state_, trial_, crossings);
+}
+
+
+void SurfaceExtrapolator::extrapolate(const std::vector<const MeasuredStateOnPlane*>& states, std::vector<std::vector<SurfaceCrossing> >& crossings) {
+  crossings.resize(states.size());
+  for (unsigned int i = 0; i < states.size(); ++i) {
+    extrapolate(*(states[i]), crossings[i]);
+  }
+}
+
+
+void SurfaceExtrapolator::extrapolate(const std::vector<Track*>& tracks, std::vector<std::vector<SurfaceCrossing> >& crossings) {
+  crossings.resize(tracks.size());
+  for (unsigned int i = 0; i < tracks.size(); ++i) {
+    crossings[i].clear();
+    try {
+      extrapolate(tracks[i]->getFittedState(-1), crossings[i]);
+    }
+    catch (Exception& e) {
+      errorOut << "SurfaceExtrapolator::extrapolate ==> track " << i << " has no fitted state: " << e.what();
+    }
+  }
+}
+
+
+template<class State>
+unsigned int SurfaceExtrapolator::walk(State& state, State& trial, std::vector<SurfaceCrossing>& crossings) const {
+  double trackLength = 0;
+
+  for (unsigned int i = 0; i < surfaces_.size(); ++i) {
+    trial = state;
+    double length = 0;
+    if (!extrapolateToSurface(trial, surfaces_[i], length))
+      continue;
+
+    // continue from the crossing
+    state.swap(trial);
+    trackLength += length;
+
+    crossings.push_back(SurfaceCrossing());
+    SurfaceCrossing& crossing = crossings.back();
+    crossing.surfaceId_ = i;
+    crossing.trackLength_ = trackLength;
+    setCrossingState(crossing, state);
+  }
+
+  return crossings.size();
+}
+
+
+bool SurfaceExtrapolator::extrapolateToSurface(StateOnPlane& trial, const ExtrapolationSurface& surface, double& length) const {
+  const AbsTrackRep* rep = trial.getRep();
+
+  try {
+    switch (surface.type_) {
+      case ExtrapolationSurface::kPlane:
+        length = rep->extrapolateToPlane(trial, surface.plane_);
+        break;
+      case ExtrapolationSurface::kCylinder:
+        length = rep->extrapolateToCylinder(trial, surface.radius_, surface.point_, surface.direction_);
+        break;
+      case ExtrapolationSurface::kSphere:
+        length = rep->extrapolateToSphere(trial, surface.radius_, surface.point_);
+        break;
+    }
+  }
+  catch (Exception& e) {
+    debugOut << "SurfaceExtrapolator::extrapolateToSurface ==> surface not reached: " << e.what();
+    return false;
+  }
+
+  // only forward
+  if (length < 0.)
+    return false;
+
+  const TVector3 pos = rep->getPos(trial);
+  if (surface.type_ == ExtrapolationSurface::kPlane) {
+    if (!surface.plane_->isInActive(surface.plane_->LabToPlane(pos)))
+      return false;
+  }
+  else if (surface.type_ == ExtrapolationSurface::kCylinder && surface.halfLength_ >= 0.) {
+    if (std::fabs((pos - surface.point_).Dot(surface.direction_)) > surface.halfLength_)
+      return false;
+  }
+
+  return true;
+}
+
+} /* End of namespace genfit */
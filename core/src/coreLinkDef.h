@@ -11,6 +11,9 @@
 #pragma link C++ class genfit::AbsFinitePlane+;
 #pragma link C++ class genfit::AbsHMatrix+;
 #pragma link C++ class genfit::RectangularFinitePlane+;
+#pragma link C++ class genfit::TrapezoidalFinitePlane+;
+#pragma link C++ class genfit::AnnularFinitePlane+;
+#pragma link C++ class genfit::PolygonFinitePlane+;
 #pragma link C++ class genfit::FitStatus+;
 #pragma link C++ class genfit::Material+;
 #pragma link C++ class genfit::PruneFlags+;
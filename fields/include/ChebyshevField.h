@@ -0,0 +1,105 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @addtogroup genfit
+ * @{
+ */
+
+#ifndef genfit_ChebyshevField_h
+#define genfit_ChebyshevField_h
+
+#include "AbsBField.h"
+
+#include <functional>
+#include <iosfwd>
+#include <vector>
+
+
+namespace genfit {
+
+/** @brief Magnetic field approximated by piecewise Chebyshev expansions.
+ *
+ *  The volume between min and max is divided into nCells[0] x nCells[1] x nCells[2] boxes.
+ *  In each box, Bx, By and Bz are fitted with a tensor product Chebyshev expansion
+ *  (interpolation at the Chebyshev nodes). The order is raised per box, up to maxOrder,
+ *  until the deviation from the source at a grid of test points is below the tolerance [kGauss].
+ *  Smooth regions thus need only a few coefficients, and the whole field is typically orders
+ *  of magnitude smaller than a grid map. Evaluation uses the Clenshaw recurrence (the Horner
+ *  scheme for Chebyshev series) and has no branches besides the box lookup.
+ *
+ *  The field is 0 outside of the volume. The expansion can be written to and read from a stream.
+ */
+class ChebyshevField : public AbsBField {
+ public:
+
+  //! field at (x, y, z) [cm] in kGauss
+  typedef std::function<void(double x, double y, double z, double& Bx, double& By, double& Bz)> FieldFunction;
+
+  static const unsigned int maxSupportedOrder = 12;
+
+  //! fit field in the box from min to max [cm]
+  ChebyshevField(const FieldFunction& field, const double min[3], const double max[3],
+                 const unsigned int nCells[3], double tolerance, unsigned int maxOrder = 8);
+  //! fit another field, e.g. a grid map
+  ChebyshevField(const AbsBField& field, const double min[3], const double max[3],
+                 const unsigned int nCells[3], double tolerance, unsigned int maxOrder = 8);
+  //! read an expansion written with write(); throws an Exception if the stream does not hold one
+  explicit ChebyshevField(std::istream& in);
+
+  //! return value at position
+  TVector3 get(const TVector3& pos) const override;
+  void get(const double& posX, const double& posY, const double& posZ, double& Bx, double& By, double& Bz) const override;
+
+  void write(std::ostream& out) const;
+
+  //! largest deviation from the source found at the test points while fitting [kGauss]
+  double getMaxFitError() const {return maxFitError_;}
+  unsigned int getNCoefficients() const {return coefficients_.size();}
+  unsigned int getOrder(unsigned int ix, unsigned int iy, unsigned int iz) const {
+    return cellOrder_[(ix * nCells_[1] + iy) * nCells_[2] + iz];
+  }
+
+ private:
+
+  void fit(const FieldFunction& field, double tolerance, unsigned int maxOrder);
+  void fitCell(const FieldFunction& field, const double cellMin[3], unsigned int order, std::vector<double>& coefficients) const;
+  double cellError(const FieldFunction& field, const double cellMin[3], unsigned int order, const double* coefficients) const;
+  void init();
+
+  //! B from the coefficients of a cell at the normalized coordinates (u, v, w) in [-1, 1]
+  static void evaluate(const double* coefficients, unsigned int order, double u, double v, double w, double B[3]);
+
+  double min_[3];
+  double max_[3];
+  unsigned int nCells_[3];
+  double maxFitError_;
+
+  std::vector<unsigned int> cellOrder_;
+  std::vector<unsigned int> cellOffset_; // into coefficients_
+  std::vector<double> coefficients_; // per cell (i, j, k, component), k fastest before the component
+
+  // derived
+  double cellWidth_[3];
+  double invCellWidth_[3];
+
+};
+
+} /* End of namespace genfit */
+/** @} */
+
+#endif // genfit_ChebyshevField_h
@@ -0,0 +1,107 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @addtogroup genfit
+ * @{
+ */
+
+#ifndef genfit_MappedField_h
+#define genfit_MappedField_h
+
+#include "AbsBField.h"
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+namespace genfit {
+
+/**
+ * @brief Header of the GenFit binary field map file.
+ *
+ * The file starts with this header, followed (at dataOffset_) by the field values
+ * Bx, By, Bz [kGauss] of all grid points as float or double in native byte order.
+ * Point (ix, iy, iz) is stored at index (ix * nPoints_[1] + iy) * nPoints_[2] + iz.
+ */
+struct FieldMapHeader {
+  char magic_[8]; // "GFBMAP\0\0"
+  uint32_t version_;
+  uint32_t valueSize_; // sizeof(float) or sizeof(double)
+  uint32_t nPoints_[3]; // number of grid points in x, y, z
+  uint32_t reserved_;
+  double min_[3]; // position of the first grid point [cm]
+  double spacing_[3]; // distance of the grid points [cm]
+  uint64_t dataOffset_; // aligned to dataAlignment
+};
+
+
+/** @brief Magnetic field map on a regular grid, memory-mapped read-only from a binary file.
+ *
+ *  The file is mapped with MAP_SHARED, so all processes on a node that use the same
+ *  file share the physical pages, and nothing is parsed at startup.
+ *  The field is interpolated trilinearly; outside of the grid it is 0.
+ *  Files are written with write() or the convertFieldMap tool.
+ */
+class MappedField : public AbsBField {
+ public:
+
+  static const uint32_t version = 1;
+  static const size_t dataAlignment = 64;
+
+  //! map the file; throws an Exception if it cannot be mapped or is not a valid field map
+  explicit MappedField(const std::string& fileName);
+  ~MappedField();
+
+  //! return value at position
+  TVector3 get(const TVector3& pos) const override;
+  void get(const double& posX, const double& posY, const double& posZ, double& Bx, double& By, double& Bz) const override;
+
+  const FieldMapHeader& getHeader() const {return *header_;}
+
+  /** @brief Write a field map file.
+   *
+   *  field holds Bx, By, Bz [kGauss] for nPoints[0]*nPoints[1]*nPoints[2] points, in the order of the file.
+   */
+  static void write(const std::string& fileName,
+                    const unsigned int nPoints[3], const double min[3], const double spacing[3],
+                    const std::vector<double>& field, bool singlePrecision = false);
+
+ private:
+
+  MappedField(const MappedField&);
+  MappedField& operator=(const MappedField&);
+
+  template<class T>
+  void interpolate(const T* data, const double pos[3], double B[3]) const;
+
+  void* mapping_;
+  size_t mappingSize_;
+  const FieldMapHeader* header_;
+  const void* data_;
+
+  // from the header, for the lookup
+  double invSpacing_[3];
+  size_t strideX_, strideY_;
+};
+
+} /* End of namespace genfit */
+/** @} */
+
+#endif // genfit_MappedField_h
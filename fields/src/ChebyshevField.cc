@@ -0,0 +1,330 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ChebyshevField.h"
+
+#include "Exception.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdint.h>
+
+
+namespace genfit {
+
+namespace {
+  const char chebyshevFieldMagic[8] = {'G', 'F', 'C', 'H', 'E', 'B', 0, 0};
+  const uint32_t chebyshevFieldVersion = 1;
+
+  //! Clenshaw recurrence for three series at once; c[j*3 + component], j = 0..order
+  inline void clenshaw3(const double* c, unsigned int order, double x, double out[3]) {
+    const double x2 = 2. * x;
+    double b1[3] = {0., 0., 0.};
+    double b2[3] = {0., 0., 0.};
+    for (unsigned int j = order; j >= 1; --j) {
+      for (unsigned int i = 0; i < 3; ++i) {
+        const double b0 = c[j*3 + i] + x2 * b1[i] - b2[i];
+        b2[i] = b1[i];
+        b1[i] = b0;
+      }
+    }
+    for (unsigned int i = 0; i < 3; ++i)
+      out[i] = c[i] + x * b1[i] - b2[i];
+  }
+
+  template<class T>
+  void writeValue(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template<class T>
+  void readValue(std::istream& in, T& value) {
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+  }
+}
+
+const unsigned int ChebyshevField::maxSupportedOrder;
+
+
+ChebyshevField::ChebyshevField(const FieldFunction& field, const double min[3], const double max[3],
+                               const unsigned int nCells[3], double tolerance, unsigned int maxOrder) :
+  maxFitError_(0)
+{
+  for (unsigned int i = 0; i < 3; ++i) {
+    min_[i] = min[i];
+    max_[i] = max[i];
+    nCells_[i] = nCells[i];
+    if (!(max[i] > min[i]) || nCells[i] == 0) {
+      Exception exc("ChebyshevField::ChebyshevField ==> empty volume or no cells",__LINE__,__FILE__);
+      exc.setFatal();
+      throw exc;
+    }
+  }
+  if (maxOrder > maxSupportedOrder || !(tolerance > 0)) {
+    Exception exc("ChebyshevField::ChebyshevField ==> maxOrder too large or tolerance not positive",__LINE__,__FILE__);
+    exc.setFatal();
+    throw exc;
+  }
+
+  cellOrder_.resize(nCells_[0] * nCells_[1] * nCells_[2], 0);
+  init();
+  fit(field, tolerance, maxOrder);
+}
+
+
+ChebyshevField::ChebyshevField(const AbsBField& field, const double min[3], const double max[3],
+                               const unsigned int nCells[3], double tolerance, unsigned int maxOrder) :
+  ChebyshevField([&field](double x, double y, double z, double& Bx, double& By, double& Bz) {
+                   field.get(x, y, z, Bx, By, Bz);
+                 },
+                 min, max, nCells, tolerance, maxOrder)
+{
+  ;
+}
+
+
+ChebyshevField::ChebyshevField(std::istream& in) :
+  maxFitError_(0)
+{
+  char magic[8];
+  uint32_t version(0);
+  in.read(magic, sizeof(magic));
+  readValue(in, version);
+  if (!in || memcmp(magic, chebyshevFieldMagic, sizeof(magic)) != 0 || version != chebyshevFieldVersion) {
+    Exception exc("ChebyshevField::ChebyshevField ==> stream does not hold a ChebyshevField",__LINE__,__FILE__);
+    exc.setFatal();
+    throw exc;
+  }
+
+  for (unsigned int i = 0; i < 3; ++i) {
+    uint32_t n(0);
+    readValue(in, min_[i]);
+    readValue(in, max_[i]);
+    readValue(in, n);
+    nCells_[i] = n;
+  }
+  readValue(in, maxFitError_);
+
+  bool valid(in && nCells_[0] > 0 && nCells_[1] > 0 && nCells_[2] > 0);
+  if (valid) {
+    cellOrder_.resize(nCells_[0] * nCells_[1] * nCells_[2]);
+    for (unsigned int& order : cellOrder_) {
+      uint32_t o(0);
+      readValue(in, o);
+      order = o;
+      valid &= (o <= maxSupportedOrder);
+    }
+  }
+  if (valid) {
+    init();
+    uint64_t nCoefficients(0);
+    readValue(in, nCoefficients);
+    valid = in && nCoefficients == coefficients_.size();
+  }
+  if (valid) {
+    in.read(reinterpret_cast<char*>(coefficients_.data()), coefficients_.size() * sizeof(double));
+    valid = bool(in);
+  }
+  if (!valid) {
+    Exception exc("ChebyshevField::ChebyshevField ==> corrupt or truncated ChebyshevField",__LINE__,__FILE__);
+    exc.setFatal();
+    throw exc;
+  }
+}
+
+
+void ChebyshevField::write(std::ostream& out) const {
+  out.write(chebyshevFieldMagic, sizeof(chebyshevFieldMagic));
+  writeValue(out, chebyshevFieldVersion);
+  for (unsigned int i = 0; i < 3; ++i) {
+    writeValue(out, min_[i]);
+    writeValue(out, max_[i]);
+    writeValue(out, uint32_t(nCells_[i]));
+  }
+  writeValue(out, maxFitError_);
+  for (unsigned int order : cellOrder_)
+    writeValue(out, uint32_t(order));
+  writeValue(out, uint64_t(coefficients_.size()));
+  out.write(reinterpret_cast<const char*>(coefficients_.data()), coefficients_.size() * sizeof(double));
+}
+
+
+void ChebyshevField::init() {
+  for (unsigned int i = 0; i < 3; ++i) {
+    cellWidth_[i] = (max_[i] - min_[i]) / nCells_[i];
+    invCellWidth_[i] = 1. / cellWidth_[i];
+  }
+
+  cellOffset_.resize(cellOrder_.size());
+  unsigned int offset = 0;
+  for (unsigned int i = 0; i < cellOrder_.size(); ++i) {
+    cellOffset_[i] = offset;
+    const unsigned int np = cellOrder_[i] + 1;
+    offset += np * np * np * 3;
+  }
+  coefficients_.resize(offset);
+}
+
+
+void ChebyshevField::fit(const FieldFunction& field, double tolerance, unsigned int maxOrder) {
+  std::vector<std::vector<double> > cellCoefficients(cellOrder_.size());
+  maxFitError_ = 0;
+
+  for (unsigned int ix = 0; ix < nCells_[0]; ++ix) {
+    for (unsigned int iy = 0; iy < nCells_[1]; ++iy) {
+      for (unsigned int iz = 0; iz < nCells_[2]; ++iz) {
+        const unsigned int iCell = (ix * nCells_[1] + iy) * nCells_[2] + iz;
+        const double cellMin[3] = {min_[0] + ix * cellWidth_[0], min_[1] + iy * cellWidth_[1], min_[2] + iz * cellWidth_[2]};
+
+        // raise the order until the tolerance is met
+        double error = 0;
+        for (unsigned int order = 0; order <= maxOrder; ++order) {
+          fitCell(field, cellMin, order, cellCoefficients[iCell]);
+          cellOrder_[iCell] = order;
+          error = cellError(field, cellMin, order, cellCoefficients[iCell].data());
+          if (error <= tolerance)
+            break;
+        }
+        maxFitError_ = std::max(maxFitError_, error);
+      }
+    }
+  }
+
+  init();
+  for (unsigned int i = 0; i < cellOrder_.size(); ++i)
+    std::copy(cellCoefficients[i].begin(), cellCoefficients[i].end(), coefficients_.begin() + cellOffset_[i]);
+}
+
+
+void ChebyshevField::fitCell(const FieldFunction& field, const double cellMin[3], unsigned int order, std::vector<double>& coefficients) const {
+  const unsigned int np = order + 1;
+
+  // Chebyshev nodes and the transformation from the values at the nodes to the coefficients
+  std::vector<double> nodes(np);
+  std::vector<double> toCoefficients(np * np);
+  for (unsigned int a = 0; a < np; ++a) {
+    const double theta = M_PI * (a + 0.5) / np;
+    nodes[a] = cos(theta);
+    for (unsigned int i = 0; i < np; ++i)
+      toCoefficients[i*np + a] = (i == 0 ? 1. : 2.) / np * cos(i * theta);
+  }
+
+  // sample the field, layout ((a*np + b)*np + c)*3 + component
+  std::vector<double> samples(np * np * np * 3);
+  for (unsigned int a = 0; a < np; ++a) {
+    const double x = cellMin[0] + 0.5 * (nodes[a] + 1.) * cellWidth_[0];
+    for (unsigned int b = 0; b < np; ++b) {
+      const double y = cellMin[1] + 0.5 * (nodes[b] + 1.) * cellWidth_[1];
+      for (unsigned int c = 0; c < np; ++c) {
+        const double z = cellMin[2] + 0.5 * (nodes[c] + 1.) * cellWidth_[2];
+        double* B = &samples[((a*np + b)*np + c)*3];
+        field(x, y, z, B[0], B[1], B[2]);
+      }
+    }
+  }
+
+  // separable transformation, one axis after the other; stride is the distance of neighbours along the axis
+  std::vector<double> transformed(samples.size());
+  const unsigned int strides[3] = {np * np * 3, np * 3, 3};
+  for (unsigned int axis = 0; axis < 3; ++axis) {
+    const unsigned int stride = strides[axis];
+    std::fill(transformed.begin(), transformed.end(), 0.);
+    for (unsigned int n = 0; n < samples.size(); ++n) {
+      const unsigned int a = (n / stride) % np; // index along axis
+      const unsigned int base = n - a * stride;
+      for (unsigned int i = 0; i < np; ++i)
+        transformed[base + i * stride] += toCoefficients[i*np + a] * samples[n];
+    }
+    samples.swap(transformed);
+  }
+
+  coefficients.swap(samples);
+}
+
+
+double ChebyshevField::cellError(const FieldFunction& field, const double cellMin[3], unsigned int order, const double* coefficients) const {
+  // uniform test points including the faces of the cell, more than the nodes of the fit
+  const unsigned int nTest = order + 3;
+  double error = 0;
+  for (unsigned int a = 0; a < nTest; ++a) {
+    const double u = -1. + 2. * a / (nTest - 1);
+    for (unsigned int b = 0; b < nTest; ++b) {
+      const double v = -1. + 2. * b / (nTest - 1);
+      for (unsigned int c = 0; c < nTest; ++c) {
+        const double w = -1. + 2. * c / (nTest - 1);
+        double B[3], fitted[3];
+        field(cellMin[0] + 0.5 * (u + 1.) * cellWidth_[0],
+              cellMin[1] + 0.5 * (v + 1.) * cellWidth_[1],
+              cellMin[2] + 0.5 * (w + 1.) * cellWidth_[2],
+              B[0], B[1], B[2]);
+        evaluate(coefficients, order, u, v, w, fitted);
+        for (unsigned int i = 0; i < 3; ++i)
+          error = std::max(error, fabs(fitted[i] - B[i]));
+      }
+    }
+  }
+  return error;
+}
+
+
+void ChebyshevField::evaluate(const double* coefficients, unsigned int order, double u, double v, double w, double B[3]) {
+  const unsigned int np = order + 1;
+  double sumK[(maxSupportedOrder + 1) * (maxSupportedOrder + 1) * 3];
+  double sumJK[(maxSupportedOrder + 1) * 3];
+
+  for (unsigned int ij = 0; ij < np * np; ++ij)
+    clenshaw3(coefficients + ij * np * 3, order, w, sumK + ij * 3);
+  for (unsigned int i = 0; i < np; ++i)
+    clenshaw3(sumK + i * np * 3, order, v, sumJK + i * 3);
+  clenshaw3(sumJK, order, u, B);
+}
+
+
+TVector3 ChebyshevField::get(const TVector3& pos) const {
+  double Bx, By, Bz;
+  get(pos.X(), pos.Y(), pos.Z(), Bx, By, Bz);
+  return TVector3(Bx, By, Bz);
+}
+
+
+void ChebyshevField::get(const double& posX, const double& posY, const double& posZ, double& Bx, double& By, double& Bz) const {
+  const double pos[3] = {posX, posY, posZ};
+  unsigned int cell[3];
+  double local[3];
+  for (unsigned int i = 0; i < 3; ++i) {
+    const double t = (pos[i] - min_[i]) * invCellWidth_[i];
+    if (!(t >= 0.) || t > nCells_[i]) { // also catches NaN
+      Bx = By = Bz = 0.;
+      return;
+    }
+    cell[i] = std::min(static_cast<unsigned int>(t), nCells_[i] - 1);
+    local[i] = 2. * (t - cell[i]) - 1.;
+  }
+
+  const unsigned int iCell = (cell[0] * nCells_[1] + cell[1]) * nCells_[2] + cell[2];
+  double B[3];
+  evaluate(&coefficients_[cellOffset_[iCell]], cellOrder_[iCell], local[0], local[1], local[2], B);
+  Bx = B[0];
+  By = B[1];
+  Bz = B[2];
+}
+
+} /* End of namespace genfit */
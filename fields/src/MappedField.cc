@@ -0,0 +1,218 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "MappedField.h"
+
+#include "Exception.h"
+
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace genfit {
+
+namespace {
+  const char fieldMapMagic[8] = {'G', 'F', 'B', 'M', 'A', 'P', 0, 0};
+
+  // Number of field values (3 per grid point) of a grid, if not more than maxValues.
+  // Divides before multiplying, so huge (corrupt) grid sizes cannot overflow.
+  bool countValues(uint64_t nx, uint64_t ny, uint64_t nz, uint64_t maxValues, uint64_t& nValues) {
+    const uint64_t factors[3] = {nx, ny, nz};
+    nValues = 3;
+    if (nValues > maxValues)
+      return false;
+    for (unsigned int i = 0; i < 3; ++i) {
+      if (factors[i] != 0 && factors[i] > maxValues / nValues)
+        return false;
+      nValues *= factors[i];
+    }
+    return true;
+  }
+}
+
+const uint32_t MappedField::version;
+const size_t MappedField::dataAlignment;
+
+
+MappedField::MappedField(const std::string& fileName) :
+  mapping_(nullptr), mappingSize_(0), header_(nullptr), data_(nullptr),
+  strideX_(0), strideY_(0)
+{
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    Exception exc("MappedField::MappedField ==> cannot open " + fileName,__LINE__,__FILE__);
+    exc.setFatal();
+    throw exc;
+  }
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || fileStat.st_size < (off_t)sizeof(FieldMapHeader)) {
+    close(fd);
+    Exception exc("MappedField::MappedField ==> " + fileName + " is too short for a field map",__LINE__,__FILE__);
+    exc.setFatal();
+    throw exc;
+  }
+
+  mappingSize_ = fileStat.st_size;
+  mapping_ = mmap(nullptr, mappingSize_, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd); // the mapping stays valid
+  if (mapping_ == MAP_FAILED) {
+    mapping_ = nullptr;
+    Exception exc("MappedField::MappedField ==> cannot map " + fileName,__LINE__,__FILE__);
+    exc.setFatal();
+    throw exc;
+  }
+
+  header_ = static_cast<const FieldMapHeader*>(mapping_);
+  const FieldMapHeader& header = *header_;
+
+  std::string error;
+  uint64_t nValues;
+  if (memcmp(header.magic_, fieldMapMagic, sizeof(fieldMapMagic)) != 0)
+    error = "not a GenFit field map";
+  else if (header.version_ != version)
+    error = "unsupported field map version";
+  else if (header.valueSize_ != sizeof(float) && header.valueSize_ != sizeof(double))
+    error = "unsupported value size";
+  else if (header.nPoints_[0] < 2 || header.nPoints_[1] < 2 || header.nPoints_[2] < 2)
+    error = "grid needs at least 2 points per axis";
+  else if (!(header.spacing_[0] > 0) || !(header.spacing_[1] > 0) || !(header.spacing_[2] > 0))
+    error = "grid spacing must be positive";
+  else if (header.dataOffset_ % dataAlignment != 0 || header.dataOffset_ < sizeof(FieldMapHeader)
+           || header.dataOffset_ > mappingSize_
+           || !countValues(header.nPoints_[0], header.nPoints_[1], header.nPoints_[2],
+                           (mappingSize_ - header.dataOffset_) / header.valueSize_, nValues))
+    error = "data does not fit into the file";
+
+  if (!error.empty()) {
+    munmap(mapping_, mappingSize_);
+    mapping_ = nullptr;
+    Exception exc("MappedField::MappedField ==> " + fileName + ": " + error,__LINE__,__FILE__);
+    exc.setFatal();
+    throw exc;
+  }
+
+  data_ = static_cast<const char*>(mapping_) + header.dataOffset_;
+  for (unsigned int i = 0; i < 3; ++i)
+    invSpacing_[i] = 1. / header.spacing_[i];
+  strideY_ = header.nPoints_[2];
+  strideX_ = header.nPoints_[1] * strideY_;
+}
+
+
+MappedField::~MappedField() {
+  if (mapping_ != nullptr)
+    munmap(mapping_, mappingSize_);
+}
+
+
+TVector3 MappedField::get(const TVector3& pos) const {
+  double Bx, By, Bz;
+  get(pos.X(), pos.Y(), pos.Z(), Bx, By, Bz);
+  return TVector3(Bx, By, Bz);
+}
+
+
+void MappedField::get(const double& posX, const double& posY, const double& posZ, double& Bx, double& By, double& Bz) const {
+  const double pos[3] = {posX, posY, posZ};
+  double B[3];
+  if (header_->valueSize_ == sizeof(float))
+    interpolate(static_cast<const float*>(data_), pos, B);
+  else
+    interpolate(static_cast<const double*>(data_), pos, B);
+  Bx = B[0];
+  By = B[1];
+  Bz = B[2];
+}
+
+
+template<class T>
+void MappedField::interpolate(const T* data, const double pos[3], double B[3]) const {
+  unsigned int index[3];
+  double frac[3];
+  for (unsigned int i = 0; i < 3; ++i) {
+    const double u = (pos[i] - header_->min_[i]) * invSpacing_[i];
+    const double uMax = header_->nPoints_[i] - 1;
+    if (!(u >= 0.) || u > uMax) { // also catches NaN
+      B[0] = B[1] = B[2] = 0.;
+      return;
+    }
+    index[i] = u < uMax - 1. ? static_cast<unsigned int>(u) : header_->nPoints_[i] - 2;
+    frac[i] = u - index[i];
+  }
+
+  const T* corner = data + 3 * (index[0] * strideX_ + index[1] * strideY_ + index[2]);
+  const size_t dx = 3 * strideX_, dy = 3 * strideY_, dz = 3;
+  for (unsigned int c = 0; c < 3; ++c) {
+    const double c00 = corner[c] + frac[2] * (corner[dz + c] - corner[c]);
+    const double c01 = corner[dy + c] + frac[2] * (corner[dy + dz + c] - corner[dy + c]);
+    const double c10 = corner[dx + c] + frac[2] * (corner[dx + dz + c] - corner[dx + c]);
+    const double c11 = corner[dx + dy + c] + frac[2] * (corner[dx + dy + dz + c] - corner[dx + dy + c]);
+    const double c0 = c00 + frac[1] * (c01 - c00);
+    const double c1 = c10 + frac[1] * (c11 - c10);
+    B[c] = c0 + frac[0] * (c1 - c0);
+  }
+}
+
+
+void MappedField::write(const std::string& fileName,
+                        const unsigned int nPoints[3], const double min[3], const double spacing[3],
+                        const std::vector<double>& field, bool singlePrecision) {
+  FieldMapHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic_, fieldMapMagic, sizeof(fieldMapMagic));
+  header.version_ = version;
+  header.valueSize_ = singlePrecision ? sizeof(float) : sizeof(double);
+  for (unsigned int i = 0; i < 3; ++i) {
+    header.nPoints_[i] = nPoints[i];
+    header.min_[i] = min[i];
+    header.spacing_[i] = spacing[i];
+  }
+  header.dataOffset_ = (sizeof(FieldMapHeader) + dataAlignment - 1) / dataAlignment * dataAlignment;
+
+  uint64_t nValues;
+  if (!countValues(nPoints[0], nPoints[1], nPoints[2], field.size(), nValues) || nValues != field.size()) {
+    Exception exc("MappedField::write ==> number of field values does not match the grid",__LINE__,__FILE__);
+    exc.setFatal();
+    throw exc;
+  }
+
+  std::ofstream out(fileName.c_str(), std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  const std::vector<char> padding(header.dataOffset_ - sizeof(header), 0);
+  out.write(padding.data(), padding.size());
+  if (singlePrecision) {
+    const std::vector<float> values(field.begin(), field.end());
+    out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+  } else {
+    out.write(reinterpret_cast<const char*>(field.data()), field.size() * sizeof(double));
+  }
+
+  if (!out) {
+    Exception exc("MappedField::write ==> cannot write " + fileName,__LINE__,__FILE__);
+    exc.setFatal();
+    throw exc;
+  }
+}
+
+} /* End of namespace genfit */
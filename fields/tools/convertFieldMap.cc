@@ -0,0 +1,171 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Converts a text field map into the binary format read by genfit::MappedField.
+//
+// The text file has one grid point per line: x y z Bx By Bz, separated by whitespace
+// or commas, in any order. Empty lines and lines starting with '#' or '%' are skipped.
+// The grid must be regular; the points are sorted into it by their coordinates.
+
+#include <MappedField.h>
+#include <Exception.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+  void usage(const char* name) {
+    std::cerr << "usage: " << name << " [--float] [--length-scale f] [--field-scale f] input.txt output.gfmap\n"
+              << "  --float           store single precision values\n"
+              << "  --length-scale f  multiply coordinates by f to get cm (e.g. 0.1 for mm)\n"
+              << "  --field-scale f   multiply field values by f to get kGauss (e.g. 10 for Tesla)\n";
+  }
+
+  // sorted, distinct grid coordinates of one axis
+  bool gridAxis(std::vector<double> values, double& min, double& spacing, unsigned int& n) {
+    std::sort(values.begin(), values.end());
+    const double tolerance = 1.E-6 * std::max(1., values.back() - values.front());
+    std::vector<double> distinct;
+    for (double value : values) {
+      if (distinct.empty() || value - distinct.back() > tolerance)
+        distinct.push_back(value);
+    }
+    n = distinct.size();
+    if (n < 2)
+      return false;
+    min = distinct.front();
+    spacing = (distinct.back() - distinct.front()) / (n - 1);
+    for (unsigned int i = 0; i < n; ++i) {
+      if (fabs(distinct[i] - (min + i * spacing)) > tolerance)
+        return false;
+    }
+    return true;
+  }
+
+}
+
+
+int main(int argc, char** argv) {
+
+  bool singlePrecision = false;
+  double lengthScale = 1.;
+  double fieldScale = 1.;
+  std::vector<std::string> files;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg(argv[i]);
+    if (arg == "--float")
+      singlePrecision = true;
+    else if (arg == "--length-scale" && i + 1 < argc)
+      lengthScale = atof(argv[++i]);
+    else if (arg == "--field-scale" && i + 1 < argc)
+      fieldScale = atof(argv[++i]);
+    else if (arg.compare(0, 2, "--") == 0) {
+      usage(argv[0]);
+      return 1;
+    }
+    else
+      files.push_back(arg);
+  }
+  if (files.size() != 2) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  std::ifstream in(files[0].c_str());
+  if (!in) {
+    std::cerr << "cannot open " << files[0] << std::endl;
+    return 1;
+  }
+
+  // read points
+  std::vector<double> points[3];
+  std::vector<double> values;
+  std::string line;
+  unsigned int lineNumber = 0;
+  while (std::getline(in, line)) {
+    ++lineNumber;
+    std::replace(line.begin(), line.end(), ',', ' ');
+    const size_t first = line.find_first_not_of(" \t\r");
+    if (first == std::string::npos || line[first] == '#' || line[first] == '%')
+      continue;
+
+    std::istringstream columns(line);
+    double x[3], B[3];
+    if (!(columns >> x[0] >> x[1] >> x[2] >> B[0] >> B[1] >> B[2])) {
+      std::cerr << files[0] << ":" << lineNumber << ": expected x y z Bx By Bz" << std::endl;
+      return 1;
+    }
+    for (unsigned int i = 0; i < 3; ++i) {
+      points[i].push_back(x[i] * lengthScale);
+      values.push_back(B[i] * fieldScale);
+    }
+  }
+
+  // grid
+  unsigned int nPoints[3];
+  double min[3], spacing[3];
+  for (unsigned int i = 0; i < 3; ++i) {
+    if (!gridAxis(points[i], min[i], spacing[i], nPoints[i])) {
+      std::cerr << "coordinate " << i << " does not form a regular grid with at least 2 points" << std::endl;
+      return 1;
+    }
+  }
+  const size_t nGrid = size_t(nPoints[0]) * nPoints[1] * nPoints[2];
+  if (points[0].size() != nGrid) {
+    std::cerr << "found " << points[0].size() << " points, the grid has " << nGrid << std::endl;
+    return 1;
+  }
+
+  // sort into the grid
+  std::vector<double> field(3 * nGrid, 0.);
+  std::vector<bool> filled(nGrid, false);
+  for (size_t p = 0; p < points[0].size(); ++p) {
+    unsigned int index[3];
+    for (unsigned int i = 0; i < 3; ++i)
+      index[i] = static_cast<unsigned int>(floor((points[i][p] - min[i]) / spacing[i] + 0.5));
+    const size_t gridIndex = (size_t(index[0]) * nPoints[1] + index[1]) * nPoints[2] + index[2];
+    if (filled[gridIndex]) {
+      std::cerr << "grid point (" << points[0][p] << ", " << points[1][p] << ", " << points[2][p] << ") appears twice" << std::endl;
+      return 1;
+    }
+    filled[gridIndex] = true;
+    for (unsigned int i = 0; i < 3; ++i)
+      field[3 * gridIndex + i] = values[3 * p + i];
+  }
+
+  try {
+    genfit::MappedField::write(files[1], nPoints, min, spacing, field, singlePrecision);
+  }
+  catch (genfit::Exception& e) {
+    std::cerr << e.what();
+    return 1;
+  }
+
+  std::cout << "wrote " << nPoints[0] << " x " << nPoints[1] << " x " << nPoints[2] << " grid points to " << files[1] << std::endl;
+  return 0;
+}
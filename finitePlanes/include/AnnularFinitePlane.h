@@ -0,0 +1,81 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @addtogroup genfit
+ * @{
+ */
+
+#ifndef genfit_AnnularFinitePlane_h
+#define genfit_AnnularFinitePlane_h
+
+#include "AbsFinitePlane.h"
+
+
+namespace genfit {
+
+/**
+ * @brief Annulus (forward disks) or sector of an annulus around the origin of the plane.
+ *
+ * The sector goes counter-clockwise from phiMin to phiMax (phi = atan2(v, u)).
+ * It is tested with cross products, no atan2 per point.
+ */
+class AnnularFinitePlane : public AbsFinitePlane {
+
+ public:
+
+  //! give radii rMin, rMax and optionally the sector phiMin, phiMax (rad)
+  AnnularFinitePlane(double rMin, double rMax, double phiMin = 0., double phiMax = 0.);
+  AnnularFinitePlane();
+  virtual ~AnnularFinitePlane();
+
+  bool isInActive(double u, double v) const override;
+  void Print(const Option_t* = "") const override;
+
+  AnnularFinitePlane* clone() const override {
+    return new AnnularFinitePlane(*this);
+  }
+
+ protected:
+
+  void isInActiveBatch(const double* u, const double* v, unsigned int n, bool* inActive) const override;
+
+ private:
+
+  bool isInSector(double u, double v) const {
+    const bool afterMin = (cosPhiMin_ * v - sinPhiMin_ * u >= 0);
+    const bool beforeMax = (u * sinPhiMax_ - v * cosPhiMax_ >= 0);
+    return convexSector_ ? (afterMin & beforeMax) : (afterMin | beforeMax);
+  }
+
+  double rMin_, rMax_, phiMin_, phiMax_;
+
+  double rMin2_, rMax2_;
+  bool fullCircle_;
+  bool convexSector_; // opening angle <= pi
+  double cosPhiMin_, sinPhiMin_, cosPhiMax_, sinPhiMax_;
+
+ public:
+
+  ClassDefOverride(AnnularFinitePlane,1)
+
+};
+
+} /* End of namespace genfit */
+/** @} */
+
+#endif // genfit_AnnularFinitePlane_h
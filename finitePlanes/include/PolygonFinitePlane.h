@@ -0,0 +1,77 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @addtogroup genfit
+ * @{
+ */
+
+#ifndef genfit_PolygonFinitePlane_h
+#define genfit_PolygonFinitePlane_h
+
+#include "AbsFinitePlane.h"
+
+#include <vector>
+
+
+namespace genfit {
+
+/**
+ * @brief Finite plane bounded by a simple (convex or concave) polygon.
+ *
+ * Points are tested with the bounding box first and then with the even-odd crossing rule.
+ */
+class PolygonFinitePlane : public AbsFinitePlane {
+
+ public:
+
+  //! give the corners (u[i], v[i]) in order along the boundary (at least 3)
+  PolygonFinitePlane(const std::vector<double>& u, const std::vector<double>& v);
+  PolygonFinitePlane();
+  virtual ~PolygonFinitePlane();
+
+  bool isInActive(double u, double v) const override;
+  void Print(const Option_t* = "") const override;
+
+  PolygonFinitePlane* clone() const override {
+    return new PolygonFinitePlane(*this);
+  }
+
+ protected:
+
+  void isInActiveBatch(const double* u, const double* v, unsigned int n, bool* inActive) const override;
+
+ private:
+
+  bool isInPolygon(double u, double v) const;
+
+  std::vector<double> u_;
+  std::vector<double> v_;
+
+  // bounding box
+  double uMin_, uMax_, vMin_, vMax_;
+
+ public:
+
+  ClassDefOverride(PolygonFinitePlane,1)
+
+};
+
+} /* End of namespace genfit */
+/** @} */
+
+#endif // genfit_PolygonFinitePlane_h
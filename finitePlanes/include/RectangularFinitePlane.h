@@ -41,20 +41,24 @@ class RectangularFinitePlane : public AbsFinitePlane {
   virtual ~RectangularFinitePlane();
 
   //override inActive & Print methods
-  bool isInActive(double u, double v) const;
-  void Print(const Option_t* = "") const;
+  bool isInActive(double u, double v) const override;
+  void Print(const Option_t* = "") const override;
 
-  RectangularFinitePlane* clone() const {
+  RectangularFinitePlane* clone() const override {
     return new RectangularFinitePlane(*this);
   }
 
+ protected:
+
+  void isInActiveBatch(const double* u, const double* v, unsigned int n, bool* inActive) const override;
+
  private:
 
   double uMin_, uMax_, vMin_, vMax_;
 
  public:
 
-  ClassDef(RectangularFinitePlane,1)
+  ClassDefOverride(RectangularFinitePlane,1)
 
 };
 
@@ -0,0 +1,72 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @addtogroup genfit
+ * @{
+ */
+
+#ifndef genfit_TrapezoidalFinitePlane_h
+#define genfit_TrapezoidalFinitePlane_h
+
+#include "AbsFinitePlane.h"
+
+
+namespace genfit {
+
+/**
+ * @brief Trapezoidal finite plane (wedge sensors), symmetric in u.
+ *
+ * The parallel sides are at v = -halfLength and v = +halfLength with half widths (in u)
+ * halfWidthMinV and halfWidthMaxV.
+ */
+class TrapezoidalFinitePlane : public AbsFinitePlane {
+
+ public:
+
+  TrapezoidalFinitePlane(double halfWidthMinV, double halfWidthMaxV, double halfLength);
+  TrapezoidalFinitePlane();
+  virtual ~TrapezoidalFinitePlane();
+
+  bool isInActive(double u, double v) const override;
+  void Print(const Option_t* = "") const override;
+
+  TrapezoidalFinitePlane* clone() const override {
+    return new TrapezoidalFinitePlane(*this);
+  }
+
+ protected:
+
+  void isInActiveBatch(const double* u, const double* v, unsigned int n, bool* inActive) const override;
+
+ private:
+
+  double halfWidthMinV_, halfWidthMaxV_, halfLength_;
+
+  // half width = halfWidthCenter_ + slope_ * v
+  double halfWidthCenter_, slope_;
+
+ public:
+
+  ClassDefOverride(TrapezoidalFinitePlane,1)
+
+};
+
+} /* End of namespace genfit */
+/** @} */
+
+#endif // genfit_TrapezoidalFinitePlane_h
@@ -0,0 +1,82 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "AnnularFinitePlane.h"
+
+#include "IO.h"
+
+#include <cassert>
+#include <cmath>
+
+namespace genfit {
+
+AnnularFinitePlane::AnnularFinitePlane(double rMin, double rMax, double phiMin, double phiMax)
+  : rMin_(rMin), rMax_(rMax), phiMin_(phiMin), phiMax_(phiMax),
+    rMin2_(rMin*rMin), rMax2_(rMax*rMax), fullCircle_(true), convexSector_(true),
+    cosPhiMin_(std::cos(phiMin)), sinPhiMin_(std::sin(phiMin)), cosPhiMax_(std::cos(phiMax)), sinPhiMax_(std::sin(phiMax))
+{
+  assert(rMin>=0);
+  assert(rMin<rMax);
+
+  if (phiMin != phiMax) {
+    double opening = std::fmod(phiMax - phiMin, 2.*M_PI);
+    if (opening <= 0)
+      opening += 2.*M_PI;
+    fullCircle_ = (opening >= 2.*M_PI);
+    convexSector_ = (opening <= M_PI);
+  }
+}
+
+AnnularFinitePlane::AnnularFinitePlane()
+  : rMin_(1.), rMax_(-1.), phiMin_(0.), phiMax_(0.),
+    rMin2_(1.), rMax2_(-1.), fullCircle_(true), convexSector_(true), //for this default ctor inActive always false
+    cosPhiMin_(1.), sinPhiMin_(0.), cosPhiMax_(1.), sinPhiMax_(0.)
+{}
+
+
+AnnularFinitePlane::~AnnularFinitePlane(){
+
+}
+
+bool AnnularFinitePlane::isInActive(double u, double v) const{
+  const double r2 = u*u + v*v;
+  if (r2<rMin2_ || r2>rMax2_)
+    return false;
+  return fullCircle_ || isInSector(u, v);
+}
+
+void AnnularFinitePlane::isInActiveBatch(const double* u, const double* v, unsigned int n, bool* inActive) const{
+  for (unsigned int i = 0; i < n; ++i) {
+    const double r2 = u[i]*u[i] + v[i]*v[i];
+    inActive[i] = (r2>=rMin2_) & (r2<=rMax2_);
+  }
+  if (fullCircle_)
+    return;
+  for (unsigned int i = 0; i < n; ++i)
+    inActive[i] = inActive[i] & isInSector(u[i], v[i]);
+}
+
+void AnnularFinitePlane::Print(const Option_t*) const{
+  printOut << "Annular Finite Plane Rmin=" << rMin_ << ", Rmax=" << rMax_;
+  if (!fullCircle_)
+    printOut << ", PhiMin=" << phiMin_ << ", PhiMax=" << phiMax_;
+  printOut << std::endl;
+}
+
+} /* End of namespace genfit */
@@ -0,0 +1,87 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PolygonFinitePlane.h"
+
+#include "IO.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace genfit {
+
+PolygonFinitePlane::PolygonFinitePlane(const std::vector<double>& u, const std::vector<double>& v)
+  : u_(u), v_(v),
+    uMin_(1.), uMax_(-1.), vMin_(1.), vMax_(-1.)
+{
+  assert(u.size()==v.size());
+  assert(u.size()>=3);
+
+  uMin_ = *std::min_element(u_.begin(), u_.end());
+  uMax_ = *std::max_element(u_.begin(), u_.end());
+  vMin_ = *std::min_element(v_.begin(), v_.end());
+  vMax_ = *std::max_element(v_.begin(), v_.end());
+}
+
+PolygonFinitePlane::PolygonFinitePlane()
+  : u_(), v_(), uMin_(1.), uMax_(-1.), vMin_(1.), vMax_(-1.) //for this default ctor inActive always false
+{}
+
+
+PolygonFinitePlane::~PolygonFinitePlane(){
+
+}
+
+bool PolygonFinitePlane::isInPolygon(double u, double v) const{
+  // even-odd rule: count crossings of the edges with the ray from (u, v) in +u direction
+  bool inside = false;
+  const unsigned int nCorners = u_.size();
+  for (unsigned int i = 0, j = nCorners - 1; i < nCorners; j = i++) {
+    if ((v_[i] > v) != (v_[j] > v)) {
+      const double uCross = u_[i] + (v - v_[i]) * (u_[j] - u_[i]) / (v_[j] - v_[i]);
+      if (u < uCross)
+        inside = !inside;
+    }
+  }
+  return inside;
+}
+
+bool PolygonFinitePlane::isInActive(double u, double v) const{
+  if (u<uMin_ || u>uMax_ || v<vMin_ || v>vMax_)
+    return false;
+  return isInPolygon(u, v);
+}
+
+void PolygonFinitePlane::isInActiveBatch(const double* u, const double* v, unsigned int n, bool* inActive) const{
+  for (unsigned int i = 0; i < n; ++i)
+    inActive[i] = (u[i]>=uMin_) & (u[i]<=uMax_) & (v[i]>=vMin_) & (v[i]<=vMax_);
+  for (unsigned int i = 0; i < n; ++i) {
+    if (inActive[i])
+      inActive[i] = isInPolygon(u[i], v[i]);
+  }
+}
+
+void PolygonFinitePlane::Print(const Option_t*) const{
+  printOut << "Polygon Finite Plane with " << u_.size() << " corners:";
+  for (unsigned int i = 0; i < u_.size(); ++i)
+    printOut << " (" << u_[i] << ", " << v_[i] << ")";
+  printOut << std::endl;
+}
+
+} /* End of namespace genfit */
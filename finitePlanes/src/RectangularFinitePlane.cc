@@ -46,6 +46,11 @@ bool RectangularFinitePlane::isInActive(double u, double v) const{
   return (u>=uMin_ && u<=uMax_ && v>=vMin_ && v<=vMax_);
 }
 
+void RectangularFinitePlane::isInActiveBatch(const double* u, const double* v, unsigned int n, bool* inActive) const{
+  for (unsigned int i = 0; i < n; ++i)
+    inActive[i] = (u[i]>=uMin_) & (u[i]<=uMax_) & (v[i]>=vMin_) & (v[i]<=vMax_);
+}
+
 void RectangularFinitePlane::Print(const Option_t*) const{
   printOut << "Rectangular Finite Plane Umin=" << uMin_ << ", Umax="
       << uMax_ << ", Vmin=" << vMin_ << ", Vmax=" << vMax_ << std::endl;
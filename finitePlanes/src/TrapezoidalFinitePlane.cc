@@ -0,0 +1,63 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrapezoidalFinitePlane.h"
+
+#include "IO.h"
+
+#include <cassert>
+#include <cmath>
+
+namespace genfit {
+
+TrapezoidalFinitePlane::TrapezoidalFinitePlane(double halfWidthMinV, double halfWidthMaxV, double halfLength)
+  : halfWidthMinV_(halfWidthMinV), halfWidthMaxV_(halfWidthMaxV), halfLength_(halfLength),
+    halfWidthCenter_(0.5 * (halfWidthMinV + halfWidthMaxV)),
+    slope_(0.5 * (halfWidthMaxV - halfWidthMinV) / halfLength)
+{
+  assert(halfWidthMinV>=0 && halfWidthMaxV>=0);
+  assert(halfWidthMinV>0 || halfWidthMaxV>0);
+  assert(halfLength>0);
+}
+
+TrapezoidalFinitePlane::TrapezoidalFinitePlane()
+  : halfWidthMinV_(-1.), halfWidthMaxV_(-1.), halfLength_(-1.),
+    halfWidthCenter_(-1.), slope_(0.) //for this default ctor inActive always false
+{}
+
+
+TrapezoidalFinitePlane::~TrapezoidalFinitePlane(){
+
+}
+
+bool TrapezoidalFinitePlane::isInActive(double u, double v) const{
+  return (std::fabs(v)<=halfLength_ && std::fabs(u)<=halfWidthCenter_+slope_*v);
+}
+
+void TrapezoidalFinitePlane::isInActiveBatch(const double* u, const double* v, unsigned int n, bool* inActive) const{
+  for (unsigned int i = 0; i < n; ++i)
+    inActive[i] = (std::fabs(v[i])<=halfLength_) & (std::fabs(u[i])<=halfWidthCenter_+slope_*v[i]);
+}
+
+void TrapezoidalFinitePlane::Print(const Option_t*) const{
+  printOut << "Trapezoidal Finite Plane half width at Vmin=" << halfWidthMinV_ << ", half width at Vmax="
+      << halfWidthMaxV_ << ", half length=" << halfLength_ << std::endl;
+}
+
+} /* End of namespace genfit */
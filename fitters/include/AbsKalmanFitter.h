@@ -30,6 +30,7 @@
 
 namespace genfit {
 
+class KalmanFitStatus;
 class KalmanFitterInfo;
 
 enum eMultipleMeasurementHandling {
@@ -65,6 +66,12 @@ class AbsKalmanFitter : public AbsFitter {
 
   //virtual void fitTrack(Track* tr, const AbsTrackRep* rep, double& chi2, double& ndf, int direction) = 0;
 
+  /**
+   * @brief Chi^2 and ndf of the forward and backward fit.
+   *
+   * Taken from the KalmanFitStatus, where the fit has accumulated them, unless the track has changed since the fit.
+   * Otherwise the increments of all updates are summed up.
+   */
   void getChiSquNdf(const Track* tr, const AbsTrackRep* rep, double& bChi2, double& fChi2, double& bNdf,  double& fNdf) const;
   double getChiSqu(const Track* tr, const AbsTrackRep* rep, int direction = -1) const;
   double getNdf(const Track* tr, const AbsTrackRep* rep, int direction = -1) const;
@@ -131,6 +138,9 @@ class AbsKalmanFitter : public AbsFitter {
 
  protected:
 
+  //! KalmanFitStatus of a fitted and unchanged track, whose chi^2 and ndf are valid, otherwise nullptr
+  const KalmanFitStatus* getValidFitStatus(const Track* tr, const AbsTrackRep* rep) const;
+
   //! get the measurementsOnPlane taking the multipleMeasurementHandling_ into account
   const std::vector<MeasurementOnPlane *> getMeasurements(const KalmanFitterInfo* fi, const TrackPoint* tp, int direction) const;
 
@@ -0,0 +1,142 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @addtogroup genfit
+ * @{
+ */
+
+#ifndef genfit_BatchKalmanFilter_h
+#define genfit_BatchKalmanFilter_h
+
+#include <TMatrixD.h>
+#include <TMatrixDSym.h>
+#include <TVectorD.h>
+
+#include <vector>
+
+
+namespace genfit {
+
+class Track;
+
+/**
+ * @brief Kalman filter running many tracks in lockstep.
+ *
+ * States, covariances, transport and noise matrices of all tracks are stored as
+ * structure of arrays ("matriplex"): element (i, j) of all tracks is contiguous.
+ * Every step of predict and update is then a loop over the tracks that the compiler vectorizes.
+ * The number of tracks is padded to a multiple of vectorWidth.
+ *
+ * All tracks of one update share the measurement matrix H, i.e. the tracks are grouped by
+ * measurement type; tracks without a measurement set are masked out of the update.
+ *
+ * filterForward() runs the filter on tracks prepared with the reference states of
+ * KalmanFitterRefTrack (transport matrix F, noise N and delta state c from the previous
+ * reference state, p_k = F p_{k-1} + c), e.g. by KalmanFitterRefTrack::prepareTrack().
+ * The extrapolation happens there, per track; here only the linear algebra is batched.
+ */
+class BatchKalmanFilter {
+
+ public:
+
+  static const unsigned int dim = 5;
+  static const unsigned int vectorWidth = 8;
+
+  explicit BatchKalmanFilter(unsigned int nTracks);
+
+  unsigned int getNTracks() const {return nTracks_;}
+
+  void setState(unsigned int iTrack, const TVectorD& state, const TMatrixDSym& cov);
+  void getState(unsigned int iTrack, TVectorD& state, TMatrixDSym& cov) const;
+  double getChi2(unsigned int iTrack) const {return chi2_[iTrack];}
+  double getNdf(unsigned int iTrack) const {return ndf_[iTrack];}
+  void resetChi2();
+
+  //! transport of track iTrack for the next predict(); tracks without one are not changed
+  void setTransport(unsigned int iTrack, const TMatrixD& F, const TMatrixDSym& N, const TVectorD& deltaState);
+  //! p = F p + c, C = F C F^T + N for all tracks
+  void predict();
+
+  //! measurement of track iTrack for the next update(); V is divided by the weight, ndf is weighted
+  void setMeasurement(unsigned int iTrack, const TVectorD& measurement, const TMatrixDSym& V, double weight = 1.);
+  //! update all tracks that have a measurement set, with the common H, and add the chi2 increments
+  void update(const TMatrixD& H);
+
+  /**
+   * @brief Forward filter over tracks with the same number of points with measurements.
+   *
+   * Uses the cardinal reps and their KalmanFitterInfos with reference states.
+   * Starts like KalmanFitterRefTrack at the forward prediction of the first point if there is one,
+   * else at the first reference state with the blown up seed covariance.
+   * Afterwards getState() gives the filtered state at the last point, getChi2() and getNdf() the sums
+   * (getNdf() is the sum of the weighted measurement dimensions).
+   *
+   * Several measurements of a point are applied one after the other, each with the covariance divided
+   * by its weight, as KalmanFitterRefTrack does for weightedAverage (the DAF setting). Measurements with
+   * weight below 1.01E-10 are skipped. The other eMultipleMeasurementHandling choices (closest measurement,
+   * unweighted) are not applied.
+   *
+   * With writeBack, the forward predictions and updates (with chi2 and ndf increments) are stored in the
+   * KalmanFitterInfos, and the forward chi2 and ndf in the KalmanFitStatus of the cardinal rep
+   * (created if the track has none), as after the forward pass of KalmanFitterRefTrack.
+   */
+  void filterForward(const std::vector<Track*>& tracks, bool writeBack = false);
+
+  void setBlowUpFactor(double blowUpFactor) {blowUpFactor_ = blowUpFactor;}
+  void setBlowUpMaxVal(double blowUpMaxVal) {blowUpMaxVal_ = blowUpMaxVal;}
+
+ private:
+
+  double* element(std::vector<double>& matriplex, unsigned int i) {return &matriplex[i * nPadded_];}
+  const double* element(const std::vector<double>& matriplex, unsigned int i) const {return &matriplex[i * nPadded_];}
+
+  //! invert the n x n matrices in place (symmetric positive definite, no pivoting)
+  void invert(std::vector<double>& matriplex, unsigned int n);
+
+  unsigned int nTracks_;
+  unsigned int nPadded_;
+
+  std::vector<double> state_; // dim x nPadded_
+  std::vector<double> cov_; // dim*dim x nPadded_
+  std::vector<double> transport_;
+  std::vector<double> noise_;
+  std::vector<double> deltaState_;
+
+  unsigned int measurementDim_;
+  std::vector<double> measurement_;
+  std::vector<double> measurementCov_;
+  std::vector<double> mask_; // 1 for tracks with a measurement, else 0
+  std::vector<double> ndfWeight_;
+
+  std::vector<double> chi2_;
+  std::vector<double> ndf_;
+
+  // work space
+  std::vector<double> work1_;
+  std::vector<double> work2_;
+  std::vector<double> work3_;
+
+  double blowUpFactor_;
+  double blowUpMaxVal_;
+
+};
+
+} /* End of namespace genfit */
+/** @} */
+
+#endif // genfit_BatchKalmanFilter_h
@@ -54,16 +54,20 @@ class KalmanFitStatus : public FitStatus {
   double getForwardNdf() const {return fNdf_;}
   double getBackwardNdf() const {return FitStatus::getNdf();}
   // virtual double getPVal() : not overridden, as it does the right thing.
-  double getForwardPVal() const {return std::max(0.,ROOT::Math::chisquared_cdf_c(fChi2_, fNdf_));}
+  double getForwardPVal() const {
+    if (fPval_ < 0)
+      fPval_ = std::max(0.,ROOT::Math::chisquared_cdf_c(fChi2_, fNdf_));
+    return fPval_;
+  }
   double getBackwardPVal() const {return FitStatus::getPVal(); }
 
   void setNumIterations(unsigned int numIterations) {numIterations_ = numIterations;}
   void setIsFittedWithDaf(bool fittedWithDaf = true) {fittedWithDaf_ = fittedWithDaf;}
   void setIsFittedWithReferenceTrack(bool fittedWithReferenceTrack = true) {fittedWithReferenceTrack_ = fittedWithReferenceTrack;}
   void setTrackLen(double trackLen) {trackLen_ = trackLen;}
-  void setForwardChi2(double fChi2) {fChi2_ = fChi2;}
+  void setForwardChi2(double fChi2) {fChi2_ = fChi2; fPval_ = -1e99;}
   void setBackwardChi2(double bChi2) {FitStatus::setChi2(bChi2);}
-  void setForwardNdf(double fNdf) {fNdf_ = fNdf;}
+  void setForwardNdf(double fNdf) {fNdf_ = fNdf; fPval_ = -1e99;}
   void setBackwardNdf(double bNdf) {FitStatus::setNdf(bNdf);}
 
   virtual void Print(const Option_t* = "") const override;
@@ -78,7 +82,7 @@ class KalmanFitStatus : public FitStatus {
 
   double fChi2_; // chi^2 of the forward fit
   double fNdf_; // degrees of freedom of the forward fit
-  double fPval_; // p-value of the forward fit, set whenever either of chi2 or ndf changes
+  mutable double fPval_; // p-value of the forward fit, calculated on demand, negative after chi2 or ndf have changed
 
  public:
 
@@ -58,6 +58,8 @@ class KalmanFitterInfo : public AbsFitterInfo {
   KalmanFittedStateOnPlane* getForwardUpdate() const {return forwardUpdate_.get();}
   KalmanFittedStateOnPlane* getBackwardUpdate() const {return backwardUpdate_.get();}
   KalmanFittedStateOnPlane* getUpdate(int direction) const {if (direction >=0) return forwardUpdate_.get(); return backwardUpdate_.get();}
+  //! Smoothed state of the Rauch-Tung-Striebel smoother (see KalmanFitterRefTrack::setUseRTSSmoother()).
+  MeasuredStateOnPlane* getSmoothedState() const {return smoothedState_.get();}
   const std::vector< genfit::MeasurementOnPlane* >& getMeasurementsOnPlane() const {return measurementsOnPlane_;}
   MeasurementOnPlane* getMeasurementOnPlane(int i = 0) const {if (i<0) i += measurementsOnPlane_.size(); return measurementsOnPlane_.at(i);}
   //! Get weighted mean of all measurements.
@@ -70,7 +72,13 @@ class KalmanFitterInfo : public AbsFitterInfo {
   std::vector<double> getWeights() const;
   //! Are the weights fixed?
   bool areWeightsFixed() const {return fixWeights_;}
-  //! Get unbiased or biased (default) smoothed state.
+  /**
+   * @brief Get unbiased or biased (default) smoothed state.
+   *
+   * If a smoothed state of the RTS smoother is available, it is the biased state, and the unbiased state is
+   * calculated by removing the information the forward update added to the forward prediction.
+   * Otherwise, forward and backward filter are averaged.
+   */
   const MeasuredStateOnPlane& getFittedState(bool biased = true) const override;
   //! Get unbiased (default) or biased residual from ith measurement.
   MeasurementOnPlane getResidual(unsigned int iMeasurement = 0, bool biased = false, bool onlyMeasurementErrors = true) const override; // calculate residual, track and measurement errors are added if onlyMeasurementErrors is false
@@ -83,6 +91,7 @@ class KalmanFitterInfo : public AbsFitterInfo {
   bool hasForwardUpdate() const override {return (forwardUpdate_.get() != nullptr);}
   bool hasBackwardUpdate() const override {return (backwardUpdate_.get() != nullptr);}
   bool hasUpdate(int direction) const override {if (direction < 0) return hasBackwardUpdate(); return hasForwardUpdate();}
+  bool hasSmoothedState() const {return (smoothedState_.get() != nullptr);}
   bool hasPredictionsAndUpdates() const {return (hasForwardPrediction() && hasBackwardPrediction() && hasForwardUpdate() && hasBackwardUpdate());}
 
   void setReferenceState(ReferenceStateOnPlane* referenceState);
@@ -92,6 +101,7 @@ class KalmanFitterInfo : public AbsFitterInfo {
   void setForwardUpdate(KalmanFittedStateOnPlane* forwardUpdate);
   void setBackwardUpdate(KalmanFittedStateOnPlane* backwardUpdate);
   void setUpdate(KalmanFittedStateOnPlane* update, int direction)  {if (direction >=0) setForwardUpdate(update); else setBackwardUpdate(update);}
+  void setSmoothedState(MeasuredStateOnPlane* smoothedState);
   void setMeasurementsOnPlane(const std::vector< genfit::MeasurementOnPlane* >& measurementsOnPlane);
   void addMeasurementOnPlane(MeasurementOnPlane* measurementOnPlane);
   void addMeasurementsOnPlane(const std::vector< genfit::MeasurementOnPlane* >& measurementsOnPlane);
@@ -118,6 +128,8 @@ class KalmanFitterInfo : public AbsFitterInfo {
   std::unique_ptr<KalmanFittedStateOnPlane> forwardUpdate_; // Ownership
   std::unique_ptr<MeasuredStateOnPlane> backwardPrediction_; // Ownership
   std::unique_ptr<KalmanFittedStateOnPlane> backwardUpdate_; // Ownership
+  //! Smoothed state of the RTS smoother. Replaces backward prediction and update.
+  std::unique_ptr<MeasuredStateOnPlane> smoothedState_; // Ownership
   mutable std::unique_ptr<MeasuredStateOnPlane> fittedStateUnbiased_; //!  cache
   mutable std::unique_ptr<MeasuredStateOnPlane> fittedStateBiased_; //!  cache
 
@@ -139,7 +151,7 @@ class KalmanFitterInfo : public AbsFitterInfo {
 
  public:
 
-  ClassDefOverride(KalmanFitterInfo,1)
+  ClassDefOverride(KalmanFitterInfo,2)
 
 };
 
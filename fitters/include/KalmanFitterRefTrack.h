@@ -29,6 +29,7 @@
 namespace genfit {
 
 class KalmanFitterInfo;
+class MeasuredStateOnPlane;
 class TrackPoint;
 
 /**
@@ -39,7 +40,7 @@ class KalmanFitterRefTrack : public AbsKalmanFitter {
   KalmanFitterRefTrack(unsigned int maxIterations = 4, double deltaPval = 1e-3, double blowUpFactor = 1e3,
 		       bool squareRootFormalism = false)
     : AbsKalmanFitter(maxIterations, deltaPval, blowUpFactor), refitAll_(false), deltaChi2Ref_(1),
-      squareRootFormalism_(squareRootFormalism)
+      squareRootFormalism_(squareRootFormalism), useRTSSmoother_(false)
   {}
 
   virtual ~KalmanFitterRefTrack() {}
@@ -70,9 +71,38 @@ class KalmanFitterRefTrack : public AbsKalmanFitter {
    */
   void setDeltaChi2Ref(double dChi2) {deltaChi2Ref_ = dChi2;}
 
+  /**
+   * @brief Smooth with the Rauch-Tung-Striebel smoother instead of a backward filter.
+   *
+   * After the forward filter, one backward sweep with the forward transport matrices of the reference states
+   * calculates the smoothed states, stored in KalmanFitterInfo::getSmoothedState(). There is no backward
+   * prediction and update; the backward chi2 and ndf of the KalmanFitStatus are those of the forward filter.
+   */
+  void setUseRTSSmoother(bool useRTSSmoother = true) {useRTSSmoother_ = useRTSSmoother;}
+  bool getUseRTSSmoother() const {return useRTSSmoother_;}
+
  private:
   void processTrackPoint(KalmanFitterInfo* fi, const KalmanFitterInfo* prevFi, const TrackPoint* tp, double& chi2, double& ndf, int direction);
   void processTrackPointSqrt(KalmanFitterInfo* fi, const KalmanFitterInfo* prevFi, const TrackPoint* tp, double& chi2, double& ndf, int direction);
+  //! Square-root formalism with fixed size matrices, for 5D track parameters
+  void processTrackPointSqrtFixed(KalmanFitterInfo* fi, const KalmanFitterInfo* prevFi, const TrackPoint* tp, double& chi2, double& ndf, int direction);
+
+  // Steps shared by the processTrackPoint variants, which differ only in the covariance algebra.
+  //! State prediction p_ = F * update of prevFi + delta state
+  void predictState(const KalmanFitterInfo* fi, const KalmanFitterInfo* prevFi, int direction);
+  //! Store p_ and C_ as the prediction of fi
+  void setPrediction(KalmanFitterInfo* fi, int direction);
+  /**
+   * @brief Start of the filter: the prediction of fi, or the reference state with the blown up covariance seed.
+   *
+   * The latter is stored as the prediction of fi. Sets p_ and returns the prediction.
+   */
+  const MeasuredStateOnPlane& startingPrediction(KalmanFitterInfo* fi, int direction);
+  //! Store p_ and C_ as the update of fi, add the increments to chi2 and ndf
+  void setUpdate(KalmanFitterInfo* fi, double chi2inc, double ndfInc, double& chi2, double& ndf, int direction);
+
+  //! RTS smoother: backward sweep over the forward updates, replaces the backward fit
+  void smoothTrack(Track* tr, const AbsTrackRep* rep);
 
   /**
    * @brief Remove referenceStates if they are too far from smoothed states.
@@ -103,13 +133,17 @@ class KalmanFitterRefTrack : public AbsKalmanFitter {
   TMatrixDSym Rinv_; //!
   TVectorD res_; //!
 
+  // aux variables for smoothTrack
+  TMatrixD gain_; //!
+
   // aux variables for removeOutdated
   TVectorD resM_; //!
 
   bool squareRootFormalism_;
+  bool useRTSSmoother_;
 
  public:
-  ClassDefOverride(KalmanFitterRefTrack, 1)
+  ClassDefOverride(KalmanFitterRefTrack, 2)
 
 };
 
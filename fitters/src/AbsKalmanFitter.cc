@@ -25,6 +25,7 @@
 #include "TrackPoint.h"
 #include "Exception.h"
 #include "KalmanFitterInfo.h"
+#include "KalmanFitStatus.h"
 #include "AbsMeasurement.h"
 
 #include "AbsKalmanFitter.h"
@@ -41,6 +42,15 @@ void AbsKalmanFitter::getChiSquNdf(const Track* tr, const AbsTrackRep* rep,
     double& bChi2, double& fChi2,
     double& bNdf,  double& fNdf) const {
 
+  const KalmanFitStatus* status = getValidFitStatus(tr, rep);
+  if (status != nullptr) {
+    bChi2 = status->getBackwardChi2();
+    fChi2 = status->getForwardChi2();
+    bNdf = std::max(0., status->getBackwardNdf());
+    fNdf = std::max(0., status->getForwardNdf());
+    return;
+  }
+
   bChi2 = 0;
   fChi2 = 0;
   bNdf = -1. * rep->getDim();
@@ -60,6 +70,8 @@ void AbsKalmanFitter::getChiSquNdf(const Track* tr, const AbsTrackRep* rep,
 
     KalmanFittedStateOnPlane* fup = fi->getForwardUpdate();
     KalmanFittedStateOnPlane* bup = fi->getBackwardUpdate();
+    if (bup == nullptr && fi->hasSmoothedState())
+      bup = fup; // RTS smoother, no backward fit
 
     if (fup == nullptr || bup == nullptr) {
       Exception exc("AbsKalmanFitter::getChiSqu(): fup == nullptr || bup == nullptr", __LINE__,__FILE__);
@@ -112,6 +124,14 @@ double AbsKalmanFitter::getRedChiSqu(const Track* tr, const AbsTrackRep* rep, in
 }
 
 double AbsKalmanFitter::getPVal(const Track* tr, const AbsTrackRep* rep, int direction) const {
+  const KalmanFitStatus* status = getValidFitStatus(tr, rep);
+  if (status != nullptr) {
+    // memoized in the status
+    if (direction < 0)
+      return status->getBackwardPVal();
+    return status->getForwardPVal();
+  }
+
   double bChi2(0), fChi2(0), bNdf(0), fNdf(0);
 
   getChiSquNdf(tr, rep, bChi2, fChi2, bNdf, fNdf);
@@ -122,6 +142,18 @@ double AbsKalmanFitter::getPVal(const Track* tr, const AbsTrackRep* rep, int dir
 }
 
 
+const KalmanFitStatus* AbsKalmanFitter::getValidFitStatus(const Track* tr, const AbsTrackRep* rep) const {
+  if (!tr->hasFitStatus(rep))
+    return nullptr;
+
+  const KalmanFitStatus* status = dynamic_cast<const KalmanFitStatus*>(tr->getFitStatus(rep));
+  if (status == nullptr || !status->isFitted() || status->hasTrackChanged())
+    return nullptr;
+
+  return status;
+}
+
+
 bool AbsKalmanFitter::isTrackPrepared(const Track* tr, const AbsTrackRep* rep) const {
   const std::vector<TrackPoint*>& points = tr->getPointsWithMeasurement();
 
@@ -166,7 +198,7 @@ bool AbsKalmanFitter::isTrackFitted(const Track* tr, const AbsTrackRep* rep) con
     if (!(fi->hasForwardUpdate()))
       return false;
 
-    if (!(fi->hasBackwardUpdate()))
+    if (!(fi->hasBackwardUpdate() || fi->hasSmoothedState()))
       return false;
   }
 
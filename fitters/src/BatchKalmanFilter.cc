@@ -0,0 +1,479 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "BatchKalmanFilter.h"
+
+#include "Exception.h"
+#include "KalmanFitStatus.h"
+#include "KalmanFittedStateOnPlane.h"
+#include "KalmanFitterInfo.h"
+#include "MeasuredStateOnPlane.h"
+#include "MeasurementOnPlane.h"
+#include "ReferenceStateOnPlane.h"
+#include "Track.h"
+#include "TrackPoint.h"
+
+#include <TVector3.h>
+
+#include <algorithm>
+
+
+namespace genfit {
+
+const unsigned int BatchKalmanFilter::dim;
+const unsigned int BatchKalmanFilter::vectorWidth;
+
+
+BatchKalmanFilter::BatchKalmanFilter(unsigned int nTracks) :
+  nTracks_(nTracks),
+  nPadded_((nTracks + vectorWidth - 1) / vectorWidth * vectorWidth),
+  measurementDim_(0),
+  blowUpFactor_(1e3), blowUpMaxVal_(1.E6)
+{
+  state_.assign(dim * nPadded_, 0.);
+  cov_.assign(dim * dim * nPadded_, 0.);
+  transport_.assign(dim * dim * nPadded_, 0.);
+  noise_.assign(dim * dim * nPadded_, 0.);
+  deltaState_.assign(dim * nPadded_, 0.);
+  for (unsigned int i = 0; i < dim; ++i) {
+    std::fill(element(cov_, i * dim + i), element(cov_, i * dim + i) + nPadded_, 1.);
+    std::fill(element(transport_, i * dim + i), element(transport_, i * dim + i) + nPadded_, 1.);
+  }
+
+  measurement_.assign(dim * nPadded_, 0.);
+  measurementCov_.assign(dim * dim * nPadded_, 0.);
+  mask_.assign(nPadded_, 0.);
+  ndfWeight_.assign(nPadded_, 0.);
+
+  chi2_.assign(nPadded_, 0.);
+  ndf_.assign(nPadded_, 0.);
+
+  work1_.resize(dim * dim * nPadded_);
+  work2_.resize(dim * dim * nPadded_);
+  work3_.resize(2 * dim * dim * nPadded_);
+}
+
+
+void BatchKalmanFilter::setState(unsigned int iTrack, const TVectorD& state, const TMatrixDSym& cov) {
+  for (unsigned int i = 0; i < dim; ++i) {
+    element(state_, i)[iTrack] = state(i);
+    for (unsigned int j = 0; j < dim; ++j)
+      element(cov_, i * dim + j)[iTrack] = cov(i, j);
+  }
+}
+
+
+void BatchKalmanFilter::getState(unsigned int iTrack, TVectorD& state, TMatrixDSym& cov) const {
+  state.ResizeTo(dim);
+  cov.ResizeTo(dim, dim);
+  for (unsigned int i = 0; i < dim; ++i) {
+    state(i) = element(state_, i)[iTrack];
+    for (unsigned int j = 0; j < dim; ++j)
+      cov(i, j) = element(cov_, i * dim + j)[iTrack];
+  }
+}
+
+
+void BatchKalmanFilter::resetChi2() {
+  std::fill(chi2_.begin(), chi2_.end(), 0.);
+  std::fill(ndf_.begin(), ndf_.end(), 0.);
+}
+
+
+void BatchKalmanFilter::setTransport(unsigned int iTrack, const TMatrixD& F, const TMatrixDSym& N, const TVectorD& deltaState) {
+  for (unsigned int i = 0; i < dim; ++i) {
+    element(deltaState_, i)[iTrack] = deltaState(i);
+    for (unsigned int j = 0; j < dim; ++j) {
+      element(transport_, i * dim + j)[iTrack] = F(i, j);
+      element(noise_, i * dim + j)[iTrack] = N(i, j);
+    }
+  }
+}
+
+
+void BatchKalmanFilter::predict() {
+  const unsigned int n = nPadded_;
+
+  // FC = F C
+  for (unsigned int i = 0; i < dim; ++i) {
+    for (unsigned int j = 0; j < dim; ++j) {
+      double* FC = element(work1_, i * dim + j);
+      std::fill(FC, FC + n, 0.);
+      for (unsigned int k = 0; k < dim; ++k) {
+        const double* F = element(transport_, i * dim + k);
+        const double* C = element(cov_, k * dim + j);
+        for (unsigned int t = 0; t < n; ++t)
+          FC[t] += F[t] * C[t];
+      }
+    }
+  }
+
+  // C = FC F^T + N
+  for (unsigned int i = 0; i < dim; ++i) {
+    for (unsigned int j = 0; j <= i; ++j) {
+      double* C = element(cov_, i * dim + j);
+      const double* N = element(noise_, i * dim + j);
+      std::copy(N, N + n, C);
+      for (unsigned int k = 0; k < dim; ++k) {
+        const double* FC = element(work1_, i * dim + k);
+        const double* F = element(transport_, j * dim + k);
+        for (unsigned int t = 0; t < n; ++t)
+          C[t] += FC[t] * F[t];
+      }
+      if (j != i)
+        std::copy(C, C + n, element(cov_, j * dim + i));
+    }
+  }
+
+  // p = F p + c
+  for (unsigned int i = 0; i < dim; ++i) {
+    double* p = element(work2_, i);
+    const double* c = element(deltaState_, i);
+    std::copy(c, c + n, p);
+    for (unsigned int k = 0; k < dim; ++k) {
+      const double* F = element(transport_, i * dim + k);
+      const double* state = element(state_, k);
+      for (unsigned int t = 0; t < n; ++t)
+        p[t] += F[t] * state[t];
+    }
+  }
+  std::copy(work2_.begin(), work2_.begin() + dim * n, state_.begin());
+
+  // tracks without transport for the next predict() stay unchanged
+  std::fill(transport_.begin(), transport_.end(), 0.);
+  std::fill(noise_.begin(), noise_.end(), 0.);
+  std::fill(deltaState_.begin(), deltaState_.end(), 0.);
+  for (unsigned int i = 0; i < dim; ++i)
+    std::fill(element(transport_, i * dim + i), element(transport_, i * dim + i) + n, 1.);
+}
+
+
+void BatchKalmanFilter::setMeasurement(unsigned int iTrack, const TVectorD& measurement, const TMatrixDSym& V, double weight) {
+  const unsigned int m = measurement.GetNrows();
+  if (m == 0 || m > dim || (measurementDim_ != 0 && m != measurementDim_)) {
+    Exception exc("BatchKalmanFilter::setMeasurement ==> all measurements of one update need the same dimension (at most 5)",__LINE__,__FILE__);
+    exc.setFatal();
+    throw exc;
+  }
+  measurementDim_ = m;
+
+  for (unsigned int a = 0; a < m; ++a) {
+    element(measurement_, a)[iTrack] = measurement(a);
+    for (unsigned int b = 0; b < m; ++b)
+      element(measurementCov_, a * m + b)[iTrack] = V(a, b) / weight;
+  }
+  mask_[iTrack] = 1.;
+  ndfWeight_[iTrack] = weight * m;
+}
+
+
+void BatchKalmanFilter::update(const TMatrixD& H) {
+  const unsigned int n = nPadded_;
+  const unsigned int m = measurementDim_;
+  if (m == 0)
+    return;
+  if (H.GetNrows() != (int)m || H.GetNcols() != (int)dim) {
+    Exception exc("BatchKalmanFilter::update ==> H does not match the dimension of the measurements",__LINE__,__FILE__);
+    exc.setFatal();
+    throw exc;
+  }
+
+  // H is common to all tracks, and mostly 0 and 1
+  double h[dim * dim];
+  for (unsigned int a = 0; a < m; ++a)
+    for (unsigned int k = 0; k < dim; ++k)
+      h[a * dim + k] = H(a, k);
+
+  // HC = H C (m x dim)
+  for (unsigned int a = 0; a < m; ++a) {
+    for (unsigned int j = 0; j < dim; ++j) {
+      double* HC = element(work1_, a * dim + j);
+      std::fill(HC, HC + n, 0.);
+      for (unsigned int k = 0; k < dim; ++k) {
+        const double hak = h[a * dim + k];
+        if (hak == 0.)
+          continue;
+        const double* C = element(cov_, k * dim + j);
+        for (unsigned int t = 0; t < n; ++t)
+          HC[t] += hak * C[t];
+      }
+    }
+  }
+
+  // S = H C H^T + V (m x m); unit matrix for masked tracks, so it can be inverted
+  for (unsigned int a = 0; a < m; ++a) {
+    for (unsigned int b = 0; b < m; ++b) {
+      double* S = element(work2_, a * m + b);
+      const double* V = element(measurementCov_, a * m + b);
+      std::copy(V, V + n, S);
+      for (unsigned int k = 0; k < dim; ++k) {
+        const double hbk = h[b * dim + k];
+        if (hbk == 0.)
+          continue;
+        const double* HC = element(work1_, a * dim + k);
+        for (unsigned int t = 0; t < n; ++t)
+          S[t] += HC[t] * hbk;
+      }
+      const double unit = (a == b) ? 1. : 0.;
+      for (unsigned int t = 0; t < n; ++t)
+        S[t] = mask_[t] * S[t] + (1. - mask_[t]) * unit;
+    }
+  }
+  invert(work2_, m);
+
+  // residual r = m - H p
+  double* r = &work3_[0];
+  for (unsigned int a = 0; a < m; ++a) {
+    double* ra = r + a * n;
+    const double* meas = element(measurement_, a);
+    std::copy(meas, meas + n, ra);
+    for (unsigned int k = 0; k < dim; ++k) {
+      const double hak = h[a * dim + k];
+      if (hak == 0.)
+        continue;
+      const double* state = element(state_, k);
+      for (unsigned int t = 0; t < n; ++t)
+        ra[t] -= hak * state[t];
+    }
+  }
+
+  // chi2 increment r^T S^-1 r, equal to the one from the updated residual
+  for (unsigned int a = 0; a < m; ++a) {
+    for (unsigned int b = 0; b < m; ++b) {
+      const double* Sinv = element(work2_, a * m + b);
+      const double* ra = r + a * n;
+      const double* rb = r + b * n;
+      for (unsigned int t = 0; t < n; ++t)
+        chi2_[t] += mask_[t] * ra[t] * Sinv[t] * rb[t];
+    }
+  }
+
+  // gain K = C H^T S^-1 (dim x m), masked
+  double* K = &work3_[dim * n];
+  for (unsigned int i = 0; i < dim; ++i) {
+    for (unsigned int a = 0; a < m; ++a) {
+      double* Kia = K + (i * m + a) * n;
+      std::fill(Kia, Kia + n, 0.);
+      for (unsigned int b = 0; b < m; ++b) {
+        const double* HC = element(work1_, b * dim + i);
+        const double* Sinv = element(work2_, b * m + a);
+        for (unsigned int t = 0; t < n; ++t)
+          Kia[t] += HC[t] * Sinv[t];
+      }
+      for (unsigned int t = 0; t < n; ++t)
+        Kia[t] *= mask_[t];
+    }
+  }
+
+  // p += K r, C -= K H C
+  for (unsigned int i = 0; i < dim; ++i) {
+    double* state = element(state_, i);
+    for (unsigned int a = 0; a < m; ++a) {
+      const double* Kia = K + (i * m + a) * n;
+      const double* ra = r + a * n;
+      for (unsigned int t = 0; t < n; ++t)
+        state[t] += Kia[t] * ra[t];
+    }
+    for (unsigned int j = 0; j <= i; ++j) {
+      double* C = element(cov_, i * dim + j);
+      for (unsigned int a = 0; a < m; ++a) {
+        const double* Kia = K + (i * m + a) * n;
+        const double* HC = element(work1_, a * dim + j);
+        for (unsigned int t = 0; t < n; ++t)
+          C[t] -= Kia[t] * HC[t];
+      }
+      if (j != i)
+        std::copy(C, C + n, element(cov_, j * dim + i));
+    }
+  }
+
+  for (unsigned int t = 0; t < n; ++t)
+    ndf_[t] += ndfWeight_[t];
+
+  std::fill(mask_.begin(), mask_.end(), 0.);
+  std::fill(ndfWeight_.begin(), ndfWeight_.end(), 0.);
+  measurementDim_ = 0;
+}
+
+
+void BatchKalmanFilter::invert(std::vector<double>& matriplex, unsigned int nn) {
+  // Gauss-Jordan in place; pivots are the diagonal elements of positive definite matrices
+  const unsigned int n = nPadded_;
+  for (unsigned int p = 0; p < nn; ++p) {
+    double* app = element(matriplex, p * nn + p);
+    for (unsigned int t = 0; t < n; ++t)
+      app[t] = 1. / app[t];
+    for (unsigned int b = 0; b < nn; ++b) {
+      if (b == p)
+        continue;
+      double* apb = element(matriplex, p * nn + b);
+      for (unsigned int t = 0; t < n; ++t)
+        apb[t] *= app[t];
+    }
+    for (unsigned int r = 0; r < nn; ++r) {
+      if (r == p)
+        continue;
+      double* arp = element(matriplex, r * nn + p);
+      for (unsigned int b = 0; b < nn; ++b) {
+        if (b == p)
+          continue;
+        double* arb = element(matriplex, r * nn + b);
+        const double* apb = element(matriplex, p * nn + b);
+        for (unsigned int t = 0; t < n; ++t)
+          arb[t] -= arp[t] * apb[t];
+      }
+      for (unsigned int t = 0; t < n; ++t)
+        arp[t] *= -app[t];
+    }
+  }
+}
+
+
+void BatchKalmanFilter::filterForward(const std::vector<Track*>& tracks, bool writeBack) {
+  if (tracks.size() != nTracks_) {
+    Exception exc("BatchKalmanFilter::filterForward ==> number of tracks does not match",__LINE__,__FILE__);
+    exc.setFatal();
+    throw exc;
+  }
+  if (tracks.empty())
+    return;
+
+  const unsigned int nPoints = tracks[0]->getNumPointsWithMeasurement();
+  for (unsigned int iTrack = 0; iTrack < nTracks_; ++iTrack) {
+    if (tracks[iTrack]->getNumPointsWithMeasurement() != nPoints ||
+        tracks[iTrack]->getCardinalRep()->getDim() != dim) {
+      Exception exc("BatchKalmanFilter::filterForward ==> tracks need the same number of points and 5D reps",__LINE__,__FILE__);
+      exc.setFatal();
+      throw exc;
+    }
+  }
+
+  resetChi2();
+
+  std::vector<KalmanFitterInfo*> infos(nTracks_);
+  std::vector<const AbsHMatrix*> pendingH(nTracks_);
+  std::vector<double> chi2Before(nTracks_);
+  std::vector<double> ndfBefore(nTracks_);
+  TVectorD state(dim);
+  TMatrixDSym cov(dim);
+
+  for (unsigned int iPoint = 0; iPoint < nPoints; ++iPoint) {
+
+    // reference states of this point
+    unsigned int maxMeasurements = 0;
+    for (unsigned int iTrack = 0; iTrack < nTracks_; ++iTrack) {
+      const Track* track = tracks[iTrack];
+      KalmanFitterInfo* fi = track->getPointWithMeasurement(iPoint)->getKalmanFitterInfo(track->getCardinalRep());
+      if (fi == nullptr || !fi->hasReferenceState()) {
+        Exception exc("BatchKalmanFilter::filterForward ==> no reference state; prepare the tracks with KalmanFitterRefTrack",__LINE__,__FILE__);
+        exc.setFatal();
+        throw exc;
+      }
+      infos[iTrack] = fi;
+      maxMeasurements = std::max(maxMeasurements, fi->getNumMeasurements());
+    }
+
+    // predict, or start like KalmanFitterRefTrack: with the forward prediction of the first point
+    // (set by prepareTrack in later iterations), else with the blown up seed covariance
+    for (unsigned int iTrack = 0; iTrack < nTracks_; ++iTrack) {
+      const ReferenceStateOnPlane* ref = infos[iTrack]->getReferenceState();
+      if (iPoint > 0) {
+        setTransport(iTrack, ref->getForwardTransportMatrix(), ref->getForwardNoiseMatrix(), ref->getForwardDeltaState());
+        continue;
+      }
+      if (infos[iTrack]->hasForwardPrediction()) {
+        const MeasuredStateOnPlane* prediction = infos[iTrack]->getForwardPrediction();
+        setState(iTrack, prediction->getState(), prediction->getCov());
+        continue;
+      }
+      const AbsTrackRep* rep = ref->getRep();
+      TMatrixDSym dummy(dim);
+      MeasuredStateOnPlane mop(ref->getState(), dummy, ref->getPlane(), rep, ref->getAuxInfo());
+      TVector3 pos, mom;
+      rep->getPosMom(mop, pos, mom);
+      rep->setPosMomCov(mop, pos, mom, tracks[iTrack]->getCovSeed());
+      mop.blowUpCov(blowUpFactor_, true, blowUpMaxVal_);
+      setState(iTrack, mop.getState(), mop.getCov());
+      if (writeBack)
+        infos[iTrack]->setForwardPrediction(new MeasuredStateOnPlane(mop));
+    }
+    if (iPoint > 0) {
+      predict();
+      if (writeBack) {
+        for (unsigned int iTrack = 0; iTrack < nTracks_; ++iTrack) {
+          const ReferenceStateOnPlane* ref = infos[iTrack]->getReferenceState();
+          getState(iTrack, state, cov);
+          infos[iTrack]->setForwardPrediction(new MeasuredStateOnPlane(state, cov, ref->getPlane(), ref->getRep(), ref->getAuxInfo()));
+        }
+      }
+    }
+    std::copy(chi2_.begin(), chi2_.begin() + nTracks_, chi2Before.begin());
+    std::copy(ndf_.begin(), ndf_.begin() + nTracks_, ndfBefore.begin());
+
+    // updates, grouped by measurement matrix
+    for (unsigned int iMeas = 0; iMeas < maxMeasurements; ++iMeas) {
+      for (unsigned int iTrack = 0; iTrack < nTracks_; ++iTrack) {
+        pendingH[iTrack] = nullptr;
+        if (iMeas < infos[iTrack]->getNumMeasurements() && infos[iTrack]->getMeasurementOnPlane(iMeas)->getWeight() > 1.01E-10)
+          pendingH[iTrack] = infos[iTrack]->getMeasurementOnPlane(iMeas)->getHMatrix();
+      }
+
+      for (unsigned int iFirst = 0; iFirst < nTracks_; ++iFirst) {
+        const AbsHMatrix* H = pendingH[iFirst];
+        if (H == nullptr)
+          continue;
+        for (unsigned int iTrack = iFirst; iTrack < nTracks_; ++iTrack) {
+          if (pendingH[iTrack] == nullptr || (pendingH[iTrack] != H && !pendingH[iTrack]->isEqual(*H)))
+            continue;
+          const MeasurementOnPlane* m = infos[iTrack]->getMeasurementOnPlane(iMeas);
+          setMeasurement(iTrack, m->getState(), m->getCov(), m->getWeight());
+          pendingH[iTrack] = nullptr;
+        }
+        update(H->getMatrix());
+      }
+    }
+
+    if (writeBack) {
+      for (unsigned int iTrack = 0; iTrack < nTracks_; ++iTrack) {
+        const ReferenceStateOnPlane* ref = infos[iTrack]->getReferenceState();
+        getState(iTrack, state, cov);
+        infos[iTrack]->setForwardUpdate(new KalmanFittedStateOnPlane(state, cov, ref->getPlane(), ref->getRep(), ref->getAuxInfo(),
+            chi2_[iTrack] - chi2Before[iTrack], ndf_[iTrack] - ndfBefore[iTrack]));
+      }
+    }
+  }
+
+  if (!writeBack)
+    return;
+
+  // forward chi2 and ndf of the fit status, ndf counted like KalmanFitterRefTrack (minus the track parameters)
+  for (unsigned int iTrack = 0; iTrack < nTracks_; ++iTrack) {
+    Track* track = tracks[iTrack];
+    const AbsTrackRep* rep = track->getCardinalRep();
+    KalmanFitStatus* status = track->hasFitStatus(rep) ? dynamic_cast<KalmanFitStatus*>(track->getFitStatus(rep)) : nullptr;
+    if (status == nullptr) {
+      status = new KalmanFitStatus();
+      track->setFitStatus(status, rep);
+    }
+    status->setForwardChi2(chi2_[iTrack]);
+    status->setForwardNdf(ndf_[iTrack] - dim);
+  }
+}
+
+} /* End of namespace genfit */
@@ -26,6 +26,7 @@
 #include "Exception.h"
 #include "KalmanFitterInfo.h"
 #include "KalmanFitStatus.h"
+#include "SqrtKalmanTools.h"
 #include "Track.h"
 #include "TrackPoint.h"
 #include "Tools.h"
@@ -375,6 +376,10 @@ KalmanFitter::processTrackPartially(Track* tr, const AbsTrackRep* rep, int start
   int nFailedHits;
   fitTrack(tr, rep, chi2, ndf, startId, endId, nFailedHits); // return value has no consequences here
 
+  // chi2 and ndf stored in the fit status do not match the updates anymore
+  if (tr->hasFitStatus(rep))
+    tr->getFitStatus(rep)->setHasTrackChanged();
+
 }
 
 
@@ -561,6 +566,41 @@ KalmanFitter::processTrackPoint(TrackPoint* tp,
         debugOut << "chi² increment = " << chi2inc << std::endl;
       }
     } // end loop over measurements
+  } else if (stateVector.GetNrows() == 5) {
+    // Square-root formalism with fixed size matrices, also applied only to the updates (see below).
+    Matrix5x5 S;
+    tools::covSqrt(cov, S);
+
+    const std::vector<MeasurementOnPlane *>& measurements = getMeasurements(fi, tp, direction);
+    for (std::vector<MeasurementOnPlane *>::const_iterator it = measurements.begin(); it != measurements.end(); ++it) {
+      const MeasurementOnPlane& mOnPlane = **it;
+      const double weight = mOnPlane.getWeight();
+
+      if (!canIgnoreWeights() && weight <= 1.01E-10) {
+        if (debugLvl_ > 0) {
+          debugOut << "Weight of measurement is almost 0, continue ... \n";
+        }
+        continue;
+      }
+
+      const TVectorD& measurement(mOnPlane.getState());
+      // (weighted) cov
+      chi2inc += tools::kalmanUpdateSqrt(S, stateVector, measurement, mOnPlane.getCov(),
+                                         (!canIgnoreWeights() && weight < 0.99999) ? weight : 1.,
+                                         mOnPlane.getHMatrix());
+
+      if (!canIgnoreWeights()) {
+        ndfInc += weight * measurement.GetNrows();
+      }
+      else
+        ndfInc += measurement.GetNrows();
+
+      if (debugLvl_ > 0) {
+        debugOut << "chi² increment = " << chi2inc << std::endl;
+      }
+    } // end loop over measurements
+
+    tools::covFromSqrt(S, cov);
   } else {
     // The square-root formalism is applied only to the updates, not
     // the prediction even though the addition of the noise covariance
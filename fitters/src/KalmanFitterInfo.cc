@@ -63,6 +63,8 @@ KalmanFitterInfo* KalmanFitterInfo::clone() const {
     retVal->setBackwardPrediction(new MeasuredStateOnPlane(*getBackwardPrediction()));
   if (hasBackwardUpdate())
     retVal->setBackwardUpdate(new KalmanFittedStateOnPlane(*getBackwardUpdate()));
+  if (hasSmoothedState())
+    retVal->setSmoothedState(new MeasuredStateOnPlane(*getSmoothedState()));
 
   retVal->measurementsOnPlane_.reserve(getNumMeasurements());
   for (std::vector<MeasurementOnPlane*>::const_iterator it = this->measurementsOnPlane_.begin(); it != this->measurementsOnPlane_.end(); ++it) {
@@ -184,6 +186,38 @@ const MeasuredStateOnPlane& KalmanFitterInfo::getFittedState(bool biased) const
   if (!biased && fittedStateUnbiased_)
     return *fittedStateUnbiased_;
 
+  // RTS smoother
+  if (smoothedState_) {
+    if (biased)
+      return *smoothedState_;
+
+    if(!forwardUpdate_ || !forwardPrediction_) {
+      Exception e("KalmanFitterInfo::getFittedState: Needed updates/predictions not available in this FitterInfo.", __LINE__,__FILE__);
+      e.setFatal();
+      throw e;
+    }
+
+    // The measurements contributed C_{k|k}^(-1) - C_{k|k-1}^(-1) to the information of the smoothed state.
+    // Subtract it in the weighted mean, so the measurement selection of the fitter needs not be known here.
+    TMatrixDSym smoothedInv, updateInv, predictionInv;
+    tools::invertMatrix(smoothedState_->getCov(), smoothedInv);
+    tools::invertMatrix(forwardUpdate_->getCov(), updateInv);
+    tools::invertMatrix(forwardPrediction_->getCov(), predictionInv);
+
+    TVectorD state(smoothedInv * smoothedState_->getState());
+    state -= updateInv * forwardUpdate_->getState();
+    state += predictionInv * forwardPrediction_->getState();
+
+    TMatrixDSym cov(smoothedInv);
+    cov -= updateInv;
+    cov += predictionInv;
+    tools::invertMatrix(cov);
+    state *= cov;
+
+    fittedStateUnbiased_.reset(new MeasuredStateOnPlane(state, cov, smoothedState_->getPlane(), rep_, smoothedState_->getAuxInfo()));
+    return *fittedStateUnbiased_;
+  }
+
 
   const TrackPoint* tp = this->getTrackPoint();
   const Track* tr = tp->getTrack();
@@ -408,8 +442,18 @@ void KalmanFitterInfo::setBackwardUpdate(KalmanFittedStateOnPlane* backwardUpdat
   backwardUpdate_.reset(backwardUpdate);
   fittedStateUnbiased_.reset();
   fittedStateBiased_.reset();
-  if (backwardUpdate_)
+  if (backwardUpdate_) {
     setPlane(backwardUpdate_->getPlane());
+    smoothedState_.reset(); // backward filter supersedes the RTS smoother
+  }
+}
+
+void KalmanFitterInfo::setSmoothedState(MeasuredStateOnPlane* smoothedState) {
+  smoothedState_.reset(smoothedState);
+  fittedStateUnbiased_.reset();
+  fittedStateBiased_.reset();
+  if (smoothedState_)
+    setPlane(smoothedState_->getPlane());
 }
 
 
@@ -454,6 +498,9 @@ void KalmanFitterInfo::setRep(const AbsTrackRep* rep) {
   if (backwardUpdate_)
     backwardUpdate_->setRep(rep);
 
+  if (smoothedState_)
+    smoothedState_->setRep(rep);
+
   for (std::vector<MeasurementOnPlane*>::iterator it = measurementsOnPlane_.begin(); it != measurementsOnPlane_.end(); ++it) {
     (*it)->setRep(rep);
   }
@@ -480,6 +527,7 @@ void KalmanFitterInfo::setWeights(const std::vector<double>& weights) {
 void KalmanFitterInfo::deleteForwardInfo() {
   setForwardPrediction(nullptr);
   setForwardUpdate(nullptr);
+  smoothedState_.reset(); // the RTS smoother is built on the forward fit
   fittedStateUnbiased_.reset();
   fittedStateBiased_.reset();
 }
@@ -532,6 +580,9 @@ void KalmanFitterInfo::Print(const Option_t*) const {
   if (backwardUpdate_) {
     printOut << "Backward update: "; backwardUpdate_->Print();
   }
+  if (smoothedState_) {
+    printOut << "Smoothed state: "; smoothedState_->Print();
+  }
 
 }
 
@@ -555,7 +606,7 @@ bool KalmanFitterInfo::checkConsistency(const genfit::PruneFlags* flags) const {
   SharedPlanePtr plane = getPlane();
 
   if (plane.get() == nullptr) {
-    if (!(referenceState_ || forwardPrediction_ || forwardUpdate_ || backwardPrediction_ || backwardUpdate_ || measurementsOnPlane_.size() > 0))
+    if (!(referenceState_ || forwardPrediction_ || forwardUpdate_ || backwardPrediction_ || backwardUpdate_ || smoothedState_ || measurementsOnPlane_.size() > 0))
       return true;
     errorOut << "KalmanFitterInfo::checkConsistency(): plane is nullptr" << std::endl;
     retVal = false;
@@ -654,6 +705,21 @@ bool KalmanFitterInfo::checkConsistency(const genfit::PruneFlags* flags) const {
     }
   }
 
+  if (smoothedState_) {
+    if(smoothedState_->getPlane() != plane) {
+      errorOut << "KalmanFitterInfo::checkConsistency(): smoothedState_ is not defined with the correct plane" << std::endl;
+      retVal = false;
+    }
+    if(smoothedState_->getRep() != rep_) {
+      errorOut << "KalmanFitterInfo::checkConsistency(): smoothedState_ is not defined with the correct TrackRep" << std::endl;
+      retVal = false;
+    }
+    if (smoothedState_->getState().GetNrows() != dim || smoothedState_->getCov().GetNrows() != dim) {
+      errorOut << "KalmanFitterInfo::checkConsistency(): smoothedState_ does not have the right dimension!" << std::endl;
+      retVal = false;
+    }
+  }
+
   for (std::vector<MeasurementOnPlane*>::const_iterator it = measurementsOnPlane_.begin(); it != measurementsOnPlane_.end(); ++it) {
     if((*it)->getPlane() != plane) {
       errorOut << "KalmanFitterInfo::checkConsistency(): measurement is not defined with the correct plane" << std::endl;
@@ -719,6 +785,7 @@ void KalmanFitterInfo::Streamer(TBuffer &R__b)
       deleteBackwardInfo();
       deleteReferenceInfo();
       deleteMeasurementInfo();
+      smoothedState_.reset();
       if (flag & 1) {
         referenceState_.reset(new ReferenceStateOnPlane());
         referenceState_->Streamer(R__b);
@@ -749,6 +816,12 @@ void KalmanFitterInfo::Streamer(TBuffer &R__b)
         backwardUpdate_->setPlane(getPlane());
         // rep needs to be fixed up
       }
+      if (flag & (1 << 5)) { // since version 2
+        smoothedState_.reset(new MeasuredStateOnPlane());
+        smoothedState_->Streamer(R__b);
+        smoothedState_->setPlane(getPlane());
+        // rep needs to be fixed up
+      }
       {
         std::vector<genfit::MeasurementOnPlane*,std::allocator<genfit::MeasurementOnPlane*> > &R__stl =  measurementsOnPlane_;
         TClass *R__tcl1 = TBuffer::GetClass(typeid(genfit::MeasurementOnPlane));
@@ -778,7 +851,8 @@ void KalmanFitterInfo::Streamer(TBuffer &R__b)
 		 | (!!forwardPrediction_ << 1)
 		 | (!!forwardUpdate_ << 2)
 		 | (!!backwardPrediction_ << 3)
-		 | (!!backwardUpdate_ << 4));
+		 | (!!backwardUpdate_ << 4)
+		 | (!!smoothedState_ << 5));
      R__b << flag;
      if (flag & 1)
        referenceState_->Streamer(R__b);
@@ -790,6 +864,8 @@ void KalmanFitterInfo::Streamer(TBuffer &R__b)
        backwardPrediction_->Streamer(R__b);
      if (flag & (1 << 4))
        backwardUpdate_->Streamer(R__b);
+     if (flag & (1 << 5))
+       smoothedState_->Streamer(R__b);
      {
        std::vector<genfit::MeasurementOnPlane*,std::allocator<genfit::MeasurementOnPlane*> > &R__stl =  measurementsOnPlane_;
        int R__n=(&R__stl) ? int(R__stl.size()) : 0;
@@ -28,6 +28,7 @@
 #include "KalmanFitterRefTrack.h"
 #include "KalmanFitterInfo.h"
 #include "KalmanFitStatus.h"
+#include "SqrtKalmanTools.h"
 
 #include <TDecompChol.h>
 #include <Math/ProbFunc.h>
@@ -103,6 +104,67 @@ TrackPoint* KalmanFitterRefTrack::fitTrack(Track* tr, const AbsTrackRep* rep, do
 }
 
 
+void KalmanFitterRefTrack::smoothTrack(Track* tr, const AbsTrackRep* rep)
+{
+  // the same points as the forward fit
+  std::vector<KalmanFitterInfo*> infos;
+  for (size_t i = 0; i < tr->getNumPointsWithMeasurement(); ++i) {
+    TrackPoint* tp = tr->getPointWithMeasurement(i);
+    if (tp->hasFitterInfo(rep))
+      infos.push_back(static_cast<KalmanFitterInfo*>(tp->getFitterInfo(rep)));
+  }
+
+  if (infos.empty())
+    return;
+
+  unsigned int dim = rep->getDim();
+  p_.ResizeTo(dim);
+  C_.ResizeTo(dim, dim);
+  res_.ResizeTo(dim);
+  gain_.ResizeTo(dim, dim);
+
+  // at the last point, the smoothed state is the forward update
+  KalmanFitterInfo* nextFi = infos.back();
+  nextFi->deleteBackwardInfo();
+  nextFi->setSmoothedState(new MeasuredStateOnPlane(*(nextFi->getForwardUpdate())));
+
+  for (int i = (int)infos.size() - 2; i >= 0; --i) {
+    KalmanFitterInfo* fi = infos[i];
+    const KalmanFittedStateOnPlane* update = fi->getForwardUpdate(); // p_{k|k}, C_{k|k}
+    const MeasuredStateOnPlane* nextPrediction = nextFi->getForwardPrediction(); // p_{k+1|k}, C_{k+1|k}
+    const MeasuredStateOnPlane* nextSmoothed = nextFi->getSmoothedState(); // p_{k+1|n}, C_{k+1|n}
+    const TMatrixD& F = nextFi->getReferenceState()->getForwardTransportMatrix(); // k -> k+1
+
+    // G = C_{k|k} F^T C_{k+1|k}^(-1)
+    tools::invertMatrix(nextPrediction->getCov(), covSumInv_);
+    gain_ = TMatrixD(update->getCov(), TMatrixD::kMultTranspose, F);
+    gain_ *= covSumInv_;
+
+    // p_{k|n} = p_{k|k} + G (p_{k+1|n} - p_{k+1|k})
+    res_ = nextSmoothed->getState();
+    res_ -= nextPrediction->getState();
+    p_ = update->getState();
+    p_ += gain_ * res_;
+
+    // C_{k|n} = C_{k|k} + G (C_{k+1|n} - C_{k+1|k}) G^T
+    C_ = nextSmoothed->getCov();
+    C_ -= nextPrediction->getCov();
+    C_.Similarity(gain_);
+    C_ += update->getCov();
+
+    if (debugLvl_ > 1) {
+      debugOut << " p_{k|n} (smoothed state)"; p_.Print();
+      debugOut << " C_{k|n} (smoothed covariance)"; C_.Print();
+    }
+
+    fi->deleteBackwardInfo();
+    fi->setSmoothedState(new MeasuredStateOnPlane(p_, C_, update->getPlane(), update->getRep(), update->getAuxInfo()));
+
+    nextFi = fi;
+  }
+}
+
+
 void KalmanFitterRefTrack::processTrackWithRep(Track* tr, const AbsTrackRep* rep, bool resortHits)
 {
   if (tr->hasFitStatus(rep) && tr->getFitStatus(rep)->isTrackPruned()) {
@@ -138,6 +200,10 @@ void KalmanFitterRefTrack::processTrackWithRep(Track* tr, const AbsTrackRep* rep
           debugOut << "KalmanFitterRefTrack::processTrack. Track preparation did not change anything!\n";
         }
 
+        // nothing has been fitted in this call, the status does not know chi2 and ndf yet
+        if (nIt == 0)
+          getChiSquNdf(tr, rep, chi2BW, chi2FW, ndfBW, ndfFW);
+
         status->setIsFitted();
 
         status->setIsFitConvergedPartially();
@@ -149,7 +215,11 @@ void KalmanFitterRefTrack::processTrackWithRep(Track* tr, const AbsTrackRep* rep
         status->setNFailedPoints(nFailedHits);
 
         status->setHasTrackChanged(false);
-        status->setCharge(rep->getCharge(*static_cast<KalmanFitterInfo*>(tr->getPointWithMeasurement(0)->getFitterInfo(rep))->getBackwardUpdate()));
+        const KalmanFitterInfo* firstInfo = static_cast<KalmanFitterInfo*>(tr->getPointWithMeasurement(0)->getFitterInfo(rep));
+        if (firstInfo->hasSmoothedState())
+          status->setCharge(rep->getCharge(*firstInfo->getSmoothedState()));
+        else
+          status->setCharge(rep->getCharge(*firstInfo->getBackwardUpdate()));
         status->setNumIterations(nIt);
         status->setForwardChi2(chi2FW);
         status->setBackwardChi2(chi2BW);
@@ -189,24 +259,36 @@ void KalmanFitterRefTrack::processTrackWithRep(Track* tr, const AbsTrackRep* rep
         debugOut << "KalmanFitterRefTrack::forward fit\n";
       TrackPoint* lastProcessedPoint = fitTrack(tr, rep, chi2FW, ndfFW, +1);
 
-      // fit backward
-      if (debugLvl_ > 0) {
-        debugOut << "KalmanFitterRefTrack::backward fit\n";
+      if (useRTSSmoother_) {
+        if (debugLvl_ > 0) {
+          debugOut << "KalmanFitterRefTrack::RTS smoother\n";
+        }
+        smoothTrack(tr, rep);
+
+        // the forward filter already has the chi2 of all measurements
+        chi2BW = chi2FW;
+        ndfBW = ndfFW;
       }
+      else {
+        // fit backward
+        if (debugLvl_ > 0) {
+          debugOut << "KalmanFitterRefTrack::backward fit\n";
+        }
 
-      // backward fit must not necessarily start at last hit, set prediction = forward update and blow up cov
-      if (lastProcessedPoint != nullptr) {
-        KalmanFitterInfo* lastInfo = static_cast<KalmanFitterInfo*>(lastProcessedPoint->getFitterInfo(rep));
-        if (! lastInfo->hasBackwardPrediction()) {
-          lastInfo->setBackwardPrediction(new MeasuredStateOnPlane(*(lastInfo->getForwardUpdate())));
-          lastInfo->getBackwardPrediction()->blowUpCov(blowUpFactor_, resetOffDiagonals_, blowUpMaxVal_);  // blow up cov
-          if (debugLvl_ > 0) {
-            debugOut << "blow up cov for backward fit at TrackPoint " << lastProcessedPoint << "\n";
+        // backward fit must not necessarily start at last hit, set prediction = forward update and blow up cov
+        if (lastProcessedPoint != nullptr) {
+          KalmanFitterInfo* lastInfo = static_cast<KalmanFitterInfo*>(lastProcessedPoint->getFitterInfo(rep));
+          if (! lastInfo->hasBackwardPrediction()) {
+            lastInfo->setBackwardPrediction(new MeasuredStateOnPlane(*(lastInfo->getForwardUpdate())));
+            lastInfo->getBackwardPrediction()->blowUpCov(blowUpFactor_, resetOffDiagonals_, blowUpMaxVal_);  // blow up cov
+            if (debugLvl_ > 0) {
+              debugOut << "blow up cov for backward fit at TrackPoint " << lastProcessedPoint << "\n";
+            }
           }
         }
-      }
 
-      fitTrack(tr, rep, chi2BW, ndfBW, -1);
+        fitTrack(tr, rep, chi2BW, ndfBW, -1);
+      }
 
       ++nIt;
 
@@ -299,6 +381,8 @@ void KalmanFitterRefTrack::processTrackWithRep(Track* tr, const AbsTrackRep* rep
   if (tp != nullptr) {
     if (static_cast<KalmanFitterInfo*>(tp->getFitterInfo(rep))->hasBackwardUpdate())
       charge = static_cast<KalmanFitterInfo*>(tp->getFitterInfo(rep))->getBackwardUpdate()->getCharge();
+    else if (static_cast<KalmanFitterInfo*>(tp->getFitterInfo(rep))->hasSmoothedState())
+      charge = static_cast<KalmanFitterInfo*>(tp->getFitterInfo(rep))->getSmoothedState()->getCharge();
   }
   status->setCharge(charge);
 
@@ -414,11 +498,14 @@ bool KalmanFitterRefTrack::prepareTrack(Track* tr, const AbsTrackRep* rep, bool
         if (prevFitterInfo == nullptr) {
           if (fitterInfo->hasBackwardUpdate())
             firstBackwardUpdate.reset(new MeasuredStateOnPlane(*(fitterInfo->getBackwardUpdate())));
+          else if (fitterInfo->hasSmoothedState()) // at the first point, the smoothed state equals the backward update
+            firstBackwardUpdate.reset(new MeasuredStateOnPlane(*(fitterInfo->getSmoothedState())));
         }
       }
 
-      // get smoothedState if available
-      if (fitterInfo->hasPredictionsAndUpdates()) {
+      // get smoothedState if available (forward/backward fit or RTS smoother)
+      if (fitterInfo->hasPredictionsAndUpdates() ||
+          (fitterInfo->hasSmoothedState() && fitterInfo->hasForwardUpdate())) {
         smoothedState = &(fitterInfo->getFittedState(true));
         if (debugLvl_ > 0) {
           debugOut << "got smoothed state \n";
@@ -546,7 +633,9 @@ bool KalmanFitterRefTrack::prepareTrack(Track* tr, const AbsTrackRep* rep, bool
       else if (rep != tr->getCardinalRep() &&
                 trackPoint->hasFitterInfo(tr->getCardinalRep()) &&
                 dynamic_cast<KalmanFitterInfo*>(trackPoint->getFitterInfo(tr->getCardinalRep())) != nullptr &&
-                static_cast<KalmanFitterInfo*>(trackPoint->getFitterInfo(tr->getCardinalRep()))->hasPredictionsAndUpdates() ) {
+                (static_cast<KalmanFitterInfo*>(trackPoint->getFitterInfo(tr->getCardinalRep()))->hasPredictionsAndUpdates() ||
+                 (static_cast<KalmanFitterInfo*>(trackPoint->getFitterInfo(tr->getCardinalRep()))->hasSmoothedState() &&
+                  static_cast<KalmanFitterInfo*>(trackPoint->getFitterInfo(tr->getCardinalRep()))->hasForwardUpdate())) ) {
         if (debugLvl_ > 0) {
           debugOut << "construct plane with smoothed state of cardinal rep fit \n";
         }
@@ -596,7 +685,9 @@ bool KalmanFitterRefTrack::prepareTrack(Track* tr, const AbsTrackRep* rep, bool
         else if (rep != tr->getCardinalRep() &&
                   trackPoint->hasFitterInfo(tr->getCardinalRep()) &&
                   dynamic_cast<KalmanFitterInfo*>(trackPoint->getFitterInfo(tr->getCardinalRep())) != nullptr &&
-                  static_cast<KalmanFitterInfo*>(trackPoint->getFitterInfo(tr->getCardinalRep()))->hasPredictionsAndUpdates() ) {
+                  (static_cast<KalmanFitterInfo*>(trackPoint->getFitterInfo(tr->getCardinalRep()))->hasPredictionsAndUpdates() ||
+                   (static_cast<KalmanFitterInfo*>(trackPoint->getFitterInfo(tr->getCardinalRep()))->hasSmoothedState() &&
+                    static_cast<KalmanFitterInfo*>(trackPoint->getFitterInfo(tr->getCardinalRep()))->hasForwardUpdate())) ) {
           if (debugLvl_ > 0) {
             debugOut << "extrapolate smoothed state of cardinal rep fit to plane\n";
           }
@@ -839,7 +930,8 @@ KalmanFitterRefTrack::removeOutdated(Track* tr, const AbsTrackRep* rep, int& not
     // check if we need to calculate or update reference state
     if (fitterInfo->hasReferenceState()) {
 
-      if (! fitterInfo->hasPredictionsAndUpdates()) {
+      if (! fitterInfo->hasPredictionsAndUpdates() &&
+          ! (fitterInfo->hasSmoothedState() && fitterInfo->hasForwardUpdate())) {
         if (debugLvl_ > 0) {
           debugOut << "reference state but not all predictions & updates -> do not touch reference state. \n";
         }
@@ -916,6 +1008,95 @@ KalmanFitterRefTrack::removeForwardBackwardInfo(Track* tr, const AbsTrackRep* re
 }
 
 
+void
+KalmanFitterRefTrack::predictState(const KalmanFitterInfo* fi, const KalmanFitterInfo* prevFi, int direction)
+{
+  const TMatrixD& F = fi->getReferenceState()->getTransportMatrix(direction); // Transport matrix
+  assert(F.GetNcols() == (int)fi->getRep()->getDim());
+
+  //p_ = ( F * prevFi->getUpdate(direction)->getState() ) + fi->getReferenceState()->getDeltaState(direction);
+  p_ = prevFi->getUpdate(direction)->getState();
+  p_ *= F;
+  p_ += fi->getReferenceState()->getDeltaState(direction);
+
+  if (debugLvl_ > 1) {
+    debugOut << "\033[31m";
+    debugOut << "F (Transport Matrix) "; F.Print();
+    debugOut << "p_{k,r} (reference state) "; fi->getReferenceState()->getState().Print();
+    debugOut << "c (delta state) "; fi->getReferenceState()->getDeltaState(direction).Print();
+    debugOut << "F*p_{k-1,r} + c "; (F *prevFi->getReferenceState()->getState() + fi->getReferenceState()->getDeltaState(direction)).Print();
+  }
+}
+
+
+void
+KalmanFitterRefTrack::setPrediction(KalmanFitterInfo* fi, int direction)
+{
+  fi->setPrediction(new MeasuredStateOnPlane(p_, C_, fi->getReferenceState()->getPlane(), fi->getReferenceState()->getRep(), fi->getReferenceState()->getAuxInfo()), direction);
+}
+
+
+const MeasuredStateOnPlane&
+KalmanFitterRefTrack::startingPrediction(KalmanFitterInfo* fi, int direction)
+{
+  if (fi->hasPrediction(direction)) {
+    if (debugLvl_ > 0) {
+      debugOut << "  Use prediction as start \n";
+    }
+    p_ = fi->getPrediction(direction)->getState();
+  }
+  else {
+    if (debugLvl_ > 0) {
+      debugOut << "  Use reference state and seed cov as start \n";
+    }
+    const AbsTrackRep *rep = fi->getReferenceState()->getRep();
+    p_ = fi->getReferenceState()->getState();
+
+    // Convert from 6D covariance of the seed to whatever the trackRep wants.
+    TMatrixDSym dummy(p_.GetNrows());
+    MeasuredStateOnPlane* mop = new MeasuredStateOnPlane(p_, dummy, fi->getReferenceState()->getPlane(), rep, fi->getReferenceState()->getAuxInfo());
+    TVector3 pos, mom;
+    rep->getPosMom(*mop, pos, mom);
+    rep->setPosMomCov(*mop, pos, mom, fi->getTrackPoint()->getTrack()->getCovSeed());
+    // Blow up, set.
+    mop->blowUpCov(blowUpFactor_, resetOffDiagonals_, blowUpMaxVal_);
+    fi->setPrediction(mop, direction);
+  }
+
+  if (debugLvl_ > 1) {
+    debugOut << "\033[31m";
+    debugOut << "p_{k,r} (reference state)"; fi->getReferenceState()->getState().Print();
+  }
+
+  return *(fi->getPrediction(direction));
+}
+
+
+void
+KalmanFitterRefTrack::setUpdate(KalmanFitterInfo* fi, double chi2inc, double ndfInc, double& chi2, double& ndf, int direction)
+{
+  chi2 += chi2inc;
+  ndf += ndfInc;
+
+
+  KalmanFittedStateOnPlane* upState = new KalmanFittedStateOnPlane(p_, C_, fi->getReferenceState()->getPlane(), fi->getReferenceState()->getRep(), fi->getReferenceState()->getAuxInfo(), chi2inc, ndfInc);
+  upState->setAuxInfo(fi->getReferenceState()->getAuxInfo());
+  fi->setUpdate(upState, direction);
+
+
+  if (debugLvl_ > 0) {
+    debugOut << " chi² inc " << chi2inc << "\t";
+    debugOut << " ndf inc  " << ndfInc << "\t";
+    debugOut << " charge of update  " << fi->getRep()->getCharge(*upState) << "\n";
+  }
+
+  // check
+  if (not fi->checkConsistency()) {
+    throw genfit::Exception("Consistency check failed ", __LINE__, __FILE__);
+  }
+}
+
+
 void
 KalmanFitterRefTrack::processTrackPoint(KalmanFitterInfo* fi, const KalmanFitterInfo* prevFi, const TrackPoint* tp, double& chi2, double& ndf, int direction)
 {
@@ -928,63 +1109,19 @@ KalmanFitterRefTrack::processTrackPoint(KalmanFitterInfo* fi, const KalmanFitter
     debugOut << " KalmanFitterRefTrack::processTrackPoint " << fi->getTrackPoint() << "\n";
   }
 
-  unsigned int dim = fi->getRep()->getDim();
-
-  p_.Zero(); // p_{k|k-1}
-  C_.Zero(); // C_{k|k-1}
-
   // predict
   if (prevFi != nullptr) {
+    predictState(fi, prevFi, direction); // p_{k|k-1}
+
     const TMatrixD& F = fi->getReferenceState()->getTransportMatrix(direction); // Transport matrix
-    assert(F.GetNcols() == (int)dim);
     const TMatrixDSym& N = fi->getReferenceState()->getNoiseMatrix(direction); // Noise matrix
-    //p_ = ( F * prevFi->getUpdate(direction)->getState() ) + fi->getReferenceState()->getDeltaState(direction);
-    p_ = prevFi->getUpdate(direction)->getState();
-    p_ *= F;
-    p_ += fi->getReferenceState()->getDeltaState(direction);
-
-    C_ = prevFi->getUpdate(direction)->getCov();
+    C_ = prevFi->getUpdate(direction)->getCov(); // C_{k|k-1}
     C_.Similarity(F);
     C_ += N;
-    fi->setPrediction(new MeasuredStateOnPlane(p_, C_, fi->getReferenceState()->getPlane(), fi->getReferenceState()->getRep(), fi->getReferenceState()->getAuxInfo()), direction);
-    if (debugLvl_ > 1) {
-      debugOut << "\033[31m";
-      debugOut << "F (Transport Matrix) "; F.Print();
-      debugOut << "p_{k,r} (reference state) "; fi->getReferenceState()->getState().Print();
-      debugOut << "c (delta state) "; fi->getReferenceState()->getDeltaState(direction).Print();
-      debugOut << "F*p_{k-1,r} + c "; (F *prevFi->getReferenceState()->getState() + fi->getReferenceState()->getDeltaState(direction)).Print();
-    }
+    setPrediction(fi, direction);
   }
   else {
-    if (fi->hasPrediction(direction)) {
-      if (debugLvl_ > 0) {
-        debugOut << "  Use prediction as start \n";
-      }
-      p_ = fi->getPrediction(direction)->getState();
-      C_ = fi->getPrediction(direction)->getCov();
-    }
-    else {
-      if (debugLvl_ > 0) {
-        debugOut << "  Use reference state and seed cov as start \n";
-      }
-      const AbsTrackRep *rep = fi->getReferenceState()->getRep();
-      p_ = fi->getReferenceState()->getState();
-
-      // Convert from 6D covariance of the seed to whatever the trackRep wants.
-      TMatrixDSym dummy(p_.GetNrows());
-      MeasuredStateOnPlane mop(p_, dummy, fi->getReferenceState()->getPlane(), rep, fi->getReferenceState()->getAuxInfo());
-      TVector3 pos, mom;
-      rep->getPosMom(mop, pos, mom);
-      rep->setPosMomCov(mop, pos, mom, fi->getTrackPoint()->getTrack()->getCovSeed());
-      // Blow up, set.
-      mop.blowUpCov(blowUpFactor_, resetOffDiagonals_, blowUpMaxVal_);
-      fi->setPrediction(new MeasuredStateOnPlane(mop), direction);
-      C_ = mop.getCov();
-    }
-    if (debugLvl_ > 1) {
-      debugOut << "\033[31m";
-      debugOut << "p_{k,r} (reference state)"; fi->getReferenceState()->getState().Print();
-    }
+    C_ = startingPrediction(fi, direction).getCov();
   }
 
   if (debugLvl_ > 1) {
@@ -1098,26 +1235,7 @@ KalmanFitterRefTrack::processTrackPoint(KalmanFitterInfo* fi, const KalmanFitter
 
   } // end loop over measurements
 
-  chi2 += chi2inc;
-  ndf += ndfInc;
-
-
-  KalmanFittedStateOnPlane* upState = new KalmanFittedStateOnPlane(p_, C_, fi->getReferenceState()->getPlane(), fi->getReferenceState()->getRep(), fi->getReferenceState()->getAuxInfo(), chi2inc, ndfInc);
-  upState->setAuxInfo(fi->getReferenceState()->getAuxInfo());
-  fi->setUpdate(upState, direction);
-
-
-  if (debugLvl_ > 0) {
-    debugOut << " chi² inc " << chi2inc << "\t";
-    debugOut << " ndf inc  " << ndfInc << "\t";
-    debugOut << " charge of update  " << fi->getRep()->getCharge(*upState) << "\n";
-  }
-
-  // check
-  if (not fi->checkConsistency()) {
-    throw genfit::Exception("Consistency check failed ", __LINE__, __FILE__);
-  }
-
+  setUpdate(fi, chi2inc, ndfInc, chi2, ndf, direction);
 }
 
 
@@ -1127,79 +1245,39 @@ void
 KalmanFitterRefTrack::processTrackPointSqrt(KalmanFitterInfo* fi, const KalmanFitterInfo* prevFi,
 					    const TrackPoint* tp, double& chi2, double& ndf, int direction)
 {
+  if (fi->getRep()->getDim() == 5) {
+    processTrackPointSqrtFixed(fi, prevFi, tp, chi2, ndf, direction);
+    return;
+  }
+
   if (debugLvl_ > 0) {
     debugOut << " KalmanFitterRefTrack::processTrackPointSqrt " << fi->getTrackPoint() << "\n";
   }
 
   unsigned int dim = fi->getRep()->getDim();
 
-  p_.Zero(); // p_{k|k-1}
-  C_.Zero(); // C_{k|k-1}
-
   TMatrixD S(dim, dim); // sqrt(C_);
 
   // predict
   if (prevFi != nullptr) {
+    predictState(fi, prevFi, direction); // p_{k|k-1}
+
     const TMatrixD& F = fi->getReferenceState()->getTransportMatrix(direction); // Transport matrix
-    assert(F.GetNcols() == (int)dim);
     const TMatrixDSym& N = fi->getReferenceState()->getNoiseMatrix(direction); // Noise matrix
-    //N = 0;
-
-    //p_ = ( F * prevFi->getUpdate(direction)->getState() ) + fi->getReferenceState()->getDeltaState(direction);
-    p_ = prevFi->getUpdate(direction)->getState();
-    p_ *= F;
-    p_ += fi->getReferenceState()->getDeltaState(direction);
-
-
     TDecompChol decompS(prevFi->getUpdate(direction)->getCov());
     decompS.Decompose();
     TMatrixD Q;
     tools::noiseMatrixSqrt(N, Q);
     tools::kalmanPredictionCovSqrt(decompS.GetU(), F, Q, S);
 
-    fi->setPrediction(new MeasuredStateOnPlane(p_, TMatrixDSym(TMatrixDSym::kAtA, S), fi->getReferenceState()->getPlane(), fi->getReferenceState()->getRep(), fi->getReferenceState()->getAuxInfo()), direction);
-    if (debugLvl_ > 1) {
-      debugOut << "\033[31m";
-      debugOut << "F (Transport Matrix) "; F.Print();
-      debugOut << "p_{k,r} (reference state) "; fi->getReferenceState()->getState().Print();
-      debugOut << "c (delta state) "; fi->getReferenceState()->getDeltaState(direction).Print();
-      debugOut << "F*p_{k-1,r} + c "; (F *prevFi->getReferenceState()->getState() + fi->getReferenceState()->getDeltaState(direction)).Print();
-    }
+    C_ = TMatrixDSym(TMatrixDSym::kAtA, S); // C_{k|k-1}
+    setPrediction(fi, direction);
   }
   else {
-    if (fi->hasPrediction(direction)) {
-      if (debugLvl_ > 0) {
-        debugOut << "  Use prediction as start \n";
-      }
-      p_ = fi->getPrediction(direction)->getState();
-      TDecompChol decompS(fi->getPrediction(direction)->getCov());
-      decompS.Decompose();
-      S = decompS.GetU();
-    }
-    else {
-      if (debugLvl_ > 0) {
-        debugOut << "  Use reference state and seed cov as start \n";
-      }
-      const AbsTrackRep *rep = fi->getReferenceState()->getRep();
-      p_ = fi->getReferenceState()->getState();
-
-      // Convert from 6D covariance of the seed to whatever the trackRep wants.
-      TMatrixDSym dummy(p_.GetNrows());
-      MeasuredStateOnPlane mop(p_, dummy, fi->getReferenceState()->getPlane(), rep, fi->getReferenceState()->getAuxInfo());
-      TVector3 pos, mom;
-      rep->getPosMom(mop, pos, mom);
-      rep->setPosMomCov(mop, pos, mom, fi->getTrackPoint()->getTrack()->getCovSeed());
-      // Blow up, set.
-      mop.blowUpCov(blowUpFactor_, resetOffDiagonals_, blowUpMaxVal_);
-      fi->setPrediction(new MeasuredStateOnPlane(mop), direction);
-      TDecompChol decompS(mop.getCov());
-      decompS.Decompose();
-      S = decompS.GetU();
-    }
-    if (debugLvl_ > 1) {
-      debugOut << "\033[31m";
-      debugOut << "p_{k,r} (reference state)"; fi->getReferenceState()->getState().Print();
-    }
+    C_ = startingPrediction(fi, direction).getCov();
+    TDecompChol decompS(C_);
+    decompS.Decompose();
+    S = decompS.GetU();
   }
 
   if (debugLvl_ > 1) {
@@ -1308,24 +1386,73 @@ KalmanFitterRefTrack::processTrackPointSqrt(KalmanFitterInfo* fi, const KalmanFi
 
   C_ = TMatrixDSym(TMatrixDSym::kAtA, S);
 
-  chi2 += chi2inc;
-  ndf += ndfInc;
+  setUpdate(fi, chi2inc, ndfInc, chi2, ndf, direction);
+}
 
 
-  KalmanFittedStateOnPlane* upState = new KalmanFittedStateOnPlane(p_, C_, fi->getReferenceState()->getPlane(), fi->getReferenceState()->getRep(), fi->getReferenceState()->getAuxInfo(), chi2inc, ndfInc);
-  upState->setAuxInfo(fi->getReferenceState()->getAuxInfo());
-  fi->setUpdate(upState, direction);
+void
+KalmanFitterRefTrack::processTrackPointSqrtFixed(KalmanFitterInfo* fi, const KalmanFitterInfo* prevFi,
+                                                 const TrackPoint* tp, double& chi2, double& ndf, int direction)
+{
+  if (debugLvl_ > 0) {
+    debugOut << " KalmanFitterRefTrack::processTrackPointSqrtFixed " << fi->getTrackPoint() << "\n";
+  }
 
+  Matrix5x5 S; // sqrt(C_), C_ = S^T S
 
-  if (debugLvl_ > 0) {
-    debugOut << " chi² inc " << chi2inc << "\t";
-    debugOut << " ndf inc  " << ndfInc << "\t";
-    debugOut << " charge of update  " << fi->getRep()->getCharge(*upState) << "\n";
+  // predict
+  if (prevFi != nullptr) {
+    predictState(fi, prevFi, direction); // p_{k|k-1}
+
+    tools::covSqrt(prevFi->getUpdate(direction)->getCov(), S);
+    tools::kalmanPredictionCovSqrt(fi->getReferenceState()->getTransportMatrix(direction),
+                                   fi->getReferenceState()->getNoiseMatrix(direction), S);
+    tools::covFromSqrt(S, C_); // C_{k|k-1}
+    setPrediction(fi, direction);
+  }
+  else {
+    tools::covSqrt(startingPrediction(fi, direction).getCov(), S);
   }
 
-  // check
-  if (not fi->checkConsistency()) {
-    throw genfit::Exception("Consistency check failed ", __LINE__, __FILE__);
+  if (debugLvl_ > 1) {
+    debugOut << " p_{k|k-1} (state prediction)"; p_.Print();
   }
 
+  // update(s)
+  double chi2inc = 0;
+  double ndfInc = 0;
+
+  const std::vector<MeasurementOnPlane *> measurements = getMeasurements(fi, tp, direction);
+  for (std::vector<MeasurementOnPlane *>::const_iterator it = measurements.begin(); it != measurements.end(); ++it) {
+    const MeasurementOnPlane& m = **it;
+
+    if (!canIgnoreWeights() && m.getWeight() <= 1.01E-10) {
+      if (debugLvl_ > 1) {
+        debugOut << "Weight of measurement is almost 0, continue ... /n";
+      }
+      continue;
+    }
+
+    // (weighted) cov
+    chi2inc += tools::kalmanUpdateSqrt(S, p_, m.getState(), m.getCov(),
+                                       (!canIgnoreWeights() && m.getWeight() < 0.99999) ? m.getWeight() : 1.,
+                                       m.getHMatrix());
+
+    if (debugLvl_ > 1) {
+      debugOut << "\033[32m";
+      debugOut << " p_{k|k} (updated state)"; p_.Print();
+      debugOut << "\033[0m";
+    }
+
+    if (!canIgnoreWeights()) {
+      ndfInc += m.getWeight() * m.getState().GetNrows();
+    }
+    else
+      ndfInc += m.getState().GetNrows();
+
+  } // end loop over measurements
+
+  tools::covFromSqrt(S, C_);
+
+  setUpdate(fi, chi2inc, ndfInc, chi2, ndf, direction);
 }
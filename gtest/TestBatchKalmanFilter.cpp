@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+
+#include <BatchKalmanFilter.h>
+#include <ConstField.h>
+#include <EigenMatrixTypedefs.h>
+#include <FieldManager.h>
+#include <KalmanFitStatus.h>
+#include <KalmanFittedStateOnPlane.h>
+#include <KalmanFitterInfo.h>
+#include <KalmanFitterRefTrack.h>
+#include <MaterialEffects.h>
+
+#include "TestTracks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace genfit {
+
+    class BatchKalmanFilterTests : public ::testing::Test {
+    protected:
+        typedef Eigen::Matrix<double, 5, 5> Matrix5;
+        typedef Eigen::Matrix<double, 5, 1> Vector5;
+
+        // deterministic pseudo random numbers
+        static double number(unsigned int i) {
+            return sin(1.7 * i + 0.3) * 0.5;
+        }
+
+        static Matrix5 positiveDefinite(unsigned int seed, double diagonal) {
+            Matrix5 A;
+            for (unsigned int i = 0; i < 25; ++i)
+                A(i / 5, i % 5) = number(seed + i);
+            return A * A.transpose() + diagonal * Matrix5::Identity();
+        }
+
+        static TMatrixDSym toRoot(const Matrix5& M) {
+            TMatrixDSym R(5);
+            for (unsigned int i = 0; i < 5; ++i)
+                for (unsigned int j = 0; j < 5; ++j)
+                    R(i, j) = M(i, j);
+            return R;
+        }
+    };
+
+    TEST_F(BatchKalmanFilterTests, AgreesWithSingleTrackFilter) {
+        const unsigned int nTracks = 11; // not a multiple of the vector width
+        BatchKalmanFilter filter(nTracks);
+
+        std::vector<Vector5> states(nTracks);
+        std::vector<Matrix5> covs(nTracks);
+        std::vector<double> chi2(nTracks, 0.);
+
+        // H of a 2D measurement in u, v
+        Eigen::Matrix<double, 2, 5> H = Eigen::Matrix<double, 2, 5>::Zero();
+        H(0, 3) = 1.;
+        H(1, 4) = 1.;
+        TMatrixD rootH(2, 5);
+        rootH(0, 3) = 1.;
+        rootH(1, 4) = 1.;
+
+        for (unsigned int iTrack = 0; iTrack < nTracks; ++iTrack) {
+            for (unsigned int i = 0; i < 5; ++i)
+                states[iTrack](i) = number(100 * iTrack + i);
+            covs[iTrack] = positiveDefinite(100 * iTrack + 10, 0.5);
+
+            TVectorD state(5);
+            for (unsigned int i = 0; i < 5; ++i)
+                state(i) = states[iTrack](i);
+            filter.setState(iTrack, state, toRoot(covs[iTrack]));
+        }
+
+        for (unsigned int iStep = 0; iStep < 3; ++iStep) {
+            // predict
+            for (unsigned int iTrack = 0; iTrack < nTracks; ++iTrack) {
+                const unsigned int seed = 1000 * iStep + 100 * iTrack;
+                Matrix5 F = Matrix5::Identity() + 0.1 * positiveDefinite(seed + 40, 0.);
+                Matrix5 N = 0.01 * positiveDefinite(seed + 70, 0.1);
+                Vector5 c;
+                TMatrixD rootF(5, 5);
+                TVectorD rootC(5);
+                for (unsigned int i = 0; i < 5; ++i) {
+                    c(i) = 0.1 * number(seed + 95 + i);
+                    rootC(i) = c(i);
+                    for (unsigned int j = 0; j < 5; ++j)
+                        rootF(i, j) = F(i, j);
+                }
+                filter.setTransport(iTrack, rootF, toRoot(N), rootC);
+
+                states[iTrack] = F * states[iTrack] + c;
+                covs[iTrack] = F * covs[iTrack] * F.transpose() + N;
+            }
+            filter.predict();
+
+            // update, every third track has no measurement
+            for (unsigned int iTrack = 0; iTrack < nTracks; ++iTrack) {
+                if ((iTrack + iStep) % 3 == 0)
+                    continue;
+                const unsigned int seed = 1000 * iStep + 100 * iTrack + 50;
+                Eigen::Vector2d m(number(seed), number(seed + 1));
+                Eigen::Matrix2d V;
+                V << 0.02, 0.005, 0.005, 0.03;
+                TVectorD rootM(2);
+                TMatrixDSym rootV(2);
+                for (unsigned int a = 0; a < 2; ++a) {
+                    rootM(a) = m(a);
+                    for (unsigned int b = 0; b < 2; ++b)
+                        rootV(a, b) = V(a, b);
+                }
+                filter.setMeasurement(iTrack, rootM, rootV);
+
+                const Eigen::Matrix2d S = H * covs[iTrack] * H.transpose() + V;
+                const Eigen::Vector2d r = m - H * states[iTrack];
+                const Eigen::Matrix<double, 5, 2> K = covs[iTrack] * H.transpose() * S.inverse();
+                states[iTrack] += K * r;
+                covs[iTrack] -= K * H * covs[iTrack];
+                chi2[iTrack] += r.dot(S.inverse() * r);
+            }
+            filter.update(rootH);
+        }
+
+        for (unsigned int iTrack = 0; iTrack < nTracks; ++iTrack) {
+            TVectorD state;
+            TMatrixDSym cov;
+            filter.getState(iTrack, state, cov);
+            for (unsigned int i = 0; i < 5; ++i) {
+                EXPECT_NEAR(states[iTrack](i), state(i), 1E-10);
+                for (unsigned int j = 0; j < 5; ++j)
+                    EXPECT_NEAR(covs[iTrack](i, j), cov(i, j), 1E-10);
+            }
+            EXPECT_NEAR(chi2[iTrack], filter.getChi2(iTrack), 1E-9);
+            EXPECT_EQ(4., filter.getNdf(iTrack)); // measured in two of three steps
+        }
+    }
+
+    class BatchKalmanFilterTrackTests : public ::testing::Test {
+    protected:
+        virtual void SetUp() {
+            genfit::FieldManager::getInstance()->init(new genfit::ConstField(0., 0., 20.));  // kGauss
+            genfit::MaterialEffects::getInstance()->init(nullptr);
+            genfit::MaterialEffects::getInstance()->setNoEffects();
+        }
+        virtual void TearDown() {
+            for (Track* track : m_tracks)
+                delete track;
+            genfit::MaterialEffects::getInstance()->destruct();
+            genfit::FieldManager::getInstance()->destruct();
+        }
+
+        std::vector<Track*> m_tracks;
+    };
+
+    TEST_F(BatchKalmanFilterTrackTests, AgreesWithKalmanFitterRefTrack) {
+        const unsigned int nTracks = 5;
+        const unsigned int nPoints = 8;
+        KalmanFitterRefTrack fitter;
+        for (unsigned int iTrack = 0; iTrack < nTracks; ++iTrack) {
+            m_tracks.push_back(testTracks::makePlanarTrack(TVector3(0., 0., 0.), TVector3(0.5 + 0.1 * iTrack, 0.1 * iTrack - 0.2, 0.2),
+                                                           nPoints, 0.01, 100 * iTrack));
+            fitter.processTrackWithRep(m_tracks[iTrack], m_tracks[iTrack]->getCardinalRep());
+        }
+
+        // forward pass of the fitter on the final reference states, removed before the batch filter
+        std::vector<KalmanFittedStateOnPlane> updates;
+        std::vector<double> chi2, ndf;
+        for (Track* track : m_tracks) {
+            KalmanFitStatus* status = static_cast<KalmanFitStatus*>(track->getFitStatus());
+            chi2.push_back(status->getForwardChi2());
+            ndf.push_back(status->getForwardNdf());
+            status->setForwardChi2(-1.);
+            status->setForwardNdf(-1.);
+            for (unsigned int iPoint = 0; iPoint < nPoints; ++iPoint) {
+                KalmanFitterInfo* fi = track->getPointWithMeasurement(iPoint)->getKalmanFitterInfo();
+                ASSERT_TRUE(fi->hasForwardUpdate());
+                updates.push_back(*(fi->getForwardUpdate()));
+                fi->setForwardUpdate(nullptr);
+            }
+        }
+
+        BatchKalmanFilter filter(nTracks);
+        filter.filterForward(m_tracks, true);
+
+        for (unsigned int iTrack = 0; iTrack < nTracks; ++iTrack) {
+            const KalmanFitStatus* status = static_cast<KalmanFitStatus*>(m_tracks[iTrack]->getFitStatus());
+            EXPECT_NEAR(chi2[iTrack], status->getForwardChi2(), 1E-6 * std::max(1., chi2[iTrack]));
+            EXPECT_DOUBLE_EQ(ndf[iTrack], status->getForwardNdf());
+            EXPECT_NEAR(chi2[iTrack], filter.getChi2(iTrack), 1E-6 * std::max(1., chi2[iTrack]));
+
+            for (unsigned int iPoint = 0; iPoint < nPoints; ++iPoint) {
+                const KalmanFittedStateOnPlane& expected = updates[iTrack * nPoints + iPoint];
+                const KalmanFitterInfo* fi = m_tracks[iTrack]->getPointWithMeasurement(iPoint)->getKalmanFitterInfo();
+                ASSERT_TRUE(fi->hasForwardUpdate());
+                const KalmanFittedStateOnPlane& update = *(fi->getForwardUpdate());
+                EXPECT_EQ(expected.getPlane(), update.getPlane());
+                for (unsigned int i = 0; i < 5; ++i) {
+                    EXPECT_NEAR(expected.getState()(i), update.getState()(i), 1E-8 * std::max(1., std::fabs(expected.getState()(i))));
+                    for (unsigned int j = 0; j < 5; ++j)
+                        EXPECT_NEAR(expected.getCov()(i, j), update.getCov()(i, j),
+                                    1E-6 * std::sqrt(expected.getCov()(i, i) * expected.getCov()(j, j)));
+                }
+                EXPECT_NEAR(expected.getChiSquareIncrement(), update.getChiSquareIncrement(), 1E-6 * std::max(1., expected.getChiSquareIncrement()));
+                EXPECT_DOUBLE_EQ(expected.getNdf(), update.getNdf());
+            }
+        }
+    }
+
+}
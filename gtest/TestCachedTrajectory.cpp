@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <TVector3.h>
+
+#include <CachedTrajectory.h>
+#include <ConstField.h>
+#include <DetPlane.h>
+#include <Exception.h>
+#include <FieldManager.h>
+#include <MaterialEffects.h>
+#include <MeasuredStateOnPlane.h>
+#include <RKTrackRep.h>
+
+#include <cmath>
+#include <vector>
+
+
+namespace genfit {
+
+    class CachedTrajectoryTests : public ::testing::Test {
+
+    protected:
+        virtual void SetUp() {
+            genfit::FieldManager::getInstance()->init(new genfit::ConstField(0., 0., 20.));  // kGauss
+            genfit::MaterialEffects::getInstance()->init(nullptr);
+            genfit::MaterialEffects::getInstance()->setNoEffects();
+            m_rep = new genfit::RKTrackRep(211);
+
+            TMatrixDSym cov(6);
+            for (int i = 0; i < 3; ++i) {
+                cov(i, i) = 1.E-4;
+                cov(i + 3, i + 3) = 1.E-6;
+            }
+            m_start = MeasuredStateOnPlane(m_rep);
+            m_rep->setPosMomCov(m_start, TVector3(0., 0., 0.), TVector3(1., 0., 1.), cov);
+
+            // "fitted" states every 20 cm
+            MeasuredStateOnPlane state(m_start);
+            m_states.push_back(state);
+            for (unsigned int i = 0; i < 4; ++i) {
+                m_rep->extrapolateBy(state, 20.);
+                m_states.push_back(state);
+            }
+            std::vector<const MeasuredStateOnPlane*> statePointers;
+            for (const MeasuredStateOnPlane& fittedState : m_states)
+                statePointers.push_back(&fittedState);
+            m_trajectory.setMaxStep(2.);
+            m_trajectory.build(statePointers);
+        }
+        virtual void TearDown() {
+            delete m_rep;
+            genfit::MaterialEffects::getInstance()->destruct();
+            genfit::FieldManager::getInstance()->destruct();
+        }
+
+        TVector3 extrapolatedPos(double s) const {
+            StateOnPlane state(m_start);
+            m_rep->extrapolateBy(state, s);
+            return m_rep->getPos(state);
+        }
+
+        genfit::RKTrackRep* m_rep;
+        MeasuredStateOnPlane m_start;
+        std::vector<MeasuredStateOnPlane> m_states;
+        CachedTrajectory m_trajectory;
+    };
+
+    TEST_F(CachedTrajectoryTests, InterpolatedPositions) {
+        EXPECT_EQ(41u, m_trajectory.getNNodes());
+        EXPECT_NEAR(0., m_trajectory.getStartLength(), 1.E-9);
+        EXPECT_NEAR(80., m_trajectory.getEndLength(), 1.E-4);
+
+        for (double s : {0., 7.3, 33.1, 61., 80.}) {
+            EXPECT_NEAR(0., (m_trajectory.getPos(s) - extrapolatedPos(s)).Mag(), 1.E-4);
+        }
+
+        TVector3 pos, mom;
+        m_trajectory.getPosMom(45., pos, mom);
+        EXPECT_NEAR(std::sqrt(2.), mom.Mag(), 1.E-9);
+        EXPECT_NEAR(1., mom.Z(), 1.E-4);
+    }
+
+    TEST_F(CachedTrajectoryTests, POCA) {
+        TVector3 pos, mom;
+        m_trajectory.getPosMom(45., pos, mom);
+        const TVector3 point = pos + 0.5 * mom.Orthogonal().Unit();
+
+        TVector3 poca;
+        EXPECT_NEAR(45., m_trajectory.getPOCA(point, poca), 1.E-3);
+        EXPECT_NEAR(0., (poca - pos).Mag(), 1.E-3);
+
+        MeasuredStateOnPlane state;
+        EXPECT_NEAR(45., m_trajectory.extrapolateToPoint(point, state), 1.E-3);
+        EXPECT_NEAR(0., (state.getPos() - pos).Mag(), 1.E-3);
+    }
+
+    TEST_F(CachedTrajectoryTests, POCAAlongTrajectory) {
+        // points off the trajectory at nodes, between them and in every state segment
+        for (double s : {0.7, 2., 19.9, 20., 31.3, 58., 64.5, 79.2}) {
+            TVector3 pos, mom;
+            m_trajectory.getPosMom(s, pos, mom);
+            const TVector3 point = pos + 0.3 * mom.Orthogonal().Unit();
+            TVector3 poca;
+            EXPECT_NEAR(s, m_trajectory.getPOCA(point, poca), 1.E-3);
+            EXPECT_NEAR(0., (poca - pos).Mag(), 1.E-3);
+        }
+
+        // points before the start and after the end are clamped to the ends
+        TVector3 poca;
+        EXPECT_NEAR(0., m_trajectory.getPOCA(extrapolatedPos(-5.), poca), 1.E-9);
+        EXPECT_NEAR(80., m_trajectory.getPOCA(extrapolatedPos(90.), poca), 1.E-4);
+    }
+
+    TEST_F(CachedTrajectoryTests, LocalExtrapolation) {
+        const SharedPlanePtr plane(new DetPlane(TVector3(0., 0., 30.), TVector3(0., 0., 1.)));
+        MeasuredStateOnPlane state;
+        const double length = m_trajectory.extrapolateToPlane(plane, state);
+
+        MeasuredStateOnPlane direct(m_start);
+        EXPECT_NEAR(m_rep->extrapolateToPlane(direct, plane), length, 1.E-4);
+        EXPECT_NEAR(0., (direct.getPos() - state.getPos()).Mag(), 1.E-4);
+        for (int i = 0; i < 5; ++i)
+            EXPECT_NEAR(direct.getCov()(i, i), state.getCov()(i, i), 1.E-4 * direct.getCov()(i, i));
+
+        state = m_trajectory.getState(55.);
+        EXPECT_NEAR(0., (state.getPos() - extrapolatedPos(55.)).Mag(), 1.E-4);
+
+        const SharedPlanePtr missed(new DetPlane(TVector3(0., 0., 500.), TVector3(0., 0., 1.)));
+        EXPECT_THROW(m_trajectory.extrapolateToPlane(missed, state), genfit::Exception);
+    }
+
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <ChebyshevField.h>
+#include <ConstField.h>
+#include <Exception.h>
+
+#include <cmath>
+#include <sstream>
+
+namespace genfit {
+
+    class ChebyshevFieldTests : public ::testing::Test {
+    protected:
+        // solenoid-like field with a smooth fringe
+        static void solenoid(double x, double y, double z, double& Bx, double& By, double& Bz) {
+            const double t1 = tanh((150. - z) / 20.);
+            const double t2 = tanh((150. + z) / 20.);
+            const double fringe = 0.5 * (t1 + t2);
+            const double dFringe = 0.5 * ((1. - t2 * t2) - (1. - t1 * t1)) / 20.;
+            Bz = 15. * fringe;
+            Bx = -0.5 * 15. * dFringe * x;
+            By = -0.5 * 15. * dFringe * y;
+        }
+    };
+
+    TEST_F(ChebyshevFieldTests, Accuracy) {
+        const double min[3] = {-100., -100., -250.};
+        const double max[3] = {100., 100., 250.};
+        const unsigned int nCells[3] = {2, 2, 10};
+        const double tolerance = 1E-3;
+        ChebyshevField field(solenoid, min, max, nCells, tolerance, 10);
+        EXPECT_LE(field.getMaxFitError(), tolerance);
+
+        // much smaller than a grid map with 1 cm spacing
+        EXPECT_LT(field.getNCoefficients(), 100000u);
+
+        for (double x = -99.5; x < 100.; x += 13.3) {
+            for (double z = -249.5; z < 250.; z += 7.1) {
+                const double y = 0.7 * x - 10.;
+                double expected[3], B[3];
+                solenoid(x, y, z, expected[0], expected[1], expected[2]);
+                field.get(x, y, z, B[0], B[1], B[2]);
+                for (unsigned int i = 0; i < 3; ++i)
+                    EXPECT_NEAR(expected[i], B[i], 2. * tolerance) << x << " " << y << " " << z;
+            }
+        }
+
+        // outside of the volume
+        EXPECT_EQ(0., field.get(TVector3(0., 0., 250.1)).Mag());
+    }
+
+    TEST_F(ChebyshevFieldTests, ConstantField) {
+        const double min[3] = {-10., -10., -10.};
+        const double max[3] = {10., 10., 10.};
+        const unsigned int nCells[3] = {2, 3, 4};
+        ConstField constField(0.1, -0.2, 15.);
+        ChebyshevField field(constField, min, max, nCells, 1E-9);
+        EXPECT_EQ(0u, field.getOrder(1, 2, 3));
+        EXPECT_EQ(2u * 3u * 4u * 3u, field.getNCoefficients());
+
+        const TVector3 B = field.get(TVector3(3., -7., 9.));
+        EXPECT_NEAR(0.1, B.X(), 1E-12);
+        EXPECT_NEAR(-0.2, B.Y(), 1E-12);
+        EXPECT_NEAR(15., B.Z(), 1E-12);
+    }
+
+    TEST_F(ChebyshevFieldTests, Serialization) {
+        const double min[3] = {-100., -100., -250.};
+        const double max[3] = {100., 100., 250.};
+        const unsigned int nCells[3] = {1, 1, 5};
+        ChebyshevField field(solenoid, min, max, nCells, 1E-2);
+
+        std::stringstream stream;
+        field.write(stream);
+        ChebyshevField readField(stream);
+        EXPECT_EQ(field.getNCoefficients(), readField.getNCoefficients());
+        EXPECT_EQ(field.getMaxFitError(), readField.getMaxFitError());
+
+        for (double z = -240.; z < 250.; z += 33.) {
+            const TVector3 pos(12., -30., z);
+            const TVector3 B = field.get(pos);
+            const TVector3 readB = readField.get(pos);
+            EXPECT_EQ(B.X(), readB.X());
+            EXPECT_EQ(B.Y(), readB.Y());
+            EXPECT_EQ(B.Z(), readB.Z());
+        }
+
+        std::stringstream garbage("not a field");
+        EXPECT_THROW(ChebyshevField garbageField(garbage), Exception);
+    }
+
+}
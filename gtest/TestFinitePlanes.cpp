@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <AnnularFinitePlane.h>
+#include <PolygonFinitePlane.h>
+#include <RectangularFinitePlane.h>
+#include <TrapezoidalFinitePlane.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+
+namespace genfit {
+
+    class FinitePlaneTests : public ::testing::Test {
+
+    protected:
+        virtual void SetUp() {
+            // grid of points covering all shapes
+            for (double u = -6.05; u < 6.; u += 0.1) {
+                for (double v = -6.05; v < 6.; v += 0.1) {
+                    m_u.push_back(u);
+                    m_v.push_back(v);
+                }
+            }
+        }
+
+        // batch test must agree with the single point test
+        void checkBatch(const AbsFinitePlane& plane) const {
+            std::unique_ptr<bool[]> inActive(new bool[m_u.size()]);
+            plane.areInActive(m_u.data(), m_v.data(), m_u.size(), inActive.get());
+            for (unsigned int i = 0; i < m_u.size(); ++i)
+                EXPECT_EQ(plane.isInActive(m_u[i], m_v[i]), inActive[i]) << "u = " << m_u[i] << ", v = " << m_v[i];
+        }
+
+        std::vector<double> m_u;
+        std::vector<double> m_v;
+    };
+
+    TEST_F(FinitePlaneTests, Rectangle) {
+        RectangularFinitePlane plane(-1., 2., -3., 4.);
+        EXPECT_TRUE(plane.isInActive(1.9, -2.9));
+        EXPECT_FALSE(plane.isInActive(2.1, 0.));
+        checkBatch(plane);
+    }
+
+    TEST_F(FinitePlaneTests, Trapezoid) {
+        TrapezoidalFinitePlane plane(1., 3., 5.);
+        EXPECT_TRUE(plane.isInActive(0.9, -4.9));
+        EXPECT_FALSE(plane.isInActive(1.1, -4.9));
+        EXPECT_TRUE(plane.isInActive(-2.9, 4.9));
+        EXPECT_TRUE(plane.isInActive(1.9, 0.));
+        EXPECT_FALSE(plane.isInActive(2.1, 0.));
+        EXPECT_FALSE(plane.isInActive(0., 5.1));
+        checkBatch(plane);
+    }
+
+    TEST_F(FinitePlaneTests, Annulus) {
+        AnnularFinitePlane ring(1., 5.);
+        EXPECT_FALSE(ring.isInActive(0.5, 0.5));
+        EXPECT_TRUE(ring.isInActive(-3., 3.));
+        EXPECT_FALSE(ring.isInActive(4., 4.));
+        checkBatch(ring);
+
+        // sector with opening below and above pi
+        AnnularFinitePlane wedge(1., 5., -0.25 * M_PI, 0.25 * M_PI);
+        EXPECT_TRUE(wedge.isInActive(3., 0.));
+        EXPECT_TRUE(wedge.isInActive(2., 1.9));
+        EXPECT_FALSE(wedge.isInActive(2., 2.1));
+        EXPECT_FALSE(wedge.isInActive(-3., 0.));
+        checkBatch(wedge);
+
+        AnnularFinitePlane wideSector(1., 5., 0., 1.5 * M_PI);
+        EXPECT_TRUE(wideSector.isInActive(-3., 0.));
+        EXPECT_TRUE(wideSector.isInActive(-2., -2.));
+        EXPECT_FALSE(wideSector.isInActive(2., -2.));
+        checkBatch(wideSector);
+    }
+
+    TEST_F(FinitePlaneTests, Polygon) {
+        // concave L shape
+        PolygonFinitePlane plane({0., 4., 4., 1., 1., 0.}, {0., 0., 1., 1., 4., 4.});
+        EXPECT_TRUE(plane.isInActive(3., 0.5));
+        EXPECT_TRUE(plane.isInActive(0.5, 3.));
+        EXPECT_FALSE(plane.isInActive(3., 3.));
+        EXPECT_FALSE(plane.isInActive(-0.5, 0.5));
+        checkBatch(plane);
+    }
+
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <GFGblDiagnostics.h>
+
+#include <thread>
+#include <vector>
+
+namespace genfit {
+
+    class GFGblDiagnosticsTests : public ::testing::Test {
+    protected:
+        // sensor id of a VXD layer (not a telescope), see GFGblHistograms::layerOfSensor
+        static unsigned int vxdSensor(unsigned int vxdLayer) {
+            return vxdLayer << 13;
+        }
+    };
+
+    TEST_F(GFGblDiagnosticsTests, AtomicHistogram) {
+        AtomicHistogram histogram("h", "test", 10, 0., 1.);
+        histogram.fill(-0.5);
+        histogram.fill(0.);
+        histogram.fill(0.55);
+        histogram.fill(1.);
+        histogram.fill(7.);
+        EXPECT_EQ(1u, histogram.getBinContent(0));
+        EXPECT_EQ(1u, histogram.getBinContent(1));
+        EXPECT_EQ(1u, histogram.getBinContent(6));
+        EXPECT_EQ(2u, histogram.getBinContent(11));
+        EXPECT_EQ(5u, histogram.getEntries());
+    }
+
+    TEST_F(GFGblDiagnosticsTests, ParallelFilling) {
+        AtomicHistogram histogram("h", "test", 100, 0., 1.);
+        const unsigned int nThreads = 4, nFills = 10000;
+        std::vector<std::thread> threads;
+        for (unsigned int ithr = 0; ithr < nThreads; ++ithr) {
+            threads.emplace_back([&histogram, ithr]() {
+                for (unsigned int i = 0; i < nFills; ++i)
+                    histogram.fill((i % 100 + 0.5) / 100.);
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        EXPECT_EQ(nThreads * nFills, histogram.getEntries());
+        for (unsigned int bin = 1; bin <= 100; ++bin)
+            EXPECT_EQ(nThreads * nFills / 100, histogram.getBinContent(bin));
+    }
+
+    TEST_F(GFGblDiagnosticsTests, LayerOfSensor) {
+        EXPECT_EQ(0u, GFGblHistograms::layerOfSensor(0));
+        // VXD layers 1-6 are layers 4-9 of the setup
+        for (unsigned int vxdLayer = 1; vxdLayer <= 6; ++vxdLayer)
+            EXPECT_EQ(vxdLayer + 3, GFGblHistograms::layerOfSensor(vxdSensor(vxdLayer)));
+        // telescopes: layer 7, ladder 2 (front) and 3 (back), sensors 1-3 and 4-6
+        EXPECT_EQ(2u, GFGblHistograms::layerOfSensor((7u << 13) | (2u << 8) | (2u << 5)));
+        EXPECT_EQ(10u, GFGblHistograms::layerOfSensor((7u << 13) | (3u << 8) | (4u << 5)));
+    }
+
+    TEST_F(GFGblDiagnosticsTests, Histograms) {
+        GFGblHistograms histograms;
+
+        TVectorD residuals(2), errors(2), downWeights(2), localPar(5);
+        residuals(0) = 0.01;
+        residuals(1) = -0.02;
+        errors(0) = errors(1) = 0.01;
+        downWeights(0) = downWeights(1) = 0.5;
+        histograms.fillMeasurement(vxdSensor(3), residuals, errors, errors, downWeights, localPar);
+        histograms.fillMeasurement(0, residuals, errors, errors, downWeights, localPar); // not in setup
+        EXPECT_EQ(1u, histograms.getLayerHistogram(6, GFGblHistograms::resU).getEntries());
+        EXPECT_EQ(1u, histograms.getLayerHistogram(6, GFGblHistograms::pullV).getEntries());
+        EXPECT_EQ(0u, histograms.getLayerHistogram(5, GFGblHistograms::resU).getEntries());
+
+        histograms.fillFitResult(0, 4);
+        EXPECT_EQ(1u, histograms.getFitResultHistogram().getEntries());
+        EXPECT_EQ(1u, histograms.getNdfHistogram().getEntries());
+
+        // all VXD layers hit
+        std::vector<unsigned int> sensors;
+        for (unsigned int vxdLayer = 1; vxdLayer <= 6; ++vxdLayer)
+            sensors.push_back(vxdSensor(vxdLayer));
+        histograms.fillTrack(8., 4, sensors);
+        EXPECT_EQ(1u, histograms.getChi2OverNdfHistogram().getEntries());
+        EXPECT_EQ(1u, histograms.getPValueHistogram().getEntries());
+        const AtomicHistogram& stats = histograms.getStatsHistogram();
+        EXPECT_EQ(1u, stats.getBinContent(1)); // tracks
+        EXPECT_EQ(1u, stats.getBinContent(4)); // VXD
+        EXPECT_EQ(1u, stats.getBinContent(5)); // SVD
+        EXPECT_EQ(0u, stats.getBinContent(2)); // no telescope
+
+        // no chi2/ndf and p-value without degrees of freedom
+        histograms.fillTrack(0., 0, sensors);
+        EXPECT_EQ(1u, histograms.getChi2OverNdfHistogram().getEntries());
+        EXPECT_EQ(1u, histograms.getPValueHistogram().getEntries());
+        EXPECT_EQ(2u, stats.getBinContent(1));
+    }
+
+}
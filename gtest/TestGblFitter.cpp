@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <ConstField.h>
+#include <DetPlane.h>
+#include <FieldManager.h>
+#include <GblFitter.h>
+#include <MaterialEffects.h>
+#include <RKTrackRep.h>
+#include <SharedPlanePtr.h>
+#include <StateOnPlane.h>
+
+#include <TMatrixD.h>
+#include <TMatrixDSym.h>
+#include <TVector3.h>
+#include <TVectorD.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace genfit {
+
+    class GblFitterTests : public ::testing::Test {
+    protected:
+        virtual void SetUp() {
+            genfit::FieldManager::getInstance()->init(new genfit::ConstField(0., 0., 20.));  // kGauss
+            genfit::MaterialEffects::getInstance()->init(nullptr);
+            genfit::MaterialEffects::getInstance()->setNoEffects();
+        }
+        virtual void TearDown() {
+            genfit::MaterialEffects::getInstance()->destruct();
+            genfit::FieldManager::getInstance()->destruct();
+        }
+    };
+
+    TEST_F(GblFitterTests, SplitSegmentJacobianAgreesWithExtrapolation) {
+        RKTrackRep rep(211);
+        StateOnPlane start(&rep);
+        rep.setPosMom(start, TVector3(0., 0., 0.), TVector3(0.5, 0.1, 0.2));
+        const SharedPlanePtr nextPlane(new DetPlane(TVector3(30., 0., 0.), TVector3(1., 0., 0.)));
+
+        TMatrixD jacSegment(5, 5), jacFirstPart(5, 5), jacDirect(5, 5);
+        TMatrixDSym noise(5);
+        TVectorD deltaState(5);
+
+        // whole segment, as in GblFitter::constructGblInfo
+        StateOnPlane segment(start);
+        rep.extrapolateToPlane(segment, nextPlane, false, true);
+        rep.getForwardJacobianAndNoise(jacSegment, noise, deltaState);
+
+        // first part up to an intermediate scatterer
+        StateOnPlane scatterer(start);
+        rep.extrapolateBy(scatterer, 12., false, true);
+        rep.getForwardJacobianAndNoise(jacFirstPart, noise, deltaState);
+
+        // second part, extrapolated directly from the scatterer
+        StateOnPlane direct(scatterer);
+        rep.extrapolateToPlane(direct, nextPlane, false, true);
+        rep.getForwardJacobianAndNoise(jacDirect, noise, deltaState);
+
+        TMatrixD jacSecondPart(5, 5);
+        ASSERT_TRUE(GblFitter::splitSegmentJacobian(jacSegment, jacFirstPart, jacSecondPart));
+        for (int i = 0; i < 5; ++i)
+            for (int j = 0; j < 5; ++j)
+                EXPECT_NEAR(jacDirect(i, j), jacSecondPart(i, j), 1E-4 * std::max(1., std::fabs(jacDirect(i, j))));
+    }
+
+    TEST_F(GblFitterTests, SplitSegmentJacobianRejectsIllConditioned) {
+        TMatrixD jacSegment(5, 5);
+        jacSegment.UnitMatrix();
+        TMatrixD jacSecondPart(5, 5);
+        jacSecondPart.Zero();
+
+        TMatrixD singular(5, 5);
+        singular.UnitMatrix();
+        singular(4, 4) = 0.;
+        EXPECT_FALSE(GblFitter::splitSegmentJacobian(jacSegment, singular, jacSecondPart));
+
+        TMatrixD nearlySingular(5, 5);
+        nearlySingular.UnitMatrix();
+        nearlySingular(4, 4) = 1.e-12;
+        EXPECT_FALSE(GblFitter::splitSegmentJacobian(jacSegment, nearlySingular, jacSecondPart));
+        EXPECT_EQ(0., jacSecondPart.E2Norm());
+
+        TMatrixD wellConditioned(5, 5);
+        wellConditioned.UnitMatrix();
+        wellConditioned(3, 1) = 10.;
+        EXPECT_TRUE(GblFitter::splitSegmentJacobian(jacSegment, wellConditioned, jacSecondPart));
+        EXPECT_NEAR(-10., jacSecondPart(3, 1), 1E-12);
+        EXPECT_NEAR(1., jacSecondPart(3, 3), 1E-12);
+    }
+
+}
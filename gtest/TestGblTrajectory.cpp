@@ -0,0 +1,369 @@
+#include <gtest/gtest.h>
+
+#include <AlignablePlanarMeasurement.h>
+#include <GblTrajectory.h>
+#include <StateOnPlane.h>
+
+#include <Eigen/Geometry>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+namespace gbl {
+
+    class GblTrajectoryTests : public ::testing::Test {
+    protected:
+        // Straight line (no curvature) in u1 with unit steps, 2D measurements at each point.
+        std::vector<GblPoint> makePoints(unsigned int nPoints, bool withScatterers) const {
+            std::vector<GblPoint> points;
+            for (unsigned int i = 0; i < nPoints; ++i) {
+                Matrix5x5 jacobian = Matrix5x5::Identity();
+                if (i > 0) {
+                    jacobian(3, 1) = 1.;
+                    jacobian(4, 2) = 1.;
+                }
+                GblPoint point(jacobian);
+                VectorDynamic residuals(2), precision(2);
+                residuals << 0.3 + 0.01 * i + 0.001 * ((i * 7) % 5 - 2.), 0.;
+                precision << 1.e4, 1.e4;
+                point.addMeasurement(residuals, precision);
+                if (withScatterers and i > 0 and i < nPoints - 1) {
+                    point.addScatterer(Vector2::Zero(), Vector2(1.e6, 1.e6));
+                }
+                points.push_back(point);
+            }
+            return points;
+        }
+    };
+
+    TEST_F(GblTrajectoryTests, BorderedBandMatrix) {
+        // border of two, band width of five (fast path) and three (generic path)
+        for (unsigned int nBand : {5u, 3u}) {
+            const unsigned int nSize = 20, nBorder = 2;
+            BorderedBandMatrix matrix;
+            matrix.resize(nSize, nBorder, nBand);
+            Eigen::MatrixXd dense = Eigen::MatrixXd::Zero(nSize, nSize);
+            for (unsigned int iBlock = 0; iBlock + nBand < nSize - nBorder; ++iBlock) {
+                // border and consecutive band parameters (like a GBL kink)
+                std::vector<unsigned int> index = {1, 2};
+                std::vector<double> derivatives = {0.1 * iBlock, -0.5};
+                for (unsigned int i = 0; i <= nBand; ++i) {
+                    index.push_back(nBorder + iBlock + i + 1);
+                    derivatives.push_back(1. + 0.3 * i - 0.2 * (iBlock % 3));
+                }
+                const double weight = 1. + 0.1 * iBlock;
+                matrix.addBlockMatrix(weight, index.size(), index.data(), derivatives.data());
+                for (unsigned int i = 0; i < index.size(); ++i)
+                    for (unsigned int j = 0; j < index.size(); ++j)
+                        dense(index[i] - 1, index[j] - 1) += weight * derivatives[i] * derivatives[j];
+            }
+            dense.diagonal().array() += 1.;
+            for (unsigned int i = 0; i < nSize; ++i) {
+                unsigned int index = i + 1;
+                double derivative = 1.;
+                matrix.addBlockMatrix(1., 1, &index, &derivative);
+            }
+
+            VectorDynamic rhs = VectorDynamic::LinSpaced(nSize, -1., 1.);
+            const VectorDynamic expected = dense.ldlt().solve(rhs);
+            matrix.solveAndInvertBorderedBand(rhs, rhs);
+            EXPECT_NEAR(0., (rhs - expected).norm(), 1.e-10);
+
+            const Eigen::MatrixXd inverse = dense.inverse();
+            // band part of inverse is only available inside the band
+            const unsigned int selection[] = {1, 2, 8, 9, 7 + nBand, 8 + nBand};
+            MatrixDynamic block;
+            matrix.getBlockMatrix(6, selection, block);
+            for (unsigned int i = 0; i < 6; ++i)
+                for (unsigned int j = 0; j < 6; ++j)
+                    EXPECT_NEAR(inverse(selection[i] - 1, selection[j] - 1), block(i, j), 1.e-10);
+        }
+    }
+
+    TEST_F(GblTrajectoryTests, StraightLineFit) {
+        const unsigned int nPoints = 10;
+        GblTrajectory trajectory(makePoints(nPoints, false), false);
+        ASSERT_TRUE(trajectory.isValid());
+        double chi2, lostWeight;
+        int ndf;
+        EXPECT_EQ(0u, trajectory.fit(chi2, ndf, lostWeight));
+        EXPECT_EQ(2 * nPoints - 4, ndf);
+
+        // compare with least squares straight line fit of u1
+        Eigen::MatrixXd design(nPoints, 2);
+        Eigen::VectorXd u(nPoints);
+        for (unsigned int i = 0; i < nPoints; ++i) {
+            design(i, 0) = 1.;
+            design(i, 1) = i;
+            u(i) = 0.3 + 0.01 * i + 0.001 * ((i * 7) % 5 - 2.);
+        }
+        const Eigen::VectorXd line = (design.transpose() * design).ldlt().solve(design.transpose() * u);
+        EXPECT_NEAR((u - design * line).squaredNorm() * 1.e4, chi2, 1.e-8);
+
+        VectorDynamic localPar;
+        MatrixDynamic localCov;
+        EXPECT_EQ(0u, trajectory.getResults(1, localPar, localCov));
+        EXPECT_NEAR(line(0), localPar(3), 1.e-10);
+        EXPECT_NEAR(line(1), localPar(1), 1.e-10);
+        EXPECT_NEAR((design.transpose() * design).inverse()(0, 0) * 1.e-4, localCov(3, 3), 1.e-12);
+    }
+
+    TEST_F(GblTrajectoryTests, ResetMatchesConstruction) {
+        GblTrajectory reused;
+        EXPECT_FALSE(reused.isValid());
+
+        // fill with longer and shorter trajectories before the one to compare
+        double chi2, lostWeight;
+        int ndf;
+        reused.reset(makePoints(20, true), false);
+        EXPECT_EQ(0u, reused.fit(chi2, ndf, lostWeight, "HH"));
+        reused.reset(makePoints(5, false), false);
+        EXPECT_EQ(0u, reused.fit(chi2, ndf, lostWeight));
+
+        const std::vector<GblPoint> points = makePoints(12, true);
+        reused.reset(points, false);
+        GblTrajectory fresh(points, false);
+        ASSERT_TRUE(reused.isValid());
+        ASSERT_EQ(fresh.getNumPoints(), reused.getNumPoints());
+
+        double freshChi2, freshLostWeight;
+        int freshNdf;
+        EXPECT_EQ(0u, fresh.fit(freshChi2, freshNdf, freshLostWeight, "H"));
+        EXPECT_EQ(0u, reused.fit(chi2, ndf, lostWeight, "H"));
+        EXPECT_EQ(freshNdf, ndf);
+        EXPECT_DOUBLE_EQ(freshChi2, chi2);
+        EXPECT_DOUBLE_EQ(freshLostWeight, lostWeight);
+
+        VectorDynamic freshPar, reusedPar;
+        MatrixDynamic freshCov, reusedCov;
+        for (int label = 1; label <= 12; ++label) {
+            EXPECT_EQ(0u, fresh.getResults(-label, freshPar, freshCov));
+            EXPECT_EQ(0u, reused.getResults(-label, reusedPar, reusedCov));
+            EXPECT_NEAR(0., (freshPar - reusedPar).norm(), 1.e-12);
+            EXPECT_NEAR(0., (freshCov - reusedCov).norm(), 1.e-12);
+        }
+    }
+
+    TEST_F(GblTrajectoryTests, DataBlocksMatchScalarData) {
+        GblTrajectory trajectory(makePoints(15, true), false);
+        ASSERT_TRUE(trajectory.isValid());
+        std::vector<GblData> data = trajectory.getData();
+        GblDataBlocks blocks;
+        blocks.assign(data);
+        ASSERT_EQ(data.size(), blocks.getNumData());
+
+        // arbitrary fit parameters, large enough for outliers in all M-estimators
+        const VectorDynamic fitPar = VectorDynamic::LinSpaced(trajectory.getNumPoints() * 2, -0.5, 0.7);
+        blocks.predict(fitPar);
+        for (unsigned int aMethod = 1; aMethod <= 3; ++aMethod) {
+            // scalar reference: prediction, M-estimator weight and Chi2 of each data block
+            double scalarLoss = 0., scalarChi2 = 0.;
+            std::vector<double> predictions, weights;
+            for (const GblData& aData : data) {
+                double value, variance, downWeight;
+                unsigned int numLocal;
+                const unsigned int* indLocal;
+                const double* derLocal;
+                aData.getResidual(value, variance, downWeight, numLocal, indLocal, derLocal); // not fitted: residual = value
+                double prediction = 0.;
+                for (unsigned int j = 0; j < numLocal; ++j)
+                    prediction += derLocal[j] * fitPar(indLocal[j] - 1);
+                const double scaledResidual = fabs(value - prediction) / sqrt(variance);
+                double weight = 1.;
+                if (aMethod == 1)
+                    weight = scaledResidual < 4.6851 ? pow(1. - 0.045558 * scaledResidual * scaledResidual, 2) : 0.;
+                else if (aMethod == 2)
+                    weight = scaledResidual >= 1.345 ? 1.345 / scaledResidual : 1.;
+                else
+                    weight = 1. / (1. + scaledResidual * scaledResidual / 5.6877);
+                scalarLoss += 1. - weight;
+                scalarChi2 += (value - prediction) * (value - prediction) / variance * weight;
+                predictions.push_back(value - prediction);
+                weights.push_back(weight);
+            }
+            EXPECT_GT(scalarLoss, 0.);
+            EXPECT_NEAR(scalarLoss, blocks.downWeight(aMethod), 1.e-12);
+            EXPECT_NEAR(scalarChi2, blocks.getChi2(), 1.e-9 * scalarChi2);
+
+            std::vector<GblData> fitted = data;
+            blocks.copyResults(fitted);
+            for (unsigned int i = 0; i < data.size(); ++i) {
+                double residual, variance, downWeight, blockResidual, blockVariance, blockDownWeight;
+                unsigned int numLocal, blockNumLocal;
+                const unsigned int *indLocal, *blockIndLocal;
+                const double *derLocal, *blockDerLocal;
+                fitted[i].getResidual(residual, variance, downWeight, numLocal, indLocal, derLocal);
+                blocks.getResidual(i, blockResidual, blockVariance, blockDownWeight, blockNumLocal, blockIndLocal, blockDerLocal);
+                EXPECT_NEAR(predictions[i], blockResidual, 1.e-12);
+                EXPECT_NEAR(weights[i], blockDownWeight, 1.e-14);
+                EXPECT_DOUBLE_EQ(residual, blockResidual);
+                EXPECT_DOUBLE_EQ(variance, blockVariance);
+                EXPECT_EQ(downWeight, blockDownWeight);
+                ASSERT_EQ(numLocal, blockNumLocal);
+                for (unsigned int j = 0; j < numLocal; ++j) {
+                    EXPECT_EQ(indLocal[j], blockIndLocal[j]);
+                    EXPECT_EQ(derLocal[j], blockDerLocal[j]);
+                }
+            }
+        }
+    }
+
+    TEST_F(GblTrajectoryTests, FittedData) {
+        GblTrajectory trajectory(makePoints(15, true), false);
+        double chi2, lostWeight;
+        int ndf;
+        ASSERT_EQ(0u, trajectory.fit(chi2, ndf, lostWeight, "H"));
+
+        // data blocks carry the predictions and down-weights of the fit
+        double dataChi2 = 0., dataLostWeight = 0.;
+        for (const GblData& aData : trajectory.getData()) {
+            double residual, variance, downWeight;
+            unsigned int numLocal;
+            const unsigned int* indLocal;
+            const double* derLocal;
+            aData.getResidual(residual, variance, downWeight, numLocal, indLocal, derLocal);
+            dataChi2 += residual * residual / variance * downWeight;
+            dataLostWeight += 1. - downWeight;
+        }
+        EXPECT_NEAR(chi2, dataChi2 / 0.9326, 1.e-9 * chi2); // normalization of Huber
+        EXPECT_NEAR(lostWeight, dataLostWeight, 1.e-12);
+    }
+
+    TEST_F(GblTrajectoryTests, MilleRecordMatchesBinary) {
+        const char* directFile = "TestGblTrajectory_direct.dat";
+        const char* recordFile = "TestGblTrajectory_record.dat";
+        {
+            MilleBinary direct(directFile), fromRecords(recordFile);
+            MilleRecord record;
+            for (unsigned int nPoints : {6u, 9u}) {
+                GblTrajectory trajectory(makePoints(nPoints, true), false);
+                trajectory.milleOut(direct);
+                trajectory.milleOut(record);
+                EXPECT_FALSE(record.isEmpty());
+                fromRecords.writeRecord(record);
+            }
+            GblTrajectory invalid;
+            invalid.milleOut(record);
+            EXPECT_TRUE(record.isEmpty());
+        }
+        std::ifstream directStream(directFile, std::ios::binary), recordStream(recordFile, std::ios::binary);
+        const std::string directBytes((std::istreambuf_iterator<char>(directStream)), std::istreambuf_iterator<char>());
+        const std::string recordBytes((std::istreambuf_iterator<char>(recordStream)), std::istreambuf_iterator<char>());
+        EXPECT_FALSE(directBytes.empty());
+        EXPECT_EQ(directBytes, recordBytes);
+        std::remove(directFile);
+        std::remove(recordFile);
+    }
+
+    TEST_F(GblTrajectoryTests, BufferedMilleOutput) {
+        const char* directFile = "TestGblTrajectory_unbuffered.dat";
+        const char* bufferedFile = "TestGblTrajectory_buffered.dat";
+        {
+            // tiny output buffer to hand over many (partial) blocks to the background writer
+            MilleBinary direct(directFile, false, 2000, 0), buffered(bufferedFile, false, 2000, 5000);
+            for (unsigned int nPoints = 3; nPoints < 40; ++nPoints) {
+                GblTrajectory trajectory(makePoints(nPoints, true), false);
+                trajectory.milleOut(direct);
+                trajectory.milleOut(buffered);
+            }
+        }
+        std::ifstream directStream(directFile, std::ios::binary), bufferedStream(bufferedFile, std::ios::binary);
+        const std::string directBytes((std::istreambuf_iterator<char>(directStream)), std::istreambuf_iterator<char>());
+        const std::string bufferedBytes((std::istreambuf_iterator<char>(bufferedStream)), std::istreambuf_iterator<char>());
+        EXPECT_GT(directBytes.size(), 5000u);
+        EXPECT_EQ(directBytes, bufferedBytes);
+        std::remove(directFile);
+        std::remove(bufferedFile);
+    }
+
+    TEST_F(GblTrajectoryTests, FixedCapacityDerivatives) {
+        const std::vector<int> labels = {11, 12, 13};
+        MatrixDynamic dynamic(2, 3);
+        dynamic << 1., 2., 3., 4., 5., 6.;
+        genfit::CalibrationDerivatives fixed = dynamic;
+        ASSERT_EQ(3, fixed.cols());
+
+        GblPoint fromDynamic = makePoints(1, false)[0], fromFixed = makePoints(1, false)[0];
+        fromDynamic.addGlobals(labels, dynamic);
+        fromDynamic.addLocals(dynamic.leftCols(2));
+        fromFixed.addGlobals(labels, fixed);
+        fromFixed.addLocals(genfit::CalibrationDerivatives(fixed.leftCols(2)));
+        EXPECT_EQ(fromDynamic.getGlobalLabels(), fromFixed.getGlobalLabels());
+        EXPECT_EQ(fromDynamic.getGlobalDerivatives(), fromFixed.getGlobalDerivatives());
+        EXPECT_EQ(fromDynamic.getLocalDerivatives(), fromFixed.getLocalDerivatives());
+    }
+
+    TEST_F(GblTrajectoryTests, AlignablePlanarMeasurementDerivatives) {
+        TVectorD coords(2);
+        coords(0) = 0.7;
+        coords(1) = -1.3;
+        TMatrixDSym cov(2);
+        cov.UnitMatrix();
+        cov *= 1.e-4;
+        genfit::AlignablePlanarMeasurement measurement(coords, cov, 1, 0, nullptr);
+        genfit::SharedPlanePtr plane(new genfit::DetPlane(TVector3(0., 0., 10.), TVector3(1., 0., 0.), TVector3(0., 1., 0.)));
+        measurement.setPlane(plane, 7);
+
+        // (q/p, u', v', u, v)
+        TVectorD state(5);
+        state(0) = 0.5;
+        state(1) = 0.4;
+        state(2) = -0.25;
+        state(3) = 0.7;
+        state(4) = -1.3;
+        genfit::StateOnPlane sop(state, plane, nullptr);
+
+        genfit::CalibrationDerivatives derivs;
+        std::vector<int> labelBuffer;
+        const std::vector<int>& labels = measurement.fillGlobalDerivatives(&sop, derivs, labelBuffer);
+        EXPECT_TRUE(labelBuffer.empty()); // cached per sensor, buffer not needed
+        ASSERT_EQ(6u, labels.size());
+        for (unsigned int i = 0; i < 6; ++i)
+            EXPECT_EQ(80 + int(i) + 1, labels[i]);
+
+        // another hit on the same sensor gets the same cached list
+        genfit::AlignablePlanarMeasurement other(measurement);
+        genfit::CalibrationDerivatives otherDerivs;
+        EXPECT_EQ(&labels, &other.fillGlobalDerivatives(&sop, otherDerivs, labelBuffer));
+
+        // numerical derivatives of the residuals: intersection of the track with the moved and rotated sensor
+        auto intersection = [&](const Eigen::Matrix<double, 6, 1>& p) {
+            const Eigen::Matrix3d R = (Eigen::AngleAxisd(p(5), Eigen::Vector3d::UnitZ())
+                                       * Eigen::AngleAxisd(p(4), Eigen::Vector3d::UnitY())
+                                       * Eigen::AngleAxisd(p(3), Eigen::Vector3d::UnitX())).toRotationMatrix();
+            const Eigen::Vector3d shift = p.head<3>();
+            const Eigen::Vector3d pos(state(3), state(4), 0.), dir(state(1), state(2), 1.);
+            const double t = (shift - pos).dot(R.col(2)) / dir.dot(R.col(2));
+            const Eigen::Vector3d local = R.transpose() * (pos + t * dir - shift);
+            return Eigen::Vector2d(local.head<2>());
+        };
+        const double epsilon = 1.e-6;
+        ASSERT_EQ(2, derivs.rows());
+        ASSERT_EQ(6, derivs.cols());
+        for (unsigned int i = 0; i < 6; ++i) {
+            Eigen::Matrix<double, 6, 1> plus = Eigen::Matrix<double, 6, 1>::Zero(), minus = plus;
+            plus(i) = epsilon;
+            minus(i) = -epsilon;
+            const Eigen::Vector2d numerical = -(intersection(plus) - intersection(minus)) / (2. * epsilon);
+            EXPECT_NEAR(numerical(0), derivs(0, i), 1.e-8);
+            EXPECT_NEAR(numerical(1), derivs(1, i), 1.e-8);
+        }
+
+        // allocating interface gives the same
+        const std::pair<std::vector<int>, TMatrixD> allocating = measurement.globalDerivatives(&sop);
+        EXPECT_EQ(labels, allocating.first);
+        for (unsigned int i = 0; i < 2; ++i)
+            for (unsigned int j = 0; j < 6; ++j)
+                EXPECT_EQ(derivs(i, j), allocating.second(i, j));
+
+        GblPoint point = makePoints(1, false)[0];
+        point.addGlobals(labels, derivs);
+        EXPECT_EQ(6u, point.getNumGlobals());
+        EXPECT_EQ(86, point.getGlobalLabels()(5));
+
+        EXPECT_EQ(0u, measurement.fillLocalDerivatives(&sop, derivs));
+    }
+
+}
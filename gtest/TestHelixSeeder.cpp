@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#include <ConstField.h>
+#include <FieldManager.h>
+#include <HelixSeeder.h>
+#include <RKTrackRep.h>
+#include <SpacepointMeasurement.h>
+#include <Track.h>
+#include <TrackPoint.h>
+
+#include <cmath>
+#include <vector>
+
+namespace genfit {
+
+    class HelixSeederTests : public ::testing::Test {
+    protected:
+        // points on a helix starting at pos with momentum mom
+        static std::vector<TVector3> helixPoints(const TVector3& pos, const TVector3& mom,
+                                                 double charge, double Bz, double sigma, bool smear) {
+            const double pT = mom.Perp();
+            const double R = pT / (0.0299792458E-2 * fabs(Bz));
+            const double h = (charge * Bz > 0.) ? -1. : 1.; // rotation sense, +1 counterclockwise
+            const double phi0 = mom.Phi() - h * 0.5 * M_PI;
+            const double xc = pos.X() - R * cos(phi0);
+            const double yc = pos.Y() - R * sin(phi0);
+            const double tanLambda = mom.Z() / pT;
+
+            std::vector<TVector3> points;
+            for (unsigned int i = 0; i < 10; ++i) {
+                const double s = 10. * i;
+                const double phi = phi0 + h * s / R;
+                TVector3 point(xc + R * cos(phi), yc + R * sin(phi), pos.Z() + tanLambda * s);
+                if (smear)
+                    point += sigma * TVector3(sin(3.1 * i + 0.2), cos(1.3 * i + 0.7), sin(2.3 * i + 1.1));
+                points.push_back(point);
+            }
+            return points;
+        }
+
+        static void addHelixPoints(HelixSeeder& seeder, const TVector3& pos, const TVector3& mom,
+                                   double charge, double Bz, double sigma, bool smear) {
+            TMatrixDSym cov(3);
+            for (int i = 0; i < 3; ++i)
+                cov(i, i) = sigma * sigma;
+            const std::vector<TVector3> points = helixPoints(pos, mom, charge, Bz, sigma, smear);
+            for (unsigned int i = 0; i < points.size(); ++i)
+                seeder.addPoint(points[i], cov);
+        }
+    };
+
+    TEST_F(HelixSeederTests, ExactPoints) {
+        const TVector3 pos(1., -2., 3.);
+        const double Bz = 15.;
+
+        for (int iCharge = -1; iCharge <= 1; iCharge += 2) {
+            const TVector3 mom(0.3, 0.4, -0.2);
+            HelixSeeder seeder;
+            addHelixPoints(seeder, pos, mom, iCharge, Bz, 0.01, false);
+            ASSERT_TRUE(seeder.fit(Bz));
+
+            EXPECT_EQ(double(iCharge), seeder.getCharge());
+            EXPECT_NEAR(0., seeder.getCircleChi2(), 1E-9);
+            const TVectorD& state = seeder.getStateSeed();
+            for (int i = 0; i < 3; ++i) {
+                EXPECT_NEAR(pos[i], state(i), 1E-8);
+                EXPECT_NEAR(mom[i], state(i + 3), 1E-8);
+            }
+
+            const TMatrixDSym& cov = seeder.getCovSeed();
+            ASSERT_EQ(6, cov.GetNrows());
+            for (int i = 0; i < 6; ++i)
+                EXPECT_GT(cov(i, i), 0.);
+        }
+
+        // reversed field flips the charge, not the trajectory
+        HelixSeeder seeder;
+        addHelixPoints(seeder, pos, TVector3(0.3, 0.4, -0.2), 1., Bz, 0.01, false);
+        ASSERT_TRUE(seeder.fit(-Bz));
+        EXPECT_EQ(-1., seeder.getCharge());
+    }
+
+    TEST_F(HelixSeederTests, SmearedPoints) {
+        const TVector3 pos(0., 0., 0.);
+        const TVector3 mom(-0.5, 0.2, 0.3);
+        const double Bz = 20.;
+        const double sigma = 0.05;
+
+        HelixSeeder seeder;
+        addHelixPoints(seeder, pos, mom, -1., Bz, sigma, true);
+        ASSERT_TRUE(seeder.fit(Bz));
+        EXPECT_EQ(-1., seeder.getCharge());
+        EXPECT_LT(seeder.getCircleChi2(), 30.);
+
+        // seed agrees with the true state within its uncertainty
+        const TVectorD& state = seeder.getStateSeed();
+        const TMatrixDSym& cov = seeder.getCovSeed();
+        for (int i = 0; i < 3; ++i) {
+            EXPECT_NEAR(pos[i], state(i), 5. * sqrt(cov(i, i)));
+            EXPECT_NEAR(mom[i], state(i + 3), 5. * sqrt(cov(i + 3, i + 3)));
+        }
+        EXPECT_NEAR(mom.Perp(), TVector3(state(3), state(4), state(5)).Perp(), 0.05 * mom.Perp());
+    }
+
+    TEST_F(HelixSeederTests, Failures) {
+        TMatrixDSym cov(3);
+        cov.UnitMatrix();
+
+        HelixSeeder seeder;
+        seeder.addPoint(TVector3(0., 0., 0.), cov);
+        seeder.addPoint(TVector3(1., 1., 1.), cov);
+        EXPECT_FALSE(seeder.fit(15.)); // too few points
+
+        seeder.addPoint(TVector3(2., 2., 2.), cov);
+        EXPECT_FALSE(seeder.fit(0.)); // no field
+        EXPECT_FALSE(seeder.fit(15.)); // straight line
+
+        seeder.clear();
+        EXPECT_EQ(0u, seeder.getNPoints());
+    }
+
+    TEST_F(HelixSeederTests, SeedTrackChecksCharge) {
+        const TVector3 pos(0., 0., 0.);
+        const TVector3 mom(0.4, 0.3, 0.1);
+        const double Bz = 20.;
+        const double sigma = 0.01;
+        FieldManager::getInstance()->init(new ConstField(0., 0., Bz));
+
+        TMatrixDSym cov(3);
+        for (int i = 0; i < 3; ++i)
+            cov(i, i) = sigma * sigma;
+
+        for (int iCharge = -1; iCharge <= 1; iCharge += 2) {
+            // pi+ representation
+            Track track(new RKTrackRep(211), TVector3(0.1, 0.1, 0.1), TVector3(1., 0., 0.));
+            const std::vector<TVector3> points = helixPoints(pos, mom, iCharge, Bz, sigma, false);
+            for (unsigned int i = 0; i < points.size(); ++i) {
+                TVectorD coords(3);
+                for (int j = 0; j < 3; ++j)
+                    coords(j) = points[i][j];
+                track.insertPoint(new TrackPoint(new SpacepointMeasurement(coords, cov, 0, i, nullptr), &track));
+            }
+
+            HelixSeeder seeder;
+            EXPECT_EQ(iCharge > 0, seeder.seedTrack(track));
+            EXPECT_EQ(double(iCharge), seeder.getCharge());
+            EXPECT_NEAR(iCharge > 0 ? mom.X() : 1., track.getStateSeed()(3), 1E-6);
+        }
+
+        FieldManager::getInstance()->destruct();
+    }
+
+}
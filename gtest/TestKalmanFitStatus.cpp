@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+
+#include <KalmanFitStatus.h>
+
+#include <Math/ProbFunc.h>
+
+namespace genfit {
+
+    TEST(KalmanFitStatusTests, PValFollowsChi2AndNdf) {
+        KalmanFitStatus status;
+        status.setForwardChi2(12.);
+        status.setForwardNdf(10.);
+        status.setBackwardChi2(8.);
+        status.setBackwardNdf(10.);
+
+        EXPECT_DOUBLE_EQ(ROOT::Math::chisquared_cdf_c(12., 10.), status.getForwardPVal());
+        EXPECT_DOUBLE_EQ(ROOT::Math::chisquared_cdf_c(8., 10.), status.getBackwardPVal());
+        EXPECT_DOUBLE_EQ(status.getBackwardPVal(), status.getPVal());
+
+        // the memoized p-values have to be recalculated after chi2 or ndf changed
+        status.setForwardChi2(20.);
+        EXPECT_DOUBLE_EQ(ROOT::Math::chisquared_cdf_c(20., 10.), status.getForwardPVal());
+        status.setForwardNdf(5.);
+        EXPECT_DOUBLE_EQ(ROOT::Math::chisquared_cdf_c(20., 5.), status.getForwardPVal());
+
+        status.setBackwardNdf(4.);
+        EXPECT_DOUBLE_EQ(ROOT::Math::chisquared_cdf_c(8., 4.), status.getBackwardPVal());
+        status.setBackwardChi2(1.);
+        EXPECT_DOUBLE_EQ(ROOT::Math::chisquared_cdf_c(1., 4.), status.getPVal());
+
+        // copies keep the memoized values consistent
+        KalmanFitStatus* clone = static_cast<KalmanFitStatus*>(status.clone());
+        EXPECT_DOUBLE_EQ(status.getForwardPVal(), clone->getForwardPVal());
+        clone->setForwardChi2(2.);
+        EXPECT_DOUBLE_EQ(ROOT::Math::chisquared_cdf_c(2., 5.), clone->getForwardPVal());
+        EXPECT_DOUBLE_EQ(ROOT::Math::chisquared_cdf_c(20., 5.), status.getForwardPVal());
+        delete clone;
+    }
+
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <ConstField.h>
+#include <FieldManager.h>
+#include <KalmanFitStatus.h>
+#include <KalmanFitterInfo.h>
+#include <KalmanFitterRefTrack.h>
+#include <MaterialEffects.h>
+#include <MeasuredStateOnPlane.h>
+
+#include "TestTracks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace genfit {
+
+    class KalmanFitterRefTrackTests : public ::testing::Test {
+    protected:
+        virtual void SetUp() {
+            genfit::FieldManager::getInstance()->init(new genfit::ConstField(0., 0., 20.));  // kGauss
+            genfit::MaterialEffects::getInstance()->init(nullptr);
+            genfit::MaterialEffects::getInstance()->setNoEffects();
+        }
+        virtual void TearDown() {
+            for (Track* track : m_tracks)
+                delete track;
+            genfit::MaterialEffects::getInstance()->destruct();
+            genfit::FieldManager::getInstance()->destruct();
+        }
+
+        // states agree within a small fraction of their errors
+        static void expectSameState(const MeasuredStateOnPlane& expected, const MeasuredStateOnPlane& actual) {
+            EXPECT_TRUE(*expected.getPlane() == *actual.getPlane()); // the tracks have their own planes
+            for (unsigned int i = 0; i < 5; ++i) {
+                EXPECT_NEAR(expected.getState()(i), actual.getState()(i), 1E-2 * std::sqrt(expected.getCov()(i, i)));
+                for (unsigned int j = 0; j < 5; ++j)
+                    EXPECT_NEAR(expected.getCov()(i, j), actual.getCov()(i, j),
+                                1E-3 * std::sqrt(expected.getCov()(i, i) * expected.getCov()(j, j)));
+            }
+        }
+
+        std::vector<Track*> m_tracks;
+    };
+
+    TEST_F(KalmanFitterRefTrackTests, RTSSmootherAgreesWithBackwardFit) {
+        const unsigned int nTracks = 3;
+        const unsigned int nPoints = 8;
+        KalmanFitterRefTrack fitter;
+        KalmanFitterRefTrack smoother;
+        smoother.setUseRTSSmoother();
+
+        for (unsigned int iTrack = 0; iTrack < nTracks; ++iTrack) {
+            const TVector3 mom(0.5 + 0.1 * iTrack, 0.1 * iTrack - 0.2, 0.2);
+            Track* track = testTracks::makePlanarTrack(TVector3(0., 0., 0.), mom, nPoints, 0.01, 100 * iTrack);
+            Track* smoothedTrack = testTracks::makePlanarTrack(TVector3(0., 0., 0.), mom, nPoints, 0.01, 100 * iTrack);
+            m_tracks.push_back(track);
+            m_tracks.push_back(smoothedTrack);
+
+            fitter.processTrackWithRep(track, track->getCardinalRep());
+            smoother.processTrackWithRep(smoothedTrack, smoothedTrack->getCardinalRep());
+            ASSERT_TRUE(track->getFitStatus()->isFitConverged());
+            ASSERT_TRUE(smoothedTrack->getFitStatus()->isFitConverged());
+
+            for (unsigned int iPoint = 0; iPoint < nPoints; ++iPoint) {
+                const KalmanFitterInfo* fi = track->getPointWithMeasurement(iPoint)->getKalmanFitterInfo();
+                const KalmanFitterInfo* smoothedFi = smoothedTrack->getPointWithMeasurement(iPoint)->getKalmanFitterInfo();
+                ASSERT_TRUE(fi->hasPredictionsAndUpdates());
+                ASSERT_TRUE(smoothedFi->hasSmoothedState());
+                ASSERT_FALSE(smoothedFi->hasBackwardUpdate());
+
+                expectSameState(fi->getFittedState(true), smoothedFi->getFittedState(true));
+                expectSameState(fi->getFittedState(false), smoothedFi->getFittedState(false));
+            }
+        }
+    }
+
+    TEST_F(KalmanFitterRefTrackTests, RTSSmootherRefitKeepsReferenceStates) {
+        const unsigned int nPoints = 8;
+        KalmanFitterRefTrack smoother;
+        smoother.setUseRTSSmoother();
+
+        Track* track = testTracks::makePlanarTrack(TVector3(0., 0., 0.), TVector3(0.6, -0.1, 0.2), nPoints, 0.01, 7);
+        m_tracks.push_back(track);
+        smoother.processTrackWithRep(track, track->getCardinalRep());
+        ASSERT_TRUE(track->getFitStatus()->isFitConverged());
+
+        std::vector<MeasuredStateOnPlane> smoothed;
+        for (unsigned int iPoint = 0; iPoint < nPoints; ++iPoint)
+            smoothed.push_back(track->getPointWithMeasurement(iPoint)->getKalmanFitterInfo()->getFittedState(true));
+
+        // the reference states are taken from the smoothed states, so the refit converges right away
+        smoother.processTrackWithRep(track, track->getCardinalRep());
+        const KalmanFitStatus* status = static_cast<KalmanFitStatus*>(track->getFitStatus());
+        ASSERT_TRUE(status->isFitConverged());
+        EXPECT_GE(2u, status->getNumIterations());
+
+        for (unsigned int iPoint = 0; iPoint < nPoints; ++iPoint) {
+            const KalmanFitterInfo* fi = track->getPointWithMeasurement(iPoint)->getKalmanFitterInfo();
+            ASSERT_TRUE(fi->hasSmoothedState());
+            expectSameState(smoothed[iPoint], fi->getFittedState(true));
+        }
+    }
+
+    TEST_F(KalmanFitterRefTrackTests, SquareRootFilterAgreesWithStandardFilter) {
+        const unsigned int nPoints = 8;
+        double chi2[2], ndf[2];
+
+        for (unsigned int squareRoot = 0; squareRoot < 2; ++squareRoot) {
+            KalmanFitterRefTrack fitter(4, 1e-3, 1e3, squareRoot == 1);
+            Track* track = testTracks::makePlanarTrack(TVector3(0., 0., 0.), TVector3(0.6, -0.1, 0.2), nPoints, 0.01, 7);
+            m_tracks.push_back(track);
+            fitter.processTrackWithRep(track, track->getCardinalRep());
+            ASSERT_TRUE(track->getFitStatus()->isFitConverged());
+
+            // forward filter only, on the final reference states
+            fitter.setRefitAll();
+            fitter.fitTrack(track, track->getCardinalRep(), chi2[squareRoot], ndf[squareRoot], +1);
+        }
+
+        EXPECT_NEAR(chi2[0], chi2[1], 1E-4 * std::max(1., chi2[0]));
+        EXPECT_DOUBLE_EQ(ndf[0], ndf[1]);
+        for (unsigned int iPoint = 0; iPoint < nPoints; ++iPoint)
+            expectSameState(*(m_tracks[0]->getPointWithMeasurement(iPoint)->getKalmanFitterInfo()->getForwardUpdate()),
+                            *(m_tracks[1]->getPointWithMeasurement(iPoint)->getKalmanFitterInfo()->getForwardUpdate()));
+    }
+
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <MappedField.h>
+#include <Exception.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace genfit {
+
+    class MappedFieldTests : public ::testing::Test {
+    protected:
+        virtual void SetUp() {
+            m_fileName = ::testing::TempDir() + "TestMappedField.gfmap";
+
+            // linear field, reproduced exactly by trilinear interpolation
+            const unsigned int nPoints[3] = {5, 4, 3};
+            const double min[3] = {-10., -5., 0.};
+            const double spacing[3] = {5., 2.5, 10.};
+            for (unsigned int ix = 0; ix < nPoints[0]; ++ix) {
+                for (unsigned int iy = 0; iy < nPoints[1]; ++iy) {
+                    for (unsigned int iz = 0; iz < nPoints[2]; ++iz) {
+                        const double x = min[0] + ix * spacing[0];
+                        const double y = min[1] + iy * spacing[1];
+                        const double z = min[2] + iz * spacing[2];
+                        double B[3];
+                        linearField(x, y, z, B);
+                        m_field.insert(m_field.end(), B, B + 3);
+                    }
+                }
+            }
+            std::copy(nPoints, nPoints + 3, m_nPoints);
+            std::copy(min, min + 3, m_min);
+            std::copy(spacing, spacing + 3, m_spacing);
+        }
+
+        virtual void TearDown() {
+            std::remove(m_fileName.c_str());
+        }
+
+        static void linearField(double x, double y, double z, double B[3]) {
+            B[0] = 0.1 * x - 0.2 * y;
+            B[1] = 0.05 * z + 1.;
+            B[2] = 15. + 0.01 * x + 0.02 * y - 0.03 * z;
+        }
+
+        std::string m_fileName;
+        unsigned int m_nPoints[3];
+        double m_min[3];
+        double m_spacing[3];
+        std::vector<double> m_field;
+    };
+
+    TEST_F(MappedFieldTests, Interpolation) {
+        for (bool singlePrecision : {false, true}) {
+            MappedField::write(m_fileName, m_nPoints, m_min, m_spacing, m_field, singlePrecision);
+            MappedField field(m_fileName);
+            EXPECT_EQ(field.getHeader().nPoints_[0], 5u);
+            EXPECT_EQ(field.getHeader().valueSize_, singlePrecision ? sizeof(float) : sizeof(double));
+
+            const double tolerance = singlePrecision ? 1E-5 : 1E-12;
+            const double positions[][3] = {{-10., -5., 0.}, {10., 2.5, 20.}, {1.3, -0.7, 13.1}, {9.99, 2.4, 0.01}};
+            for (const auto& pos : positions) {
+                double expected[3], B[3];
+                linearField(pos[0], pos[1], pos[2], expected);
+                field.get(pos[0], pos[1], pos[2], B[0], B[1], B[2]);
+                for (unsigned int i = 0; i < 3; ++i)
+                    EXPECT_NEAR(expected[i], B[i], tolerance);
+            }
+
+            // outside of the grid
+            const TVector3 outside = field.get(TVector3(0., 0., 20.1));
+            EXPECT_EQ(0., outside.Mag());
+        }
+    }
+
+    TEST_F(MappedFieldTests, InvalidFile) {
+        std::ofstream(m_fileName.c_str()) << "not a field map, but long enough for the header of one. not a field map, but long enough for the header of one.";
+        EXPECT_THROW(MappedField field(m_fileName), Exception);
+        EXPECT_THROW(MappedField field(m_fileName + ".missing"), Exception);
+    }
+
+    TEST_F(MappedFieldTests, OverflowingGridSize) {
+        MappedField::write(m_fileName, m_nPoints, m_min, m_spacing, m_field, false);
+        std::vector<char> bytes;
+        {
+            std::ifstream in(m_fileName.c_str(), std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        ASSERT_GE(bytes.size(), sizeof(FieldMapHeader));
+
+        // 3 * 2^31 * 2^31 * 2^31 wraps around to 0 in 64 bits
+        FieldMapHeader header;
+        memcpy(&header, bytes.data(), sizeof(header));
+        header.nPoints_[0] = header.nPoints_[1] = header.nPoints_[2] = 1u << 31;
+        memcpy(bytes.data(), &header, sizeof(header));
+        std::ofstream(m_fileName.c_str(), std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size());
+
+        EXPECT_THROW(MappedField field(m_fileName), Exception);
+    }
+
+}
@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 
 #include <Material.h>
+#include <MaterialTable.h>
+
+#include <cmath>
 
 namespace genfit {
 
@@ -40,4 +43,28 @@ namespace genfit {
         EXPECT_FALSE(myMaterial02 != myMaterial03);
     }
 
+    TEST_F (MaterialTests, TableInterning) {
+        MaterialTable* table = MaterialTable::getInstance();
+        EXPECT_EQ(MaterialTable::vacuumId, table->intern(Material()));
+        EXPECT_EQ(MaterialTable::vacuumId, table->intern(Material(-0., 0, 0, 0, 0)));
+
+        const Material silicon(2.33, 14, 28.0855, 9.37, 173);
+        const Material iron(7.874, 26, 55.845, 1.757, 286);
+        const MaterialId siliconId = table->intern(silicon);
+        const MaterialId ironId = table->intern(iron);
+        EXPECT_NE(MaterialTable::vacuumId, siliconId);
+        EXPECT_NE(siliconId, ironId);
+        EXPECT_EQ(siliconId, table->intern(Material(2.33, 14, 28.0855, 9.37, 173)));
+        EXPECT_EQ(ironId, table->intern(iron));
+        EXPECT_TRUE(table->getMaterial(siliconId) == silicon);
+
+        const MaterialConstants& constants = table->getConstants(siliconId);
+        EXPECT_FALSE(constants.isVacuum_);
+        EXPECT_TRUE(table->getConstants(MaterialTable::vacuumId).isVacuum_);
+        EXPECT_DOUBLE_EQ(14. / 28.0855 * 2.33, constants.zOverADensity_);
+        EXPECT_DOUBLE_EQ(std::log(173.E-6), constants.logMEE_);
+        EXPECT_DOUBLE_EQ(1. / 9.37, constants.invRadiationLength_);
+        EXPECT_DOUBLE_EQ(16. * std::pow(14., 0.9), constants.urbanI_);
+    }
+
 }
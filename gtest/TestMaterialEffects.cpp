@@ -2,9 +2,24 @@
 
 #include <AbsMaterialInterface.h>
 #include <MaterialEffects.h>
+#include <MaterialTable.h>
+#include <RKTrackRep.h>
+
+#include <vector>
 
 namespace genfit {
 
+    // Homogeneous material everywhere.
+    class ConstMaterialInterface : public AbsMaterialInterface {
+    public:
+        explicit ConstMaterialInterface(const Material& material) : material_(material) {;}
+        bool initTrack(double, double, double, double, double, double) override {return false;}
+        Material getMaterialParameters() override {return material_;}
+        double findNextBoundary(const RKTrackRep*, const M1x7&, double sMax, bool) override {return sMax;}
+    private:
+        Material material_;
+    };
+
     class MaterialEffectsTests : public ::testing::Test {
     protected:
         virtual void SetUp() {
@@ -17,6 +32,47 @@ namespace genfit {
     };
 
 
-    // TODO: Write a ConstMaterialInterface similiar to the ConstMagneticField for testing purposes.
-    // TODO: We can easily check the formulas then! Yeah...
+    class MaterialEffectsStepTests : public ::testing::Test {
+    protected:
+        virtual void SetUp() {
+            genfit::MaterialEffects::getInstance()->init(new ConstMaterialInterface(Material()));
+        }
+
+        virtual void TearDown() {
+            genfit::MaterialEffects::getInstance()->destruct();
+        }
+
+        static RKStep makeStep(MaterialId id, double stepSize) {
+            RKStep step;
+            step.materialId_ = id;
+            step.stepSize_ = stepSize;
+            step.state7_[5] = 1.; // along z
+            step.state7_[6] = 1.; // q/p
+            return step;
+        }
+
+        double effects(const std::vector<RKStep>& steps, M7x7& noise) const {
+            std::fill(noise.begin(), noise.end(), 0.);
+            return MaterialEffects::getInstance()->effects(steps, 0, steps.size(), 1., 211, &noise);
+        }
+    };
+
+    TEST_F(MaterialEffectsStepTests, TinyFirstStepLoadsMaterial) {
+        MaterialTable* table = MaterialTable::getInstance();
+        const MaterialId siliconId = table->intern(Material(2.33, 14, 28.0855, 9.37, 173));
+        const MaterialId ironId = table->intern(Material(7.874, 26, 55.845, 1.757, 286));
+
+        M7x7 noise, referenceNoise;
+        const double reference = effects(std::vector<RKStep>{makeStep(siliconId, 1.)}, referenceNoise);
+        EXPECT_GT(reference, 0.);
+
+        // iron is loaded last, the silicon steps must not use its constants
+        M7x7 ironNoise;
+        EXPECT_GT(effects(std::vector<RKStep>{makeStep(ironId, 1.)}, ironNoise), reference);
+
+        const double momLoss = effects(std::vector<RKStep>{makeStep(siliconId, 1.E-10), makeStep(siliconId, 1.)}, noise);
+        EXPECT_DOUBLE_EQ(reference, momLoss);
+        for (unsigned int i = 0; i < 7 * 7; ++i)
+            EXPECT_DOUBLE_EQ(referenceNoise[i], noise[i]);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <GblTrajectory.h>
+#include <MilleAccumulator.h>
+
+namespace gbl {
+
+    const unsigned int nPlanes = 10;
+
+    class MilleAccumulatorTests : public ::testing::Test {
+    protected:
+        // Offsets of planes in u (planes 0, 1 and the last two are the reference)
+        double planeOffset(unsigned int iPlane) const {
+            return (iPlane < 2 or iPlane >= nPlanes - 2) ? 0. : 0.01 * iPlane - 0.03 * (iPlane % 3);
+        }
+
+        // Straight line in u1 measured by shifted planes, offsets are global parameters (label = plane + 1)
+        GblTrajectory makeTrajectory(double offset, double slope) const {
+            std::vector<GblPoint> points;
+            for (unsigned int i = 0; i < nPlanes; ++i) {
+                Matrix5x5 jacobian = Matrix5x5::Identity();
+                if (i > 0) {
+                    jacobian(3, 1) = 1.;
+                    jacobian(4, 2) = 1.;
+                }
+                GblPoint point(jacobian);
+                VectorDynamic residuals(2), precision(2);
+                residuals << offset + slope * i + planeOffset(i), 0.;
+                precision << 1.e4, 1.e4;
+                point.addMeasurement(residuals, precision);
+                if (planeOffset(i) != 0.) {
+                    MatrixDynamic derivatives = MatrixDynamic::Zero(2, 1);
+                    derivatives(0, 0) = 1.;
+                    point.addGlobals(std::vector<int>(1, i + 1), derivatives);
+                }
+                points.push_back(point);
+            }
+            return GblTrajectory(points, false);
+        }
+    };
+
+    TEST_F(MilleAccumulatorTests, RecoverPlaneOffsets) {
+        MilleAccumulator all, firstHalf, secondHalf;
+        for (unsigned int iTrack = 0; iTrack < 20; ++iTrack) {
+            GblTrajectory trajectory = makeTrajectory(0.1 * (iTrack % 7) - 0.3, 0.02 * (iTrack % 5) - 0.04);
+            EXPECT_EQ(0u, all.addTrajectory(trajectory));
+            EXPECT_EQ(0u, (iTrack % 2 ? firstHalf : secondHalf).addTrajectory(trajectory));
+        }
+        EXPECT_EQ(20u, all.getNumRecords());
+        EXPECT_EQ(0u, all.getNumRejected());
+        EXPECT_EQ(nPlanes - 4, all.getNumParameters());
+        // track parameters (offset, slope in u and v) are eliminated
+        EXPECT_EQ(20 * (2 * static_cast<int>(nPlanes) - 4), all.getNdf());
+
+        firstHalf.merge(secondHalf);
+        EXPECT_EQ(all.getNumRecords(), firstHalf.getNumRecords());
+
+        for (MilleAccumulator* accumulator : {&all, &firstHalf}) {
+            std::map<int, double> correction;
+            EXPECT_EQ(0u, accumulator->solve(correction));
+            ASSERT_EQ(nPlanes - 4, correction.size());
+            for (unsigned int i = 2; i < nPlanes - 2; ++i)
+                EXPECT_NEAR(planeOffset(i), correction[i + 1], 1.e-6);
+        }
+    }
+
+    TEST_F(MilleAccumulatorTests, RejectedRecordCreatesNoParameters) {
+        MilleAccumulator accumulator;
+        const unsigned int indLocal[1] = {1};
+        const double derLocal[1] = {1.};
+        MilleRecord record(true, 0);
+        record.addData(0.1, 0.01, 1, indLocal, derLocal, std::vector<int>(1, 7), std::vector<double>(1, 1.));
+        record.addData(0.2, 0., 1, indLocal, derLocal, std::vector<int>(1, 8), std::vector<double>(1, 1.)); // bad error
+        EXPECT_EQ(2u, accumulator.addRecord(record));
+        EXPECT_EQ(1u, accumulator.getNumRejected());
+        EXPECT_EQ(0u, accumulator.getNumRecords());
+        EXPECT_EQ(0u, accumulator.getNumParameters());
+
+        GblTrajectory trajectory = makeTrajectory(0.1, 0.01);
+        EXPECT_EQ(0u, accumulator.addTrajectory(trajectory));
+        EXPECT_EQ(nPlanes - 4, accumulator.getNumParameters());
+    }
+
+}
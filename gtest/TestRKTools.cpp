@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include <RKTools.h>
+#include <EigenMatrixTypedefs.h>
+#include <RKMatrixEigenTransformations.h>
+
+#include <cmath>
+
+namespace genfit {
+
+    class RKToolsTests : public ::testing::Test {
+    protected:
+        // transposed RK Jacobian: last column (0, 0, 0, 0, 0, 0, 1)
+        static M7x7 makeJacobianT(double seed) {
+            M7x7 jacT;
+            for (unsigned int i = 0; i < 7; ++i)
+                for (unsigned int j = 0; j < 7; ++j)
+                    jacT(i, j) = (i == j ? 1. : 0.) + 0.1 * sin(seed + 3. * i + j);
+            for (unsigned int i = 0; i < 7; ++i)
+                jacT(i, 6) = (i == 6 ? 1. : 0.);
+            return jacT;
+        }
+
+        // material noise: symmetric 6x6 block and q/p variance
+        static M7x7 makeNoise(double seed) {
+            Eigen::Matrix<double, 7, 7> root = Eigen::Matrix<double, 7, 7>::Zero();
+            for (unsigned int i = 0; i < 6; ++i)
+                for (unsigned int j = 0; j < 6; ++j)
+                    root(i, j) = cos(seed + 2. * i + 5. * j);
+            Eigen::Matrix<double, 7, 7> noise = root * root.transpose();
+            noise(6, 6) = 0.3 + 0.1 * seed;
+            return eigenMatrixToRKMatrix<7, 7>(noise);
+        }
+    };
+
+    TEST_F(RKToolsTests, NoiseSimilarity) {
+        const M7x7 jacT = makeJacobianT(0.7);
+        const M7x7 noise = makeNoise(1.3);
+        M7x7 out = makeNoise(2.1);
+
+        const Eigen::Matrix<double, 7, 7> jac = RKMatrixToEigenMatrix<7, 7>(jacT).transpose();
+        const Eigen::Matrix<double, 7, 7> expected =
+            RKMatrixToEigenMatrix<7, 7>(out) + jac * RKMatrixToEigenMatrix<7, 7>(noise) * jac.transpose();
+
+        RKTools::J_MMxNoise7xJ_MMT(jacT, noise, out);
+        for (unsigned int i = 0; i < 7; ++i)
+            for (unsigned int j = 0; j < 7; ++j)
+                EXPECT_NEAR(expected(i, j), out(i, j), 1E-12) << i << ", " << j;
+    }
+
+    TEST_F(RKToolsTests, JacobianProduct) {
+        const M7x7 stepT = makeJacobianT(0.4);
+        M7x7 accT = makeJacobianT(1.9);
+
+        const Eigen::Matrix<double, 7, 7> expected =
+            RKMatrixToEigenMatrix<7, 7>(stepT) * RKMatrixToEigenMatrix<7, 7>(accT);
+
+        RKTools::J_MMTxJ_MMT(stepT, accT);
+        for (unsigned int i = 0; i < 7; ++i)
+            for (unsigned int j = 0; j < 7; ++j)
+                EXPECT_NEAR(expected(i, j), accT(i, j), 1E-12) << i << ", " << j;
+    }
+
+}
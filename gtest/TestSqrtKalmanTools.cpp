@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include <HMatrixUV.h>
+#include <SqrtKalmanTools.h>
+
+#include <cmath>
+
+namespace genfit {
+
+    class SqrtKalmanToolsTests : public ::testing::Test {
+    protected:
+        // deterministic pseudo random numbers
+        static double number(unsigned int i) {
+            return sin(2.3 * i + 0.7) * 0.5;
+        }
+
+        static Matrix5x5 positiveDefinite(unsigned int seed, double diagonal) {
+            Matrix5x5 A;
+            for (unsigned int i = 0; i < 25; ++i)
+                A(i / 5, i % 5) = number(seed + i);
+            return A * A.transpose() + diagonal * Matrix5x5::Identity();
+        }
+
+        static Matrix5x5 upperSqrt(const Matrix5x5& cov) {
+            return cov.llt().matrixU();
+        }
+    };
+
+    TEST_F(SqrtKalmanToolsTests, NoiseSqrtOfSingularNoise) {
+        // rank 2 noise, like multiple scattering in the direction only
+        Eigen::Matrix<double, 5, 2> A;
+        for (unsigned int i = 0; i < 10; ++i)
+            A(i % 5, i / 5) = number(i);
+        const Matrix5x5 noise = A * A.transpose();
+
+        Matrix5x5 Q;
+        tools::noiseMatrixSqrt<5>(noise, Q);
+        EXPECT_LT((Q * Q.transpose() - noise).cwiseAbs().maxCoeff(), 1E-14);
+
+        tools::noiseMatrixSqrt<5>(Matrix5x5::Zero(), Q);
+        EXPECT_EQ(0., Q.cwiseAbs().maxCoeff());
+    }
+
+    TEST_F(SqrtKalmanToolsTests, PredictionAgreesWithStandardFilter) {
+        const Matrix5x5 C = positiveDefinite(10, 0.1);
+        const Matrix5x5 F = Matrix5x5::Identity() + 0.2 * positiveDefinite(40, 0.);
+        const Matrix5x5 N = 0.01 * positiveDefinite(70, 0.);
+
+        Matrix5x5 S = upperSqrt(C);
+        Matrix5x5 Q;
+        tools::noiseMatrixSqrt<5>(N, Q);
+        tools::kalmanPredictionCovSqrt<5>(S, F, Q, S);
+
+        const Matrix5x5 expected = F * C * F.transpose() + N;
+        EXPECT_LT((S.transpose() * S - expected).cwiseAbs().maxCoeff(), 1E-12);
+        EXPECT_EQ(0., S.triangularView<Eigen::StrictlyLower>().toDenseMatrix().cwiseAbs().maxCoeff());
+    }
+
+    TEST_F(SqrtKalmanToolsTests, UpdateAgreesWithStandardFilter) {
+        const Matrix5x5 C = positiveDefinite(100, 0.2);
+        Eigen::Matrix<double, 2, 5> H = Eigen::Matrix<double, 2, 5>::Zero();
+        H(0, 3) = 1.;
+        H(1, 4) = 1.;
+        Matrix2x2 V;
+        V << 0.02, 0.005, 0.005, 0.03;
+        const Vector2 res(0.3, -0.1);
+
+        Matrix5x5 S = upperSqrt(C);
+        const Matrix2x2 R = V.llt().matrixU();
+        Vector5 update;
+        const double chi2inc = tools::kalmanUpdateSqrt<5, 2>(S, res, R, H, update, S);
+
+        const Matrix2x2 covSum = H * C * H.transpose() + V;
+        const Eigen::Matrix<double, 5, 2> K = C * H.transpose() * covSum.inverse();
+        const Matrix5x5 expectedCov = C - K * H * C;
+        EXPECT_LT((update - K * res).cwiseAbs().maxCoeff(), 1E-12);
+        EXPECT_LT((S.transpose() * S - expectedCov).cwiseAbs().maxCoeff(), 1E-12);
+        EXPECT_NEAR(res.dot(covSum.inverse() * res), chi2inc, 1E-12);
+
+        // chi2 of the updated residual with the updated covariance is the same
+        const Vector2 resNew = res - H * update;
+        const Matrix2x2 resNewCov = V - H * expectedCov * H.transpose();
+        EXPECT_NEAR(resNew.dot(resNewCov.inverse() * resNew), chi2inc, 1E-10);
+    }
+
+    TEST_F(SqrtKalmanToolsTests, WeightedUpdateOfRootState) {
+        const Matrix5x5 C = positiveDefinite(200, 0.2);
+        const double weight = 0.4;
+        const HMatrixUV H;
+        Eigen::Matrix<double, 2, 5> eigenH = Eigen::Matrix<double, 2, 5>::Zero();
+        eigenH(0, 3) = 1.;
+        eigenH(1, 4) = 1.;
+
+        TVectorD state(5);
+        Vector5 eigenState;
+        for (unsigned int i = 0; i < 5; ++i)
+            eigenState(i) = state(i) = number(250 + i);
+        TVectorD measurement(2);
+        measurement(0) = 0.3;
+        measurement(1) = -0.1;
+        TMatrixDSym V(2);
+        V(0, 0) = 0.02;
+        V(0, 1) = V(1, 0) = 0.005;
+        V(1, 1) = 0.03;
+
+        TMatrixDSym cov(5);
+        for (unsigned int i = 0; i < 5; ++i)
+            for (unsigned int j = 0; j < 5; ++j)
+                cov(i, j) = C(i, j);
+        Matrix5x5 S;
+        tools::covSqrt(cov, S);
+        const double chi2inc = tools::kalmanUpdateSqrt(S, state, measurement, V, weight, &H);
+        tools::covFromSqrt(S, cov);
+
+        Matrix2x2 weightedV;
+        weightedV << 0.02, 0.005, 0.005, 0.03;
+        weightedV /= weight;
+        const Vector2 res = Vector2(0.3, -0.1) - eigenH * eigenState;
+        const Matrix2x2 covSum = eigenH * C * eigenH.transpose() + weightedV;
+        const Eigen::Matrix<double, 5, 2> K = C * eigenH.transpose() * covSum.inverse();
+        const Vector5 expectedState = eigenState + K * res;
+        const Matrix5x5 expectedCov = C - K * eigenH * C;
+        for (unsigned int i = 0; i < 5; ++i) {
+            EXPECT_NEAR(expectedState(i), state(i), 1E-12);
+            for (unsigned int j = 0; j < 5; ++j)
+                EXPECT_NEAR(expectedCov(i, j), cov(i, j), 1E-12);
+        }
+        EXPECT_NEAR(res.dot(covSum.inverse() * res), chi2inc, 1E-12);
+    }
+
+    TEST_F(SqrtKalmanToolsTests, IllConditionedWireUpdates) {
+        // blown up seed, many precise 1D measurements in the same direction
+        Matrix5x5 S = upperSqrt(1E6 * Matrix5x5::Identity());
+        Eigen::Matrix<double, 1, 5> H;
+        H << 0., 0., 0., 1., 1E-3;
+        const Eigen::Matrix<double, 1, 1> R = Eigen::Matrix<double, 1, 1>::Constant(1E-4);
+        const Eigen::Matrix<double, 1, 1> res = Eigen::Matrix<double, 1, 1>::Zero();
+        Vector5 update;
+        for (unsigned int i = 0; i < 100; ++i)
+            tools::kalmanUpdateSqrt<5, 1>(S, res, R, H, update, S);
+
+        // the covariance stays positive semidefinite by construction, and is still decomposable
+        const Matrix5x5 C = S.transpose() * S;
+        EXPECT_EQ(Eigen::Success, C.llt().info());
+        EXPECT_NEAR(1E-8 / 100., H * C * H.transpose(), 1E-12);
+    }
+
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <TVector3.h>
+
+#include <ConstField.h>
+#include <DetPlane.h>
+#include <FieldManager.h>
+#include <MaterialEffects.h>
+#include <MeasuredStateOnPlane.h>
+#include <RKTrackRep.h>
+#include <RectangularFinitePlane.h>
+#include <SurfaceExtrapolator.h>
+
+#include <cmath>
+#include <vector>
+
+
+namespace genfit {
+
+    class SurfaceExtrapolatorTests : public ::testing::Test {
+
+    protected:
+        virtual void SetUp() {
+            genfit::FieldManager::getInstance()->init(new genfit::ConstField(0., 0., 20.));  // kGauss
+            genfit::MaterialEffects::getInstance()->init(nullptr);
+            genfit::MaterialEffects::getInstance()->setNoEffects();
+            m_rep = new genfit::RKTrackRep(211);
+
+            TMatrixDSym cov(6);
+            for (int i = 0; i < 3; ++i) {
+                cov(i, i) = 1.E-4;
+                cov(i + 3, i + 3) = 1.E-6;
+            }
+            m_start = MeasuredStateOnPlane(m_rep);
+            m_rep->setPosMomCov(m_start, TVector3(0., 0., 0.), TVector3(1., 0., 1.), cov);
+
+            // two cylinders, one out of reach, a plane and a small disk behind it
+            m_extrapolator.addSurface(ExtrapolationSurface(10., TVector3(0., 0., 0.), TVector3(0., 0., 1.)));
+            m_extrapolator.addSurface(ExtrapolationSurface(50., TVector3(0., 0., 0.), TVector3(0., 0., 1.), 200.));
+            m_extrapolator.addSurface(ExtrapolationSurface(500., TVector3(0., 0., 0.), TVector3(0., 0., 1.)));
+            m_extrapolator.addSurface(ExtrapolationSurface(SharedPlanePtr(new DetPlane(TVector3(0., 0., 100.), TVector3(0., 0., 1.)))));
+            m_extrapolator.addSurface(ExtrapolationSurface(SharedPlanePtr(new DetPlane(TVector3(0., 0., 150.), TVector3(0., 0., 1.),
+                new RectangularFinitePlane(-1., 1., -1., 1.)))));
+        }
+        virtual void TearDown() {
+            delete m_rep;
+            genfit::MaterialEffects::getInstance()->destruct();
+            genfit::FieldManager::getInstance()->destruct();
+        }
+
+        genfit::RKTrackRep* m_rep;
+        MeasuredStateOnPlane m_start;
+        SurfaceExtrapolator m_extrapolator;
+    };
+
+    TEST_F(SurfaceExtrapolatorTests, CrossingsMatchSingleExtrapolations) {
+        std::vector<SurfaceCrossing> crossings;
+        ASSERT_EQ(3u, m_extrapolator.extrapolate(m_start, crossings));
+        EXPECT_EQ(0u, crossings[0].surfaceId_);
+        EXPECT_EQ(1u, crossings[1].surfaceId_);
+        EXPECT_EQ(3u, crossings[2].surfaceId_);
+
+        StateOnPlane state(m_start);
+        double length = m_rep->extrapolateToCylinder(state, 10.);
+        EXPECT_NEAR(length, crossings[0].trackLength_, 1.E-4);
+        EXPECT_NEAR(0., (m_rep->getPos(state) - crossings[0].state_.getPos()).Mag(), 1.E-4);
+
+        state = m_start;
+        length = m_rep->extrapolateToCylinder(state, 50.);
+        EXPECT_NEAR(length, crossings[1].trackLength_, 1.E-4);
+        EXPECT_NEAR(0., (m_rep->getPos(state) - crossings[1].state_.getPos()).Mag(), 1.E-4);
+
+        state = m_start;
+        length = m_rep->extrapolateToPlane(state, m_extrapolator.getSurface(3).plane_);
+        EXPECT_NEAR(length, crossings[2].trackLength_, 1.E-4);
+        EXPECT_NEAR(0., (m_rep->getPos(state) - crossings[2].state_.getPos()).Mag(), 1.E-4);
+
+        // no covariance requested
+        for (const SurfaceCrossing& crossing : crossings)
+            EXPECT_DOUBLE_EQ(0., crossing.state_.getCov()(0, 0));
+    }
+
+    TEST_F(SurfaceExtrapolatorTests, CovarianceOnRequest) {
+        m_extrapolator.setCalcCovariance();
+        std::vector<const MeasuredStateOnPlane*> states(2, &m_start);
+        std::vector<std::vector<SurfaceCrossing> > crossings;
+        m_extrapolator.extrapolate(states, crossings);
+        ASSERT_EQ(2u, crossings.size());
+        ASSERT_EQ(3u, crossings[1].size());
+
+        MeasuredStateOnPlane state(m_start);
+        m_rep->extrapolateToPlane(state, m_extrapolator.getSurface(3).plane_);
+        const TMatrixDSym& cov = crossings[1][2].state_.getCov();
+        for (int i = 0; i < 5; ++i) {
+            EXPECT_GT(cov(i, i), 0.);
+            for (int j = 0; j < 5; ++j)
+                EXPECT_NEAR(state.getCov()(i, j), cov(i, j), 1.E-4 * std::sqrt(cov(i, i) * cov(j, j)));
+        }
+    }
+
+}
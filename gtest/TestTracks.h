@@ -0,0 +1,57 @@
+#ifndef genfit_gtest_TestTracks_h
+#define genfit_gtest_TestTracks_h
+
+#include <TMatrixDSym.h>
+#include <TVector3.h>
+#include <TVectorD.h>
+
+#include <DetPlane.h>
+#include <PlanarMeasurement.h>
+#include <RKTrackRep.h>
+#include <SharedPlanePtr.h>
+#include <StateOnPlane.h>
+#include <Track.h>
+#include <TrackPoint.h>
+
+#include <cmath>
+
+
+namespace genfit {
+
+    namespace testTracks {
+
+        // deterministic pseudo random numbers in [-0.5, 0.5]
+        inline double number(unsigned int i) {
+            return std::sin(1.7 * i + 0.3) * 0.5;
+        }
+
+        // Pion track from pos with mom, measured in u and v with resolution sigma on nPlanes planes
+        // perpendicular to the x axis, 10 cm apart. The hits are shifted by deterministic offsets
+        // (seed), the seed state of the track is shifted from the true one.
+        inline Track* makePlanarTrack(const TVector3& pos, const TVector3& mom, unsigned int nPlanes,
+                                      double sigma, unsigned int seed) {
+            RKTrackRep* rep = new RKTrackRep(211);
+            Track* track = new Track(rep, pos + TVector3(0.05, -0.05, 0.1), 1.05 * mom);
+
+            StateOnPlane state(rep);
+            rep->setPosMom(state, pos, mom);
+            TMatrixDSym cov(2);
+            cov(0, 0) = cov(1, 1) = sigma * sigma;
+            for (unsigned int i = 0; i < nPlanes; ++i) {
+                const SharedPlanePtr plane(new DetPlane(TVector3(10. * (i + 1), 0., 0.), TVector3(0., 1., 0.), TVector3(0., 0., 1.)));
+                rep->extrapolateToPlane(state, plane);
+                TVectorD coords(2);
+                coords(0) = state.getState()(3) + 2. * sigma * number(seed + 2 * i);
+                coords(1) = state.getState()(4) + 2. * sigma * number(seed + 2 * i + 1);
+                PlanarMeasurement* measurement = new PlanarMeasurement(coords, cov, 0, i, nullptr);
+                measurement->setPlane(plane, i);
+                track->insertPoint(new TrackPoint(measurement, track));
+            }
+            return track;
+        }
+
+    }
+
+}
+
+#endif // genfit_gtest_TestTracks_h
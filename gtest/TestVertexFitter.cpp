@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+
+#include <TVector3.h>
+
+#include <ConstField.h>
+#include <FieldManager.h>
+#include <MaterialEffects.h>
+#include <MeasuredStateOnPlane.h>
+#include <RKTrackRep.h>
+#include <VertexFinder.h>
+#include <VertexFitter.h>
+
+#include <cmath>
+#include <vector>
+
+
+namespace genfit {
+
+    class VertexFitterTests : public ::testing::Test {
+
+    protected:
+        virtual void SetUp() {
+            genfit::FieldManager::getInstance()->init(new genfit::ConstField(0., 0., 20.));  // kGauss
+            genfit::MaterialEffects::getInstance()->init(nullptr);
+            genfit::MaterialEffects::getInstance()->setNoEffects();
+            m_rep = new genfit::RKTrackRep(211);
+        }
+        virtual void TearDown() {
+            delete m_rep;
+            genfit::MaterialEffects::getInstance()->destruct();
+            genfit::FieldManager::getInstance()->destruct();
+        }
+
+        // Tracks from vertex, states 5 to 15 cm away from it.
+        void makeStates(const TVector3& vertex, unsigned int nTracks, std::vector<MeasuredStateOnPlane>& states) const {
+            TMatrixDSym cov(6);
+            for (int i = 0; i < 3; ++i) {
+                cov(i, i) = 1.E-4;
+                cov(i + 3, i + 3) = 1.E-6;
+            }
+            for (unsigned int i = 0; i < nTracks; ++i) {
+                const double phi = 0.7 * i, theta = 0.6 + 0.05 * i;
+                TVector3 mom(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+                mom *= 0.5 + 0.1 * i;
+                MeasuredStateOnPlane state(m_rep);
+                m_rep->setPosMomCov(state, vertex, mom, cov);
+                m_rep->extrapolateBy(state, 5. + i);
+                states.push_back(state);
+            }
+        }
+
+        genfit::RKTrackRep* m_rep;
+    };
+
+    TEST_F(VertexFitterTests, RecoverVertex) {
+        const TVector3 vertex(0.1, -0.2, 0.5);
+        std::vector<MeasuredStateOnPlane> states;
+        makeStates(vertex, 10, states);
+        std::vector<const MeasuredStateOnPlane*> statePointers;
+        for (const MeasuredStateOnPlane& state : states)
+            statePointers.push_back(&state);
+
+        VertexFitter fitter;
+        FittedVertex fitted;
+        ASSERT_TRUE(fitter.fit(statePointers, fitted));
+        EXPECT_NEAR(0., (fitted.getPos() - vertex).Mag(), 1.E-4);
+        EXPECT_NEAR(0., fitted.getChi2(), 1.E-3);
+        EXPECT_DOUBLE_EQ(17., fitted.getNdf());
+        ASSERT_EQ(10u, fitted.getNTracks());
+        for (unsigned int i = 0; i < fitted.getNTracks(); ++i) {
+            EXPECT_DOUBLE_EQ(1., fitted.getParameters(i).weight_);
+            EXPECT_NEAR(0.5 + 0.1 * i, fitted.getParameters(i).mom_.norm(), 1.E-4);
+        }
+        for (unsigned int i = 0; i < 3; ++i)
+            EXPECT_GT(fitted.getCov()(i, i), 0.);
+    }
+
+    TEST_F(VertexFitterTests, AdaptiveFitRejectsOutlier) {
+        const TVector3 vertex(0.1, -0.2, 0.5);
+        std::vector<MeasuredStateOnPlane> states;
+        makeStates(vertex, 10, states);
+        // track from a second vertex 1 cm away
+        makeStates(vertex + TVector3(1., 0., 0.), 1, states);
+        std::vector<const MeasuredStateOnPlane*> statePointers;
+        for (const MeasuredStateOnPlane& state : states)
+            statePointers.push_back(&state);
+
+        VertexFitter fitter;
+        FittedVertex fitted;
+        ASSERT_TRUE(fitter.fit(statePointers, fitted));
+        const double plainDistance = (fitted.getPos() - vertex).Mag();
+
+        ASSERT_TRUE(fitter.fitAdaptive(statePointers, fitted));
+        EXPECT_NEAR(0., (fitted.getPos() - vertex).Mag(), 1.E-3);
+        EXPECT_LT((fitted.getPos() - vertex).Mag(), plainDistance);
+        for (unsigned int i = 0; i < 10; ++i)
+            EXPECT_GT(fitted.getParameters(i).weight_, 0.9);
+        EXPECT_LT(fitted.getParameters(10).weight_, 1.E-3);
+    }
+
+    TEST_F(VertexFitterTests, NotConvergedFitFails) {
+        const TVector3 vertex(0.1, -0.2, 0.5);
+        std::vector<MeasuredStateOnPlane> states;
+        makeStates(vertex, 10, states);
+        std::vector<const MeasuredStateOnPlane*> statePointers;
+        for (const MeasuredStateOnPlane& state : states)
+            statePointers.push_back(&state);
+
+        VertexFitter fitter;
+        fitter.setMaxIterations(1);
+        FittedVertex fitted;
+        EXPECT_FALSE(fitter.fit(statePointers, fitted, vertex + TVector3(1., 1., 1.)));
+        EXPECT_FALSE(fitted.isConverged());
+        EXPECT_EQ(1u, fitted.getNIterations());
+        // result of the last iteration is kept
+        EXPECT_LT((fitted.getPos() - vertex).Mag(), 1.);
+
+        fitter.setMaxIterations(30);
+        EXPECT_TRUE(fitter.fit(statePointers, fitted, vertex + TVector3(1., 1., 1.)));
+        EXPECT_TRUE(fitted.isConverged());
+    }
+
+    // Rep with other than 5 track parameters, which the vertex fit does not support.
+    class SixDimTrackRep : public RKTrackRep {
+    public:
+        explicit SixDimTrackRep(int pdgCode) : RKTrackRep(pdgCode) {;}
+        unsigned int getDim() const override {return 6;}
+    };
+
+    TEST_F(VertexFitterTests, SkipNonFiveDimensionalReps) {
+        const TVector3 vertex(0.1, -0.2, 0.5);
+        std::vector<MeasuredStateOnPlane> states;
+        makeStates(vertex, 10, states);
+        SixDimTrackRep sixDimRep(211);
+        MeasuredStateOnPlane sixDimState(states[0]);
+        sixDimState.setRep(&sixDimRep);
+        states.push_back(sixDimState);
+        std::vector<const MeasuredStateOnPlane*> statePointers;
+        for (const MeasuredStateOnPlane& state : states)
+            statePointers.push_back(&state);
+
+        VertexFitter fitter;
+        FittedVertex fitted;
+        ASSERT_TRUE(fitter.fit(statePointers, fitted, vertex));
+        EXPECT_NEAR(0., (fitted.getPos() - vertex).Mag(), 1.E-4);
+        EXPECT_DOUBLE_EQ(17., fitted.getNdf());
+        ASSERT_EQ(11u, fitted.getNTracks());
+        EXPECT_DOUBLE_EQ(0., fitted.getParameters(10).weight_);
+    }
+
+    TEST_F(VertexFitterTests, FindPrimaryAndSecondaryVertices) {
+        // three primary vertices on the beam line
+        const double z0[3] = {-1., 0., 1.5};
+        std::vector<MeasuredStateOnPlane> states;
+        for (double z : z0)
+            makeStates(TVector3(0., 0., z), 8, states);
+
+        // V0 decaying 10 cm away from the beam line, daughters with large impact parameter.
+        // Single chords from the POCAs to the states would miss each other by 1 mm, more than the default cut.
+        const TVector3 decay(10., 0., 3.);
+        RKTrackRep negativeRep(-211);
+        TMatrixDSym cov(6);
+        for (int i = 0; i < 3; ++i) {
+            cov(i, i) = 1.E-4;
+            cov(i + 3, i + 3) = 1.E-6;
+        }
+        MeasuredStateOnPlane positive(m_rep), negative(&negativeRep);
+        m_rep->setPosMomCov(positive, decay, TVector3(0.3, 0.3, 0.3), cov);
+        m_rep->extrapolateBy(positive, 20.);
+        negativeRep.setPosMomCov(negative, decay, TVector3(0.2, -0.4, 0.1), cov);
+        negativeRep.extrapolateBy(negative, 20.);
+        states.push_back(positive);
+        states.push_back(negative);
+
+        std::vector<const MeasuredStateOnPlane*> statePointers;
+        for (const MeasuredStateOnPlane& state : states)
+            statePointers.push_back(&state);
+
+        VertexFinder finder;
+        finder.setNThreads(2);
+        std::vector<FittedVertex> vertices;
+        finder.findPrimaryVertices(statePointers, vertices);
+        ASSERT_EQ(3u, vertices.size());
+        for (unsigned int i = 0; i < 3; ++i) {
+            EXPECT_NEAR(0., (vertices[i].getPos() - TVector3(0., 0., z0[i])).Mag(), 1.E-3);
+            EXPECT_EQ(8u, vertices[i].getNTracks());
+            for (unsigned int j = 0; j < vertices[i].getNTracks(); ++j)
+                EXPECT_EQ(&states[8 * i + j], vertices[i].getParameters(j).state_);
+        }
+
+        finder.findSecondaryVertices(statePointers, vertices);
+        unsigned int nFound = 0;
+        for (const FittedVertex& vertex : vertices) {
+            EXPECT_GT(vertex.getPos().Perp(), 0.5);
+            if ((vertex.getPos() - decay).Mag() < 1.E-3) {
+                ++nFound;
+                ASSERT_EQ(2u, vertex.getNTracks());
+                EXPECT_EQ(&states[24], vertex.getParameters(0).state_);
+                EXPECT_EQ(&states[25], vertex.getParameters(1).state_);
+            }
+        }
+        EXPECT_EQ(1u, nFound);
+    }
+
+}
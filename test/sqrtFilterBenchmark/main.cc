@@ -0,0 +1,96 @@
+/* Time of the forward filter of KalmanFitterRefTrack, standard vs. square-root formalism.
+ *
+ * Planar tracks in a constant field without material, the forward filter is run
+ * repeatedly on the converged reference track, so only the filter algebra is timed.
+ *
+ * usage: sqrtFilterBenchmark [nRepetitions] [nPlanes]
+ */
+
+#include <ConstField.h>
+#include <DetPlane.h>
+#include <FieldManager.h>
+#include <KalmanFitterRefTrack.h>
+#include <MaterialEffects.h>
+#include <PlanarMeasurement.h>
+#include <RKTrackRep.h>
+#include <SharedPlanePtr.h>
+#include <StateOnPlane.h>
+#include <Track.h>
+#include <TrackPoint.h>
+
+#include <TMatrixDSym.h>
+#include <TVector3.h>
+#include <TVectorD.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+
+namespace {
+
+  // Pion track measured in u and v on nPlanes planes perpendicular to the x axis, 10 cm apart
+  genfit::Track* makePlanarTrack(unsigned int nPlanes, double sigma) {
+    const TVector3 pos(0., 0., 0.);
+    const TVector3 mom(0.6, -0.1, 0.2);
+    genfit::RKTrackRep* rep = new genfit::RKTrackRep(211);
+    genfit::Track* track = new genfit::Track(rep, pos + TVector3(0.05, -0.05, 0.1), 1.05 * mom);
+
+    genfit::StateOnPlane state(rep);
+    rep->setPosMom(state, pos, mom);
+    TMatrixDSym cov(2);
+    cov(0, 0) = cov(1, 1) = sigma * sigma;
+    for (unsigned int i = 0; i < nPlanes; ++i) {
+      const genfit::SharedPlanePtr plane(new genfit::DetPlane(TVector3(10. * (i + 1), 0., 0.), TVector3(0., 1., 0.), TVector3(0., 0., 1.)));
+      rep->extrapolateToPlane(state, plane);
+      TVectorD coords(2);
+      coords(0) = state.getState()(3) + sigma * std::sin(1.7 * i + 0.3);
+      coords(1) = state.getState()(4) + sigma * std::cos(2.3 * i + 0.7);
+      genfit::PlanarMeasurement* measurement = new genfit::PlanarMeasurement(coords, cov, 0, i, nullptr);
+      measurement->setPlane(plane, i);
+      track->insertPoint(new genfit::TrackPoint(measurement, track));
+    }
+    return track;
+  }
+
+}
+
+
+int main(int argc, char** argv) {
+
+  const unsigned int nRepetitions = (argc > 1) ? std::atoi(argv[1]) : 10000;
+  const unsigned int nPlanes = (argc > 2) ? std::atoi(argv[2]) : 8;
+
+  genfit::FieldManager::getInstance()->init(new genfit::ConstField(0., 0., 20.)); // kGauss
+  genfit::MaterialEffects::getInstance()->init(nullptr);
+  genfit::MaterialEffects::getInstance()->setNoEffects();
+
+  double microseconds[2];
+  for (unsigned int squareRoot = 0; squareRoot < 2; ++squareRoot) {
+    genfit::KalmanFitterRefTrack fitter(4, 1e-3, 1e3, squareRoot == 1);
+    genfit::Track* track = makePlanarTrack(nPlanes, 0.01);
+    fitter.processTrackWithRep(track, track->getCardinalRep());
+    if (!track->getFitStatus()->isFitConverged()) {
+      std::cerr << "fit did not converge" << std::endl;
+      return 1;
+    }
+
+    // forward filter only, on the final reference states
+    fitter.setRefitAll();
+    double chi2, ndf;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < nRepetitions; ++i)
+      fitter.fitTrack(track, track->getCardinalRep(), chi2, ndf, +1);
+    microseconds[squareRoot] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / nRepetitions;
+
+    std::cout << (squareRoot ? "square root" : "standard   ") << " filter: " << microseconds[squareRoot]
+              << " us per forward pass over " << nPlanes << " planes (chi2 " << chi2 << ", ndf " << ndf << ")" << std::endl;
+    delete track;
+  }
+  std::cout << "square root / standard: " << microseconds[1] / microseconds[0] << std::endl;
+
+  genfit::MaterialEffects::getInstance()->destruct();
+  genfit::FieldManager::getInstance()->destruct();
+  return 0;
+}
@@ -26,6 +26,7 @@
 
 #include "RKTools.h"
 #include "AbsMaterialInterface.h"
+#include "MaterialTable.h"
 
 #include <iostream>
 #include <vector>
@@ -102,7 +103,7 @@ public:
                const double& mom, // momentum
                double& relMomLoss, // relative momloss for the step will be added
                const int& pdg,
-               Material& currentMaterial,
+               MaterialId& currentMaterial,
                StepLimits& limits,
                bool varField = true);
 
@@ -116,6 +117,9 @@ public:
   //! sets charge_, mass_
   void getParticleParameters();
 
+  //! sets the cached values of the material
+  void setMaterial(MaterialId id);
+
   void getMomGammaBeta(double Energy,
                        double& mom, double& gammaSquare, double& gamma, double& betaSquare) const;
 
@@ -149,7 +153,7 @@ public:
    * With the MSC variance and the current direction of the track a full 7D noise matrix is calculated.
    * This noise matrix is the additional noise at the end of fStep in the 7D globa cooridnate system
    * taking even the (co)variances of the position coordinates into account.
-   * 
+   * Only the position/direction block is touched and added to in place; q/p stays uncorrelated.
     */
   void noiseCoulomb(M7x7& noise,
                     const M1x3& direction, double momSquare, double betaSquare) const;
@@ -188,8 +192,7 @@ public:
   double matDensity_;
   double matZ_;
   double matA_;
-  double radiationLength_;
-  double mEE_; // mean excitation energy
+  const MaterialConstants* matConstants_; // precomputed constants of the current material
 
   int pdg_;
   double charge_;
@@ -80,6 +80,15 @@ namespace RKTools {
 
   void Np_N_NpT(const M7x7& Np, M7x7& N);
 
+  //! out7 += J_MM * noise7 * J_MM^T, with J_MM given transposed like the RK Jacobian.
+  //! Material noise has no correlations between q/p and the 6D position/direction,
+  //! and q/p is not changed by the transport; only these blocks are multiplied.
+  void J_MMxNoise7xJ_MMT(const M7x7& J_MMT, const M7x7& noise7, M7x7& out7);
+
+  //! J_MMT_acc = J_MMT_step * J_MMT_acc, i.e. the (transposed) Jacobian of the step is applied after the accumulated one.
+  //! Both have the last column (0, 0, 0, 0, 0, 0, 1).
+  void J_MMTxJ_MMT(const M7x7& J_MMT_step, M7x7& J_MMT_acc);
+
   void printDim(const double* mat, unsigned int dimX, unsigned int dimY);
 
 }
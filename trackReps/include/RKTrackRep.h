@@ -28,7 +28,7 @@
 #include "StateOnPlane.h"
 #include "RKTools.h"
 #include "StepLimits.h"
-#include "Material.h"
+#include "MaterialTable.h"
 
 #include <algorithm>
 
@@ -38,11 +38,12 @@ namespace genfit {
  * @brief Helper for RKTrackRep
  */
 struct RKStep {
-  MatStep matStep_; // material properties and stepsize
+  MaterialId materialId_; // material (MaterialTable)
+  double stepSize_;
   M1x7 state7_; // 7D state vector
   StepLimits limits_;
 
-  RKStep() {
+  RKStep() : materialId_(MaterialTable::vacuumId), stepSize_(0) {
     std::fill(state7_.begin(), state7_.end(), 0);
   }
 };
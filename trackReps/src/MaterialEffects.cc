@@ -21,6 +21,7 @@
 #include "Exception.h"
 #include "IO.h"
 
+#include <limits>
 #include <stdexcept>
 #include <string>
 #include <stdlib.h>
@@ -53,8 +54,7 @@ MaterialEffects::MaterialEffects():
   matDensity_(0),
   matZ_(0),
   matA_(0),
-  radiationLength_(0),
-  mEE_(0),
+  matConstants_(nullptr),
   pdg_(0),
   charge_(0),
   mag_charge_(0),
@@ -145,10 +145,11 @@ double MaterialEffects::effects(const std::vector<RKStep>& steps,
   getParticleParameters();
 
   double momLoss = 0.;
+  MaterialId loadedId(std::numeric_limits<MaterialId>::max()); // no material loaded yet
 
   for ( std::vector<RKStep>::const_iterator it = steps.begin() + materialsFXStart; it !=  steps.begin() + materialsFXStop; ++it) { // loop over steps
 
-    double realPath = it->matStep_.stepSize_;
+    double realPath = it->stepSize_;
     if (fabs(realPath) < 1.E-8) {
       // do material effects only if distance is not too small
       continue;
@@ -159,8 +160,8 @@ double MaterialEffects::effects(const std::vector<RKStep>& steps,
       if (doNoise) 
         debugOut << "and noise";
       debugOut << " for ";
-      debugOut << "stepSize = " << it->matStep_.stepSize_ << "\t";
-      it->matStep_.material_.Print();
+      debugOut << "stepSize = " << it->stepSize_ << "\t";
+      MaterialTable::getInstance()->getMaterial(it->materialId_).Print();
     }
 
     double stepSign(1.);
@@ -170,15 +171,14 @@ double MaterialEffects::effects(const std::vector<RKStep>& steps,
     stepSize_ = realPath;
 
 
-    const Material& currentMaterial = it->matStep_.material_;
-    matDensity_ = currentMaterial.density;
-    matZ_ = currentMaterial.Z;
-    matA_ = currentMaterial.A;
-    radiationLength_ = currentMaterial.radiationLength;
-    mEE_ = currentMaterial.mEE;
+    // consecutive steps are mostly in the same material
+    if (it->materialId_ != loadedId) {
+      setMaterial(it->materialId_);
+      loadedId = it->materialId_;
+    }
 
 
-    if (matZ_ > 1.E-3) { // don't calculate energy loss for vacuum
+    if (!matConstants_->isVacuum_) { // don't calculate energy loss for vacuum
 
       momLoss += momentumLoss(stepSign, mom - momLoss, false);
 
@@ -221,7 +221,7 @@ void MaterialEffects::stepper(const RKTrackRep* rep,
                               const double& mom, // momentum
                               double& relMomLoss, // relative momloss for the step will be added
                               const int& pdg,
-                              Material& currentMaterial,
+                              MaterialId& currentMaterial,
                               StepLimits& limits,
                               bool varField)
 {
@@ -275,22 +275,19 @@ void MaterialEffects::stepper(const RKTrackRep* rep,
                                 limits.getStepSign() * state7[3], limits.getStepSign() * state7[4], limits.getStepSign() * state7[5]);
 
 
-  currentMaterial = materialInterface_->getMaterialParameters();
-  matDensity_ = currentMaterial.density;
-  matZ_ = currentMaterial.Z;
-  matA_ = currentMaterial.A;
-  radiationLength_ = currentMaterial.radiationLength;
-  mEE_ = currentMaterial.mEE;
+  MaterialTable* table = MaterialTable::getInstance();
+  currentMaterial = table->intern(materialInterface_->getMaterialParameters());
+  setMaterial(currentMaterial);
 
   if (debugLvl_ > 0) {
-    debugOut << "     currentMaterial "; currentMaterial.Print();
+    debugOut << "     currentMaterial "; matConstants_->material_.Print();
   }
 
   // limit due to momloss
   double relMomLossPer_cm(0);
   stepSize_ = 1.; // set stepsize for momLoss calculation
 
-  if (matZ_ > 1.E-3) { // don't calculate energy loss for vacuum
+  if (!matConstants_->isVacuum_) { // don't calculate energy loss for vacuum
     relMomLossPer_cm = this->momentumLoss(limits.getStepSign(), mom, true) / mom;
   }
 
@@ -346,10 +343,10 @@ void MaterialEffects::stepper(const RKTrackRep* rep,
     materialInterface_->initTrack(state7[0], state7[1], state7[2],
                                   limits.getStepSign() * state7[3], limits.getStepSign() * state7[4], limits.getStepSign() * state7[5]);
 
-    Material materialAfter = materialInterface_->getMaterialParameters();
+    const MaterialId materialAfter = table->intern(materialInterface_->getMaterialParameters());
 
     if (debugLvl_ > 0) {
-      debugOut << "     material after step: "; materialAfter.Print();
+      debugOut << "     material after step: "; table->getMaterial(materialAfter).Print();
     }
 
     if (materialAfter != currentMaterial)
@@ -371,6 +368,16 @@ void MaterialEffects::getParticleParameters()
 }
 
 
+void MaterialEffects::setMaterial(MaterialId id)
+{
+  matConstants_ = &(MaterialTable::getInstance()->getConstants(id));
+  const Material& material = matConstants_->material_;
+  matDensity_ = material.density;
+  matZ_ = material.Z;
+  matA_ = material.A;
+}
+
+
 void MaterialEffects::getMomGammaBeta(double Energy,
                      double& mom, double& gammaSquare, double& gamma, double& betaSquare) const {
 
@@ -480,11 +487,11 @@ double MaterialEffects::dEdxBetheBloch(double betaSquare, double gamma, double g
   }
 
   // calc dEdx_, also needed in noiseBetheBloch!
-  double result( 0.307075 * matZ_ / matA_ * matDensity_ / betaSquare * charge_ * charge_ );
+  double result( 0.307075 * matConstants_->zOverADensity_ / betaSquare * charge_ * charge_ );
   double massRatio( me_ / mass_ );
-  double argument( gammaSquare * betaSquare * me_ * 1.E3 * 2. / ((1.E-6 * mEE_) *
-      sqrt(1. + 2. * gamma * massRatio + massRatio * massRatio)) );
-  result *= log(argument) - betaSquare; // Bethe-Bloch [MeV/cm]
+  double argument( gammaSquare * betaSquare * me_ * 1.E3 * 2. /
+      sqrt(1. + 2. * gamma * massRatio + massRatio * massRatio) );
+  result *= log(argument) - matConstants_->logMEE_ - betaSquare; // Bethe-Bloch [MeV/cm]
   result *= 1.E-3;  // in GeV/cm, hence 1.e-3
   if (result < 0.) {
     result = 0;
@@ -500,7 +507,7 @@ void MaterialEffects::noiseBetheBloch(M7x7& noise, double mom, double betaSquare
 
   // ENERGY LOSS FLUCTUATIONS; calculate sigma^2(E);
   double sigma2E ( 0. );
-  double zeta  ( 153.4E3 * charge_ * charge_ / betaSquare * matZ_ / matA_ * matDensity_ * fabs(stepSize_) ); // eV
+  double zeta  ( 153.4E3 * charge_ * charge_ / betaSquare * matConstants_->zOverADensity_ * fabs(stepSize_) ); // eV
   double Emax  ( 2.E9 * me_ * betaSquare * gammaSquare / (1. + 2.*gamma * me_ / mass_ + (me_ / mass_) * (me_ / mass_)) ); // eV
   double kappa ( zeta / Emax );
 
@@ -508,12 +515,11 @@ void MaterialEffects::noiseBetheBloch(M7x7& noise, double mom, double betaSquare
     sigma2E += zeta * Emax * (1. - betaSquare / 2.); // eV^2
   } else { // Urban/Landau approximation
     // calculate number of collisions Nc
-    double I = 16. * pow(matZ_, 0.9); // eV
-    double f2 = 0.;
-    if (matZ_ > 2.) f2 = 2. / matZ_;
-    double f1 = 1. - f2;
-    double e2 = 10.*matZ_ * matZ_; // eV
-    double e1 = pow((I / pow(e2, f2)), 1. / f1); // eV
+    const double I = matConstants_->urbanI_; // eV
+    const double f2 = matConstants_->urbanF2_;
+    const double f1 = matConstants_->urbanF1_;
+    const double e2 = matConstants_->urbanE2_; // eV
+    const double e1 = matConstants_->urbanE1_; // eV
 
     double mbbgg2 = 2.E9 * mass_ * betaSquare * gammaSquare; // eV
     double Sigma1 = dEdx_ * 1.0E9 * f1 / e1 * (log(mbbgg2 / e1) - betaSquare) / (log(mbbgg2 / I) - betaSquare) * 0.6; // 1/cm
@@ -564,10 +570,10 @@ void MaterialEffects::noiseCoulomb(M7x7& noise,
   const double step = fabs(stepSize_);
   const double step2 = step * step;
   if (mscModelCode_ == 0) {// PANDA report PV/01-07 eq(43); linear in step length
-    sigma2 = 225.E-6 * charge_ * charge_ / (betaSquare * momSquare) * step / radiationLength_ * matZ_ / (matZ_ + 1) * log(159.*pow(matZ_, -1. / 3.)) / log(287.*pow(matZ_, -0.5)); // sigma^2 = 225E-6*z^2/mom^2 * XX0/beta_^2 * Z/(Z+1) * ln(159*Z^(-1/3))/ln(287*Z^(-1/2)
+    sigma2 = 225.E-6 * charge_ * charge_ / (betaSquare * momSquare) * step * matConstants_->invRadiationLength_ * matConstants_->coulombFactor_; // sigma^2 = 225E-6*z^2/mom^2 * XX0/beta_^2 * Z/(Z+1) * ln(159*Z^(-1/3))/ln(287*Z^(-1/2)
 
   } else if (mscModelCode_ == 1) { //Highland not linear in step length formula taken from PDG book 2011 edition
-    double stepOverRadLength = step / radiationLength_;
+    double stepOverRadLength = step * matConstants_->invRadiationLength_;
     double logCor = (1 + 0.038 * log(stepOverRadLength));
     sigma2 = 0.0136 * 0.0136 * charge_ * charge_ / (betaSquare * momSquare) * stepOverRadLength * logCor * logCor;
   }
@@ -575,52 +581,29 @@ void MaterialEffects::noiseCoulomb(M7x7& noise,
   sigma2 = (sigma2 > 0.0 ? sigma2 : 0.0);
   //XXX debugOut << "MaterialEffects::noiseCoulomb the MSC variance is " << sigma2 << std::endl;
 
-  M7x7 noiseAfter; // will hold the new MSC noise to cause by the current stepSize_ length
-  std::fill(noiseAfter.begin(), noiseAfter.end(), 0);
-
   const M1x3& a = direction; // as an abbreviation
   // This calculates the MSC angular spread in the 7D global
   // coordinate system.  See PDG 2010, Sec. 27.3 for formulae.
-  noiseAfter[0 * 7 + 0] =  sigma2 * step2 / 3.0 * (1 - a[0]*a[0]);
-  noiseAfter[1 * 7 + 0] = -sigma2 * step2 / 3.0 * a[0]*a[1];
-  noiseAfter[2 * 7 + 0] = -sigma2 * step2 / 3.0 * a[0]*a[2];
-  noiseAfter[3 * 7 + 0] =  sigma2 * step * 0.5 * (1 - a[0]*a[0]);
-  noiseAfter[4 * 7 + 0] = -sigma2 * step * 0.5 * a[0]*a[1];
-  noiseAfter[5 * 7 + 0] = -sigma2 * step * 0.5 * a[0]*a[1];
-  noiseAfter[0 * 7 + 1] = noiseAfter[1 * 7 + 0];
-  noiseAfter[1 * 7 + 1] =  sigma2 * step2 / 3.0 * (1 - a[1]*a[1]);
-  noiseAfter[2 * 7 + 1] = -sigma2 * step2 / 3.0 * a[1]*a[2];
-  noiseAfter[3 * 7 + 1] = noiseAfter[4 * 7 + 0]; // Cov(x,a_y) = Cov(y,a_x)
-  noiseAfter[4 * 7 + 1] =  sigma2 * step * 0.5 * (1 - a[1] * a[1]);
-  noiseAfter[5 * 7 + 1] = -sigma2 * step * 0.5 * a[1]*a[2];
-  noiseAfter[0 * 7 + 2] = noiseAfter[2 * 7 + 0];
-  noiseAfter[1 * 7 + 2] = noiseAfter[2 * 7 + 1];
-  noiseAfter[2 * 7 + 2] =  sigma2 * step2 / 3.0 * (1 - a[2]*a[2]);
-  noiseAfter[3 * 7 + 2] = noiseAfter[5 * 7 + 0]; // Cov(z,a_x) = Cov(x,a_z)
-  noiseAfter[4 * 7 + 2] = noiseAfter[5 * 7 + 1]; // Cov(y,a_z) = Cov(z,a_y)
-  noiseAfter[5 * 7 + 2] =  sigma2 * step * 0.5 * (1 - a[2]*a[2]);
-  noiseAfter[0 * 7 + 3] = noiseAfter[3 * 7 + 0];
-  noiseAfter[1 * 7 + 3] = noiseAfter[3 * 7 + 1];
-  noiseAfter[2 * 7 + 3] = noiseAfter[3 * 7 + 2];
-  noiseAfter[3 * 7 + 3] =  sigma2 * (1 - a[0]*a[0]);
-  noiseAfter[4 * 7 + 3] = -sigma2 * a[0]*a[1];
-  noiseAfter[5 * 7 + 3] = -sigma2 * a[0]*a[2];
-  noiseAfter[0 * 7 + 4] = noiseAfter[4 * 7 + 0];
-  noiseAfter[1 * 7 + 4] = noiseAfter[4 * 7 + 1];
-  noiseAfter[2 * 7 + 4] = noiseAfter[4 * 7 + 2];
-  noiseAfter[3 * 7 + 4] = noiseAfter[4 * 7 + 3];
-  noiseAfter[4 * 7 + 4] =  sigma2 * (1 - a[1]*a[1]);
-  noiseAfter[5 * 7 + 4] = -sigma2 * a[1]*a[2];
-  noiseAfter[0 * 7 + 5] = noiseAfter[5 * 7 + 0];
-  noiseAfter[1 * 7 + 5] = noiseAfter[5 * 7 + 1];
-  noiseAfter[2 * 7 + 5] = noiseAfter[5 * 7 + 2];
-  noiseAfter[3 * 7 + 5] = noiseAfter[5 * 7 + 3];
-  noiseAfter[4 * 7 + 5] = noiseAfter[5 * 7 + 4];
-  noiseAfter[5 * 7 + 5] = sigma2 * (1 - a[2]*a[2]);
-//    debugOut << "new noise\n";
-//    RKTools::printDim(noiseAfter, 7,7);
-  for (unsigned int i = 0; i < 7 * 7; ++i) {
-    noise[i] += noiseAfter[i];
+  // All blocks of the position/direction noise are sigma2 * (1 - a a^T), scaled with
+  // step^2/3 (position), step/2 (position-direction) and 1 (direction);
+  // q/p is not affected, so only the upper left 6x6 block of the noise is updated.
+  const double posFactor = step2 / 3.0;
+  const double posDirFactor = step * 0.5;
+  for (unsigned int i = 0; i < 3; ++i) {
+    for (unsigned int j = 0; j <= i; ++j) {
+      const double angular = sigma2 * ((i == j ? 1. : 0.) - a[i]*a[j]);
+      const double posDir = posDirFactor * angular;
+      noise[i * 7 + j] += posFactor * angular;
+      noise[(i + 3) * 7 + (j + 3)] += angular;
+      noise[(i + 3) * 7 + j] += posDir; // Cov(x_j, a_i) = Cov(x_i, a_j)
+      noise[j * 7 + (i + 3)] += posDir;
+      if (j != i) {
+        noise[j * 7 + i] += posFactor * angular;
+        noise[(j + 3) * 7 + (i + 3)] += angular;
+        noise[(j + 3) * 7 + i] += posDir;
+        noise[i * 7 + (j + 3)] += posDir;
+      }
+    }
   }
 }
 
@@ -811,7 +794,7 @@ void MaterialEffects::noiseBrems(M7x7& noise, double momSquare, double betaSquar
 
   if (abs(pdg_) != 11) return; // only for electrons and positrons
 
-  double minusXOverLn2  = -1.442695 * fabs(stepSize_) / radiationLength_;
+  double minusXOverLn2  = -1.442695 * fabs(stepSize_) * matConstants_->invRadiationLength_;
   double sigma2E = 1.44*(pow(3., minusXOverLn2) - pow(4., minusXOverLn2)) * momSquare;
   sigma2E = std::max(sigma2E, 0.0); // must be positive
   
@@ -834,12 +817,7 @@ void MaterialEffects::drawdEdx(int pdg) {
   stepSize_ = 1;
 
   materialInterface_->initTrack(0, 0, 0, 1, 1, 1);
-  auto currentMaterial = materialInterface_->getMaterialParameters();
-  matDensity_ = currentMaterial.density;
-  matZ_ = currentMaterial.Z;
-  matA_ = currentMaterial.A;
-  radiationLength_ = currentMaterial.radiationLength;
-  mEE_ = currentMaterial.mEE;
+  setMaterial(MaterialTable::getInstance()->intern(materialInterface_->getMaterialParameters()));
 
   double minMom = 0.00001;
   double maxMom = 10000;
@@ -494,6 +494,87 @@ void RKTools::Np_N_NpT(const M7x7& Np, M7x7& N) {
 }
 
 
+void RKTools::J_MMxNoise7xJ_MMT(const M7x7& J_MMT, const M7x7& noise7, M7x7& out7) {
+
+  // J_MMT            noise7
+  // x x x x x x 0    x x x x x x 0
+  // x x x x x x 0    x x x x x x 0
+  // x x x x x x 0    x x x x x x 0
+  // x x x x x x 0    x x x x x x 0
+  // x x x x x x 0    x x x x x x 0
+  // x x x x x x 0    x x x x x x 0
+  // x x x x x x 1    0 0 0 0 0 0 x
+
+  // J_MM = J_MMT^T = (B c; 0 1), noise7 = (A 0; 0 d)
+  // J_MM * noise7 * J_MM^T = (B A B^T + d c c^T, d c; d c^T, d)
+
+  // BA[i][l] = sum_k B[i][k] A[k][l]
+  double BA[6*6];
+  for (unsigned int i = 0; i < 6; ++i) {
+    for (unsigned int l = 0; l < 6; ++l) {
+      double sum = 0;
+      for (unsigned int k = 0; k < 6; ++k)
+        sum += J_MMT[k*7+i] * noise7[k*7+l];
+      BA[i*6+l] = sum;
+    }
+  }
+
+  const double d = noise7[6*7+6];
+  for (unsigned int i = 0; i < 6; ++i) {
+    const double dc_i = d * J_MMT[6*7+i];
+    for (unsigned int j = 0; j <= i; ++j) {
+      double sum = dc_i * J_MMT[6*7+j];
+      for (unsigned int l = 0; l < 6; ++l)
+        sum += BA[i*6+l] * J_MMT[l*7+j];
+      out7[i*7+j] += sum;
+      if (j != i)
+        out7[j*7+i] += sum;
+    }
+    out7[i*7+6] += dc_i;
+    out7[6*7+i] += dc_i;
+  }
+  out7[6*7+6] += d;
+}
+
+
+void RKTools::J_MMTxJ_MMT(const M7x7& J_MMT_step, M7x7& J_MMT_acc) {
+
+  // both
+  // x x x x x x 0
+  // x x x x x x 0
+  // x x x x x x 0
+  // x x x x x x 0
+  // x x x x x x 0
+  // x x x x x x 0
+  // x x x x x x 1
+
+  // the last row of the product needs the old rows of J_MMT_acc, compute it first
+  double lastRow[6];
+  for (unsigned int j = 0; j < 6; ++j) {
+    double sum = J_MMT_acc[6*7+j];
+    for (unsigned int k = 0; k < 6; ++k)
+      sum += J_MMT_step[6*7+k] * J_MMT_acc[k*7+j];
+    lastRow[j] = sum;
+  }
+
+  double upper[6*6];
+  for (unsigned int i = 0; i < 6; ++i) {
+    for (unsigned int j = 0; j < 6; ++j) {
+      double sum = 0;
+      for (unsigned int k = 0; k < 6; ++k)
+        sum += J_MMT_step[i*7+k] * J_MMT_acc[k*7+j];
+      upper[i*6+j] = sum;
+    }
+  }
+
+  for (unsigned int i = 0; i < 6; ++i)
+    for (unsigned int j = 0; j < 6; ++j)
+      J_MMT_acc[i*7+j] = upper[i*6+j];
+  for (unsigned int j = 0; j < 6; ++j)
+    J_MMT_acc[6*7+j] = lastRow[j];
+}
+
+
 void RKTools::printDim(const double* mat, unsigned int dimX, unsigned int dimY){
 
   printOut << dimX << " x " << dimY << " matrix as follows: \n";
@@ -941,11 +941,12 @@ void RKTrackRep::calcForwardJacobianAndNoise(const M1x7& startState7, const DetP
   }
 
   // The Jacobians returned from RKutta are transposed.
-  TMatrixD jac(TMatrixD::kTransposed, TMatrixD(7, 7, ExtrapSteps_.back().jac7_.begin()));
-  TMatrixDSym noise(7, ExtrapSteps_.back().noise7_.begin());
+  // Noise and Jacobians keep q/p apart from the 6D position/direction, only the nonzero blocks are multiplied.
+  M7x7 jacT = ExtrapSteps_.back().jac7_;
+  M7x7 noise = ExtrapSteps_.back().noise7_;
   for (int i = ExtrapSteps_.size() - 2; i >= 0; --i) {
-    noise += TMatrixDSym(7, ExtrapSteps_[i].noise7_.begin()).Similarity(jac);
-    jac *= TMatrixD(TMatrixD::kTransposed, TMatrixD(7, 7, ExtrapSteps_[i].jac7_.begin()));
+    RKTools::J_MMxNoise7xJ_MMT(jacT, ExtrapSteps_[i].noise7_, noise);
+    RKTools::J_MMTxJ_MMT(ExtrapSteps_[i].jac7_, jacT);
   }
 
   // Project into 5x5 space.
@@ -960,10 +961,9 @@ void RKTrackRep::calcForwardJacobianAndNoise(const M1x7& startState7, const DetP
   calcJ_pM_5x7(J_pM, startPlane.getU(), startPlane.getV(), pTilde, spu);
   M7x5 J_Mp;
   calcJ_Mp_7x5(J_Mp, destPlane.getU(), destPlane.getV(), destPlane.getNormal(), *((M1x3*) &destState7[3]));
-  jac.Transpose(jac); // Because the helper function wants transposed input.
-  RKTools::J_pMTTxJ_MMTTxJ_MpTT(J_Mp, *(M7x7 *)jac.GetMatrixArray(),
+  RKTools::J_pMTTxJ_MMTTxJ_MpTT(J_Mp, jacT,
 				J_pM, *(M5x5 *)fJacobian_.GetMatrixArray());
-  RKTools::J_MpTxcov7xJ_Mp(J_Mp, *(M7x7 *)noise.GetMatrixArray(),
+  RKTools::J_MpTxcov7xJ_Mp(J_Mp, noise,
 			   *(M5x5 *)fNoise_.GetMatrixArray());
 
   if (debugLvl_ > 0) {
@@ -1050,8 +1050,11 @@ std::vector<genfit::MatStep> RKTrackRep::getSteps() const {
   std::vector<MatStep> retVal;
   retVal.reserve(RKSteps_.size());
 
+  const MaterialTable* table = MaterialTable::getInstance();
   for (unsigned int i = 0; i<RKSteps_.size(); ++i) {
-    retVal.push_back(RKSteps_[i].matStep_);
+    retVal.push_back(MatStep());
+    retVal.back().material_ = table->getMaterial(RKSteps_[i].materialId_);
+    retVal.back().stepSize_ = RKSteps_[i].stepSize_;
   }
 
   return retVal;
@@ -1070,7 +1073,7 @@ double RKTrackRep::getRadiationLenght() const {
   double radLen(0);
 
   for (unsigned int i = 0; i<RKSteps_.size(); ++i) {
-    radLen += RKSteps_.at(i).matStep_.stepSize_ / RKSteps_.at(i).matStep_.material_.radiationLength;
+    radLen += RKSteps_.at(i).stepSize_ * MaterialTable::getInstance()->getConstants(RKSteps_.at(i).materialId_).invRadiationLength_;
   }
 
   return radLen;
@@ -1944,9 +1947,9 @@ bool RKTrackRep::RKutta(const M1x4& SU,
 
     // check if we went back and forth multiple times -> we don't come closer to the plane!
     if (counter > 3){
-      if (S                            *RKSteps_.at(counter-1).matStep_.stepSize_ < 0 &&
-          RKSteps_.at(counter-1).matStep_.stepSize_*RKSteps_.at(counter-2).matStep_.stepSize_ < 0 &&
-          RKSteps_.at(counter-2).matStep_.stepSize_*RKSteps_.at(counter-3).matStep_.stepSize_ < 0){
+      if (S                            *RKSteps_.at(counter-1).stepSize_ < 0 &&
+          RKSteps_.at(counter-1).stepSize_*RKSteps_.at(counter-2).stepSize_ < 0 &&
+          RKSteps_.at(counter-2).stepSize_*RKSteps_.at(counter-3).stepSize_ < 0){
         Exception exc("RKTrackRep::RKutta ==> Do not get closer to plane!",__LINE__,__FILE__);
         exc.setFatal();
         throw exc;
@@ -2089,12 +2092,12 @@ double RKTrackRep::estimateStep(const M1x7& state7,
       }
       else {
         if (debugLvl_ > 0) {
-          debugOut << " RKTrackRep::estimateStep: use stepSize " << cachePos_ << " from cache: " << RKSteps_.at(cachePos_).matStep_.stepSize_ << "\n";
+          debugOut << " RKTrackRep::estimateStep: use stepSize " << cachePos_ << " from cache: " << RKSteps_.at(cachePos_).stepSize_ << "\n";
         }
         //for(int n = 0; n < 1*7; ++n) RKSteps_[cachePos_].state7_[n] = state7[n];
         ++RKStepsFXStop_;
         limits = RKSteps_.at(cachePos_).limits_;
-        return RKSteps_.at(cachePos_++).matStep_.stepSize_;
+        return RKSteps_.at(cachePos_++).stepSize_;
       }
     }
   }
@@ -2264,12 +2267,12 @@ double RKTrackRep::estimateStep(const M1x7& state7,
                                             charge/state7[6], // |p|
                                             relMomLoss,
                                             pdgCode_,
-                                            lastStep->matStep_.material_,
+                                            lastStep->materialId_,
                                             limits,
                                             true);
   } else { //assume material has not changed
     if  (RKSteps_.size()>1) {
-      lastStep->matStep_.material_ = (lastStep - 1)->matStep_.material_;
+      lastStep->materialId_ = (lastStep - 1)->materialId_;
     }
   }
 
@@ -2280,7 +2283,7 @@ double RKTrackRep::estimateStep(const M1x7& state7,
 
   double finalStep = limits.getLowestLimitSignedVal();
 
-  lastStep->matStep_.stepSize_ = finalStep;
+  lastStep->stepSize_ = finalStep;
   lastStep->limits_ = limits;
 
   if (debugLvl_ > 0) {
@@ -2381,8 +2384,8 @@ double RKTrackRep::Extrap(const DetPlane& startPlane,
     if (debugLvl_ > 0) {
       debugOut<<"RKSteps \n";
       for (std::vector<RKStep>::iterator it = RKSteps_.begin(); it != RKSteps_.end(); ++it){
-        debugOut << "stepSize = " << it->matStep_.stepSize_ << "\t";
-        it->matStep_.material_.Print();
+        debugOut << "stepSize = " << it->stepSize_ << "\t";
+        MaterialTable::getInstance()->getMaterial(it->materialId_).Print();
       }
       debugOut<<"\n";
     }
@@ -2607,12 +2610,12 @@ void RKTrackRep::checkCache(const StateOnPlane& state, const SharedPlanePtr* pla
     double firstStep(0);
     for (unsigned int i=0; i<RKSteps_.size(); ++i) {
       if (i == 0) {
-        firstStep = RKSteps_.at(0).matStep_.stepSize_;
+        firstStep = RKSteps_.at(0).stepSize_;
         continue;
       }
-      if (RKSteps_.at(i).matStep_.stepSize_ * firstStep < 0) {
-        if (RKSteps_.at(i-1).matStep_.material_ == RKSteps_.at(i).matStep_.material_) {
-          RKSteps_.at(i-1).matStep_.stepSize_ += RKSteps_.at(i).matStep_.stepSize_;
+      if (RKSteps_.at(i).stepSize_ * firstStep < 0) {
+        if (RKSteps_.at(i-1).materialId_ == RKSteps_.at(i).materialId_) {
+          RKSteps_.at(i-1).stepSize_ += RKSteps_.at(i).stepSize_;
         }
         RKSteps_.erase(RKSteps_.begin()+i, RKSteps_.end());
       }
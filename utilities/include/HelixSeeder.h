@@ -0,0 +1,127 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @addtogroup utilities
+ * @{
+ */
+
+#ifndef genfit_HelixSeeder_h
+#define genfit_HelixSeeder_h
+
+#include <TMatrixDSym.h>
+#include <TVector3.h>
+#include <TVectorD.h>
+
+#include <vector>
+
+
+namespace genfit {
+
+class AbsMeasurement;
+class Track;
+
+/**
+ * @brief Non-iterative helix fit of space points, to get stateSeed and covSeed of a Track.
+ *
+ * The circle in the bending (xy) plane is determined with the weighted Riemann fit:
+ * the points are mapped onto the paraboloid z = x^2 + y^2, and the circle is the
+ * intersection with the plane through the mapped points, which is found with one
+ * eigenvalue decomposition of a 3x3 matrix.
+ * Then a straight line z = z0 + tanLambda * s is fitted in the sz plane, with s the arc length
+ * on the circle. The field is assumed to be parallel to z near the points.
+ *
+ * The seed is the helix position and momentum at the first point, and the covariance of the
+ * 6D seed is propagated from the covariances of the circle and line parameters.
+ * Multiple scattering is not taken into account.
+ *
+ * The points must be ordered along the track, and consecutive points must not be more than half a turn apart.
+ * Measurements are converted to space points by addMeasurement():
+ * SpacepointMeasurements directly, 2D PlanarMeasurements via their plane,
+ * WirePointMeasurements at the reconstructed point on the wire, and WireMeasurements (and WireMeasurementNew)
+ * at the wire center, with the drift radius and the wire length as uncertainties.
+ * 1D strip measurements cannot be converted and are ignored.
+ */
+class HelixSeeder {
+
+ public:
+
+  HelixSeeder();
+
+  void clear();
+
+  //! add a space point with its 3x3 covariance
+  void addPoint(const TVector3& pos, const TMatrixDSym& cov);
+  //! add the space point of a measurement; returns false if the measurement type cannot be used
+  bool addMeasurement(const AbsMeasurement* measurement);
+
+  unsigned int getNPoints() const {return points_.size();}
+
+  /**
+   * @brief Fit the points, with the z component of the field in kGauss.
+   *
+   * Returns false if there are less than 3 points, the field is 0, or the points lie on a straight line.
+   */
+  bool fit(double Bz);
+  //! Fit the points, with the field from the FieldManager at the center of the points.
+  bool fit();
+
+  /**
+   * @brief Clear, add the first raw measurements of all points of the track, fit,
+   * and set stateSeed and covSeed of the track if the fit succeeded.
+   *
+   * Returns false, and leaves the seed of the track unchanged, if the fitted charge (getCharge())
+   * does not have the sign of the charge of the cardinal representation of the track.
+   * The fit results are kept, so the caller can choose a representation with the right charge and seed again.
+   */
+  bool seedTrack(Track& track);
+
+  //! position and momentum at the first point
+  const TVectorD& getStateSeed() const {return stateSeed_;}
+  //! 6x6 covariance of the seed
+  const TMatrixDSym& getCovSeed() const {return covSeed_;}
+  //! charge sign derived from the rotation sense and the field
+  double getCharge() const {return charge_;}
+
+  double getRadius() const {return R_;}
+  double getTanLambda() const {return tanLambda_;}
+  //! chi2 of the circle fit, with the radial distances of the points
+  double getCircleChi2() const {return circleChi2_;}
+
+
+ private:
+
+  std::vector<TVector3> points_;
+  std::vector<TMatrixDSym> covs_;
+
+  double xc_;
+  double yc_;
+  double R_;
+  double z0_;
+  double tanLambda_;
+  double charge_;
+  double circleChi2_;
+
+  TVectorD stateSeed_;
+  TMatrixDSym covSeed_;
+
+};
+
+} /* End of namespace genfit */
+/** @} */
+
+#endif // genfit_HelixSeeder_h
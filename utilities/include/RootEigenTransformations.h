@@ -91,4 +91,17 @@ namespace genfit {
         return rootMatrix;
     }
 
+    /** @brief Read-only view on the (row-major) storage of a ROOT matrix (TMatrixD or TMatrixDSym), no copy. */
+    inline Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+    rootMatrixView(const TMatrixDBase& rootMatrix) {
+        return Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>(
+                   rootMatrix.GetMatrixArray(), rootMatrix.GetNrows(), rootMatrix.GetNcols());
+    }
+
+    /** @brief Read-only view on the storage of a ROOT vector, no copy. */
+    inline Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, 1>> rootVectorView(const TVectorD& rootVector) {
+        return Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, 1>>(rootVector.GetMatrixArray(),
+                                                                          rootVector.GetNrows());
+    }
+
 }
@@ -0,0 +1,335 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "HelixSeeder.h"
+
+#include <Exception.h>
+#include <FieldManager.h>
+#include <Track.h>
+#include <TrackPoint.h>
+#include <PlanarMeasurement.h>
+#include <SpacepointMeasurement.h>
+#include <WireMeasurement.h>
+#include <WireMeasurementNew.h>
+#include <WirePointMeasurement.h>
+
+#include <TVector2.h>
+
+#include <Eigen/Dense>
+#include <Eigen/Eigenvalues>
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace {
+
+  // covariance of a point on a wire with direction dir (unit vector)
+  TMatrixDSym wireCov(const TVector3& dir, double perpendicularVariance, double alongVariance) {
+    TMatrixDSym cov(3);
+    for (int i = 0; i < 3; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        cov(i, j) = (alongVariance - perpendicularVariance) * dir[i] * dir[j];
+      }
+      cov(i, i) += perpendicularVariance;
+    }
+    return cov;
+  }
+
+}
+
+
+namespace genfit {
+
+HelixSeeder::HelixSeeder() :
+  xc_(0), yc_(0), R_(0), z0_(0), tanLambda_(0), charge_(0), circleChi2_(0),
+  stateSeed_(6), covSeed_(6)
+{
+  ;
+}
+
+
+void HelixSeeder::clear() {
+  points_.clear();
+  covs_.clear();
+
+  xc_ = yc_ = R_ = z0_ = tanLambda_ = charge_ = circleChi2_ = 0;
+  stateSeed_.Zero();
+  covSeed_.Zero();
+}
+
+
+void HelixSeeder::addPoint(const TVector3& pos, const TMatrixDSym& cov) {
+  if (cov.GetNrows() != 3) {
+    Exception exc("HelixSeeder::addPoint ==> covariance must be 3x3",__LINE__,__FILE__);
+    throw exc;
+  }
+  points_.push_back(pos);
+  covs_.push_back(cov);
+}
+
+
+bool HelixSeeder::addMeasurement(const AbsMeasurement* measurement) {
+  const TVectorD& coords = measurement->getRawHitCoords();
+  const TMatrixDSym& rawCov = measurement->getRawHitCov();
+
+  if (dynamic_cast<const SpacepointMeasurement*>(measurement) != nullptr) {
+    addPoint(TVector3(coords(0), coords(1), coords(2)), rawCov.GetSub(0, 2, 0, 2));
+    return true;
+  }
+
+  if (dynamic_cast<const WirePointMeasurement*>(measurement) != nullptr) {
+    // coords: wire end 1, wire end 2, drift radius, distance of the point from wire end 1
+    const TVector3 wire1(coords(0), coords(1), coords(2));
+    const TVector3 wireDir = (TVector3(coords(3), coords(4), coords(5)) - wire1).Unit();
+    addPoint(wire1 + coords(7) * wireDir,
+             wireCov(wireDir, coords(6) * coords(6) + rawCov(6, 6), rawCov(7, 7)));
+    return true;
+  }
+
+  if (dynamic_cast<const WireMeasurement*>(measurement) != nullptr ||
+      dynamic_cast<const WireMeasurementNew*>(measurement) != nullptr) {
+    // the track passes somewhere on a circle with the drift radius around the wire, and somewhere along the wire
+    const TVector3 wire1(coords(0), coords(1), coords(2));
+    const TVector3 wire2(coords(3), coords(4), coords(5));
+    const double length = (wire2 - wire1).Mag();
+    const double driftVariance = rawCov.GetNrows() == 1 ? rawCov(0, 0) : rawCov(6, 6);
+    addPoint(0.5 * (wire1 + wire2),
+             wireCov((wire2 - wire1).Unit(), coords(6) * coords(6) + driftVariance, length * length / 12.));
+    return true;
+  }
+
+  if (dynamic_cast<const PlanarMeasurement*>(measurement) != nullptr) {
+    if (coords.GetNrows() != 2)
+      return false;
+
+    const SharedPlanePtr plane = measurement->constructPlane(StateOnPlane());
+    const TVector3& U = plane->getU();
+    const TVector3& V = plane->getV();
+    TMatrixDSym cov(3);
+    for (int i = 0; i < 3; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        cov(i, j) = U[i] * U[j] * rawCov(0, 0) + V[i] * V[j] * rawCov(1, 1)
+                  + (U[i] * V[j] + V[i] * U[j]) * rawCov(0, 1);
+      }
+    }
+    addPoint(plane->toLab(TVector2(coords(0), coords(1))), cov);
+    return true;
+  }
+
+  return false;
+}
+
+
+bool HelixSeeder::fit(double Bz) {
+  stateSeed_.Zero();
+  covSeed_.Zero();
+
+  const unsigned int nPoints = points_.size();
+  if (nPoints < 3 || Bz == 0.)
+    return false;
+
+  // weights for the Riemann fit: largest variance in the xy plane, as the radial direction is not known yet
+  std::vector<double> weights(nPoints);
+  double sumWeights(0);
+  Eigen::Vector2d center(Eigen::Vector2d::Zero());
+  for (unsigned int i = 0; i < nPoints; ++i) {
+    const TMatrixDSym& cov = covs_[i];
+    const double halfDiff = 0.5 * (cov(0, 0) - cov(1, 1));
+    const double maxVariance = 0.5 * (cov(0, 0) + cov(1, 1)) + sqrt(halfDiff * halfDiff + cov(0, 1) * cov(0, 1));
+    if (!(maxVariance > 0.) || !(cov(2, 2) > 0.)) {
+      Exception exc("HelixSeeder::fit ==> covariance of point is not positive definite",__LINE__,__FILE__);
+      throw exc;
+    }
+    weights[i] = 1. / maxVariance;
+    sumWeights += weights[i];
+    center += weights[i] * Eigen::Vector2d(points_[i].X(), points_[i].Y());
+  }
+  center /= sumWeights;
+
+  // map onto the paraboloid, relative to the center of the points for numerical stability
+  std::vector<Eigen::Vector3d> mapped(nPoints);
+  Eigen::Vector3d mean(Eigen::Vector3d::Zero());
+  double maxDist2(0);
+  for (unsigned int i = 0; i < nPoints; ++i) {
+    const double u = points_[i].X() - center(0);
+    const double v = points_[i].Y() - center(1);
+    mapped[i] = Eigen::Vector3d(u, v, u*u + v*v);
+    mean += weights[i] * mapped[i];
+    maxDist2 = std::max(maxDist2, mapped[i](2));
+  }
+  mean /= sumWeights;
+
+  Eigen::Matrix3d scatter(Eigen::Matrix3d::Zero());
+  for (unsigned int i = 0; i < nPoints; ++i) {
+    const Eigen::Vector3d d = mapped[i] - mean;
+    scatter += weights[i] * d * d.transpose();
+  }
+
+  // normal of the plane n.q + c = 0: eigenvector of the smallest eigenvalue
+  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigenSolver(scatter);
+  if (eigenSolver.info() != Eigen::Success)
+    return false;
+  const Eigen::Vector3d n = eigenSolver.eigenvectors().col(0);
+  const double c = -n.dot(mean);
+  if (n(2) == 0.)
+    return false; // straight line
+
+  xc_ = center(0) - 0.5 * n(0) / n(2);
+  yc_ = center(1) - 0.5 * n(1) / n(2);
+  R_ = sqrt(n(0)*n(0) + n(1)*n(1) - 4. * c * n(2)) / (2. * fabs(n(2)));
+  // no measurable sagitta: straight line
+  if (!std::isfinite(R_) || R_ > 1E9 * sqrt(maxDist2))
+    return false;
+
+  // circle covariance from the radial residuals, and unwrapped azimuths on the circle
+  Eigen::Matrix3d circleWeight(Eigen::Matrix3d::Zero());
+  std::vector<double> phi(nPoints);
+  circleChi2_ = 0;
+  for (unsigned int i = 0; i < nPoints; ++i) {
+    const double dx = points_[i].X() - xc_;
+    const double dy = points_[i].Y() - yc_;
+    const double r = sqrt(dx*dx + dy*dy);
+    const Eigen::Vector2d radial(dx / r, dy / r);
+    const TMatrixDSym& cov = covs_[i];
+    const double variance = radial(0) * radial(0) * cov(0, 0) + 2. * radial(0) * radial(1) * cov(0, 1)
+                          + radial(1) * radial(1) * cov(1, 1);
+    const Eigen::Vector3d J(-radial(0), -radial(1), -1.);
+    circleWeight += J * J.transpose() / variance;
+    circleChi2_ += (r - R_) * (r - R_) / variance;
+
+    phi[i] = atan2(dy, dx);
+    if (i > 0) {
+      double dPhi = phi[i] - phi[i-1];
+      dPhi -= 2. * M_PI * floor((dPhi + M_PI) / (2. * M_PI));
+      phi[i] = phi[i-1] + dPhi;
+    }
+  }
+
+  Eigen::FullPivLU<Eigen::Matrix3d> circleLU(circleWeight);
+  if (!circleLU.isInvertible())
+    return false;
+  const Eigen::Matrix3d circleCov = circleLU.inverse();
+
+  // rotation sense: +1 counterclockwise
+  const double h = (phi[nPoints-1] > phi[0]) ? 1. : -1.;
+
+  // straight line z = z0 + tanLambda * s
+  double S(0), Ss(0), Sss(0), Sz(0), Ssz(0);
+  for (unsigned int i = 0; i < nPoints; ++i) {
+    const double s = h * R_ * (phi[i] - phi[0]);
+    const double w = 1. / covs_[i](2, 2);
+    S += w;
+    Ss += w * s;
+    Sss += w * s * s;
+    Sz += w * points_[i].Z();
+    Ssz += w * s * points_[i].Z();
+  }
+  const double det = S * Sss - Ss * Ss;
+  if (!(det > 0.))
+    return false;
+  z0_ = (Sss * Sz - Ss * Ssz) / det;
+  tanLambda_ = (S * Ssz - Ss * Sz) / det;
+
+  Eigen::Matrix<double, 5, 5> paramCov(Eigen::Matrix<double, 5, 5>::Zero());
+  paramCov.block<3, 3>(0, 0) = circleCov;
+  paramCov(3, 3) = Sss / det;
+  paramCov(3, 4) = paramCov(4, 3) = -Ss / det;
+  paramCov(4, 4) = S / det;
+
+  // state at the first point, projected onto the helix
+  const double dx = points_[0].X() - xc_;
+  const double dy = points_[0].Y() - yc_;
+  const double d2 = dx*dx + dy*dy;
+  const double cosPhi = dx / sqrt(d2);
+  const double sinPhi = dy / sqrt(d2);
+  const double k = 0.0299792458E-2 * fabs(Bz); // pT = k * R, with Bz in kGauss, R in cm, pT in GeV
+  const double pT = k * R_;
+
+  charge_ = (Bz > 0.) ? -h : h;
+
+  stateSeed_(0) = xc_ + R_ * cosPhi;
+  stateSeed_(1) = yc_ + R_ * sinPhi;
+  stateSeed_(2) = z0_;
+  stateSeed_(3) = -h * pT * sinPhi;
+  stateSeed_(4) = h * pT * cosPhi;
+  stateSeed_(5) = pT * tanLambda_;
+
+  // jacobian of the seed w.r.t. (xc, yc, R, z0, tanLambda); the azimuth phi of the first point depends on xc, yc
+  const double dPhi_dxc = dy / d2;
+  const double dPhi_dyc = -dx / d2;
+  Eigen::Matrix<double, 6, 5> J(Eigen::Matrix<double, 6, 5>::Zero());
+  J(0, 0) = 1. - R_ * sinPhi * dPhi_dxc;
+  J(0, 1) = -R_ * sinPhi * dPhi_dyc;
+  J(0, 2) = cosPhi;
+  J(1, 0) = R_ * cosPhi * dPhi_dxc;
+  J(1, 1) = 1. + R_ * cosPhi * dPhi_dyc;
+  J(1, 2) = sinPhi;
+  J(2, 3) = 1.;
+  J(3, 0) = -h * pT * cosPhi * dPhi_dxc;
+  J(3, 1) = -h * pT * cosPhi * dPhi_dyc;
+  J(3, 2) = -h * k * sinPhi;
+  J(4, 0) = -h * pT * sinPhi * dPhi_dxc;
+  J(4, 1) = -h * pT * sinPhi * dPhi_dyc;
+  J(4, 2) = h * k * cosPhi;
+  J(5, 2) = k * tanLambda_;
+  J(5, 4) = pT;
+
+  const Eigen::Matrix<double, 6, 6> cov6 = J * paramCov * J.transpose();
+  for (int i = 0; i < 6; ++i)
+    for (int j = 0; j < 6; ++j)
+      covSeed_(i, j) = 0.5 * (cov6(i, j) + cov6(j, i));
+
+  return true;
+}
+
+
+bool HelixSeeder::fit() {
+  if (points_.empty())
+    return false;
+
+  TVector3 center(0, 0, 0);
+  for (unsigned int i = 0; i < points_.size(); ++i)
+    center += points_[i];
+  center *= 1. / points_.size();
+
+  return fit(FieldManager::getInstance()->getFieldVal(center).Z());
+}
+
+
+bool HelixSeeder::seedTrack(Track& track) {
+  clear();
+  for (unsigned int i = 0; i < track.getNumPointsWithMeasurement(); ++i) {
+    const TrackPoint* point = track.getPointWithMeasurement(i);
+    addMeasurement(point->getRawMeasurement(0));
+  }
+
+  if (!fit())
+    return false;
+
+  // the rotation sense fixes the charge, the cardinal representation has to agree
+  if (track.getNumReps() == 0 || !(track.getCardinalRep()->getPDGCharge() * charge_ > 0.))
+    return false;
+
+  track.setStateSeed(stateSeed_);
+  track.setCovSeed(covSeed_);
+  return true;
+}
+
+} /* End of namespace genfit */
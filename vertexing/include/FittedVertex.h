@@ -0,0 +1,101 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @addtogroup vertexing
+ * @{
+ */
+
+#ifndef genfit_FittedVertex_h
+#define genfit_FittedVertex_h
+
+#include "EigenMatrixTypedefs.h"
+
+#include <TVector3.h>
+
+#include <vector>
+
+
+namespace genfit {
+
+class MeasuredStateOnPlane;
+
+/**
+ * @brief Track in a FittedVertex: weight, chi2 and momentum at the vertex.
+ */
+struct VertexTrackParameters {
+
+  VertexTrackParameters() :
+    state_(nullptr), weight_(0), chi2_(0), mom_(Vector3::Zero()),
+    momCov_(Matrix3x3Sym::Zero()), posMomCov_(Matrix3x3::Zero()) {;}
+
+  const MeasuredStateOnPlane* state_; // original state of the track, no ownership
+  double weight_; // weight of the track in the vertex (0 if it could not be used)
+  double chi2_; // chi2 of the track for the vertex position
+  Vector3 mom_; // momentum at the vertex
+  Matrix3x3Sym momCov_; // covariance of mom_
+  Matrix3x3 posMomCov_; // covariance (vertex position, mom_)
+
+};
+
+
+/**
+ * @brief Result of the VertexFitter: position, covariance and the tracks of the vertex.
+ *
+ * Tracks are stored in the order of the input states.
+ */
+class FittedVertex {
+
+ public:
+
+  FittedVertex();
+
+  const Vector3& getPosition() const {return pos_;}
+  TVector3 getPos() const {return TVector3(pos_(0), pos_(1), pos_(2));}
+  //! 3x3 covariance of the position
+  const Matrix3x3Sym& getCov() const {return cov_;}
+  double getChi2() const {return chi2_;}
+  double getNdf() const {return ndf_;}
+  //! Number of (re-linearization) iterations of the fit
+  unsigned int getNIterations() const {return nIterations_;}
+  //! False if the vertex still moved more than the convergence distance in the last iteration
+  bool isConverged() const {return converged_;}
+
+  unsigned int getNTracks() const {return tracks_.size();}
+  const VertexTrackParameters& getParameters(unsigned int i) const {return tracks_[i];}
+
+  void Print() const;
+
+ private:
+
+  friend class VertexFitter;
+  friend class VertexFinder;
+
+  Vector3 pos_;
+  Matrix3x3Sym cov_;
+  double chi2_;
+  double ndf_;
+  unsigned int nIterations_;
+  bool converged_;
+  std::vector<VertexTrackParameters> tracks_;
+
+};
+
+} /* End of namespace genfit */
+/** @} */
+
+#endif // genfit_FittedVertex_h
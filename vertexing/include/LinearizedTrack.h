@@ -0,0 +1,124 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @addtogroup vertexing
+ * @{
+ */
+
+#ifndef genfit_LinearizedTrack_h
+#define genfit_LinearizedTrack_h
+
+#include "EigenMatrixTypedefs.h"
+
+
+namespace genfit {
+
+/**
+ * @brief Track parameters linearized in vertex position and track momentum.
+ *
+ * The track parameters (q/p, u', v', u, v) on a plane (origin o, directions u, v and normal w)
+ * are expressed by the vertex position x and the momentum p at the vertex:
+ *
+ *   q/p = Q/|p|,  u' = p.u / p.w,  v' = p.v / p.w,  (u, v) = intersection of the line (x, p) with the plane.
+ *
+ * For a plane close to the vertex (e.g. through the POCA of the track to the vertex estimate)
+ * the straight line model is sufficient, the track is re-linearized when the vertex moves.
+ * The model is linearized around (x0, p0): h(x, p) = h(x0, p0) + A (x - x0) + B (p - p0),
+ * with the measured parameters q and their weight matrix G the momentum can be eliminated
+ * (Billoir-Fruehwirth) to give the contribution A^T G_B A, A^T G_B (q - c) of the track
+ * to the vertex normal equations with G_B = G - G B (B^T G B)^-1 B^T G.
+ *
+ * All matrices are fixed size Eigen matrices.
+ */
+class LinearizedTrack {
+
+ public:
+
+  LinearizedTrack();
+
+  /**
+   * @brief Linearize the track around vertex position and momentum.
+   *
+   * Throws genfit::Exception if the covariance matrix is not positive definite
+   * or the momentum is parallel to the plane.
+   */
+  void linearize(const Vector3& planeO, const Vector3& planeU, const Vector3& planeV,
+      const Vector5& state, const Matrix5x5Sym& cov, double charge,
+      const Vector3& linPos, const Vector3& linMom);
+
+  /**
+   * @brief Linearize again around new vertex position and momentum, same plane and track parameters.
+   *
+   * Re-linearization along a straight line, no extrapolation, only valid close to the plane.
+   */
+  void relinearize(const Vector3& linPos, const Vector3& linMom);
+
+  //! Track parameters on the plane for vertex position and momentum (not linearized).
+  Vector5 predict(const Vector3& pos, const Vector3& mom) const;
+
+  //! Jacobian d(track parameters)/d(vertex position)
+  const Matrix5x3& getPosJacobian() const {return posJacobian_;}
+  //! Jacobian d(track parameters)/d(momentum)
+  const Matrix5x3& getMomJacobian() const {return momJacobian_;}
+  const Vector3& getLinearizationPos() const {return linPos_;}
+  const Vector3& getLinearizationMom() const {return linMom_;}
+
+  //! Add (weighted) contribution of the track to the vertex normal equations.
+  void addToVertex(double weight, Matrix3x3Sym& vertexWeight, Vector3& vertexRhs) const;
+
+  //! Chi2 of the track for the vertex position (momentum fitted).
+  double getChi2(const Vector3& pos) const;
+
+  //! Momentum at the vertex, fitted for the vertex position.
+  Vector3 getMom(const Vector3& pos) const;
+
+  /**
+   * @brief Covariance of the fitted momentum and its correlation to the vertex position.
+   *
+   * @param vertexCov Covariance of the vertex position
+   * @param momCov Covariance of the momentum
+   * @param posMomCov Covariance (position, momentum)
+   */
+  void getMomCov(const Matrix3x3Sym& vertexCov, Matrix3x3Sym& momCov, Matrix3x3& posMomCov) const;
+
+ private:
+
+  Vector3 o_;
+  Vector3 u_;
+  Vector3 v_;
+  Vector3 w_;
+  double charge_;
+  Vector5 state_;
+
+  Vector3 linPos_;
+  Vector3 linMom_;
+
+  Matrix5x3 posJacobian_; // A
+  Matrix5x3 momJacobian_; // B
+  Vector5 residual_; // q - c, c = h(x0, p0) - A x0 - B p0
+  Matrix5x5Sym weight_; // G
+  Matrix5x5Sym reducedWeight_; // G_B
+  Matrix3x3Sym momWeightInv_; // (B^T G B)^-1
+  Matrix3x5 momGain_; // (B^T G B)^-1 B^T G
+
+};
+
+} /* End of namespace genfit */
+/** @} */
+
+#endif // genfit_LinearizedTrack_h
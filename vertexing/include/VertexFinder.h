@@ -0,0 +1,148 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @addtogroup vertexing
+ * @{
+ */
+
+#ifndef genfit_VertexFinder_h
+#define genfit_VertexFinder_h
+
+#include "FittedVertex.h"
+#include "LinearizedTrack.h"
+#include "MeasuredStateOnPlane.h"
+#include "VertexFitter.h"
+
+#include <TVector3.h>
+
+#include <vector>
+
+
+namespace genfit {
+
+/**
+ * @brief Primary and secondary vertex finder, native replacement of the Rave finders.
+ *
+ * Primary vertices:
+ * all tracks are extrapolated to the POCA to the beam line (AbsTrackRep::extrapolateToLine)
+ * and linearized there. Tracks with an impact parameter below the cut are sorted in z0
+ * (position along the beam line) and split into clusters where neighbouring z0 are further apart
+ * than the z separation. Each cluster is fitted with the adaptive vertex fit of the linearized tracks;
+ * tracks with low weight and the tracks of failed or too small clusters are clustered again in the next pass.
+ *
+ * Secondary vertices (V0s):
+ * every track is approximated by chords of the helix (in the field at the POCA) from its POCA
+ * to the beam line to its state, with sagittas below a quarter of the maximum pair distance.
+ * The chords are entered into a uniform spatial grid (hashed cells), only pairs of tracks sharing
+ * a cell are tested (distance of closest approach, decay radius) and fitted (VertexFitter::fit).
+ *
+ * Extrapolation (track representations, field and material are not thread safe) and the
+ * final fits of secondary vertices are done track by track; the fits of the clusters and
+ * the pair search run in parallel on nThreads threads.
+ */
+class VertexFinder {
+
+ public:
+
+  VertexFinder();
+
+  //! Beam line (default: z axis)
+  void setBeamLine(const TVector3& point, const TVector3& direction);
+  //! Tracks with a larger distance (cm) to the beam line are not used for primary vertices.
+  void setMaxImpactParameter(double d0) {maxImpactParameter_ = d0;}
+  //! Clusters of z0 are split at gaps larger than this (cm).
+  void setZSeparation(double dz) {zSeparation_ = dz;}
+  //! Minimum number of tracks (with weight above minimum weight) of a vertex.
+  void setMinTracks(unsigned int n) {minTracks_ = n;}
+  //! Tracks with lower weight in the adaptive fit are not assigned to the vertex.
+  void setMinWeight(double w) {minWeight_ = w;}
+  void setMaxPasses(unsigned int n) {maxPasses_ = n;}
+  //! Number of threads (0: hardware concurrency)
+  void setNThreads(unsigned int n) {nThreads_ = n;}
+
+  //! Maximum distance of closest approach (cm) of the track paths for secondary vertices.
+  void setMaxPairDistance(double dca) {maxPairDistance_ = dca;}
+  //! Minimum distance (cm) of secondary vertices to the beam line.
+  void setMinDecayRadius(double r) {minDecayRadius_ = r;}
+  void setMaxSecondaryChi2(double chi2) {maxSecondaryChi2_ = chi2;}
+  //! Only pairs of tracks with opposite charge (V0s).
+  void setOppositeCharge(bool opt = true) {oppositeCharge_ = opt;}
+  //! Cell size (cm) of the spatial grid of the pair search.
+  void setCellSize(double size) {cellSize_ = size;}
+
+  //! Fitter (settings) used for the vertex fits; beam spot is not used for secondary vertices.
+  VertexFitter& getFitter() {return fitter_;}
+
+  /**
+   * @brief Find primary vertices, sorted in z0.
+   *
+   * Tracks of the vertices are the tracks with weight above the minimum weight,
+   * with pointers to the states, in the order of the input states.
+   */
+  void findPrimaryVertices(const std::vector<const MeasuredStateOnPlane*>& states, std::vector<FittedVertex>& vertices);
+
+  //! Find secondary vertices of track pairs.
+  void findSecondaryVertices(const std::vector<const MeasuredStateOnPlane*>& states, std::vector<FittedVertex>& vertices);
+
+ private:
+
+  //! Track at POCA to the beam line
+  struct BeamLineTrack {
+    bool usable_;
+    double z0_;
+    double d0_;
+    double charge_;
+    Vector3 poca_;
+    Vector3 statePos_;
+    std::vector<Vector3> path_; // points on the helix from poca_ to statePos_
+    LinearizedTrack linTrack_;
+  };
+
+  //! Extrapolate all tracks to the beam line (track by track).
+  void prepareTracks(const std::vector<const MeasuredStateOnPlane*>& states);
+  //! Chords of the helix from the POCA with momentum mom over the arc length to the state.
+  void fillPath(BeamLineTrack& track, const Vector3& mom, double length) const;
+  unsigned int getNThreads(unsigned int nJobs) const;
+
+  Vector3 beamPoint_;
+  Vector3 beamDirection_;
+  double maxImpactParameter_;
+  double zSeparation_;
+  unsigned int minTracks_;
+  double minWeight_;
+  unsigned int maxPasses_;
+  unsigned int nThreads_;
+
+  double maxPairDistance_;
+  double minDecayRadius_;
+  double maxSecondaryChi2_;
+  bool oppositeCharge_;
+  double cellSize_;
+
+  VertexFitter fitter_;
+
+  // work space (reused)
+  std::vector<BeamLineTrack> tracks_;
+  MeasuredStateOnPlane workState_;
+
+};
+
+} /* End of namespace genfit */
+/** @} */
+
+#endif // genfit_VertexFinder_h
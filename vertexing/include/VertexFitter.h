@@ -0,0 +1,142 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @addtogroup vertexing
+ * @{
+ */
+
+#ifndef genfit_VertexFitter_h
+#define genfit_VertexFitter_h
+
+#include "FittedVertex.h"
+#include "LinearizedTrack.h"
+#include "MeasuredStateOnPlane.h"
+
+#include <TMatrixDSym.h>
+#include <TVector3.h>
+
+#include <vector>
+
+
+namespace genfit {
+
+class Track;
+
+/**
+ * @brief Vertex fitter working directly on MeasuredStateOnPlane, independent of Rave.
+ *
+ * Billoir/Kalman vertex fit: the tracks are extrapolated with their AbsTrackRep (e.g. RKTrackRep)
+ * to the POCA to the vertex estimate and linearized there (LinearizedTrack),
+ * the momenta are eliminated and the vertex position is obtained from the sum of the
+ * 3x3 contributions of all tracks. The fit is iterated with re-linearization
+ * of all tracks at the new vertex position until the vertex moves less than
+ * the convergence distance.
+ *
+ * The adaptive vertex fit (Fruehwirth, Waltenberger) down-weights outliers with the weights
+ *   w = exp(-chi2/2T) / (exp(-chi2/2T) + exp(-chi2Cut/2T))
+ * of the track chi2 for the current vertex, annealing the temperature T
+ * from the initial temperature down to 1 (T -> 1 + ratio * (T - 1)).
+ *
+ * Optionally a beam spot (position and covariance) is used as prior.
+ *
+ * A VertexFitter keeps work space between fits and is not thread safe,
+ * use one fitter per thread.
+ */
+class VertexFitter {
+
+ public:
+
+  VertexFitter();
+
+  //! Maximum number of (re-linearization) iterations.
+  void setMaxIterations(unsigned int n) {maxIterations_ = (n > 0 ? n : 1);}
+  //! Fit has converged if the vertex moves less than this distance (cm) in an iteration.
+  void setConvergenceDistance(double dist) {convergenceDistance_ = dist;}
+  //! Annealing of the adaptive fit: initial temperature, ratio and chi2 cut of the weights.
+  void setAnnealing(double initialTemperature, double ratio, double chi2Cut);
+  void setBeamSpot(const TVector3& pos, const TMatrixDSym& cov);
+  void clearBeamSpot() {useBeamSpot_ = false;}
+
+  /**
+   * @brief Billoir/Kalman fit of the vertex of the states.
+   *
+   * @param states States of the tracks (with AbsTrackRep and covariance)
+   * @param vertex Result
+   * @param seed Start value for the vertex position
+   * @return false if the fit failed (less than 2 usable tracks or singular vertex covariance)
+   * or did not converge within the maximum number of iterations. In the latter case the vertex
+   * holds the result of the last iteration, see FittedVertex::isConverged().
+   */
+  bool fit(const std::vector<const MeasuredStateOnPlane*>& states, FittedVertex& vertex, const TVector3& seed);
+  //! Billoir/Kalman fit, seed from the beam spot (if set) or the mean position of the states.
+  bool fit(const std::vector<const MeasuredStateOnPlane*>& states, FittedVertex& vertex);
+
+  //! Adaptive (annealed) vertex fit of the states.
+  bool fitAdaptive(const std::vector<const MeasuredStateOnPlane*>& states, FittedVertex& vertex, const TVector3& seed);
+  //! Adaptive vertex fit, seed from the beam spot (if set) or the mean position of the states.
+  bool fitAdaptive(const std::vector<const MeasuredStateOnPlane*>& states, FittedVertex& vertex);
+
+  //! Fit the vertex of the fitted states (first hit, cardinal rep) of the tracks.
+  bool fit(const std::vector<Track*>& tracks, FittedVertex& vertex, bool adaptive = false);
+
+  /**
+   * @brief Fit the vertex of already linearized tracks.
+   *
+   * The tracks are re-linearized on their planes along straight lines, without extrapolation,
+   * so the planes have to be close to the vertex (e.g. at the POCA to the beam line).
+   * Does not use the track representations, field or material and is therefore thread safe
+   * (with one fitter per thread).
+   */
+  bool fit(const std::vector<LinearizedTrack>& tracks, FittedVertex& vertex, const Vector3& seed, bool adaptive = false);
+
+  //! Weight of a track with chi2 in the adaptive fit at temperature.
+  double getAdaptiveWeight(double chi2, double temperature) const;
+
+ private:
+
+  //! Iterated fit, with states (extrapolated) or of the linearized tracks in the work space (states == nullptr).
+  bool fitVertex(const std::vector<const MeasuredStateOnPlane*>* states, FittedVertex& vertex,
+      const Vector3& seed, bool adaptive);
+  //! Extrapolate all usable tracks to the POCA to pos and linearize them there, tracks with non 5D reps are not usable.
+  unsigned int linearizeTracks(const std::vector<const MeasuredStateOnPlane*>& states, const Vector3& pos);
+  //! Re-linearize all usable tracks of the work space at pos (along straight lines), not in the first iteration.
+  unsigned int relinearizeTracks(const Vector3& pos, bool first);
+  Vector3 getSeed(const std::vector<const MeasuredStateOnPlane*>& states) const;
+
+  unsigned int maxIterations_;
+  double convergenceDistance_;
+  double initialTemperature_;
+  double annealingRatio_;
+  double chi2Cut_;
+
+  bool useBeamSpot_;
+  Vector3 beamSpotPos_;
+  Matrix3x3Sym beamSpotWeight_;
+
+  // work space (reused)
+  std::vector<LinearizedTrack> linTracks_;
+  std::vector<char> usable_;
+  std::vector<double> weights_;
+  MeasuredStateOnPlane workState_;
+
+};
+
+} /* End of namespace genfit */
+/** @} */
+
+#endif // genfit_VertexFitter_h
@@ -0,0 +1,47 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "FittedVertex.h"
+
+#include "IO.h"
+
+
+namespace genfit {
+
+FittedVertex::FittedVertex() :
+  pos_(Vector3::Zero()), cov_(Matrix3x3Sym::Zero()), chi2_(0), ndf_(0), nIterations_(0), converged_(false), tracks_()
+{
+  ;
+}
+
+
+void FittedVertex::Print() const {
+  printOut << "FittedVertex\n";
+  printOut << "Position: " << pos_.transpose() << "\n";
+  printOut << "Covariance:\n" << cov_ << "\n";
+  printOut << "Ndf: " << ndf_ << ", Chi2: " << chi2_ << ", Iterations: " << nIterations_
+            << (converged_ ? "" : " (not converged)") << "\n";
+  printOut << "Number of tracks: " << tracks_.size() << "\n";
+  for (unsigned int i = 0; i < tracks_.size(); ++i) {
+    printOut << "  track " << i << ": weight " << tracks_[i].weight_ << ", chi2 " << tracks_[i].chi2_
+             << ", momentum " << tracks_[i].mom_.transpose() << "\n";
+  }
+}
+
+} /* End of namespace genfit */
@@ -0,0 +1,149 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LinearizedTrack.h"
+
+#include "Exception.h"
+
+#include <cmath>
+
+
+namespace genfit {
+
+LinearizedTrack::LinearizedTrack() :
+  o_(Vector3::Zero()), u_(Vector3::UnitX()), v_(Vector3::UnitY()), w_(Vector3::UnitZ()), charge_(0), state_(Vector5::Zero()),
+  linPos_(Vector3::Zero()), linMom_(Vector3::Zero()),
+  posJacobian_(Matrix5x3::Zero()), momJacobian_(Matrix5x3::Zero()), residual_(Vector5::Zero()),
+  weight_(Matrix5x5Sym::Zero()), reducedWeight_(Matrix5x5Sym::Zero()),
+  momWeightInv_(Matrix3x3Sym::Zero()), momGain_(Matrix3x5::Zero())
+{
+  ;
+}
+
+
+void LinearizedTrack::linearize(const Vector3& planeO, const Vector3& planeU, const Vector3& planeV,
+    const Vector5& state, const Matrix5x5Sym& cov, double charge,
+    const Vector3& linPos, const Vector3& linMom)
+{
+  o_ = planeO;
+  u_ = planeU;
+  v_ = planeV;
+  w_ = planeU.cross(planeV);
+  charge_ = charge;
+  state_ = state;
+
+  Eigen::LLT<Matrix5x5Sym> covDecomp(cov);
+  if (covDecomp.info() != Eigen::Success) {
+    Exception exc("LinearizedTrack::linearize ==> covariance is not positive definite.",__LINE__,__FILE__);
+    throw exc;
+  }
+  weight_ = covDecomp.solve(Matrix5x5Sym::Identity());
+
+  relinearize(linPos, linMom);
+}
+
+
+void LinearizedTrack::relinearize(const Vector3& linPos, const Vector3& linMom)
+{
+  linPos_ = linPos;
+  linMom_ = linMom;
+
+  const double pw = linMom.dot(w_);
+  const double p = linMom.norm();
+  if (std::fabs(pw) < 1.E-10 * p) {
+    Exception exc("LinearizedTrack::relinearize ==> momentum is parallel to plane.",__LINE__,__FILE__);
+    throw exc;
+  }
+
+  const Vector3 d = linPos - o_;
+  const double dw = d.dot(w_);
+  const double pu = linMom.dot(u_);
+  const double pv = linMom.dot(v_);
+
+  // d(u')/dp, d(v')/dp
+  const Vector3 dSlopeU = (u_ - pu / pw * w_) / pw;
+  const Vector3 dSlopeV = (v_ - pv / pw * w_) / pw;
+
+  posJacobian_.row(0).setZero();
+  posJacobian_.row(1).setZero();
+  posJacobian_.row(2).setZero();
+  posJacobian_.row(3) = (u_ - pu / pw * w_).transpose();
+  posJacobian_.row(4) = (v_ - pv / pw * w_).transpose();
+
+  momJacobian_.row(0) = (-charge_ / (p * p * p) * linMom).transpose();
+  momJacobian_.row(1) = dSlopeU.transpose();
+  momJacobian_.row(2) = dSlopeV.transpose();
+  momJacobian_.row(3) = (-dw * dSlopeU).transpose();
+  momJacobian_.row(4) = (-dw * dSlopeV).transpose();
+
+  residual_ = state_ - predict(linPos, linMom) + posJacobian_ * linPos + momJacobian_ * linMom;
+
+  const Matrix3x5 BtG = momJacobian_.transpose() * weight_;
+  Eigen::LLT<Matrix3x3Sym> momDecomp(BtG * momJacobian_);
+  if (momDecomp.info() != Eigen::Success) {
+    Exception exc("LinearizedTrack::relinearize ==> momentum is not constrained by track.",__LINE__,__FILE__);
+    throw exc;
+  }
+  momWeightInv_ = momDecomp.solve(Matrix3x3Sym::Identity());
+  momGain_ = momWeightInv_ * BtG;
+  reducedWeight_ = weight_ - BtG.transpose() * momGain_;
+}
+
+
+Vector5 LinearizedTrack::predict(const Vector3& pos, const Vector3& mom) const
+{
+  const double pw = mom.dot(w_);
+  const Vector3 d = pos - o_;
+  const Vector3 onPlane = d - d.dot(w_) / pw * mom;
+
+  Vector5 retVal;
+  retVal << charge_ / mom.norm(), mom.dot(u_) / pw, mom.dot(v_) / pw, onPlane.dot(u_), onPlane.dot(v_);
+  return retVal;
+}
+
+
+void LinearizedTrack::addToVertex(double weight, Matrix3x3Sym& vertexWeight, Vector3& vertexRhs) const
+{
+  const Matrix3x5 AtGB = posJacobian_.transpose() * reducedWeight_;
+  vertexWeight.noalias() += weight * AtGB * posJacobian_;
+  vertexRhs.noalias() += weight * AtGB * residual_;
+}
+
+
+double LinearizedTrack::getChi2(const Vector3& pos) const
+{
+  const Vector5 res = residual_ - posJacobian_ * pos;
+  return res.dot(reducedWeight_ * res);
+}
+
+
+Vector3 LinearizedTrack::getMom(const Vector3& pos) const
+{
+  return momGain_ * (residual_ - posJacobian_ * pos);
+}
+
+
+void LinearizedTrack::getMomCov(const Matrix3x3Sym& vertexCov, Matrix3x3Sym& momCov, Matrix3x3& posMomCov) const
+{
+  const Matrix3x3 E = momGain_ * posJacobian_;
+  posMomCov = -vertexCov * E.transpose();
+  momCov = momWeightInv_ + E * vertexCov * E.transpose();
+}
+
+} /* End of namespace genfit */
@@ -0,0 +1,465 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "VertexFinder.h"
+
+#include "AbsTrackRep.h"
+#include "Exception.h"
+#include "FieldManager.h"
+#include "IO.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+
+
+namespace {
+
+  using genfit::Vector3;
+
+  // Candidate pair of tracks for a secondary vertex
+  struct TrackPair {
+    unsigned int first;
+    unsigned int second;
+    Vector3 point; // middle of the closest approach of the paths
+
+    bool operator<(const TrackPair& other) const {
+      return first < other.first || (first == other.first && second < other.second);
+    }
+    bool operator==(const TrackPair& other) const {
+      return first == other.first && second == other.second;
+    }
+  };
+
+  double clampUnit(double x) {
+    return std::min(1., std::max(0., x));
+  }
+
+  // Distance of closest approach of the segments (p1, q1) and (p2, q2), and the middle point between them
+  double segmentDistance(const Vector3& p1, const Vector3& q1, const Vector3& p2, const Vector3& q2, Vector3& middle) {
+    const double eps = 1.E-12;
+    const Vector3 d1 = q1 - p1;
+    const Vector3 d2 = q2 - p2;
+    const Vector3 r = p1 - p2;
+    const double a = d1.squaredNorm();
+    const double e = d2.squaredNorm();
+    const double f = d2.dot(r);
+    double s = 0., t = 0.;
+
+    if (a <= eps && e <= eps) {
+      s = t = 0.;
+    }
+    else if (a <= eps) {
+      t = clampUnit(f / e);
+    }
+    else {
+      const double c = d1.dot(r);
+      if (e <= eps) {
+        s = clampUnit(-c / a);
+      }
+      else {
+        const double b = d1.dot(d2);
+        const double denom = a * e - b * b;
+        s = (denom > eps * a * e) ? clampUnit((b * f - c * e) / denom) : 0.;
+        t = (b * s + f) / e;
+        if (t < 0.) {
+          t = 0.;
+          s = clampUnit(-c / a);
+        }
+        else if (t > 1.) {
+          t = 1.;
+          s = clampUnit((b - c) / a);
+        }
+      }
+    }
+
+    const Vector3 c1 = p1 + s * d1;
+    const Vector3 c2 = p2 + t * d2;
+    middle = 0.5 * (c1 + c2);
+    return (c1 - c2).norm();
+  }
+
+  // Distance of closest approach of the polylines through the points of path1 and path2
+  double pathDistance(const std::vector<Vector3>& path1, const std::vector<Vector3>& path2, Vector3& middle) {
+    double minDistance = 1.E99;
+    Vector3 point;
+    middle.setZero();
+    for (unsigned int i = 1; i < path1.size(); ++i) {
+      for (unsigned int j = 1; j < path2.size(); ++j) {
+        const double distance = segmentDistance(path1[i - 1], path1[i], path2[j - 1], path2[j], point);
+        if (distance < minDistance) {
+          minDistance = distance;
+          middle = point;
+        }
+      }
+    }
+    return minDistance;
+  }
+
+  // Point at arc length s on the helix through pos with direction dir (unit vector);
+  // curvature = kappa * B, with dir' = dir x curvature
+  Vector3 helixPoint(const Vector3& pos, const Vector3& dir, const Vector3& curvature, double s) {
+    const double a = curvature.norm();
+    if (a * std::fabs(s) < 1.E-9)
+      return pos + s * dir;
+    const Vector3 axis = curvature / a;
+    const Vector3 parallel = dir.dot(axis) * axis;
+    const Vector3 perp = dir - parallel;
+    return pos + s * parallel + (std::sin(a * s) / a) * perp - ((1. - std::cos(a * s)) / a) * axis.cross(perp);
+  }
+
+  // Key of the cell (ix, iy, iz) of the spatial grid
+  unsigned long long cellKey(long long ix, long long iy, long long iz) {
+    const unsigned long long mask = 0x1FFFFF;
+    return ((static_cast<unsigned long long>(ix) & mask) << 42) |
+           ((static_cast<unsigned long long>(iy) & mask) << 21) |
+           (static_cast<unsigned long long>(iz) & mask);
+  }
+
+}
+
+
+namespace genfit {
+
+VertexFinder::VertexFinder() :
+  beamPoint_(Vector3::Zero()), beamDirection_(Vector3::UnitZ()),
+  maxImpactParameter_(0.5), zSeparation_(0.1), minTracks_(2), minWeight_(0.5), maxPasses_(5), nThreads_(0),
+  maxPairDistance_(0.05), minDecayRadius_(0.5), maxSecondaryChi2_(10.), oppositeCharge_(true), cellSize_(1.),
+  fitter_(), tracks_(), workState_()
+{
+  ;
+}
+
+
+void VertexFinder::setBeamLine(const TVector3& point, const TVector3& direction) {
+  if (direction.Mag2() == 0.) {
+    Exception exc("VertexFinder::setBeamLine ==> direction has zero length.",__LINE__,__FILE__);
+    exc.setFatal();
+    throw exc;
+  }
+  beamPoint_ << point.X(), point.Y(), point.Z();
+  beamDirection_ << direction.X(), direction.Y(), direction.Z();
+  beamDirection_.normalize();
+}
+
+
+void VertexFinder::findPrimaryVertices(const std::vector<const MeasuredStateOnPlane*>& states, std::vector<FittedVertex>& vertices) {
+  vertices.clear();
+  prepareTracks(states);
+
+  std::vector<unsigned int> pool;
+  for (unsigned int i = 0; i < tracks_.size(); ++i) {
+    if (tracks_[i].usable_ && tracks_[i].d0_ < maxImpactParameter_)
+      pool.push_back(i);
+  }
+  auto byZ0 = [this](unsigned int a, unsigned int b) {return tracks_[a].z0_ < tracks_[b].z0_;};
+  std::sort(pool.begin(), pool.end(), byZ0);
+
+  std::vector<std::pair<unsigned int, unsigned int> > clusters; // [begin, end) in pool
+  std::vector<FittedVertex> found;
+  std::vector<char> fitted;
+  std::vector<unsigned int> nextPool;
+
+  for (unsigned int pass = 0; pass < maxPasses_; ++pass) {
+    // split sorted z0 at gaps
+    clusters.clear();
+    nextPool.clear();
+    unsigned int begin = 0;
+    for (unsigned int k = 1; k <= pool.size(); ++k) {
+      if (k < pool.size() && tracks_[pool[k]].z0_ - tracks_[pool[k - 1]].z0_ <= zSeparation_)
+        continue;
+      if (k - begin >= std::max(2u, minTracks_))
+        clusters.push_back(std::make_pair(begin, k));
+      else
+        nextPool.insert(nextPool.end(), pool.begin() + begin, pool.begin() + k);
+      begin = k;
+    }
+    if (clusters.empty())
+      break;
+
+    // adaptive fits of the clusters in parallel
+    found.assign(clusters.size(), FittedVertex());
+    fitted.assign(clusters.size(), 0);
+    const unsigned int nThreads = getNThreads(clusters.size());
+    std::vector<VertexFitter> fitters(nThreads, fitter_);
+    std::atomic<unsigned int> nextCluster(0);
+    auto worker = [&](VertexFitter& fitter) {
+      std::vector<LinearizedTrack> linTracks;
+      unsigned int icl;
+      while ((icl = nextCluster++) < clusters.size()) {
+        linTracks.clear();
+        double sumZ0 = 0;
+        for (unsigned int k = clusters[icl].first; k < clusters[icl].second; ++k) {
+          linTracks.push_back(tracks_[pool[k]].linTrack_);
+          sumZ0 += tracks_[pool[k]].z0_;
+        }
+        const Vector3 seed = beamPoint_ + sumZ0 / linTracks.size() * beamDirection_;
+        fitted[icl] = fitter.fit(linTracks, found[icl], seed, true);
+      }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned int ithr = 1; ithr < nThreads; ++ithr)
+      threads.emplace_back(worker, std::ref(fitters[ithr]));
+    worker(fitters[0]);
+    for (auto& thread : threads)
+      thread.join();
+
+    // accept vertices, tracks with low weight and of rejected clusters are clustered again
+    unsigned int nAccepted = 0;
+    for (unsigned int icl = 0; icl < clusters.size(); ++icl) {
+      FittedVertex& vertex = found[icl];
+      unsigned int nAssigned = 0;
+      if (fitted[icl]) {
+        for (unsigned int k = clusters[icl].first; k < clusters[icl].second; ++k) {
+          if (vertex.tracks_[k - clusters[icl].first].weight_ >= minWeight_)
+            ++nAssigned;
+        }
+      }
+      if (nAssigned < minTracks_) {
+        nextPool.insert(nextPool.end(), pool.begin() + clusters[icl].first, pool.begin() + clusters[icl].second);
+        continue;
+      }
+
+      // tracks of the vertex in the order of the input states
+      std::vector<unsigned int> members;
+      for (unsigned int k = clusters[icl].first; k < clusters[icl].second; ++k) {
+        if (vertex.tracks_[k - clusters[icl].first].weight_ >= minWeight_)
+          members.push_back(k);
+        else
+          nextPool.push_back(pool[k]);
+      }
+      std::sort(members.begin(), members.end(), [&pool](unsigned int a, unsigned int b) {return pool[a] < pool[b];});
+      std::vector<VertexTrackParameters> assigned;
+      assigned.reserve(nAssigned);
+      for (unsigned int k : members) {
+        assigned.push_back(vertex.tracks_[k - clusters[icl].first]);
+        assigned.back().state_ = states[pool[k]];
+      }
+      vertex.tracks_.swap(assigned);
+      vertices.push_back(vertex);
+      ++nAccepted;
+    }
+    if (nAccepted == 0)
+      break;
+
+    pool.swap(nextPool);
+    std::sort(pool.begin(), pool.end(), byZ0);
+  }
+
+  std::sort(vertices.begin(), vertices.end(), [this](const FittedVertex& a, const FittedVertex& b) {
+    return (a.getPosition() - beamPoint_).dot(beamDirection_) < (b.getPosition() - beamPoint_).dot(beamDirection_);
+  });
+}
+
+
+void VertexFinder::findSecondaryVertices(const std::vector<const MeasuredStateOnPlane*>& states, std::vector<FittedVertex>& vertices) {
+  vertices.clear();
+  prepareTracks(states);
+
+  // spatial grid of the paths (POCA to beam line, state). The paths are sampled every half cell,
+  // so a sample is at most a quarter cell away from any path point; inflating the cells by
+  // the maximum distance plus a quarter cell, two paths closer than the maximum distance share a cell.
+  // Samples too close to the beam line to be near an accepted vertex are left out.
+  const double inflation = maxPairDistance_ + 0.25 * cellSize_;
+  const double minSampleRadius = minDecayRadius_ - inflation;
+  std::unordered_map<unsigned long long, std::vector<unsigned int> > grid;
+  std::vector<unsigned long long> trackCells;
+  for (unsigned int i = 0; i < tracks_.size(); ++i) {
+    if (!tracks_[i].usable_)
+      continue;
+    const std::vector<Vector3>& path = tracks_[i].path_;
+    trackCells.clear();
+    for (unsigned int ichord = 1; ichord < path.size(); ++ichord) {
+      const Vector3& a = path[ichord - 1];
+      const Vector3 chord = path[ichord] - a;
+      const unsigned int nSteps = static_cast<unsigned int>(std::ceil(chord.norm() / (0.5 * cellSize_)));
+      for (unsigned int step = 0; step <= nSteps; ++step) {
+        const Vector3 p = (nSteps > 0) ? Vector3(a + chord * (double(step) / nSteps)) : a;
+        if (minSampleRadius > 0.) {
+          const Vector3 d = p - beamPoint_;
+          if ((d - d.dot(beamDirection_) * beamDirection_).norm() < minSampleRadius)
+            continue;
+        }
+        const Vector3 low = ((p.array() - inflation) / cellSize_).floor().matrix();
+        const Vector3 high = ((p.array() + inflation) / cellSize_).floor().matrix();
+        for (long long ix = low(0); ix <= high(0); ++ix)
+          for (long long iy = low(1); iy <= high(1); ++iy)
+            for (long long iz = low(2); iz <= high(2); ++iz)
+              trackCells.push_back(cellKey(ix, iy, iz));
+      }
+    }
+    std::sort(trackCells.begin(), trackCells.end());
+    trackCells.erase(std::unique(trackCells.begin(), trackCells.end()), trackCells.end());
+    for (unsigned int k = 0; k < trackCells.size(); ++k)
+      grid[trackCells[k]].push_back(i);
+  }
+
+  std::vector<const std::vector<unsigned int>*> cells;
+  for (auto& cell : grid) {
+    if (cell.second.size() > 1)
+      cells.push_back(&cell.second);
+  }
+
+  // test pairs of tracks in the same cell in parallel
+  const unsigned int nThreads = getNThreads(cells.size());
+  std::vector<std::vector<TrackPair> > threadPairs(std::max(1u, nThreads));
+  std::atomic<unsigned int> nextCell(0);
+  auto worker = [&](std::vector<TrackPair>& pairs) {
+    unsigned int icell;
+    while ((icell = nextCell++) < cells.size()) {
+      const std::vector<unsigned int>& cell = *(cells[icell]);
+      for (unsigned int a = 0; a < cell.size(); ++a) {
+        const BeamLineTrack& first = tracks_[cell[a]];
+        for (unsigned int b = a + 1; b < cell.size(); ++b) {
+          const BeamLineTrack& second = tracks_[cell[b]];
+          if (oppositeCharge_ && first.charge_ * second.charge_ >= 0.)
+            continue;
+          TrackPair pair;
+          if (pathDistance(first.path_, second.path_, pair.point) > maxPairDistance_)
+            continue;
+          const Vector3 d = pair.point - beamPoint_;
+          if ((d - d.dot(beamDirection_) * beamDirection_).norm() < minDecayRadius_)
+            continue;
+          pair.first = cell[a];
+          pair.second = cell[b];
+          pairs.push_back(pair);
+        }
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (unsigned int ithr = 1; ithr < nThreads; ++ithr)
+    threads.emplace_back(worker, std::ref(threadPairs[ithr]));
+  worker(threadPairs[0]);
+  for (auto& thread : threads)
+    thread.join();
+
+  // pairs are found in several cells
+  std::vector<TrackPair> pairs;
+  for (unsigned int ithr = 0; ithr < threadPairs.size(); ++ithr)
+    pairs.insert(pairs.end(), threadPairs[ithr].begin(), threadPairs[ithr].end());
+  std::sort(pairs.begin(), pairs.end());
+  pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+  // fits with extrapolation, track by track
+  VertexFitter fitter(fitter_);
+  fitter.clearBeamSpot();
+  std::vector<const MeasuredStateOnPlane*> pairStates(2);
+  FittedVertex vertex;
+  for (unsigned int ip = 0; ip < pairs.size(); ++ip) {
+    pairStates[0] = states[pairs[ip].first];
+    pairStates[1] = states[pairs[ip].second];
+    const Vector3& seed = pairs[ip].point;
+    if (!fitter.fit(pairStates, vertex, TVector3(seed(0), seed(1), seed(2))))
+      continue;
+    if (vertex.getNTracks() != 2 || vertex.getParameters(0).weight_ <= 0. || vertex.getParameters(1).weight_ <= 0.)
+      continue;
+    if (vertex.getChi2() > maxSecondaryChi2_)
+      continue;
+    const Vector3 d = vertex.getPosition() - beamPoint_;
+    if ((d - d.dot(beamDirection_) * beamDirection_).norm() < minDecayRadius_)
+      continue;
+    vertices.push_back(vertex);
+  }
+}
+
+
+void VertexFinder::prepareTracks(const std::vector<const MeasuredStateOnPlane*>& states) {
+  const TVector3 linePoint(beamPoint_(0), beamPoint_(1), beamPoint_(2));
+  const TVector3 lineDirection(beamDirection_(0), beamDirection_(1), beamDirection_(2));
+
+  tracks_.resize(states.size());
+  for (unsigned int i = 0; i < states.size(); ++i) {
+    BeamLineTrack& track = tracks_[i];
+    track.usable_ = false;
+
+    const AbsTrackRep* rep = states[i]->getRep();
+    if (rep->getDim() != 5) {
+      errorOut << "VertexFinder::prepareTracks ==> track " << i << " can not be used: only 5 dimensional track parameters are supported.\n";
+      continue;
+    }
+
+    try {
+      const TVector3 statePos = states[i]->getPos();
+      track.statePos_ << statePos.X(), statePos.Y(), statePos.Z();
+
+      workState_ = *(states[i]);
+      const double length = rep->extrapolateToLine(workState_, linePoint, lineDirection);
+
+      TVector3 pos, mom;
+      rep->getPosMom(workState_, pos, mom);
+      track.poca_ << pos.X(), pos.Y(), pos.Z();
+      const Vector3 d = track.poca_ - beamPoint_;
+      track.z0_ = d.dot(beamDirection_);
+      track.d0_ = (d - track.z0_ * beamDirection_).norm();
+      track.charge_ = rep->getCharge(workState_);
+      fillPath(track, Vector3(mom.X(), mom.Y(), mom.Z()), -length);
+
+      const DetPlane& plane = *(workState_.getPlane());
+      track.linTrack_.linearize(Vector3(plane.getO().X(), plane.getO().Y(), plane.getO().Z()),
+          Vector3(plane.getU().X(), plane.getU().Y(), plane.getU().Z()),
+          Vector3(plane.getV().X(), plane.getV().Y(), plane.getV().Z()),
+          Eigen::Map<const Vector5>(workState_.getState().GetMatrixArray()),
+          Eigen::Map<const Matrix5x5Sym>(workState_.getCov().GetMatrixArray()),
+          track.charge_, track.poca_, Vector3(mom.X(), mom.Y(), mom.Z()));
+      track.usable_ = true;
+    }
+    catch (Exception& e) {
+      errorOut << "VertexFinder::prepareTracks ==> track " << i << " can not be used: " << e.what();
+    }
+  }
+}
+
+
+void VertexFinder::fillPath(BeamLineTrack& track, const Vector3& mom, double length) const {
+  // helix in the field at the POCA, dir' = dir x kappa*B with kappa = 0.0299792458E-2 * q/p (GeV, kGauss, cm)
+  const TVector3 field = FieldManager::getInstance()->getFieldVal(TVector3(track.poca_(0), track.poca_(1), track.poca_(2)));
+  const double p = mom.norm();
+  const Vector3 dir = mom / p;
+  const Vector3 curvature = 0.0299792458E-2 * track.charge_ / p * Vector3(field.X(), field.Y(), field.Z());
+
+  // Sagitta of the chords below a quarter of the maximum pair distance, so that the paths of
+  // two tracks from a common vertex pass the pair cut. The sagitta of a chord is
+  // (transverse length)^2 / 8R = |dir x curvature| * (length/nChords)^2 / 8.
+  const unsigned int maxChords = 64;
+  const double sagitta = dir.cross(curvature).norm() * length * length / 8.;
+  const double tolerance = 0.25 * maxPairDistance_;
+  unsigned int nChords = maxChords;
+  if (sagitta < tolerance * maxChords * maxChords)
+    nChords = std::max(1u, static_cast<unsigned int>(std::ceil(std::sqrt(sagitta / tolerance))));
+
+  track.path_.resize(nChords + 1);
+  track.path_[0] = track.poca_;
+  for (unsigned int k = 1; k < nChords; ++k)
+    track.path_[k] = helixPoint(track.poca_, dir, curvature, length * k / nChords);
+  track.path_[nChords] = track.statePos_;
+}
+
+
+unsigned int VertexFinder::getNThreads(unsigned int nJobs) const {
+  unsigned int nThreads = nThreads_;
+  if (nThreads == 0)
+    nThreads = std::max(1u, std::thread::hardware_concurrency());
+  return std::max(1u, std::min(nThreads, nJobs));
+}
+
+} /* End of namespace genfit */
@@ -0,0 +1,302 @@
+/* Copyright 2008-2010, Technische Universitaet Muenchen,
+   Authors: Christian Hoeppner & Sebastian Neubert & Johannes Rauch
+
+   This file is part of GENFIT.
+
+   GENFIT is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published
+   by the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   GENFIT is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with GENFIT.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "VertexFitter.h"
+
+#include "AbsTrackRep.h"
+#include "Exception.h"
+#include "IO.h"
+#include "Track.h"
+
+#include <cmath>
+
+
+namespace genfit {
+
+VertexFitter::VertexFitter() :
+  maxIterations_(30), convergenceDistance_(1.E-4),
+  initialTemperature_(256.), annealingRatio_(0.25), chi2Cut_(9.),
+  useBeamSpot_(false), beamSpotPos_(Vector3::Zero()), beamSpotWeight_(Matrix3x3Sym::Zero()),
+  linTracks_(), usable_(), weights_(), workState_()
+{
+  ;
+}
+
+
+void VertexFitter::setAnnealing(double initialTemperature, double ratio, double chi2Cut) {
+  if (initialTemperature < 1. || ratio < 0. || ratio >= 1.) {
+    Exception exc("VertexFitter::setAnnealing ==> initial temperature must be >= 1 and ratio in [0, 1).",__LINE__,__FILE__);
+    exc.setFatal();
+    throw exc;
+  }
+  initialTemperature_ = initialTemperature;
+  annealingRatio_ = ratio;
+  chi2Cut_ = chi2Cut;
+}
+
+
+void VertexFitter::setBeamSpot(const TVector3& pos, const TMatrixDSym& cov) {
+  Matrix3x3Sym eigenCov;
+  for (unsigned int i = 0; i < 3; ++i)
+    for (unsigned int j = 0; j < 3; ++j)
+      eigenCov(i, j) = cov(i, j);
+
+  Eigen::LLT<Matrix3x3Sym> covDecomp(eigenCov);
+  if (covDecomp.info() != Eigen::Success) {
+    Exception exc("VertexFitter::setBeamSpot ==> covariance is not positive definite.",__LINE__,__FILE__);
+    exc.setFatal();
+    throw exc;
+  }
+  beamSpotPos_ << pos.X(), pos.Y(), pos.Z();
+  beamSpotWeight_ = covDecomp.solve(Matrix3x3Sym::Identity());
+  useBeamSpot_ = true;
+}
+
+
+bool VertexFitter::fit(const std::vector<const MeasuredStateOnPlane*>& states, FittedVertex& vertex, const TVector3& seed) {
+  return fitVertex(&states, vertex, Vector3(seed.X(), seed.Y(), seed.Z()), false);
+}
+
+
+bool VertexFitter::fit(const std::vector<const MeasuredStateOnPlane*>& states, FittedVertex& vertex) {
+  return fitVertex(&states, vertex, getSeed(states), false);
+}
+
+
+bool VertexFitter::fitAdaptive(const std::vector<const MeasuredStateOnPlane*>& states, FittedVertex& vertex, const TVector3& seed) {
+  return fitVertex(&states, vertex, Vector3(seed.X(), seed.Y(), seed.Z()), true);
+}
+
+
+bool VertexFitter::fitAdaptive(const std::vector<const MeasuredStateOnPlane*>& states, FittedVertex& vertex) {
+  return fitVertex(&states, vertex, getSeed(states), true);
+}
+
+
+bool VertexFitter::fit(const std::vector<Track*>& tracks, FittedVertex& vertex, bool adaptive) {
+  std::vector<const MeasuredStateOnPlane*> states;
+  states.reserve(tracks.size());
+  for (unsigned int i = 0; i < tracks.size(); ++i) {
+    states.push_back(&(tracks[i]->getFittedState()));
+  }
+  return fitVertex(&states, vertex, getSeed(states), adaptive);
+}
+
+
+bool VertexFitter::fit(const std::vector<LinearizedTrack>& tracks, FittedVertex& vertex, const Vector3& seed, bool adaptive) {
+  linTracks_ = tracks;
+  return fitVertex(nullptr, vertex, seed, adaptive);
+}
+
+
+double VertexFitter::getAdaptiveWeight(double chi2, double temperature) const {
+  // exp(-chi2/2T) / (exp(-chi2/2T) + exp(-chi2Cut/2T)), safe for large chi2
+  const double arg = (chi2 - chi2Cut_) / (2. * temperature);
+  if (arg > 700.)
+    return 0.;
+  return 1. / (1. + std::exp(arg));
+}
+
+
+bool VertexFitter::fitVertex(const std::vector<const MeasuredStateOnPlane*>* states, FittedVertex& vertex,
+    const Vector3& seed, bool adaptive) {
+
+  // without states the tracks have been linearized already
+  const unsigned int nTracks = states ? states->size() : linTracks_.size();
+  linTracks_.resize(nTracks);
+  usable_.assign(nTracks, 1);
+  weights_.assign(nTracks, 1.);
+
+  vertex.pos_ = seed;
+  vertex.cov_.setZero();
+  vertex.chi2_ = 0;
+  vertex.ndf_ = 0;
+  vertex.nIterations_ = 0;
+  vertex.converged_ = false;
+  vertex.tracks_.assign(nTracks, VertexTrackParameters());
+  if (states) {
+    for (unsigned int i = 0; i < nTracks; ++i) {
+      vertex.tracks_[i].state_ = (*states)[i];
+    }
+  }
+
+  double temperature = adaptive ? initialTemperature_ : 1.;
+  Vector3 pos = seed;
+  Matrix3x3Sym vertexWeight;
+  Vector3 vertexRhs;
+  Eigen::LLT<Matrix3x3Sym> vertexDecomp;
+  bool converged = false;
+
+  for (unsigned int iter = 0; iter < maxIterations_; ++iter) {
+    const unsigned int nUsable = states ? linearizeTracks(*states, pos) : relinearizeTracks(pos, iter == 0);
+    if (nUsable < 2) {
+      debugOut << "VertexFitter::fitVertex ==> less than 2 usable tracks.\n";
+      return false;
+    }
+
+    if (useBeamSpot_) {
+      vertexWeight = beamSpotWeight_;
+      vertexRhs.noalias() = beamSpotWeight_ * beamSpotPos_;
+    }
+    else {
+      vertexWeight.setZero();
+      vertexRhs.setZero();
+    }
+    for (unsigned int i = 0; i < nTracks; ++i) {
+      if (!usable_[i])
+        continue;
+      if (adaptive)
+        weights_[i] = getAdaptiveWeight(linTracks_[i].getChi2(pos), temperature);
+      if (weights_[i] > 0.)
+        linTracks_[i].addToVertex(weights_[i], vertexWeight, vertexRhs);
+    }
+
+    vertexDecomp.compute(vertexWeight);
+    if (vertexDecomp.info() != Eigen::Success) {
+      debugOut << "VertexFitter::fitVertex ==> vertex weight matrix is not positive definite.\n";
+      return false;
+    }
+    const Vector3 newPos = vertexDecomp.solve(vertexRhs);
+    const double shift = (newPos - pos).norm();
+    pos = newPos;
+    vertex.nIterations_ = iter + 1;
+
+    if (temperature > 1.) {
+      temperature = 1. + annealingRatio_ * (temperature - 1.);
+      if (temperature < 1. + 1.E-3)
+        temperature = 1.;
+      continue;
+    }
+    if (shift < convergenceDistance_) {
+      converged = true;
+      break;
+    }
+  }
+
+  if (!converged) {
+    debugOut << "VertexFitter::fitVertex ==> not converged after " << maxIterations_ << " iterations.\n";
+  }
+
+  // final results with the linearization of the last iteration, also if not converged
+  vertex.converged_ = converged;
+  vertex.pos_ = pos;
+  vertex.cov_ = vertexDecomp.solve(Matrix3x3Sym::Identity());
+
+  double sumWeights = 0;
+  for (unsigned int i = 0; i < nTracks; ++i) {
+    if (!usable_[i]) {
+      weights_[i] = 0.;
+      continue;
+    }
+    VertexTrackParameters& trackPar = vertex.tracks_[i];
+    trackPar.weight_ = weights_[i];
+    trackPar.chi2_ = linTracks_[i].getChi2(pos);
+    trackPar.mom_ = linTracks_[i].getMom(pos);
+    linTracks_[i].getMomCov(vertex.cov_, trackPar.momCov_, trackPar.posMomCov_);
+    vertex.chi2_ += trackPar.weight_ * trackPar.chi2_;
+    sumWeights += trackPar.weight_;
+  }
+  vertex.ndf_ = 2. * sumWeights - 3.;
+  if (useBeamSpot_) {
+    const Vector3 diff = pos - beamSpotPos_;
+    vertex.chi2_ += diff.dot(beamSpotWeight_ * diff);
+    vertex.ndf_ += 3.;
+  }
+
+  return converged;
+}
+
+
+unsigned int VertexFitter::linearizeTracks(const std::vector<const MeasuredStateOnPlane*>& states, const Vector3& pos) {
+  const TVector3 point(pos(0), pos(1), pos(2));
+  unsigned int nUsable = 0;
+
+  for (unsigned int i = 0; i < states.size(); ++i) {
+    if (!usable_[i])
+      continue;
+
+    const AbsTrackRep* rep = states[i]->getRep();
+    if (rep->getDim() != 5) {
+      errorOut << "VertexFitter::linearizeTracks ==> track " << i << " can not be used: only 5 dimensional track parameters are supported.\n";
+      usable_[i] = 0;
+      continue;
+    }
+
+    try {
+      workState_ = *(states[i]);
+      rep->extrapolateToPoint(workState_, point);
+
+      const DetPlane& plane = *(workState_.getPlane());
+      const TVector3 mom = rep->getMom(workState_);
+      linTracks_[i].linearize(Vector3(plane.getO().X(), plane.getO().Y(), plane.getO().Z()),
+          Vector3(plane.getU().X(), plane.getU().Y(), plane.getU().Z()),
+          Vector3(plane.getV().X(), plane.getV().Y(), plane.getV().Z()),
+          Eigen::Map<const Vector5>(workState_.getState().GetMatrixArray()),
+          Eigen::Map<const Matrix5x5Sym>(workState_.getCov().GetMatrixArray()),
+          rep->getCharge(workState_),
+          pos, Vector3(mom.X(), mom.Y(), mom.Z()));
+      ++nUsable;
+    }
+    catch (Exception& e) {
+      errorOut << "VertexFitter::linearizeTracks ==> track " << i << " can not be used: " << e.what();
+      usable_[i] = 0;
+    }
+  }
+
+  return nUsable;
+}
+
+
+unsigned int VertexFitter::relinearizeTracks(const Vector3& pos, bool first) {
+  unsigned int nUsable = 0;
+
+  for (unsigned int i = 0; i < linTracks_.size(); ++i) {
+    if (!usable_[i])
+      continue;
+    try {
+      // the tracks are given linearized, afterwards along straight lines to the new position
+      if (!first)
+        linTracks_[i].relinearize(pos, linTracks_[i].getMom(pos));
+      ++nUsable;
+    }
+    catch (Exception& e) {
+      errorOut << "VertexFitter::relinearizeTracks ==> track " << i << " can not be used: " << e.what();
+      usable_[i] = 0;
+    }
+  }
+
+  return nUsable;
+}
+
+
+Vector3 VertexFitter::getSeed(const std::vector<const MeasuredStateOnPlane*>& states) const {
+  if (useBeamSpot_)
+    return beamSpotPos_;
+
+  Vector3 seed(Vector3::Zero());
+  if (states.empty())
+    return seed;
+  for (unsigned int i = 0; i < states.size(); ++i) {
+    const TVector3 pos = states[i]->getPos();
+    seed += Vector3(pos.X(), pos.Y(), pos.Z());
+  }
+  return seed / states.size();
+}
+
+} /* End of namespace genfit */